@@ -211,7 +211,7 @@ PythonDictionary= { 'nil'             : None,
 # [4] KLayout executables including buddy tools
 #-----------------------------------------------------
 KLayoutExecs  = ['klayout']
-KLayoutExecs += ['strm2cif', 'strm2dxf', 'strm2gds', 'strm2gdstxt', 'strm2oas']
+KLayoutExecs += ['strm2cif', 'strm2dxf', 'strm2gds', 'strm2gdstxt', 'strm2img', 'strm2oas']
 KLayoutExecs += ['strm2txt', 'strmclip', 'strmcmp',  'strmrun',     'strmxor']
 
 #----------------
@@ -24,16 +24,36 @@
 #include "tlStaticObjects.h"
 #include "rba.h"
 
-#include <QCoreApplication>
+#if defined(BD_GUI_APP)
+#  include <QApplication>
+#else
+#  include <QCoreApplication>
+#endif
 
+#if defined(BD_GUI_APP)
+//  GUI applications are not part of the bd library, but carry their implementation
+int BD_TARGET (int argc, char *argv []);
+#else
 BD_PUBLIC int BD_TARGET (int argc, char *argv []);
+#endif
 
 /**
  *  @brief The continuation function to support Ruby's special top-level hook
  */
 static int main_cont (int &argc, char **argv)
 {
+#if defined(BD_GUI_APP)
+  //  Applications drawing layouts need a QApplication, but no display.
+  //  With Qt5 we use the "offscreen" platform unless a platform is specified explicitly.
+#  if QT_VERSION >= 0x050000
+  if (qgetenv ("QT_QPA_PLATFORM").isEmpty ()) {
+    qputenv ("QT_QPA_PLATFORM", QByteArray ("offscreen"));
+  }
+#  endif
+  QApplication app (argc, argv);
+#else
   QCoreApplication app (argc, argv);
+#endif
   return bd::_main_impl (&BD_TARGET, argc, argv);
 }
 
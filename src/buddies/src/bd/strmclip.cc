@@ -25,6 +25,7 @@
 #include "dbClip.h"
 #include "dbLayout.h"
 #include "dbGDS2Writer.h"
+#include "dbGDS2Reader.h"
 #include "dbOASISWriter.h"
 #include "dbReader.h"
 #include "tlLog.h"
@@ -72,6 +73,15 @@ void clip (const ClipData &data)
     db::LoadLayoutOptions load_options;
     data.reader_options.configure (load_options);
 
+    //  read only the parts required for the clip if possible
+    if (data.clip_layer.is_null ()) {
+      db::GDS2ReaderOptions &gds2_options = load_options.get_options<db::GDS2ReaderOptions> ();
+      gds2_options.top_cell = data.top;
+      for (std::vector <db::DBox>::const_iterator b = data.clip_boxes.begin (); b != data.clip_boxes.end (); ++b) {
+        gds2_options.region += *b;
+      }
+    }
+
     tl::InputStream stream (data.file_in);
     db::Reader reader (stream);
     reader.read (layout, load_options);
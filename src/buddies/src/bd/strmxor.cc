@@ -70,6 +70,11 @@ public:
     m_count += inserter.count ();
   }
 
+  virtual bool accepts_sub_tiles () const
+  {
+    return true;
+  }
+
   size_t count () const
   {
     return m_count;
@@ -79,6 +84,39 @@ private:
   size_t m_count;
 };
 
+class XORTileOperation
+  : public db::TileOperation
+{
+public:
+  XORTileOperation (size_t input_a, size_t input_b)
+    : m_input_a (input_a), m_input_b (input_b)
+  {
+    //  .. nothing yet ..
+  }
+
+  void add_output (size_t output, double tolerance)
+  {
+    m_outputs.push_back (std::make_pair (output, tolerance));
+  }
+
+  virtual void process (db::TileContext &context) const
+  {
+    db::Region x = context.region (m_input_a) ^ context.region (m_input_b);
+
+    for (std::vector<std::pair<size_t, double> >::const_iterator o = m_outputs.begin (); o != m_outputs.end (); ++o) {
+      if (o->second > db::epsilon) {
+        db::Coord d = db::coord_traits<db::Coord>::rounded (o->second / context.dbu ());
+        x = x.sized (-d / 2).sized (d / 2);
+      }
+      context.output (o->first, x);
+    }
+  }
+
+private:
+  size_t m_input_a, m_input_b;
+  std::vector<std::pair<size_t, double> > m_outputs;
+};
+
 struct ResultDescriptor
 {
   ResultDescriptor ()
@@ -144,6 +182,7 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
   int tolerance_bump = 10000;
   int threads = 1;
   double tile_size = 0.0;
+  bool adaptive = false;
 
   tl::CommandLineOptions cmd;
   generic_reader_options_a.add_options (cmd);
@@ -187,6 +226,11 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
                   "In tiling mode, the layout is divided into tiles of the given size. Each tile is computed "
                   "individually. Multiple tiles can be processed in parallel on multiple cores."
                  )
+      << tl::arg ("--adaptive-tiles",          &adaptive,  "Adapts the tiles to the shape density",
+                  "With this option, tiles with a high shape density are split into smaller ones and empty tiles "
+                  "are combined. The heavy tiles are processed first. This option is effective in tiling mode "
+                  "only and helps balancing the load between multiple threads."
+                 )
       << tl::arg ("-b|--layer-bump=offset",    &tolerance_bump, "Specifies the layer number offset to add for every tolerance",
                   "This value is the number added to the original layer number to form a layer set for each tolerance "
                   "value. If this value is set to 1000, the first tolerance value will produce XOR results on the "
@@ -285,6 +329,8 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
       tl::log << "Tile size: " << tile_size;
     }
     proc.tile_size (tile_size, tile_size);
+    proc.set_adaptive (adaptive);
+    proc.set_cache_inputs (true);
   }
 
   proc.tile_border (tolerances.back () * 2.0, tolerances.back () * 2.0);
@@ -343,6 +389,8 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
       std::string in_a = "a" + tl::to_string (index);
       std::string in_b = "b" + tl::to_string (index);
 
+      XORTileOperation *op = new XORTileOperation (proc.inputs (), proc.inputs () + 1);
+
       if (ll->second.first < 0) {
         proc.input (in_a, db::RecursiveShapeIterator ());
       } else {
@@ -355,8 +403,6 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
         proc.input (in_b, db::RecursiveShapeIterator (layout_b, layout_b.cell (index_b.second), ll->second.second));
       }
 
-      std::string expr = "var x=" + in_a + "^" + in_b + "; ";
-
       int tol_index = 0;
       for (std::vector<double>::const_iterator t = tolerances.begin (); t != tolerances.end (); ++t) {
 
@@ -373,6 +419,8 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
         result.layout = output_layout.get ();
         result.top_cell = output_top;
 
+        op->add_output (proc.outputs (), *t);
+
         if (result.layout) {
           result.layer_output = result.layout->insert_layer (lp);
           proc.output (out, *result.layout, result.top_cell, result.layer_output);
@@ -382,19 +430,14 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
           proc.output (out, 0, counter, db::ICplxTrans ());
         }
 
-        if (*t > db::epsilon) {
-          expr += "x=x.sized(-round(" + tl::to_string (*t) + "/_dbu)/2).sized(round(" + tl::to_string (*t) + "/_dbu)/2); ";
-        }
-        expr += "_output(" + out + ",x); ";
-
         ++tol_index;
 
       }
 
       if (tl::verbosity () >= 20) {
-        tl::log << "Running expression: '" << expr << "' for layer " << ll->first;
+        tl::log << "Running XOR for layer " << ll->first;
       }
-      proc.queue (expr);
+      proc.queue (op);
 
     }
 
@@ -7,6 +7,7 @@ SUBDIRS = \
   strm2dxf \
   strm2gds \
   strm2gdstxt \
+  strm2img \
   strm2oas \
   strm2txt \
   strmclip \
@@ -18,6 +19,7 @@ strm2cif.depends += bd
 strm2dxf.depends += bd
 strm2gds.depends += bd
 strm2gdstxt.depends += bd
+strm2img.depends += bd
 strm2oas.depends += bd
 strm2txt.depends += bd
 strmclip.depends += bd
@@ -0,0 +1,223 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+#include "bdReaderOptions.h"
+#include "layBatchRenderer.h"
+#include "layLayoutView.h"
+#include "tlCommandLineParser.h"
+#include "tlStream.h"
+#include "tlString.h"
+#include "tlLog.h"
+
+#include <algorithm>
+
+struct RenderData
+{
+  RenderData ()
+    : output ("image_%d.png"), width (640), height (480), linewidth (0), oversampling (0), resolution (0.0), threads (1), monochrome (false)
+  { }
+
+  bd::GenericReaderOptions reader_options;
+  std::string file_in;
+  std::string lyp;
+  std::string top;
+  std::string output;
+  std::vector<db::DBox> boxes;
+  std::vector<std::string> filenames;
+  int width, height;
+  int linewidth, oversampling;
+  double resolution;
+  int threads;
+  bool monochrome;
+
+  void add_box (const std::string &spec)
+  {
+    tl::Extractor ex (spec.c_str ());
+    read_box (ex);
+    ex.expect_end ();
+    filenames.push_back (std::string ());
+  }
+
+  void read_boxes (const std::string &fn)
+  {
+    tl::InputStream stream (fn);
+    tl::TextInputStream text_stream (stream);
+
+    while (! text_stream.at_end ()) {
+
+      std::string line = text_stream.get_line ();
+
+      tl::Extractor ex (line.c_str ());
+      if (ex.at_end () || ex.test ("#")) {
+        continue;
+      }
+
+      read_box (ex);
+
+      //  an optional file name may follow the box
+      std::string name;
+      if (! ex.at_end ()) {
+        ex.read_word_or_quoted (name, "_.$-+/\\:");
+      }
+      ex.expect_end ();
+
+      filenames.push_back (name);
+
+    }
+  }
+
+  void set_size (const std::string &spec)
+  {
+    tl::Extractor ex (spec.c_str ());
+    ex.read (width);
+    ex.expect ("x");
+    ex.read (height);
+    ex.expect_end ();
+  }
+
+private:
+  void read_box (tl::Extractor &ex)
+  {
+    double l = 0.0, b = 0.0, r = 0.0, t = 0.0;
+    ex.read (l);
+    ex.expect (",");
+    ex.read (b);
+    ex.expect (",");
+    ex.read (r);
+    ex.expect (",");
+    ex.read (t);
+    boxes.push_back (db::DBox (l, b, r, t));
+  }
+};
+
+static void
+render (const RenderData &data)
+{
+  lay::BatchRenderer renderer;
+
+  renderer.set_size ((unsigned int) std::max (1, data.width), (unsigned int) std::max (1, data.height));
+  renderer.set_linewidth (data.linewidth);
+  renderer.set_oversampling (data.oversampling);
+  renderer.set_resolution (data.resolution);
+  renderer.set_monochrome (data.monochrome);
+  renderer.set_threads (data.threads);
+
+  db::LoadLayoutOptions load_options;
+  data.reader_options.configure (load_options);
+
+  unsigned int cv_index = renderer.load_layout (data.file_in, load_options, std::string ());
+
+  if (! data.top.empty ()) {
+    const lay::CellView &cv = renderer.view ()->cellview (cv_index);
+    std::pair<bool, db::cell_index_type> tc = cv->layout ().cell_by_name (data.top.c_str ());
+    if (! tc.first) {
+      throw tl::Exception ("Cell %s is not a valid cell in the input layout", data.top);
+    }
+    renderer.view ()->select_cell (tc.second, cv_index);
+    renderer.view ()->max_hier ();
+  }
+
+  if (! data.lyp.empty ()) {
+    renderer.load_layer_props (data.lyp);
+  }
+
+  std::vector<db::DBox> boxes = data.boxes;
+  std::vector<std::string> filenames = data.filenames;
+
+  //  without boxes, the whole layout is rendered
+  if (boxes.empty ()) {
+    boxes.push_back (db::DBox ());
+    filenames.push_back (std::string ());
+  }
+
+  for (size_t i = 0; i < filenames.size (); ++i) {
+    if (filenames [i].empty ()) {
+      filenames [i] = tl::sprintf (data.output, int (i + 1));
+    }
+  }
+
+  tl::log << "Rendering " << boxes.size () << " image(s)";
+
+  renderer.render_to_files (boxes, filenames);
+}
+
+int strm2img (int argc, char *argv[])
+{
+  RenderData data;
+
+  tl::CommandLineOptions cmd;
+  data.reader_options.add_options (cmd);
+
+  cmd << tl::arg ("input",                     &data.file_in, "The input file",
+                  "The input file can be any supported format. It can be gzip compressed and will "
+                  "be uncompressed automatically in this case."
+                 )
+      << tl::arg ("-l|--layer-props=file",     &data.lyp, "Specifies the layer properties file",
+                  "If this option is given, the layer properties (colors, stipples etc.) are taken from the "
+                  "given file (usually a \".lyp\" file). Otherwise, default layer properties are used."
+                 )
+      << tl::arg ("-t|--top=cellname",         &data.top, "Specifies the cell to draw",
+                  "If this option is given, it specifies the cell to draw. By default, the top cell is drawn."
+                 )
+      << tl::arg ("*-r|--rect=\"l,b,r,t\"",    &data, &RenderData::add_box, "Specifies a box to render",
+                  "This option specifies a box to render in micrometer units. The box is given "
+                  "by left, bottom, right and top coordinates. This option can be used multiple times "
+                  "to render more than one image."
+                 )
+      << tl::arg ("-b|--boxes=file",           &data, &RenderData::read_boxes, "Takes the boxes to render from a file",
+                  "The file contains one box per line in the \"l,b,r,t\" format (micrometer units). "
+                  "An optional file name may follow the box. If no file name is given, the output "
+                  "pattern is used. Empty lines and lines starting with \"#\" are ignored."
+                 )
+      << tl::arg ("-o|--output=pattern",       &data.output, "Specifies the output file name pattern",
+                  "Images without an explicit file name are written to files named after this pattern. "
+                  "\"%d\" is replaced by the number of the image, starting with 1. The default pattern is "
+                  "\"image_%d.png\". The images are written in PNG format."
+                 )
+      << tl::arg ("-s|--size=\"wxh\"",         &data, &RenderData::set_size, "Specifies the image size",
+                  "The size is given in pixels, i.e. \"200x200\". The default size is 640x480 pixels."
+                 )
+      << tl::arg ("--linewidth=width",         &data.linewidth, "Specifies the line width in pixels",
+                  "Use 0 for the default line width."
+                 )
+      << tl::arg ("--oversampling=factor",     &data.oversampling, "Specifies the oversampling factor",
+                  "Use 0 for the default oversampling."
+                 )
+      << tl::arg ("--resolution=value",        &data.resolution, "Specifies the resolution",
+                  "The resolution is the pixel size compared to a screen pixel (usually 1/oversampling). "
+                  "Use 0 for the default resolution."
+                 )
+      << tl::arg ("-m|--monochrome",           &data.monochrome, "Produces monochrome images")
+      << tl::arg ("-j|--threads=n",            &data.threads, "Specifies the number of threads",
+                  "The threads are used for drawing and writing the images. With 0 threads, the images "
+                  "are drawn and written synchronously."
+                 )
+    ;
+
+  cmd.brief ("This program renders images of layout regions without a main window");
+
+  cmd.parse (argc, argv);
+
+  render (data);
+
+  return 0;
+}
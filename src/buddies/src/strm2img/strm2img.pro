@@ -0,0 +1,11 @@
+
+include($$PWD/../buddy_app.pri)
+
+# strm2img draws layouts and needs a QApplication. It is not part of the bd 
+# library as this would make all buddy tools depend on laybasic.
+DEFINES += BD_GUI_APP
+SOURCES += strm2img.cc
+
+INCLUDEPATH += $$DB_INC $$RDB_INC $$LAYBASIC_INC
+DEPENDPATH += $$DB_INC $$RDB_INC $$LAYBASIC_INC
+LIBS += -lklayout_laybasic
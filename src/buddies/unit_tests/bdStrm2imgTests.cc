@@ -0,0 +1,54 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "bdCommon.h"
+#include "tlUnitTest.h"
+#include "tlInternational.h"
+
+#include <QImage>
+
+//  NOTE: strm2img is not part of the bd library - the test carries the implementation
+int strm2img (int argc, char *argv[]);
+
+TEST(1)
+{
+  std::string input = tl::testsrc ();
+  input += "/testdata/bd/strm2clip_in.gds";
+
+  std::string output = "-o=" + this->tmp_file ("img_%d.png");
+
+  const char *argv[] = { "x", input.c_str (), output.c_str (), "-s=50x40", "-r=0,-2,9,5", "-r=13,-2,16,3", "-j=2" };
+
+  EXPECT_EQ (strm2img (sizeof (argv) / sizeof (argv[0]), (char **) argv), 0);
+
+  QImage img;
+  EXPECT_EQ (img.load (tl::to_qstring (this->tmp_file ("img_1.png"))), true);
+  EXPECT_EQ (img.width (), 50);
+  EXPECT_EQ (img.height (), 40);
+
+  EXPECT_EQ (img.load (tl::to_qstring (this->tmp_file ("img_2.png"))), true);
+  EXPECT_EQ (img.width (), 50);
+  EXPECT_EQ (img.height (), 40);
+
+  EXPECT_EQ (img.load (tl::to_qstring (this->tmp_file ("img_3.png"))), false);
+}
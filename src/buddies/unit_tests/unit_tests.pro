@@ -10,13 +10,15 @@ include($$PWD/../../lib_ut.pri)
 SOURCES = \
   bdBasicTests.cc \
   bdConverterTests.cc \
+  bdStrm2imgTests.cc \
   bdStrm2txtTests.cc \
   bdStrmclipTests.cc \
   bdStrmcmpTests.cc \
   bdStrmxorTests.cc \
+  $$PWD/../src/strm2img/strm2img.cc \
 
 
-INCLUDEPATH += $$BD_INC $$DB_INC $$TL_INC $$GSI_INC
-DEPENDPATH += $$BD_INC $$DB_INC $$TL_INC $$GSI_INC
+INCLUDEPATH += $$BD_INC $$DB_INC $$TL_INC $$GSI_INC $$RDB_INC $$LAYBASIC_INC
+DEPENDPATH += $$BD_INC $$DB_INC $$TL_INC $$GSI_INC $$RDB_INC $$LAYBASIC_INC
 
-LIBS += -L$$DESTDIR_UT -lklayout_bd -lklayout_db -lklayout_tl -lklayout_gsi
+LIBS += -L$$DESTDIR_UT -lklayout_bd -lklayout_db -lklayout_tl -lklayout_gsi -lklayout_laybasic
@@ -85,6 +85,7 @@ SOURCES = \
   dbStatic.cc \
   dbStream.cc \
   dbStreamLayers.cc \
+  dbStreamingWriter.cc \
   dbTestSupport.cc \
   dbText.cc \
   dbTextWriter.cc \
@@ -215,6 +216,7 @@ HEADERS = \
   dbStatic.h \
   dbStream.h \
   dbStreamLayers.h \
+  dbStreamingWriter.h \
   dbTestSupport.h \
   dbText.h \
   dbTextWriter.h \
@@ -265,12 +265,17 @@ public:
     }
   }
 
+  /**
+   *  @brief Clears the repository
+   *
+   *  This will invalidate all arrays referring to base objects inside this repository.
+   */
+  void clear ();
+
   void mem_stat (MemStatistics *stat, MemStatistics::purpose_t purpose, int cat, bool no_self = false, void *parent = 0) const;
 
 private:
   repositories m_reps;
-
-  void clear ();
 };
 
 /**
@@ -189,7 +189,7 @@ Cell::shapes (unsigned int index)
 {
   shapes_map::iterator s = m_shapes_map.find(index);
   if (s == m_shapes_map.end()) {
-    s = m_shapes_map.insert (std::make_pair(index, shapes_type (0, this, mp_layout ? mp_layout->is_editable () : true))).first;
+    s = m_shapes_map.insert (std::make_pair(index, shapes_type (0, this, index, mp_layout ? mp_layout->is_editable () : true))).first;
     s->second.manager (manager ());
   }
   return s->second;
@@ -27,6 +27,7 @@
 #include "dbLayout.h"
 #include "tlTimer.h"
 #include "tlProgress.h"
+#include "tlProfiler.h"
 #include "gsi.h"
 
 #include <vector>
@@ -1549,6 +1550,8 @@ get_intersections_per_band_any (std::vector <CutPoints> &cutpoints, std::vector
 void 
 EdgeProcessor::process (db::EdgeSink &es, EdgeEvaluatorBase &op)
 {
+  tl::ProfileZone zone ("EdgeProcessor::process");
+
   tl::SelfTimer timer (tl::verbosity () >= 31, "EdgeProcessor: process");
 
   bool prefer_touch = op.prefer_touch (); 
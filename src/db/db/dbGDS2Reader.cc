@@ -29,10 +29,198 @@
 #include "tlException.h"
 #include "tlString.h"
 #include "tlClassRegistry.h"
+#include "tlAssert.h"
+
+#include <QFileInfo>
+#include <QDateTime>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <list>
+#include <algorithm>
 
 namespace db
 {
 
+// ---------------------------------------------------------------
+//  GDS2StructureIndex
+
+std::vector<std::string>
+GDS2StructureIndex::top_structures () const
+{
+  std::set<std::string> referenced;
+  for (const_iterator s = begin (); s != end (); ++s) {
+    referenced.insert (s->second.children.begin (), s->second.children.end ());
+  }
+
+  std::vector<std::string> top;
+  for (const_iterator s = begin (); s != end (); ++s) {
+    if (referenced.find (s->first) == referenced.end ()) {
+      top.push_back (s->first);
+    }
+  }
+
+  return top;
+}
+
+std::vector<size_t>
+GDS2StructureIndex::positions_for_subtrees (const std::vector<std::string> &top_cells, bool top_down) const
+{
+  //  collect the cells of the subtrees
+  std::set<std::string> cells;
+  std::vector<std::string> todo (top_cells.begin (), top_cells.end ());
+  while (! todo.empty ()) {
+    std::string cn = todo.back ();
+    todo.pop_back ();
+    const Structure *s = structure (cn);
+    if (s && cells.insert (cn).second) {
+      todo.insert (todo.end (), s->children.begin (), s->children.end ());
+    }
+  }
+
+  //  the cells in file order
+  std::vector<std::pair<size_t, const std::string *> > by_pos;
+  by_pos.reserve (cells.size ());
+  for (std::set<std::string>::const_iterator c = cells.begin (); c != cells.end (); ++c) {
+    by_pos.push_back (std::make_pair (structure (*c)->pos, &*c));
+  }
+  std::sort (by_pos.begin (), by_pos.end ());
+
+  std::vector<size_t> positions;
+  positions.reserve (cells.size () + 1);
+  if (m_has_context_info) {
+    positions.push_back (m_context_info_pos);
+  }
+
+  if (! top_down) {
+    for (std::vector<std::pair<size_t, const std::string *> >::const_iterator p = by_pos.begin (); p != by_pos.end (); ++p) {
+      positions.push_back (p->first);
+    }
+    return positions;
+  }
+
+  //  count the parents of each cell inside the subtrees
+  std::map<std::string, size_t> parent_count;
+  for (std::set<std::string>::const_iterator c = cells.begin (); c != cells.end (); ++c) {
+    const Structure *s = structure (*c);
+    for (std::vector<std::string>::const_iterator cc = s->children.begin (); cc != s->children.end (); ++cc) {
+      if (cells.find (*cc) != cells.end ()) {
+        parent_count [*cc] += 1;
+      }
+    }
+  }
+
+  //  Deliver the cells in top-down order: this is done in sweeps over the file, each
+  //  taking the cells whose parents have been read already. A sweep seeks forward only, 
+  //  so the number of backward seeks (which restart decompression on compressed files) 
+  //  is bounded by the depth of the hierarchy.
+  while (! by_pos.empty ()) {
+
+    std::vector<std::pair<size_t, const std::string *> > deferred;
+
+    for (std::vector<std::pair<size_t, const std::string *> >::const_iterator p = by_pos.begin (); p != by_pos.end (); ++p) {
+
+      std::map<std::string, size_t>::const_iterator pc = parent_count.find (*p->second);
+      if (pc != parent_count.end () && pc->second > 0) {
+        deferred.push_back (*p);
+        continue;
+      }
+
+      positions.push_back (p->first);
+
+      const Structure *s = structure (*p->second);
+      for (std::vector<std::string>::const_iterator cc = s->children.begin (); cc != s->children.end (); ++cc) {
+        std::map<std::string, size_t>::iterator c = parent_count.find (*cc);
+        if (c != parent_count.end ()) {
+          --c->second;
+        }
+      }
+
+    }
+
+    //  cannot happen with a valid (recursion-free) hierarchy
+    tl_assert (deferred.size () < by_pos.size ());
+    by_pos.swap (deferred);
+
+  }
+
+  return positions;
+}
+
+//  the maximum number of structure indexes kept in the cache
+const size_t max_cached_indexes = 8;
+
+namespace
+{
+
+struct GDS2StructureIndexCacheEntry
+{
+  qint64 size;
+  QDateTime modified;
+  GDS2StructureIndex index;
+  std::list<std::string>::iterator lru;
+};
+
+}
+
+static QMutex s_index_cache_lock;
+static std::map<std::string, GDS2StructureIndexCacheEntry> s_index_cache;
+static std::list<std::string> s_index_cache_lru;
+
+bool
+GDS2StructureIndex::get_cached (const std::string &path, GDS2StructureIndex &index)
+{
+  QFileInfo fi (tl::to_qstring (path));
+  if (path.empty () || ! fi.exists ()) {
+    return false;
+  }
+
+  QMutexLocker locker (&s_index_cache_lock);
+
+  std::map<std::string, GDS2StructureIndexCacheEntry>::const_iterator c = s_index_cache.find (path);
+  if (c == s_index_cache.end () || c->second.size != fi.size () || c->second.modified != fi.lastModified ()) {
+    return false;
+  }
+
+  //  mark as most recently used
+  s_index_cache_lru.splice (s_index_cache_lru.end (), s_index_cache_lru, c->second.lru);
+
+  index = c->second.index;
+  return true;
+}
+
+void
+GDS2StructureIndex::put_cached (const std::string &path, const GDS2StructureIndex &index)
+{
+  QFileInfo fi (tl::to_qstring (path));
+  if (path.empty () || ! fi.exists ()) {
+    return;
+  }
+
+  QMutexLocker locker (&s_index_cache_lock);
+
+  std::map<std::string, GDS2StructureIndexCacheEntry>::iterator c = s_index_cache.find (path);
+  if (c != s_index_cache.end ()) {
+    s_index_cache_lru.splice (s_index_cache_lru.end (), s_index_cache_lru, c->second.lru);
+  } else {
+
+    //  drop the least recently used index
+    if (s_index_cache.size () >= max_cached_indexes) {
+      s_index_cache.erase (s_index_cache_lru.front ());
+      s_index_cache_lru.pop_front ();
+    }
+
+    s_index_cache_lru.push_back (path);
+    c = s_index_cache.insert (std::make_pair (path, GDS2StructureIndexCacheEntry ())).first;
+    c->second.lru = --s_index_cache_lru.end ();
+
+  }
+
+  c->second.size = fi.size ();
+  c->second.modified = fi.lastModified ();
+  c->second.index = index;
+}
+
 // ---------------------------------------------------------------
 //  GDS2Reader
 
@@ -64,9 +252,114 @@ GDS2Reader::read (db::Layout &layout, const db::LoadLayoutOptions &options)
   --m_recnum;
   m_reclen = 0;
 
+  prepare_selective_read ();
+
   return basic_read (layout, m_common_options.layer_map, m_common_options.create_other_layers, m_common_options.enable_text_objects, m_common_options.enable_properties, m_options.allow_multi_xy_records, m_options.box_mode);
 }
 
+void
+GDS2Reader::prepare_selective_read ()
+{
+  if (m_options.top_cell.empty () && m_options.region.empty ()) {
+    set_selective_read (std::vector<size_t> (), std::set<std::string> (), db::DBox ());
+    return;
+  }
+
+  GDS2StructureIndex index;
+
+  std::string path = m_stream.absolute_path ();
+  if (! GDS2StructureIndex::get_cached (path, index)) {
+    build_index (index);
+    GDS2StructureIndex::put_cached (path, index);
+  }
+
+  m_stream.seek (0);
+  m_stored_rec = 0;
+  m_recnum = 0;
+  --m_recnum;
+  m_reclen = 0;
+
+  std::vector<std::string> top_cells;
+  if (! m_options.top_cell.empty ()) {
+    if (! index.structure (m_options.top_cell)) {
+      throw GDS2ReaderException (tl::sprintf (tl::to_string (QObject::tr ("Top cell '%s' not found in file")), m_options.top_cell), 0, 0, std::string ());
+    }
+    top_cells.push_back (m_options.top_cell);
+  } else {
+    top_cells = index.top_structures ();
+  }
+
+  //  the region is propagated top-down, otherwise the structures are read in file order
+  set_selective_read (index.positions_for_subtrees (top_cells, ! m_options.region.empty ()), std::set<std::string> (top_cells.begin (), top_cells.end ()), m_options.region);
+}
+
+void
+GDS2Reader::build_index (GDS2StructureIndex &index)
+{
+  tl::SelfTimer timer (tl::verbosity () >= 21, "Building structure index");
+
+  m_stream.seek (0);
+  m_stored_rec = 0;
+  m_recnum = 0;
+  --m_recnum;
+  m_reclen = 0;
+
+  GDS2StructureIndex::Structure *current = 0;
+  std::set<std::string> children;
+  size_t bgnstr_pos = 0;
+  bool first_structure = true;
+
+  while (true) {
+
+    short rec_id = get_record ();
+
+    if (rec_id == sENDLIB) {
+
+      break;
+
+    } else if (rec_id == sBGNSTR) {
+
+      progress_checkpoint ();
+      bgnstr_pos = m_stream.pos () - m_reclen - 4;
+
+    } else if (rec_id == sSTRNAME) {
+
+      std::string cn (get_string ());
+
+      if (first_structure && cn == "$$$CONTEXT_INFO$$$") {
+        index.set_context_info_pos (bgnstr_pos);
+      } else {
+        current = &index.add (cn, bgnstr_pos);
+        children.clear ();
+      }
+
+      first_structure = false;
+
+    } else if (rec_id == sSNAME) {
+
+      if (current) {
+        children.insert (std::string (get_string ()));
+      }
+
+    } else if (rec_id == sENDSTR) {
+
+      if (current) {
+        current->children.assign (children.begin (), children.end ());
+        current = 0;
+      }
+
+    }
+
+  }
+}
+
+void
+GDS2Reader::seek_record (size_t pos)
+{
+  m_stream.seek (pos);
+  m_stored_rec = 0;
+}
+
 const LayerMap &
 GDS2Reader::read (db::Layout &layout)
 {
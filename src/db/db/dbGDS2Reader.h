@@ -53,7 +53,9 @@ public:
   GDS2ReaderOptions ()
     : box_mode (1),
       allow_big_records (true),
-      allow_multi_xy_records (true)
+      allow_multi_xy_records (true),
+      top_cell (),
+      region ()
   {
     //  .. nothing yet ..
   }
@@ -83,6 +85,26 @@ public:
    */
   bool allow_multi_xy_records;
 
+  /**
+   *  @brief Load only the given cell and its subtree
+   *
+   *  If this property is non-empty, only the cell with this name and the cells 
+   *  instantiated by it are read. The reader uses a structure index for this purpose 
+   *  which is built by a quick pre-scan of the file and cached in memory.
+   */
+  std::string top_cell;
+
+  /**
+   *  @brief Load only shapes overlapping the given region
+   *
+   *  If this box is not empty, only shapes overlapping this box are read. The box is 
+   *  given in micrometer units and in the coordinate system of the top cell (or the
+   *  top cells if no top cell is specified). The region is propagated through the hierarchy.
+   *  Filtering is conservative, i.e. some shapes outside this region may be read too.
+   *  Instances are not filtered.
+   */
+  db::DBox region;
+
   /** 
    *  @brief Implementation of FormatSpecificReaderOptions
    */
@@ -113,6 +135,119 @@ public:
   { }
 };
 
+/**
+ *  @brief An index of the structures inside a GDS2 file
+ *
+ *  The index provides the stream positions of the structures and the names
+ *  of the cells referenced by them. It is built by a quick scan over the 
+ *  records of the file which does not decode the elements.
+ */
+class DB_PUBLIC GDS2StructureIndex
+{
+public:
+  /**
+   *  @brief Describes one structure
+   */
+  struct Structure
+  {
+    Structure () : pos (0) { }
+
+    size_t pos;
+    std::vector<std::string> children;
+  };
+
+  typedef std::map<std::string, Structure> structure_map;
+  typedef structure_map::const_iterator const_iterator;
+
+  /**
+   *  @brief Default constructor
+   */
+  GDS2StructureIndex ()
+    : m_has_context_info (false), m_context_info_pos (0)
+  { }
+
+  /**
+   *  @brief Adds a structure 
+   */
+  Structure &add (const std::string &name, size_t pos)
+  {
+    Structure &s = m_structures [name];
+    s.pos = pos;
+    return s;
+  }
+
+  /**
+   *  @brief Declares the position of the context info structure
+   */
+  void set_context_info_pos (size_t pos)
+  {
+    m_has_context_info = true;
+    m_context_info_pos = pos;
+  }
+
+  /**
+   *  @brief Finds the structure with the given name 
+   *
+   *  Returns 0 if there is no such structure.
+   */
+  const Structure *structure (const std::string &name) const
+  {
+    const_iterator s = m_structures.find (name);
+    return s != m_structures.end () ? &s->second : 0;
+  }
+
+  /**
+   *  @brief Iterates over the structures: begin
+   */
+  const_iterator begin () const
+  {
+    return m_structures.begin ();
+  }
+
+  /**
+   *  @brief Iterates over the structures: end
+   */
+  const_iterator end () const
+  {
+    return m_structures.end ();
+  }
+
+  /**
+   *  @brief Gets the names of the top structures (the ones not referenced by others)
+   */
+  std::vector<std::string> top_structures () const;
+
+  /**
+   *  @brief Computes the structures to read for the subtrees of the given cells
+   *
+   *  If "top_down" is true, the positions are delivered in top-down order, i.e. parent 
+   *  cells come before their children. This order is formed by as few forward sweeps 
+   *  over the file as possible. Otherwise the positions are delivered in file order.
+   *  The context info structure is included as the first one if present.
+   */
+  std::vector<size_t> positions_for_subtrees (const std::vector<std::string> &top_cells, bool top_down = true) const;
+
+  /**
+   *  @brief Gets the index from the in-memory cache
+   *
+   *  The cache key is the absolute path of the file. The index is invalidated if the 
+   *  file's size or modification time changes. Returns false if no valid index is cached.
+   */
+  static bool get_cached (const std::string &path, GDS2StructureIndex &index);
+
+  /**
+   *  @brief Stores the index in the in-memory cache
+   *
+   *  The cache keeps the indexes of the most recently used files only.
+   */
+  static void put_cached (const std::string &path, const GDS2StructureIndex &index);
+
+private:
+  structure_map m_structures;
+  bool m_has_context_info;
+  size_t m_context_info_pos;
+};
+
 /**
  *  @brief The GDS2 format stream reader
  */
@@ -169,6 +304,14 @@ public:
    */
   virtual const char *format () const { return "GDS2"; }
 
+  /**
+   *  @brief Builds the structure index for the stream
+   *
+   *  This method scans the stream from the beginning and leaves the stream at 
+   *  the end of the file.
+   */
+  void build_index (GDS2StructureIndex &index);
+
 private:
   tl::InputStream &m_stream;
   size_t m_recnum;
@@ -195,6 +338,9 @@ private:
   virtual void get_time (unsigned int *mod_time, unsigned int *access_time);
   virtual GDS2XY *get_xy_data (unsigned int &length);
   virtual void progress_checkpoint ();
+  virtual void seek_record (size_t pos);
+
+  void prepare_selective_read ();
 };
 
 }
@@ -67,13 +67,15 @@ private:
 //  GDS2ReaderBase
 
 GDS2ReaderBase::GDS2ReaderBase ()
-  : m_dbu (0.001), 
+  : m_last_dl_valid (false),
+    m_dbu (0.001), 
     m_dbuu (1.0), 
     m_create_layers (true), 
     m_read_texts (true),
     m_read_properties (true),
     m_allow_multi_xy_records (false),
-    m_box_mode (0)
+    m_box_mode (0),
+    mp_current_regions (0)
 {
   // .. nothing yet ..
 }
@@ -88,6 +90,7 @@ GDS2ReaderBase::basic_read (db::Layout &layout, const LayerMap &layer_map, bool
 {
   m_layer_map = layer_map;
   m_layer_map.prepare (layout);
+  m_last_dl_valid = false;
   m_read_texts = enable_text_objects;
   m_read_properties = enable_properties;
 
@@ -102,6 +105,20 @@ GDS2ReaderBase::basic_read (db::Layout &layout, const LayerMap &layer_map, bool
   return m_layer_map;
 }
 
+void
+GDS2ReaderBase::set_selective_read (const std::vector<size_t> &positions, const std::set<std::string> &top_cells, const db::DBox &region)
+{
+  m_structure_positions = positions;
+  m_region_top_cells = top_cells;
+  m_region = region;
+}
+
+void
+GDS2ReaderBase::seek_record (size_t /*pos*/)
+{
+  error (tl::to_string (QObject::tr ("This reader does not support selective reading")));
+}
+
 void
 GDS2ReaderBase::finish_element ()
 {
@@ -176,14 +193,19 @@ GDS2ReaderBase::finish_element (db::PropertiesRepository &rep)
 std::pair <bool, unsigned int> 
 GDS2ReaderBase::open_dl (db::Layout &layout, const LDPair &dl, bool create) 
 {
-  std::pair<bool, unsigned int> ll = m_layer_map.logical (dl);
-  if (ll.first) {
+  //  Consecutive elements usually are on the same layer - this cache avoids the layer map lookup
+  if (m_last_dl_valid && m_last_dl == dl) {
+    return m_last_ll;
+  }
 
-    return ll;
+  std::pair<bool, unsigned int> ll = m_layer_map.logical (dl);
+  if (ll.first || ! create) {
 
-  } else if (! create) {
+    //  mapped or - if no layer create is requested - not mapped
+    m_last_dl_valid = true;
+    m_last_dl = dl;
+    m_last_ll = ll;
 
-    //  layer not mapped and no layer create is requested
     return ll;
 
   } else {
@@ -196,7 +218,11 @@ GDS2ReaderBase::open_dl (db::Layout &layout, const LDPair &dl, bool create)
     unsigned int ll = layout.insert_layer (lp);
     m_layer_map.map (dl, ll, lp);
 
-    return std::make_pair (true, ll);
+    m_last_dl_valid = true;
+    m_last_dl = dl;
+    m_last_ll = std::make_pair (true, ll);
+
+    return m_last_ll;
 
   }
 }
@@ -325,140 +351,262 @@ GDS2ReaderBase::do_read (db::Layout &layout)
   //  prepare a string vector for the context information
   m_context_info.clear ();
 
-  bool first_cell = true;
+  //  prepare the region filter
+  m_cell_regions.clear ();
+  mp_current_regions = 0;
+  if (! m_region.empty ()) {
+    m_region_dbu = db::VCplxTrans (1.0 / m_dbu) * m_region;
+  }
+
+  if (! m_structure_positions.empty ()) {
 
-  //  get cells
-  while ((rec_id = get_record ()) == sBGNSTR) {
+    //  selective read: read the given structures in the given order
+    bool first_cell = true;
+    for (std::vector<size_t>::const_iterator p = m_structure_positions.begin (); p != m_structure_positions.end (); ++p) {
 
-    progress_checkpoint ();
+      seek_record (*p);
+      if (get_record () != sBGNSTR) {
+        error (tl::to_string (QObject::tr ("BGNSTR record expected")));
+      }
 
-    //  erase current instance list 
-    instances.erase (instances.begin (), instances.end ());
-    instances_with_props.erase (instances_with_props.begin (), instances_with_props.end ());
+      read_structure (layout, first_cell, instances, instances_with_props);
+      first_cell = false;
 
-    if (get_record () != sSTRNAME) {
-      error (tl::to_string (QObject::tr ("STRNAME record expected")));
     }
 
-    get_string (m_cellname);
+  } else {
 
-    //  if the first cell is the dummy cell containing the context informations
-    //  read this cell in a special way and store the context informations separately.
-    if (first_cell && m_cellname == "$$$CONTEXT_INFO$$$") {
+    bool first_cell = true;
 
-      read_context_info_cell ();
+    //  get cells
+    while ((rec_id = get_record ()) == sBGNSTR) {
+      read_structure (layout, first_cell, instances, instances_with_props);
+      first_cell = false;
+    }
 
-    } else {
+    //  check, if the last record is a ENDLIB
+    if (rec_id != sENDLIB) {
+      error (tl::to_string (QObject::tr ("ENDLIB record expected")));
+    }
 
-      db::cell_index_type cell_index;
+  }
 
-      std::pair<bool, db::cell_index_type> c = layout.cell_by_name (m_cellname.c_str ()); 
-      if (c.first) {
-        //  cell already there: just add shapes (cell might have been created through forward reference)
-        cell_index = c.second;
-        //  remove "ghost cell" state
-        layout.cell (cell_index).set_ghost_cell (false);
-      } else {
-        cell_index = layout.add_cell (m_cellname.c_str ());
-      }
+  mp_current_regions = 0;
+  m_cell_regions.clear ();
+}
 
-      db::Cell *cell = &layout.cell (cell_index);
+void
+GDS2ReaderBase::read_structure (db::Layout &layout, bool first_cell, tl::vector<db::CellInstArray> &instances, tl::vector<db::CellInstArrayWithProperties> &instances_with_props)
+{
+  short rec_id = 0;
 
-      std::map <tl::string, std::vector <std::string> >::const_iterator ctx = m_context_info.find (m_cellname);
-      if (ctx != m_context_info.end ()) {
-        GDS2ReaderLayerMapping layer_mapping (this, &layout, m_create_layers);
-        if (layout.recover_proxy_as (cell_index, ctx->second.begin (), ctx->second.end (), &layer_mapping)) {
-          //  ignore everything in that cell since it is created by the import:
-          cell = 0;
-        }
-      }
-      
-      long attr = 0;
-      db::PropertiesRepository::properties_set cell_properties;
+  progress_checkpoint ();
 
-      //  read cell content
-      while ((rec_id = get_record ()) != sENDSTR) { 
+  //  erase current instance list 
+  instances.erase (instances.begin (), instances.end ());
+  instances_with_props.erase (instances_with_props.begin (), instances_with_props.end ());
 
-        progress_checkpoint ();
+  if (get_record () != sSTRNAME) {
+    error (tl::to_string (QObject::tr ("STRNAME record expected")));
+  }
 
-        if (cell == 0) {
+  get_string (m_cellname);
 
-          //  ignore everything in proxy cells: these are created from the libraries or PCell's.
+  //  if the first cell is the dummy cell containing the context informations
+  //  read this cell in a special way and store the context informations separately.
+  if (first_cell && m_cellname == "$$$CONTEXT_INFO$$$") {
 
-        } else if (rec_id == sPROPATTR) {
+    read_context_info_cell ();
 
-          attr = long (get_ushort ());
+  } else {
 
-        } else if (rec_id == sPROPVALUE) {
+    db::cell_index_type cell_index;
 
-          const char *value = get_string ();
-          if (m_read_properties) {
-            cell_properties.insert (std::make_pair (layout.properties_repository ().prop_name_id (tl::Variant (attr)), tl::Variant (value)));
-          }
+    std::pair<bool, db::cell_index_type> c = layout.cell_by_name (m_cellname.c_str ()); 
+    if (c.first) {
+      //  cell already there: just add shapes (cell might have been created through forward reference)
+      cell_index = c.second;
+      //  remove "ghost cell" state
+      layout.cell (cell_index).set_ghost_cell (false);
+    } else {
+      cell_index = layout.add_cell (m_cellname.c_str ());
+    }
+
+    db::Cell *cell = &layout.cell (cell_index);
+
+    //  establish the region filter for this cell
+    if (! m_region.empty ()) {
+      std::vector<db::Box> &regions = m_cell_regions [cell_index];
+      if (m_region_top_cells.find (std::string (m_cellname.c_str ())) != m_region_top_cells.end ()) {
+        regions.push_back (m_region_dbu);
+      }
+      mp_current_regions = &regions;
+    } else {
+      mp_current_regions = 0;
+    }
 
-        } else if (rec_id == sBOUNDARY) {
+    //  NOTE: in streaming mode, the proxies are not restored
+    std::map <tl::string, std::vector <std::string> >::const_iterator ctx = m_context_info.find (m_cellname);
+    if (ctx != m_context_info.end () && ! receiver ()) {
+      GDS2ReaderLayerMapping layer_mapping (this, &layout, m_create_layers);
+      if (layout.recover_proxy_as (cell_index, ctx->second.begin (), ctx->second.end (), &layer_mapping)) {
+        //  ignore everything in that cell since it is created by the import:
+        cell = 0;
+      }
+    }
+    
+    long attr = 0;
+    db::PropertiesRepository::properties_set cell_properties;
 
-          read_boundary (layout, *cell, false);
+    //  read cell content
+    while ((rec_id = get_record ()) != sENDSTR) { 
 
-        } else if (rec_id == sPATH) {
+      progress_checkpoint ();
 
-          read_path (layout, *cell);
+      if (cell == 0) {
 
-        } else if (rec_id == sSREF || rec_id == sAREF) {
+        //  ignore everything in proxy cells: these are created from the libraries or PCell's.
 
-          bool array = (rec_id == sAREF);
-          read_ref (layout, *cell, array, instances, instances_with_props);
+      } else if (rec_id == sPROPATTR) {
 
-        } else if (rec_id == sTEXT) {
+        attr = long (get_ushort ());
 
-          read_text (layout, *cell);
+      } else if (rec_id == sPROPVALUE) {
 
-        } else if (rec_id == sBOX) {
+        const char *value = get_string ();
+        if (m_read_properties) {
+          cell_properties.insert (std::make_pair (layout.properties_repository ().prop_name_id (tl::Variant (attr)), tl::Variant (value)));
+        }
 
-          if (m_box_mode == 1) {
-            read_box (layout, *cell);
-          } else if (m_box_mode == 2) {
-            read_boundary (layout, *cell, true);
-          } else if (m_box_mode == 3) {
-            error (tl::to_string (QObject::tr ("BOX record encountered (reader is configured to produce an error in this case)")));
-          } else {
-            while (get_record () != sENDEL) { }
-          }
+      } else if (rec_id == sBOUNDARY) {
 
-        } else if (rec_id == sNODE) {
+        read_boundary (layout, *cell, false);
 
-          //  NODE records are ignored.
-          while (get_record () != sENDEL) { }
+      } else if (rec_id == sPATH) {
 
+        read_path (layout, *cell);
+
+      } else if (rec_id == sSREF || rec_id == sAREF) {
+
+        bool array = (rec_id == sAREF);
+        read_ref (layout, *cell, array, instances, instances_with_props);
+
+      } else if (rec_id == sTEXT) {
+
+        read_text (layout, *cell);
+
+      } else if (rec_id == sBOX) {
+
+        if (m_box_mode == 1) {
+          read_box (layout, *cell);
+        } else if (m_box_mode == 2) {
+          read_boundary (layout, *cell, true);
+        } else if (m_box_mode == 3) {
+          error (tl::to_string (QObject::tr ("BOX record encountered (reader is configured to produce an error in this case)")));
         } else {
-          error (tl::to_string (QObject::tr ("Invalid record or data type")));
+          while (get_record () != sENDEL) { }
         }
-      
-      }
 
-      //  insert all instances collected
-      if (! instances.empty ()) {
-        cell->insert (instances.begin (), instances.end ());
-      }
-      if (! instances_with_props.empty ()) {
-        cell->insert (instances_with_props.begin (), instances_with_props.end ());
-      }
+      } else if (rec_id == sNODE) {
 
-      //  set the cell properties
-      if (! cell_properties.empty ()) {
-        cell->prop_id (layout.properties_repository ().properties_id (cell_properties));
+        //  NODE records are ignored.
+        while (get_record () != sENDEL) { }
+
+      } else {
+        error (tl::to_string (QObject::tr ("Invalid record or data type")));
       }
+    
+    }
+
+    //  insert all instances collected
+    if (! instances.empty ()) {
+      cell->insert (instances.begin (), instances.end ());
+    }
+    if (! instances_with_props.empty ()) {
+      cell->insert (instances_with_props.begin (), instances_with_props.end ());
+    }
+
+    //  set the cell properties
+    if (! cell_properties.empty ()) {
+      cell->prop_id (layout.properties_repository ().properties_id (cell_properties));
+    }
+
+    mp_current_regions = 0;
+
+    //  in streaming mode: hand over the cell to the receiver
+    if (cell) {
+      deliver_cell (layout, cell_index);
+    }
+
+  }
+
+  m_cellname = "";
+}
+
+bool
+GDS2ReaderBase::is_outside_region (const db::Box &box) const
+{
+  if (! mp_current_regions) {
+    return false;
+  }
+
+  for (std::vector<db::Box>::const_iterator r = mp_current_regions->begin (); r != mp_current_regions->end (); ++r) {
+    if (r->touches (box)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void
+GDS2ReaderBase::add_child_regions (const db::CellInstArray &inst)
+{
+  //  maximum number of boxes per cell before they are merged into one
+  const size_t max_regions_per_cell = 100;
+
+  if (! mp_current_regions || mp_current_regions->empty ()) {
+    return;
+  }
+
+  //  the displacements of the corner members of the array
+  std::vector<db::Vector> corners;
+  corners.push_back (db::Vector ());
+
+  db::Vector a, b;
+  unsigned long na = 1, nb = 1;
+  if (inst.is_regular_array (a, b, na, nb)) {
+    db::Vector amax = a * long (std::max ((unsigned long) 1, na) - 1);
+    db::Vector bmax = b * long (std::max ((unsigned long) 1, nb) - 1);
+    corners.push_back (amax);
+    corners.push_back (bmax);
+    corners.push_back (amax + bmax);
+  }
+
+  db::ICplxTrans ti = inst.complex_trans ().inverted ();
+
+  std::vector<db::Box> &child_regions = m_cell_regions [inst.object ().cell_index ()];
 
+  for (std::vector<db::Box>::const_iterator r = mp_current_regions->begin (); r != mp_current_regions->end (); ++r) {
+
+    //  the region in the child cell covered by all array members is enclosed by the 
+    //  box of the regions seen by the corner members
+    db::Box cr;
+    for (std::vector<db::Vector>::const_iterator c = corners.begin (); c != corners.end (); ++c) {
+      cr += ti * r->moved (-*c);
     }
 
-    m_cellname = "";
-    first_cell = false;
+    child_regions.push_back (cr);
 
   }
 
-  //  check, if the last record is a ENDLIB
-  if (rec_id != sENDLIB) {
-    error (tl::to_string (QObject::tr ("ENDLIB record expected")));
+  if (child_regions.size () > max_regions_per_cell) {
+    db::Box bx;
+    for (std::vector<db::Box>::const_iterator r = child_regions.begin (); r != child_regions.end (); ++r) {
+      bx += *r;
+    }
+    child_regions.clear ();
+    child_regions.push_back (bx);
   }
 }
 
@@ -589,11 +737,15 @@ GDS2ReaderBase::read_boundary (db::Layout &layout, db::Cell &cell, bool from_box
         }
       }
 
-      std::pair<bool, db::properties_id_type> pp = finish_element (layout.properties_repository ());
-      if (pp.first) {
-        cell.shapes (ll.second).insert (db::BoxWithProperties (db::Box (p1, p2), pp.second));
+      if (is_outside_region (db::Box (p1, p2))) {
+        finish_element ();
       } else {
-        cell.shapes (ll.second).insert (db::Box (p1, p2));
+        std::pair<bool, db::properties_id_type> pp = finish_element (layout.properties_repository ());
+        if (pp.first) {
+          cell.shapes (ll.second).insert (db::BoxWithProperties (db::Box (p1, p2), pp.second));
+        } else {
+          cell.shapes (ll.second).insert (db::Box (p1, p2));
+        }
       }
 
     } else {
@@ -646,6 +798,8 @@ GDS2ReaderBase::read_boundary (db::Layout &layout, db::Cell &cell, bool from_box
       if (poly.hull ().size () < 3) {
         warn (tl::to_string (QObject::tr ("BOUNDARY with less than 3 points ignored")));
         finish_element ();
+      } else if (is_outside_region (poly.box ())) {
+        finish_element ();
       } else {
         //  this will copy the polyon:
         std::pair<bool, db::properties_id_type> pp = finish_element (layout.properties_repository ());
@@ -785,11 +939,15 @@ GDS2ReaderBase::read_path (db::Layout &layout, db::Cell &cell)
       if (path.points () < 2 && type != 1) {
         warn (tl::to_string (QObject::tr ("PATH with less than two points encountered - interpretation may be different in other tools")));
       }
-      std::pair<bool, db::properties_id_type> pp = finish_element (layout.properties_repository ());
-      if (pp.first) {
-        cell.shapes (ll.second).insert (db::PathRefWithProperties (db::PathRef (path, layout.shape_repository ()), pp.second));
+      if (is_outside_region (path.box ())) {
+        finish_element ();
       } else {
-        cell.shapes (ll.second).insert (db::PathRef (path, layout.shape_repository ()));
+        std::pair<bool, db::properties_id_type> pp = finish_element (layout.properties_repository ());
+        if (pp.first) {
+          cell.shapes (ll.second).insert (db::PathRefWithProperties (db::PathRef (path, layout.shape_repository ()), pp.second));
+        } else {
+          cell.shapes (ll.second).insert (db::PathRef (path, layout.shape_repository ()));
+        }
       }
     }
 
@@ -916,7 +1074,7 @@ GDS2ReaderBase::read_text (db::Layout &layout, db::Cell &cell)
     error (tl::to_string (QObject::tr ("STRING record expected")));
   }
 
-  if (ll.first) {
+  if (ll.first && ! is_outside_region (db::Box (db::Point () + t.disp (), db::Point () + t.disp ()))) {
 
     //  Create the text
     db::Text text (get_string (), t, size, font, ha, va);
@@ -968,6 +1126,11 @@ GDS2ReaderBase::read_box (db::Layout &layout, db::Cell &cell)
       box += pt_conv (*xy++);
     }
 
+    if (is_outside_region (box)) {
+      finish_element ();
+      return;
+    }
+
     std::pair<bool, db::properties_id_type> pp = finish_element (layout.properties_repository ());
     if (! box.empty ()) {
       if (pp.first) {
@@ -1170,6 +1333,8 @@ GDS2ReaderBase::read_ref (db::Layout &layout, db::Cell & /*cell*/, bool array, t
                                       db::Trans (angle, mirror, p), r, c, ir - ir0, ic - ic0);
           }
 
+          add_child_regions (inst);
+
           if (pp.first) {
             instances_with_props.push_back (db::CellInstArrayWithProperties (inst, pp.second));
           } else {
@@ -1200,6 +1365,8 @@ GDS2ReaderBase::read_ref (db::Layout &layout, db::Cell & /*cell*/, bool array, t
                                   db::Trans (angle, mirror, xy), r, c, rows, cols);
       }
 
+      add_child_regions (inst);
+
       if (pp.first) {
         instances_with_props.push_back (db::CellInstArrayWithProperties (inst, pp.second));
       } else {
@@ -1235,6 +1402,8 @@ GDS2ReaderBase::read_ref (db::Layout &layout, db::Cell & /*cell*/, bool array, t
       inst = db::CellInstArray (db::CellInst (ci), db::Trans (angle, mirror, xy));
     }
 
+    add_child_regions (inst);
+
     std::pair<bool, db::properties_id_type> pp = finish_element (layout.properties_repository ());
     if (pp.first) {
       instances_with_props.push_back (db::CellInstArrayWithProperties (inst, pp.second));
@@ -67,6 +67,11 @@ public:
    */
   const std::string &libname () const { return m_libname; }
 
+  /**
+   *  @brief The GDS2 readers support the streaming mode
+   */
+  virtual bool supports_receiver () const { return true; }
+
 protected:
   /** 
    *  @brief The basic read method 
@@ -95,10 +100,40 @@ protected:
    */
   const tl::string &cellname () const { return m_cellname; }
 
+  /**
+   *  @brief Configures a selective read
+   *
+   *  If positions are given, basic_read will only read the structures
+   *  starting at the given stream positions (the positions of the BGNSTR records),
+   *  in the given order. If a region is given, the order must be top-down, i.e. 
+   *  parent cells must come before their children. Otherwise, file order is the
+   *  most efficient one. Reading selectively requires "seek_record" to be 
+   *  implemented.
+   *
+   *  If a non-empty region is given, only shapes overlapping this region are read.
+   *  The region is given in micrometer units and applies to the given top cells. 
+   *  It is propagated to the child cells through the instances. Shapes are 
+   *  filtered conservatively - some shapes outside of the region may be read
+   *  as well.
+   *
+   *  An empty position list disables the selective read.
+   */
+  void set_selective_read (const std::vector<size_t> &positions, const std::set<std::string> &top_cells, const db::DBox &region);
+
+  /**
+   *  @brief Positions the reader at the record starting at the given stream position
+   *
+   *  The default implementation does not support seeking and issues an error.
+   */
+  virtual void seek_record (size_t pos);
+
 private:
   friend class GDS2ReaderLayerMapping;
 
   LayerMap m_layer_map;
+  bool m_last_dl_valid;
+  LDPair m_last_dl;
+  std::pair<bool, unsigned int> m_last_ll;
   tl::string m_cellname;
   std::string m_libname;
   double m_dbu, m_dbuu;
@@ -109,8 +144,17 @@ private:
   unsigned int m_box_mode;
   std::map <tl::string, std::vector<std::string> > m_context_info;
   std::vector <db::Point> m_all_points;
+  std::vector <size_t> m_structure_positions;
+  std::set <std::string> m_region_top_cells;
+  db::DBox m_region;
+  db::Box m_region_dbu;
+  std::map <db::cell_index_type, std::vector<db::Box> > m_cell_regions;
+  const std::vector<db::Box> *mp_current_regions;
 
   void read_context_info_cell ();
+  void read_structure (db::Layout &layout, bool first_cell, tl::vector<db::CellInstArray> &instances, tl::vector<db::CellInstArrayWithProperties> &instances_with_props);
+  bool is_outside_region (const db::Box &box) const;
+  void add_child_regions (const db::CellInstArray &inst);
   void read_boundary (db::Layout &layout, db::Cell &cell, bool from_box_record);
   void read_path (db::Layout &layout, db::Cell &cell);
   void read_text (db::Layout &layout, db::Cell &cell);
@@ -46,6 +46,7 @@ namespace db
 //  GDS2WriterBase implementation
 
 GDS2WriterBase::GDS2WriterBase ()
+  : mp_stream_layout (0), m_stream_sf (1.0), m_stream_dbu (0.001)
 {
   // .. nothing yet ..
 }
@@ -108,33 +109,14 @@ GDS2WriterBase::write (db::Layout &layout, tl::OutputStream &stream, const db::S
   //  get current time
   short time_data [6] = { 0, 0, 0, 0, 0, 0 };
   if (gds2_options.write_timestamps) {
-    time_t ti = 0;
-    time (&ti);
-    const struct tm *t = localtime (&ti);
-    if (t) {
-      time_data[0] = t->tm_year + 1900;
-      time_data[1] = t->tm_mon + 1;
-      time_data[2] = t->tm_mday;
-      time_data[3] = t->tm_hour;
-      time_data[4] = t->tm_min;
-      time_data[5] = t->tm_sec;
-    }
+    get_current_time (time_data);
   }
 
   std::string str_time = tl::sprintf ("%d/%d/%d %d:%02d:%02d", time_data[1], time_data[2], time_data[0], time_data[3], time_data[4], time_data[5]); 
   layout.add_meta_info (MetaInfo ("mod_time", tl::to_string (QObject::tr ("Modification Time")), str_time));
   layout.add_meta_info (MetaInfo ("access_time", tl::to_string (QObject::tr ("Access Time")), str_time));
 
-  bool multi_xy = gds2_options.multi_xy_records;
-  size_t max_cellname_length = std::max (gds2_options.max_cellname_length, (unsigned int)8);
-  size_t max_vertex_count = std::max (gds2_options.max_vertex_count, (unsigned int)4);
-  bool no_zero_length_paths = gds2_options.no_zero_length_paths;
-
-  m_cell_name_map = db::WriterCellNameMap (max_cellname_length);
-  m_cell_name_map.replacement ('$');
-  m_cell_name_map.disallow_all ();
-  //  TODO: restrict character set, i.e allow_standard and "$"
-  m_cell_name_map.allow_all_printing ();
+  init_cell_name_map (gds2_options);
 
   //  For keep instances we need to map all cells since all can be present as instances.
   //  We use top-down assignment to make "upper cells less modified".
@@ -152,27 +134,7 @@ GDS2WriterBase::write (db::Layout &layout, tl::OutputStream &stream, const db::S
 
   //  write header
 
-  write_record_size (6);
-  write_record (sHEADER);
-  write_short (600);
-
-  write_record_size (4 + 12 * 2);
-  write_record (sBGNLIB);
-  write_time (time_data);
-  write_time (time_data);
-
-  write_string_record (sLIBNAME, gds2_options.libname);
-
-  write_record_size (4 + 8 * 2);
-  write_record (sUNITS);
-  write_double (dbu / std::max (1e-9, gds2_options.user_units));
-  write_double (dbu * 1e-6);
-
-  //  layout properties 
-
-  if (gds2_options.write_file_properties && layout.prop_id () != 0) {
-    write_properties (layout, layout.prop_id ());
-  }
+  write_lib_header (layout, dbu, gds2_options, time_data);
 
   //  write context info
   
@@ -272,74 +234,228 @@ GDS2WriterBase::write (db::Layout &layout, tl::OutputStream &stream, const db::S
         write_properties (layout, cref.prop_id ());
       }
 
-      //  instances
-      
-      for (db::Cell::const_iterator inst = cref.begin (); ! inst.at_end (); ++inst) {
+      write_cell_body (layout, cref, layers, options.keep_instances () ? 0 : &cell_set, sf, dbu, gds2_options);
 
-        //  write only instances to selected cells
-        if (options.keep_instances () || cell_set.find (inst->cell_index ()) != cell_set.end ()) {
+      //  end of cell
 
-          progress_checkpoint ();
-          write_inst (sf, *inst, true /*normalize*/, layout, inst->prop_id ());
+      write_record_size (4);
+      write_record (sENDSTR);
 
-        }
+    }
 
-      }
+  }
 
-      //  shapes
-
-      for (std::vector <std::pair <unsigned int, db::LayerProperties> >::const_iterator l = layers.begin (); l != layers.end (); ++l) {
-   
-        if (layout.is_valid_layer (l->first)) {
-
-          int layer = l->second.layer;
-          int datatype = l->second.datatype;
-
-          db::ShapeIterator shape (cref.shapes (l->first).begin (db::ShapeIterator::Boxes | db::ShapeIterator::Polygons | db::ShapeIterator::Edges | db::ShapeIterator::Paths | db::ShapeIterator::Texts));
-          while (! shape.at_end ()) {
-
-            progress_checkpoint ();
-
-            if (shape->is_text ()) {
-              write_text (layer, datatype, sf, dbu, *shape, layout, shape->prop_id ());
-            } else if (shape->is_polygon ()) {
-              write_polygon (layer, datatype, sf, *shape, multi_xy, max_vertex_count, layout, shape->prop_id ());
-            } else if (shape->is_edge ()) {
-              write_edge (layer, datatype, sf, *shape, layout, shape->prop_id ());
-            } else if (shape->is_path ()) {
-              if (no_zero_length_paths && (shape->path_length () - shape->path_extensions ().first - shape->path_extensions ().second) == 0) {
-                //  eliminate the zero-width path
-                db::Polygon poly;
-                shape->polygon (poly);
-                write_polygon (layer, datatype, sf, poly, multi_xy, max_vertex_count, layout, shape->prop_id (), false);
-              } else {
-                write_path (layer, datatype, sf, *shape, multi_xy, layout, shape->prop_id ());
-              }
-            } else if (shape->is_box ()) {
-              write_box (layer, datatype, sf, *shape, layout, shape->prop_id ());
-            }
-
-            ++shape;
+  write_record_size (4);
+  write_record (sENDLIB);
 
-          }
+  progress_checkpoint ();
+}
+
+void
+GDS2WriterBase::get_current_time (short *time_data)
+{
+  time_t ti = 0;
+  time (&ti);
+  const struct tm *t = localtime (&ti);
+  if (t) {
+    time_data[0] = t->tm_year + 1900;
+    time_data[1] = t->tm_mon + 1;
+    time_data[2] = t->tm_mday;
+    time_data[3] = t->tm_hour;
+    time_data[4] = t->tm_min;
+    time_data[5] = t->tm_sec;
+  }
+}
+
+void
+GDS2WriterBase::init_cell_name_map (const db::GDS2WriterOptions &gds2_options)
+{
+  size_t max_cellname_length = std::max (gds2_options.max_cellname_length, (unsigned int)8);
+
+  m_cell_name_map = db::WriterCellNameMap (max_cellname_length);
+  m_cell_name_map.replacement ('$');
+  m_cell_name_map.disallow_all ();
+  //  TODO: restrict character set, i.e allow_standard and "$"
+  m_cell_name_map.allow_all_printing ();
+}
+
+void
+GDS2WriterBase::write_lib_header (const db::Layout &layout, double dbu, const db::GDS2WriterOptions &gds2_options, const short *time_data)
+{
+  write_record_size (6);
+  write_record (sHEADER);
+  write_short (600);
+
+  write_record_size (4 + 12 * 2);
+  write_record (sBGNLIB);
+  write_time (time_data);
+  write_time (time_data);
+
+  write_string_record (sLIBNAME, gds2_options.libname);
+
+  write_record_size (4 + 8 * 2);
+  write_record (sUNITS);
+  write_double (dbu / std::max (1e-9, gds2_options.user_units));
+  write_double (dbu * 1e-6);
 
+  //  layout properties 
+
+  if (gds2_options.write_file_properties && layout.prop_id () != 0) {
+    write_properties (layout, layout.prop_id ());
+  }
+}
+
+void
+GDS2WriterBase::write_cell_body (const db::Layout &layout, const db::Cell &cref, const std::vector <std::pair <unsigned int, db::LayerProperties> > &layers, const std::set <db::cell_index_type> *cell_set, double sf, double dbu, const db::GDS2WriterOptions &gds2_options)
+{
+  bool multi_xy = gds2_options.multi_xy_records;
+  size_t max_vertex_count = std::max (gds2_options.max_vertex_count, (unsigned int)4);
+  bool no_zero_length_paths = gds2_options.no_zero_length_paths;
+
+  //  instances
+  
+  for (db::Cell::const_iterator inst = cref.begin (); ! inst.at_end (); ++inst) {
+
+    //  write only instances to selected cells
+    if (! cell_set || cell_set->find (inst->cell_index ()) != cell_set->end ()) {
+
+      progress_checkpoint ();
+      write_inst (sf, *inst, true /*normalize*/, layout, inst->prop_id ());
+
+    }
+
+  }
+
+  //  shapes
+
+  for (std::vector <std::pair <unsigned int, db::LayerProperties> >::const_iterator l = layers.begin (); l != layers.end (); ++l) {
+
+    if (layout.is_valid_layer (l->first)) {
+
+      int layer = l->second.layer;
+      int datatype = l->second.datatype;
+
+      db::ShapeIterator shape (cref.shapes (l->first).begin (db::ShapeIterator::Boxes | db::ShapeIterator::Polygons | db::ShapeIterator::Edges | db::ShapeIterator::Paths | db::ShapeIterator::Texts));
+      while (! shape.at_end ()) {
+
+        progress_checkpoint ();
+
+        if (shape->is_text ()) {
+          write_text (layer, datatype, sf, dbu, *shape, layout, shape->prop_id ());
+        } else if (shape->is_polygon ()) {
+          write_polygon (layer, datatype, sf, *shape, multi_xy, max_vertex_count, layout, shape->prop_id ());
+        } else if (shape->is_edge ()) {
+          write_edge (layer, datatype, sf, *shape, layout, shape->prop_id ());
+        } else if (shape->is_path ()) {
+          if (no_zero_length_paths && (shape->path_length () - shape->path_extensions ().first - shape->path_extensions ().second) == 0) {
+            //  eliminate the zero-width path
+            db::Polygon poly;
+            shape->polygon (poly);
+            write_polygon (layer, datatype, sf, poly, multi_xy, max_vertex_count, layout, shape->prop_id (), false);
+          } else {
+            write_path (layer, datatype, sf, *shape, multi_xy, layout, shape->prop_id ());
+          }
+        } else if (shape->is_box ()) {
+          write_box (layer, datatype, sf, *shape, layout, shape->prop_id ());
         }
 
+        ++shape;
+
       }
 
-      //  end of cell
+    }
 
-      write_record_size (4);
-      write_record (sENDSTR);
+  }
+}
 
-    }
+void
+GDS2WriterBase::begin_streaming (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options)
+{
+  set_stream (stream);
 
+  mp_stream_layout = &layout;
+  m_stream_options = options;
+  m_stream_gds2_options = options.get_options<db::GDS2WriterOptions> ();
+
+  m_stream_dbu = (options.dbu () == 0.0) ? layout.dbu () : options.dbu ();
+  m_stream_sf = options.scale_factor () * (layout.dbu () / m_stream_dbu);
+  if (fabs (m_stream_sf - 1.0) < 1e-9) {
+    //  to avoid rounding problems, set to 1.0 exactly if possible.
+    m_stream_sf = 1.0;
+  }
+
+  for (unsigned int i = 0; i < 6; ++i) {
+    m_stream_time_data [i] = 0;
+  }
+  if (m_stream_gds2_options.write_timestamps) {
+    get_current_time (m_stream_time_data);
+  }
+
+  init_cell_name_map (m_stream_gds2_options);
+
+  write_lib_header (layout, m_stream_dbu, m_stream_gds2_options, m_stream_time_data);
+}
+
+const std::string &
+GDS2WriterBase::streaming_cell_name (db::cell_index_type cell_index)
+{
+  //  cells are mapped as they are encountered
+  if (! m_cell_name_map.has_cell_name (cell_index)) {
+    m_cell_name_map.insert (cell_index, mp_stream_layout->cell_name (cell_index));
   }
+  return m_cell_name_map.cell_name (cell_index);
+}
+
+void
+GDS2WriterBase::begin_streaming_cell (db::cell_index_type cell_index)
+{
+  progress_checkpoint ();
+
+  write_record_size (4 + 12 * 2);
+  write_record (sBGNSTR);
+  write_time (m_stream_time_data);
+  write_time (m_stream_time_data);
 
+  write_string_record (sSTRNAME, streaming_cell_name (cell_index));
+
+  const db::Cell &cref = mp_stream_layout->cell (cell_index);
+  if (m_stream_gds2_options.write_cell_properties && cref.prop_id () != 0) {
+    write_properties (*mp_stream_layout, cref.prop_id ());
+  }
+}
+
+void
+GDS2WriterBase::write_streaming_cell_content (db::cell_index_type cell_index)
+{
+  const db::Cell &cref = mp_stream_layout->cell (cell_index);
+
+  //  make sure the child cells are known to the name map
+  for (db::Cell::const_iterator inst = cref.begin (); ! inst.at_end (); ++inst) {
+    streaming_cell_name (inst->cell_index ());
+  }
+
+  std::vector <std::pair <unsigned int, db::LayerProperties> > layers;
+  m_stream_options.get_valid_layers (*mp_stream_layout, layers, db::SaveLayoutOptions::LP_AssignNumber);
+
+  write_cell_body (*mp_stream_layout, cref, layers, 0, m_stream_sf, m_stream_dbu, m_stream_gds2_options);
+}
+
+void
+GDS2WriterBase::end_streaming_cell (db::cell_index_type /*cell_index*/)
+{
+  write_record_size (4);
+  write_record (sENDSTR);
+}
+
+void
+GDS2WriterBase::end_streaming ()
+{
   write_record_size (4);
   write_record (sENDLIB);
 
   progress_checkpoint ();
+
+  mp_stream_layout = 0;
 }
 
 void
@@ -37,6 +37,7 @@ namespace db
 {
 
 class Layout;
+class Cell;
 class SaveLayoutOptions;
 
 /**
@@ -163,6 +164,16 @@ public:
    */
   void write (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options);
 
+  /**
+   *  @brief Implementation of the streaming mode interface
+   */
+  virtual bool supports_streaming () const { return true; }
+  virtual void begin_streaming (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options);
+  virtual void begin_streaming_cell (db::cell_index_type cell_index);
+  virtual void write_streaming_cell_content (db::cell_index_type cell_index);
+  virtual void end_streaming_cell (db::cell_index_type cell_index);
+  virtual void end_streaming ();
+
 protected:
   /**
    *  @brief Write a byte
@@ -266,8 +277,18 @@ protected:
 
 private:
   db::WriterCellNameMap m_cell_name_map;
+  const db::Layout *mp_stream_layout;
+  db::SaveLayoutOptions m_stream_options;
+  db::GDS2WriterOptions m_stream_gds2_options;
+  double m_stream_sf, m_stream_dbu;
+  short m_stream_time_data [6];
 
   void write_properties (const db::Layout &layout, db::properties_id_type prop_id);
+  void get_current_time (short *time_data);
+  void init_cell_name_map (const db::GDS2WriterOptions &gds2_options);
+  void write_lib_header (const db::Layout &layout, double dbu, const db::GDS2WriterOptions &gds2_options, const short *time_data);
+  void write_cell_body (const db::Layout &layout, const db::Cell &cref, const std::vector <std::pair <unsigned int, db::LayerProperties> > &layers, const std::set <db::cell_index_type> *cell_set, double sf, double dbu, const db::GDS2WriterOptions &gds2_options);
+  const std::string &streaming_cell_name (db::cell_index_type cell_index);
 };
 
 } // namespace db
@@ -35,6 +35,7 @@
 #include "tlLog.h"
 #include "tlInternational.h"
 #include "tlProgress.h"
+#include "tlProfiler.h"
 #include "tlAssert.h"
 
 
@@ -1271,6 +1272,8 @@ Layout::update () const
 void 
 Layout::do_update ()
 {
+  tl::ProfileZone zone ("Layout::update");
+
   tl::SelfTimer timer (tl::verbosity () >= 21, tl::to_string (QObject::tr ("Sorting")));
 
   //  establish a progress report since this operation can take some time.
@@ -25,6 +25,8 @@
 #define HDR_dbLayoutStateModel
 
 #include "dbCommon.h"
+#include "dbTypes.h"
+#include "dbBox.h"
 
 #include "tlEvents.h"
 
@@ -102,6 +104,39 @@ public:
    */
   void invalidate_bboxes (unsigned int index);
 
+  /**
+   *  @brief Invalidate a region of a cell's layer
+   *
+   *  This method is supposed to be called by shape containers before a shape
+   *  is inserted, removed or modified. "box" is the bounding box of the affected
+   *  shapes in the coordinates of the cell. An empty box indicates that the
+   *  affected region is not known, i.e. the whole layer of the cell is affected.
+   *
+   *  In contrast to "invalidate_bboxes", the "region_changed" event is issued on
+   *  every call. Shape containers should not compute the boxes unless 
+   *  "tracks_regions" is true. Shape containers report a limited number of regions
+   *  only until they are updated again and then report the whole layer once.
+   *
+   *  Only shape containers report regions currently. Instance lists don't - changes
+   *  of instances are reported through "invalidate_hier" only.
+   */
+  void invalidate_region (db::cell_index_type ci, unsigned int index, const db::Box &box)
+  {
+    if (tracks_regions ()) {
+      region_changed_event (ci, index, box);
+    }
+  }
+
+  /**
+   *  @brief Gets a value indicating whether changed regions are tracked
+   *
+   *  Regions are tracked if there is a receiver for the "region_changed" event.
+   */
+  bool tracks_regions () const
+  {
+    return ! region_changed_event.empty ();
+  }
+
   /**
    *  @brief Signal that the database unit has changed
    */
@@ -187,6 +222,7 @@ protected:
 public:
   tl::Event hier_changed_event;
   tl::event<unsigned int> bboxes_changed_event;
+  tl::event<db::cell_index_type, unsigned int, const db::Box &> region_changed_event;
   tl::Event bboxes_changed_any_event;
   tl::Event dbu_changed_event;
   tl::Event cell_name_changed_event;
@@ -122,6 +122,7 @@ OASISReader::OASISReader (tl::InputStream &s)
   m_table_textstring = 0;
   m_table_layername = 0;
   m_table_start = 0;
+  m_last_dl_valid = false;
 }
 
 OASISReader::~OASISReader ()
@@ -137,6 +138,7 @@ OASISReader::read (db::Layout &layout, const db::LoadLayoutOptions &options)
 
   m_layer_map = common_options.layer_map;
   m_layer_map.prepare (layout);
+  m_last_dl_valid = false;
   m_layers_created.clear ();
   m_read_texts = common_options.enable_text_objects;
   m_read_properties = common_options.enable_properties;
@@ -554,12 +556,17 @@ OASISReader::warn (const std::string &msg)
 std::pair <bool, unsigned int> 
 OASISReader::open_dl (db::Layout &layout, const LDPair &dl, bool create)
 {
-  std::pair<bool, unsigned int> ll = m_layer_map.logical (dl);
-  if (ll.first) {
+  //  Consecutive shapes usually are on the same layer - this cache avoids the layer map lookup
+  if (m_last_dl_valid && m_last_dl == dl) {
+    return m_last_ll;
+  }
 
-    return ll;
+  std::pair<bool, unsigned int> ll = m_layer_map.logical (dl);
+  if (ll.first || ! create) {
 
-  } else if (! create) {
+    m_last_dl_valid = true;
+    m_last_dl = dl;
+    m_last_ll = ll;
 
     return ll;
 
@@ -584,7 +591,11 @@ OASISReader::open_dl (db::Layout &layout, const LDPair &dl, bool create)
 
     m_layers_created.insert (ll);
 
-    return std::make_pair (true, ll);
+    m_last_dl_valid = true;
+    m_last_dl = dl;
+    m_last_ll = std::make_pair (true, ll);
+
+    return m_last_ll;
 
   }
 }
@@ -1467,7 +1478,7 @@ OASISReader::store_last_properties (db::PropertiesRepository &rep, db::Propertie
 }
 
 std::pair <bool, db::properties_id_type> 
-OASISReader::read_element_properties (db::PropertiesRepository &rep, bool ignore_special)
+OASISReader::read_element_properties (db::PropertiesRepository &rep, bool ignore_special, bool skip)
 {
   db::PropertiesRepository::properties_set properties;
 
@@ -1497,14 +1508,20 @@ OASISReader::read_element_properties (db::PropertiesRepository &rep, bool ignore
 
     } else if (m == 28 /*PROPERTY*/) {
 
+      //  NOTE: the modal property variables need to be maintained even if the
+      //  properties are not stored (skip mode for objects on unmapped layers)
       read_properties (rep);
-      store_last_properties (rep, properties, ignore_special);
+      if (! skip) {
+        store_last_properties (rep, properties, ignore_special);
+      }
 
       mark_start_table ();
 
     } else if (m == 29 /*PROPERTY*/) {
 
-      store_last_properties (rep, properties, ignore_special);
+      if (! skip) {
+        store_last_properties (rep, properties, ignore_special);
+      }
 
       mark_start_table ();
 
@@ -2158,8 +2175,7 @@ OASISReader::do_read_text (bool xy_absolute,
 
   if ((m & 0x4) && read_repetition ()) {
 
-    //  TODO: should not read properties if layer is not enabled!
-    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
+    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false, ! ll.first);
 
     if (ll.first) {
 
@@ -2224,7 +2240,7 @@ OASISReader::do_read_text (bool xy_absolute,
 
   } else {
 
-    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
+    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false, ! ll.first);
 
     if (ll.first) {
 
@@ -2299,7 +2315,7 @@ OASISReader::do_read_rectangle (bool xy_absolute,
 
   if ((m & 0x4) && read_repetition ()) {
 
-    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
+    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false, ! ll.first);
 
     if (ll.first) {
 
@@ -2354,7 +2370,7 @@ OASISReader::do_read_rectangle (bool xy_absolute,
 
   } else {
     
-    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
+    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false, ! ll.first);
 
     if (ll.first) {
 
@@ -2413,7 +2429,7 @@ OASISReader::do_read_polygon (bool xy_absolute, db::cell_index_type cell_index,
 
   if ((m & 0x4) && read_repetition ()) {
 
-    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
+    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false, ! ll.first);
 
     if (ll.first) {
 
@@ -2487,7 +2503,7 @@ OASISReader::do_read_polygon (bool xy_absolute, db::cell_index_type cell_index,
 
   } else {
 
-    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
+    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false, ! ll.first);
 
     if (ll.first) {
 
@@ -2580,7 +2596,7 @@ OASISReader::do_read_path (bool xy_absolute, db::cell_index_type cell_index, db:
 
   if ((m & 0x4) && read_repetition ()) {
 
-    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
+    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false, ! ll.first);
 
     if (ll.first) {
 
@@ -2656,7 +2672,7 @@ OASISReader::do_read_path (bool xy_absolute, db::cell_index_type cell_index, db:
 
   } else {
 
-    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
+    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false, ! ll.first);
 
     if (ll.first) {
 
@@ -2755,7 +2771,7 @@ OASISReader::do_read_trapezoid (unsigned char r, bool xy_absolute,db::cell_index
 
   if ((m & 0x4) && read_repetition ()) {
 
-    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
+    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false, ! ll.first);
 
     if (ll.first) {
 
@@ -2823,7 +2839,7 @@ OASISReader::do_read_trapezoid (unsigned char r, bool xy_absolute,db::cell_index
 
   } else {
 
-    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
+    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false, ! ll.first);
 
     if (ll.first) {
 
@@ -3115,7 +3131,7 @@ OASISReader::do_read_ctrapezoid (bool xy_absolute,db::cell_index_type cell_index
 
   if ((m & 0x4) && read_repetition ()) {
 
-    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
+    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false, ! ll.first);
 
     if (ll.first) {
 
@@ -3182,7 +3198,7 @@ OASISReader::do_read_ctrapezoid (bool xy_absolute,db::cell_index_type cell_index
 
   } else {
 
-    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
+    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false, ! ll.first);
 
     if (ll.first) {
 
@@ -3250,7 +3266,7 @@ OASISReader::do_read_circle (bool xy_absolute, db::cell_index_type cell_index, d
 
   if ((m & 0x4) && read_repetition ()) {
 
-    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
+    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false, ! ll.first);
 
     if (ll.first) {
 
@@ -3318,7 +3334,7 @@ OASISReader::do_read_circle (bool xy_absolute, db::cell_index_type cell_index, d
 
   } else {
 
-    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false);
+    std::pair<bool, db::properties_id_type> pp = read_element_properties (layout.properties_repository (), false, ! ll.first);
 
     if (ll.first) {
 
@@ -3558,12 +3574,15 @@ OASISReader::do_read_cell (db::cell_index_type cell_index, db::Layout &layout)
     m_instances_with_props.clear ();
   }
 
-  //  Restore proxy cell (link to PCell or Library)
-  if (has_context) {
+  //  Restore proxy cell (link to PCell or Library) - not in streaming mode
+  if (has_context && ! receiver ()) {
     OASISReaderLayerMapping layer_mapping (this, &layout, m_create_layers);
     layout.recover_proxy_as (cell_index, context_strings.begin (), context_strings.end (), &layer_mapping);
   }
 
+  //  in streaming mode: hand over the cell to the receiver
+  deliver_cell (layout, cell_index);
+
   m_cellname = "";
 }
 
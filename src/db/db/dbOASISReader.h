@@ -172,6 +172,11 @@ public:
    */
   virtual const char *format () const { return "OASIS"; }
 
+  /**
+   *  @brief The OASIS reader supports the streaming mode
+   */
+  virtual bool supports_receiver () const { return true; }
+
   /**
    *  @brief Issue an error with positional informations
    *
@@ -203,6 +208,9 @@ private:
 
   tl::InputStream &m_stream;
   LayerMap m_layer_map;
+  bool m_last_dl_valid;
+  LDPair m_last_dl;
+  std::pair<bool, unsigned int> m_last_ll;
   std::set<unsigned int> m_layers_created;
   tl::AbsoluteProgress m_progress;
   std::string m_cellname;
@@ -301,7 +309,7 @@ private:
   void read_pointlist (modal_variable <std::vector <db::Point> > &pointlist, bool for_polygon);
   void read_properties (db::PropertiesRepository &rep);
   void store_last_properties (db::PropertiesRepository &rep, db::PropertiesRepository::properties_set &properties, bool ignore_special);
-  std::pair <bool, db::properties_id_type> read_element_properties (db::PropertiesRepository &rep, bool ignore_special);
+  std::pair <bool, db::properties_id_type> read_element_properties (db::PropertiesRepository &rep, bool ignore_special, bool skip = false);
 
   unsigned char get_byte ()
   {
@@ -1635,7 +1635,7 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
 
       //  instances
       if (cref.cell_instances () > 0) {
-        write_insts (cell_set);
+        write_insts (&cell_set);
       }
 
       //  shapes
@@ -1769,6 +1769,138 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
   m_progress.set (mp_stream->pos ());
 }
 
+void
+OASISWriter::begin_streaming (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options)
+{
+  mp_layout = &layout;
+  mp_cell = 0;
+  m_layer = m_datatype = 0;
+  m_in_cblock = false;
+  m_cblock_buffer.clear ();
+
+  m_options = options.get_options<OASISWriterOptions> ();
+  //  strict mode needs the name tables which are not known before all cells have been written
+  m_options.strict_mode = false;
+  m_stream_options = options;
+  mp_stream = &stream;
+
+  double dbu = (options.dbu () == 0.0) ? layout.dbu () : options.dbu ();
+  m_sf = options.scale_factor () * (layout.dbu () / dbu);
+  if (fabs (m_sf - 1.0) < 1e-9) {
+    //  to avoid rounding problems, set to 1.0 exactly if possible.
+    m_sf = 1.0;
+  }
+
+  char magic[] = "%SEMI-OASIS\015\012";
+  write_bytes (magic, sizeof (magic) - 1);
+
+  //  START record with an empty offset table (non-strict mode)
+  write_record_id (1); 
+  write_bstring ("1.0");
+  write (1.0 / dbu);
+  write_byte (0);
+  for (unsigned int i = 0; i < 12; ++i) {
+    write_byte (0);
+  }
+
+  reset_modal_variables ();
+
+  m_textstrings.clear ();
+  m_propnames.clear ();
+  m_propstrings.clear ();
+  m_propstring_id = m_propname_id = 0;
+  m_proptables_written = false;
+
+  if (layout.prop_id () != 0) {
+    write_props (layout.prop_id ());
+  }
+}
+
+void
+OASISWriter::begin_streaming_cell (db::cell_index_type cell_index)
+{
+  m_progress.set (mp_stream->pos ());
+
+  mp_cell = &mp_layout->cell (cell_index);
+
+  //  the cell names are written at the end, hence the cell is given by reference number
+  write_record_id (13);  // CELL
+  write ((unsigned long) cell_index);
+
+  reset_modal_variables ();
+
+  if (mp_cell->prop_id () != 0) {
+    write_props (mp_cell->prop_id ());
+  }
+}
+
+void
+OASISWriter::write_streaming_cell_content (db::cell_index_type cell_index)
+{
+  mp_cell = &mp_layout->cell (cell_index);
+
+  std::vector <std::pair <unsigned int, db::LayerProperties> > layers;
+  m_stream_options.get_valid_layers (*mp_layout, layers, db::SaveLayoutOptions::LP_AssignNumber);
+
+  //  one CBLOCK per chunk keeps the compression buffer bounded
+  if (m_options.write_cblocks) {
+    begin_cblock ();
+  }
+
+  if (mp_cell->cell_instances () > 0) {
+    write_insts (0);
+  }
+
+  for (std::vector <std::pair <unsigned int, db::LayerProperties> >::const_iterator l = layers.begin (); l != layers.end (); ++l) {
+    const db::Shapes &shapes = mp_cell->shapes (l->first);
+    if (! shapes.empty ()) {
+      write_shapes (l->second, shapes);
+      m_progress.set (mp_stream->pos ());
+    }
+  }
+
+  if (m_options.write_cblocks) {
+    end_cblock ();
+  } 
+}
+
+void
+OASISWriter::end_streaming_cell (db::cell_index_type /*cell_index*/)
+{
+  mp_cell = 0;
+}
+
+void
+OASISWriter::end_streaming ()
+{
+  //  CELLNAME records with explicit reference numbers
+  for (db::Layout::const_iterator cell = mp_layout->begin (); cell != mp_layout->end (); ++cell) {
+    write_record_id (4);
+    write_nstring (mp_layout->cell_name (cell->cell_index ()));
+    write ((unsigned long) cell->cell_index ());
+  }
+
+  //  END record
+
+  size_t end_record_pos = mp_stream->pos ();
+
+  write_record_id (2);
+
+  //  write a b-string to pad up to 255 bytes
+  //  (this bstring consists of a "long zero" and no characters
+  while (mp_stream->pos () < end_record_pos + 254) {
+    write_byte (char (0x80));
+  }
+  write_byte (0);
+
+  //  validation-scheme
+  write_byte (0);
+
+  m_progress.set (mp_stream->pos ());
+
+  mp_layout = 0;
+}
+
 void 
 OASISWriter::write (const Repetition &rep)
 {
@@ -1978,7 +2110,7 @@ OASISWriter::write (const db::CellInstArray &inst, db::properties_id_type prop_i
 }
 
 void 
-OASISWriter::write_insts (const std::set <db::cell_index_type> &cell_set)
+OASISWriter::write_insts (const std::set <db::cell_index_type> *cell_set)
 {
   int level = m_options.compression_level;
 
@@ -1992,7 +2124,7 @@ OASISWriter::write_insts (const std::set <db::cell_index_type> &cell_set)
   //  Collect all instances 
   for (db::Cell::const_iterator inst_iterator = mp_cell->begin (); ! inst_iterator.at_end (); ++inst_iterator) {
 
-    if (cell_set.find (inst_iterator->cell_index ()) != cell_set.end ()) {
+    if (! cell_set || cell_set->find (inst_iterator->cell_index ()) != cell_set->end ()) {
 
       db::properties_id_type prop_id = inst_iterator->prop_id ();
 
@@ -2289,11 +2421,12 @@ OASISWriter::write (const db::Text &text, db::properties_id_type prop_id, const
   m_progress.set (mp_stream->pos ());
 
   db::Trans trans = text.trans ();
+
+  //  NOTE: without a text string table (streaming mode), the string is written explicitly
   std::map <std::string, unsigned long>::const_iterator ts = m_textstrings.find (text.string ());
-  tl_assert (ts != m_textstrings.end ());
-  unsigned long text_id = ts->second;
+  tl_assert (ts != m_textstrings.end () || ! m_options.strict_mode);
 
-  unsigned char info = 0x20;
+  unsigned char info = (ts != m_textstrings.end ()) ? 0x20 : 0;
 
   if (mm_text_string != text.string ()) {
     info |= 0x40;
@@ -2318,7 +2451,11 @@ OASISWriter::write (const db::Text &text, db::properties_id_type prop_id, const
   write_byte (info);
   if (info & 0x40) {
     mm_text_string = text.string ();
-    write ((unsigned long) text_id);
+    if (info & 0x20) {
+      write ((unsigned long) ts->second);
+    } else {
+      write_astring (text.string ());
+    }
   }
   if (info & 0x01) {
     mm_textlayer = m_layer;
@@ -204,6 +204,19 @@ public:
    */
   void write (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options);
 
+  /**
+   *  @brief Implementation of the streaming mode interface
+   *
+   *  In streaming mode, the OASIS writer always produces non-strict mode files.
+   *  The cell names are written at the end of the file.
+   */
+  virtual bool supports_streaming () const { return true; }
+  virtual void begin_streaming (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options);
+  virtual void begin_streaming_cell (db::cell_index_type cell_index);
+  virtual void write_streaming_cell_content (db::cell_index_type cell_index);
+  virtual void end_streaming_cell (db::cell_index_type cell_index);
+  virtual void end_streaming ();
+
   void write (const db::CellInstArray &inst_array, const db::Repetition &rep)
   {
     write (inst_array, 0, rep);
@@ -336,6 +349,7 @@ private:
   modal_variable<property_value_list> mm_last_value_list;
 
   OASISWriterOptions m_options;
+  db::SaveLayoutOptions m_stream_options;
   tl::AbsoluteProgress m_progress;
 
   void write_record_id (char b);
@@ -390,7 +404,7 @@ private:
 
   void emit_propname_def (db::properties_id_type prop_id);
   void emit_propstring_def (db::properties_id_type prop_id);
-  void write_insts (const std::set <db::cell_index_type> &cell_set);
+  void write_insts (const std::set <db::cell_index_type> *cell_set);
 
   void write_shapes (const db::LayerProperties &lprops, const db::Shapes &shapes);
 
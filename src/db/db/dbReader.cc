@@ -23,6 +23,7 @@
 
 #include "dbReader.h"
 #include "dbStream.h"
+#include "dbLayout.h"
 #include "tlClassRegistry.h"
 
 namespace db
@@ -32,7 +33,7 @@ namespace db
 //  ReaderBase implementation
 
 ReaderBase::ReaderBase () 
-  : m_warnings_as_errors (false)
+  : m_warnings_as_errors (false), mp_receiver (0)
 { 
 }
 
@@ -46,6 +47,89 @@ ReaderBase::set_warnings_as_errors (bool f)
   m_warnings_as_errors = f;
 }
 
+const db::LayerMap &
+ReaderBase::read (db::ReaderReceiver &receiver, const db::LoadLayoutOptions &options)
+{
+  db::Layout layout;
+
+  mp_receiver = &receiver;
+  m_layers_delivered.clear ();
+
+  try {
+
+    receiver.begin_file (layout);
+
+    const db::LayerMap &lm = read (layout, options);
+
+    if (! supports_receiver ()) {
+      //  deliver the cells after the fact
+      for (db::Layout::bottom_up_iterator c = layout.begin_bottom_up (); c != layout.end_bottom_up (); ++c) {
+        do_deliver_cell (layout, *c);
+      }
+    }
+
+    receiver.end_file (layout);
+
+    mp_receiver = 0;
+    return lm;
+
+  } catch (...) {
+    mp_receiver = 0;
+    throw;
+  }
+}
+
+void
+ReaderBase::deliver_cell (db::Layout &layout, db::cell_index_type cell_index)
+{
+  if (mp_receiver) {
+
+    do_deliver_cell (layout, cell_index);
+
+    //  discard the cell's content - the shape and array repositories are no longer 
+    //  required as the cells delivered before are empty too.
+    db::Cell &cell = layout.cell (cell_index);
+    cell.clear_insts ();
+    cell.clear_shapes ();
+    layout.shape_repository ().clear ();
+    layout.array_repository ().clear ();
+
+  }
+}
+
+void
+ReaderBase::do_deliver_cell (db::Layout &layout, db::cell_index_type cell_index)
+{
+  //  announce new layers
+  for (unsigned int l = 0; l < layout.layers (); ++l) {
+    if (layout.is_valid_layer (l) && (l >= m_layers_delivered.size () || ! m_layers_delivered [l])) {
+      if (l >= m_layers_delivered.size ()) {
+        m_layers_delivered.resize (l + 1, false);
+      }
+      m_layers_delivered [l] = true;
+      mp_receiver->layer (l, layout.get_properties (l));
+    }
+  }
+
+  const db::Cell &cell = layout.cell (cell_index);
+
+  mp_receiver->begin_cell (cell_index, layout.cell_name (cell_index));
+
+  for (unsigned int l = 0; l < layout.layers (); ++l) {
+    if (layout.is_valid_layer (l)) {
+      for (db::ShapeIterator s = cell.shapes (l).begin (db::ShapeIterator::All); ! s.at_end (); ++s) {
+        mp_receiver->shape (l, *s);
+      }
+    }
+  }
+
+  for (db::Cell::const_iterator i = cell.begin (); ! i.at_end (); ++i) {
+    mp_receiver->instance (*i);
+  }
+
+  mp_receiver->end_cell (cell_index);
+}
+
 // ---------------------------------------------------------------
 //  Reader implementation
 
@@ -32,7 +32,9 @@
 #include "tlString.h"
 
 #include "tlStream.h"
+#include "tlProfiler.h"
 #include "dbLoadLayoutOptions.h"
+#include "dbTypes.h"
 
 #include <vector>
 
@@ -41,6 +43,9 @@ namespace db
 
 class Layout;
 class ReaderBase;
+class Shape;
+class Instance;
+class LayerProperties;
 
 /**
  *  @brief Generic base class of reader exceptions
@@ -54,6 +59,75 @@ public:
   { }
 };
 
+/**
+ *  @brief A receiver for the streaming read mode
+ *
+ *  In streaming mode, the reader does not build a full layout. Instead it
+ *  delivers the cells one by one to the receiver once they have been read.
+ *  The cell's content is discarded after it has been delivered, so the memory 
+ *  required is basically that of the largest cell.
+ *
+ *  The reader still employs a layout object internally ("scratch layout"). 
+ *  This layout is passed to begin_file and can be used to look up cell names
+ *  (from the cell indexes of the instances), layer properties and property 
+ *  sets (from the properties IDs). The scratch layout's cells are empty except
+ *  for the cell currently delivered.
+ *
+ *  For each cell, the sequence of calls is "begin_cell", "shape" for all shapes,
+ *  "instance" for all instances and finally "end_cell". "layer" is called before
+ *  a layer is used the first time. The layer index is the one of the scratch 
+ *  layout and reflects the layer mapping of the reader.
+ *
+ *  Cell names and property values may not be known yet when a cell is delivered
+ *  (i.e. for OASIS files with forward references). The final values can be obtained
+ *  from the scratch layout in "end_file".
+ *
+ *  Library and PCell proxies are not restored in streaming mode - the cells are
+ *  delivered with the content found in the file.
+ */
+class DB_PUBLIC ReaderReceiver
+{
+public:
+  ReaderReceiver () { }
+  virtual ~ReaderReceiver () { }
+
+  /**
+   *  @brief Indicates the start of the file
+   *  The layout is the scratch layout (see class description). 
+   */
+  virtual void begin_file (const db::Layout & /*layout*/) { }
+
+  /**
+   *  @brief Indicates a new layer
+   */
+  virtual void layer (unsigned int /*layer_index*/, const db::LayerProperties & /*lp*/) { }
+
+  /**
+   *  @brief Indicates the start of a cell
+   */
+  virtual void begin_cell (db::cell_index_type /*cell_index*/, const std::string & /*name*/) { }
+
+  /**
+   *  @brief Delivers a shape of the current cell
+   */
+  virtual void shape (unsigned int /*layer_index*/, const db::Shape & /*shape*/) { }
+
+  /**
+   *  @brief Delivers an instance of the current cell
+   */
+  virtual void instance (const db::Instance & /*instance*/) { }
+
+  /**
+   *  @brief Indicates the end of a cell
+   */
+  virtual void end_cell (db::cell_index_type /*cell_index*/) { }
+
+  /**
+   *  @brief Indicates the end of the file
+   */
+  virtual void end_file (const db::Layout & /*layout*/) { }
+};
+
 /**
  *  @brief The generic reader base class
  */
@@ -67,6 +141,24 @@ public:
   virtual const db::LayerMap &read (db::Layout &layout) = 0;
   virtual const char *format () const = 0;
 
+  /**
+   *  @brief Reads the stream in streaming mode
+   *
+   *  The cells are delivered to the receiver (see ReaderReceiver).
+   *  Readers not supporting the streaming mode will read the full layout first
+   *  and deliver the cells bottom-up after that.
+   */
+  const db::LayerMap &read (db::ReaderReceiver &receiver, const db::LoadLayoutOptions &options);
+
+  /**
+   *  @brief Returns true, if the reader delivers cells to a receiver while reading
+   *  Readers supporting this mode have to call "deliver_cell" after each cell has been read.
+   */
+  virtual bool supports_receiver () const 
+  {
+    return false;
+  }
+
   /**
    *  @brief Sets a flag indicating that warnings shall be treated as errors
    *  If this flag is set, warnings will be handled as errors.
@@ -81,8 +173,28 @@ public:
     return m_warnings_as_errors;
   }
 
+protected:
+  /**
+   *  @brief Gets the receiver in streaming mode or 0 if not in streaming mode
+   */
+  db::ReaderReceiver *receiver () const
+  {
+    return mp_receiver;
+  }
+
+  /**
+   *  @brief Delivers the given cell to the receiver in streaming mode
+   *  This method will clear the cell's content after delivery. In non-streaming mode
+   *  this method does nothing.
+   */
+  void deliver_cell (db::Layout &layout, db::cell_index_type cell_index);
+
 private:
   bool m_warnings_as_errors;
+  db::ReaderReceiver *mp_receiver;
+  std::vector<bool> m_layers_delivered;
+
+  void do_deliver_cell (db::Layout &layout, db::cell_index_type cell_index);
 };
 
 /**
@@ -127,7 +239,10 @@ public:
    */
   const db::LayerMap &read (db::Layout &layout, const db::LoadLayoutOptions &options) 
   {
-    return mp_actual_reader->read (layout, options);
+    tl::ProfileZone zone ("Reader::read");
+    const db::LayerMap &lm = mp_actual_reader->read (layout, options);
+    zone.add_bytes (m_stream.pos ());
+    return lm;
   }
 
   /** 
@@ -145,7 +260,27 @@ public:
    */
   const db::LayerMap &read (db::Layout &layout)
   {
-    return mp_actual_reader->read (layout);
+    tl::ProfileZone zone ("Reader::read");
+    const db::LayerMap &lm = mp_actual_reader->read (layout);
+    zone.add_bytes (m_stream.pos ());
+    return lm;
+  }
+
+  /** 
+   *  @brief The streaming read method 
+   *
+   *  This method will deliver the cells to the given receiver instead of building
+   *  a full layout. See ReaderReceiver for details.
+   *
+   *  @param receiver The receiver that will get the cells
+   *  @param options The LayerMap object
+   */
+  const db::LayerMap &read (db::ReaderReceiver &receiver, const db::LoadLayoutOptions &options) 
+  {
+    tl::ProfileZone zone ("Reader::read");
+    const db::LayerMap &lm = mp_actual_reader->read (receiver, options);
+    zone.add_bytes (m_stream.pos ());
+    return lm;
   }
 
   /**
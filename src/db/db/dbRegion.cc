@@ -33,6 +33,7 @@
 #include "dbPolygonTools.h"
 
 #include "tlVariant.h"
+#include "tlProfiler.h"
 
 #include <sstream>
 #include <set>
@@ -367,6 +368,8 @@ Region::merge ()
 Region &
 Region::merge (bool min_coherence, unsigned int min_wc)
 {
+  tl::ProfileZone zone ("Region::merge");
+
   if (empty ()) {
 
     //  ignore empty
@@ -415,6 +418,8 @@ Region::merge (bool min_coherence, unsigned int min_wc)
 Region &
 Region::size (Region::coord_type dx, Region::coord_type dy, unsigned int mode)
 {
+  tl::ProfileZone zone ("Region::size");
+
   if (empty ()) {
 
     //  ignore empty
@@ -496,6 +501,8 @@ Region::size (Region::coord_type dx, Region::coord_type dy, unsigned int mode)
 Region &
 Region::operator&= (const Region &other)
 {
+  tl::ProfileZone zone ("Region::and");
+
   if (empty ()) {
 
     //  Nothing to do
@@ -606,6 +613,8 @@ Region::operator&= (const Region &other)
 Region &
 Region::operator-= (const Region &other)
 {
+  tl::ProfileZone zone ("Region::not");
+
   if (empty ()) {
 
     //  Nothing to do
@@ -662,6 +671,8 @@ Region::operator-= (const Region &other)
 Region &
 Region::operator^= (const Region &other)
 {
+  tl::ProfileZone zone ("Region::xor");
+
   if (empty () && ! other.strict_handling ()) {
 
     *this = other;
@@ -719,6 +730,8 @@ Region::operator^= (const Region &other)
 Region &
 Region::operator|= (const Region &other)
 {
+  tl::ProfileZone zone ("Region::or");
+
   if (empty () && ! other.strict_handling ()) {
 
     *this = other;
@@ -825,6 +838,8 @@ Region::operator+= (const Region &other)
 Region
 Region::selected_interacting_generic (const Region &other, int mode, bool touching, bool inverse) const
 {
+  tl::ProfileZone zone ("Region::interacting");
+
   db::EdgeProcessor ep (m_report_progress, m_progress_desc);
 
   //  shortcut
@@ -883,6 +898,8 @@ Region::selected_interacting_generic (const Region &other, int mode, bool touchi
 void
 Region::select_interacting_generic (const Region &other, int mode, bool touching, bool inverse)
 {
+  tl::ProfileZone zone ("Region::interacting");
+
   //  shortcut
   if (empty ()) {
     return;
@@ -1053,6 +1070,8 @@ struct EdgeOrRegionBoxConverter
 Region
 Region::selected_interacting_generic (const Edges &other, bool inverse) const
 {
+  tl::ProfileZone zone ("Region::interacting");
+
   if (other.empty ()) {
     if (! inverse) {
       return Region ();
@@ -1094,6 +1113,8 @@ Region::selected_interacting_generic (const Edges &other, bool inverse) const
 void
 Region::select_interacting_generic (const Edges &other, bool inverse)
 {
+  tl::ProfileZone zone ("Region::interacting");
+
   //  shortcut
   if (other.empty ()) {
     if (! inverse) {
@@ -1444,6 +1465,8 @@ Region::begin_merged_iter () const
 void 
 Region::ensure_merged_polygons_valid () const
 {
+  tl::ProfileZone zone ("Region::merged_polygons");
+
   if (! m_merged_polygons_valid) {
 
     m_merged_polygons.clear ();
@@ -1803,6 +1826,8 @@ private:
 EdgePairs 
 Region::run_check (db::edge_relation_type rel, bool different_polygons, const Region *other, db::Coord d, bool whole_edges, metrics_type metrics, double ignore_angle, distance_type min_projection, distance_type max_projection) const
 {
+  tl::ProfileZone zone ("Region::check");
+
   EdgePairs result;
 
   db::box_scanner<db::Polygon, size_t> scanner (m_report_progress, m_progress_desc);
@@ -1844,6 +1869,8 @@ Region::run_check (db::edge_relation_type rel, bool different_polygons, const Re
 EdgePairs 
 Region::run_single_polygon_check (db::edge_relation_type rel, db::Coord d, bool whole_edges, metrics_type metrics, double ignore_angle, distance_type min_projection, distance_type max_projection) const
 {
+  tl::ProfileZone zone ("Region::check");
+
   EdgePairs result;
 
   EdgeRelationFilter check (rel, d, metrics);
@@ -89,6 +89,16 @@ public:
     return &(*f);
   }
 
+  /**
+   *  @brief Clears the repository
+   *
+   *  This will invalidate all references to shapes inside this repository.
+   */
+  void clear ()
+  {
+    m_set.clear ();
+  }
+
   /**
    *  @brief Report the number of shapes in this repository
    */
@@ -176,6 +186,19 @@ public:
     return m_text_repository;
   }
 
+  /**
+   *  @brief Clears all repositories
+   *
+   *  This will invalidate all references to shapes inside this repository.
+   */
+  void clear ()
+  {
+    m_polygon_repository.clear ();
+    m_simple_polygon_repository.clear ();
+    m_path_repository.clear ();
+    m_text_repository.clear ();
+  }
+
   void mem_stat (MemStatistics *stat, MemStatistics::purpose_t purpose, int cat, bool no_self, void *parent) const
   {
     db::mem_stat (stat, purpose, cat, m_polygon_repository, no_self, parent);
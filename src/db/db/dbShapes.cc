@@ -134,6 +134,9 @@ layer_op<Sh, StableTag>::erase (Shapes *shapes)
 // ---------------------------------------------------------------------------------------
 //  Shapes implementation
 
+//  the number of changed regions reported per container before the whole layer is reported
+const unsigned int max_reported_regions = 64;
+
 Shapes &
 Shapes::operator= (const Shapes &d)
 {
@@ -210,16 +213,36 @@ Shapes::array_repository () const
   return layout ()->array_repository ();
 }
 
+bool
+Shapes::tracks_regions () const
+{
+  db::Layout *ly = layout ();
+  return ly && ly->tracks_regions () && ! ly->under_construction ();
+}
+
 void
 Shapes::invalidate_state ()
 {
+  invalidate_state (db::Box ());
+}
+
+void
+Shapes::invalidate_state (const db::Box &box)
+{
+  //  Until the container is updated again, the first max_reported_regions changed regions are 
+  //  reported individually. After that, the whole layer is reported once.
+  if (! is_dirty ()) {
+    m_regions_reported = 0;
+  }
+  if (m_regions_reported <= max_reported_regions && m_layer_index != std::numeric_limits<unsigned int>::max () && tracks_regions ()) {
+    layout ()->invalidate_region (cell ()->cell_index (), m_layer_index, m_regions_reported < max_reported_regions ? box : db::Box ());
+    ++m_regions_reported;
+  }
+
   if (! is_dirty ()) {
     set_dirty (true);
-    if (layout () && cell ()) {
-      unsigned int index = cell ()->index_of_shapes (this);
-      if (index != std::numeric_limits<unsigned int>::max ()) {
-        layout ()->invalidate_bboxes (index);
-      }
+    if (layout () && m_layer_index != std::numeric_limits<unsigned int>::max ()) {
+      layout ()->invalidate_bboxes (m_layer_index);
     }
   }
 }
@@ -1134,7 +1157,7 @@ Shapes::replace_member_with_props (typename db::object_tag<Sh> tag, const shape_
         db::layer_op<Sh, db::stable_layer_tag>::queue_or_append (manager (), this, false /*not insert*/, *ref.basic_ptr (tag));
       }
 
-      invalidate_state ();  //  HINT: must come before the change is done!
+      invalidate_state (region_of (*ref.basic_ptr (tag)) + region_of (sh));  //  HINT: must come before the change is done!
 
       get_layer<Sh, db::stable_layer_tag> ().replace (ref.basic_iter (tag), sh);
 
@@ -1158,7 +1181,7 @@ Shapes::replace_member_with_props (typename db::object_tag<Sh> tag, const shape_
         db::layer_op<Sh, db::stable_layer_tag>::queue_or_append (manager (), this, false /*not insert*/, *ref.basic_ptr (tag));
       }
 
-      invalidate_state ();  //  HINT: must come before the change is done!
+      invalidate_state (region_of (*ref.basic_ptr (tag)) + region_of (sh));  //  HINT: must come before the change is done!
 
       if (needs_translate (tag)) {
 
@@ -1186,7 +1209,7 @@ Shapes::replace_member_with_props (typename db::object_tag<Sh> tag, const shape_
         db::layer_op<db::object_with_properties<Sh>, db::stable_layer_tag>::queue_or_append (manager (), this, false /*not insert*/, *ref.basic_ptr (typename db::object_with_properties<Sh>::tag ()));
       }
 
-      invalidate_state ();  //  HINT: must come before the change is done!
+      invalidate_state (region_of (*ref.basic_ptr (typename db::object_with_properties<Sh>::tag ())) + region_of (sh));  //  HINT: must come before the change is done!
 
       db::object_with_properties<Sh> swp;
       swp.translate (db::object_with_properties<Sh> (sh, ref.prop_id ()), shape_repository (), array_repository ());
@@ -35,6 +35,8 @@
 #include "tlVector.h"
 #include "tlUtils.h"
 
+#include <limits>
+
 namespace db 
 {
 
@@ -501,7 +503,7 @@ public:
    *  are created in editable mode to allow insertion and deletion of shapes by default.
    */
   Shapes ()
-    : db::Object (0), mp_cell (0)
+    : db::Object (0), mp_cell (0), m_layer_index (std::numeric_limits<unsigned int>::max ()), m_regions_reported (0)
   {
     set_editable (true);
   }
@@ -514,7 +516,7 @@ public:
    *  or insert-once mode.
    */
   Shapes (bool editable)
-    : db::Object (0), mp_cell (0)
+    : db::Object (0), mp_cell (0), m_layer_index (std::numeric_limits<unsigned int>::max ()), m_regions_reported (0)
   {
     set_editable (editable);
   }
@@ -527,10 +529,12 @@ public:
    *
    *  Since such containers are usually used in a layout context, they are created according to the
    *  editable settings of the database by default.
+   *
+   *  "layer_index" is the index of the layer inside the cell. It is used for reporting changes.
    */
-  Shapes (db::Manager *manager, db::Cell *cell, bool editable) 
+  Shapes (db::Manager *manager, db::Cell *cell, unsigned int layer_index, bool editable) 
     : db::Object (manager), 
-      mp_cell (cell)
+      mp_cell (cell), m_layer_index (layer_index), m_regions_reported (0)
   {
     set_dirty (false);
     set_editable (editable);
@@ -558,7 +562,8 @@ public:
    */
   Shapes (const Shapes &d) 
     : db::Object (d), 
-      mp_cell (d.mp_cell)  //  implicitly copies "dirty" and "editable" 
+      mp_cell (d.mp_cell),  //  implicitly copies "dirty" and "editable" 
+      m_layer_index (d.m_layer_index), m_regions_reported (0)
   {
     operator= (d);
   }
@@ -773,7 +778,7 @@ public:
         db::layer_op<Sh, db::unstable_layer_tag>::queue_or_append (manager (), this, true /*insert*/, sh);
       }
     }
-    invalidate_state ();  //  HINT: must come before the change is done!
+    invalidate_state (region_of (sh));  //  HINT: must come before the change is done!
     if (is_editable ()) {
       return shape_type (this, get_layer<Sh, db::stable_layer_tag> ().insert (sh));
     } else {
@@ -873,7 +878,7 @@ public:
         db::layer_op<value_type, db::unstable_layer_tag>::queue_or_append (manager (), this, true /*insert*/, from, to);
       }
     }
-    invalidate_state ();
+    invalidate_state (region_of<value_type> (from, to));
     if (is_editable ()) {
       get_layer<value_type, db::stable_layer_tag> ().insert (from, to);
     } else {
@@ -964,7 +969,7 @@ public:
     if (manager () && manager ()->transacting ()) {
       db::layer_op<typename Tag::object_type, StableTag>::queue_or_append (manager (), this, false /*not insert*/, *pos);
     }
-    invalidate_state ();  //  HINT: must come before the change is done!
+    invalidate_state (region_of (*pos));  //  HINT: must come before the change is done!
     get_layer<typename Tag::object_type, StableTag> ().erase (pos);
   }
 
@@ -1027,7 +1032,7 @@ public:
     if (manager () && manager ()->transacting ()) {
       db::layer_op<typename Tag::object_type, StableTag>::queue_or_append (manager (), this, false /*not insert*/, from, to);
     }
-    invalidate_state ();  //  HINT: must come before the change is done!
+    invalidate_state (region_of<typename Tag::object_type> (from, to));  //  HINT: must come before the change is done!
     get_layer<typename Tag::object_type, StableTag> ().erase (from, to);
   }
 
@@ -1053,7 +1058,7 @@ public:
     if (manager () && manager ()->transacting ()) {
       db::layer_op<typename Tag::object_type, StableTag>::queue_or_append (manager (), this, false /*not insert*/, first, last, true /*dummy*/);
     }
-    invalidate_state ();  //  HINT: must come before the change is done!
+    invalidate_state (region_of_positions<typename Tag::object_type> (first, last));  //  HINT: must come before the change is done!
     get_layer<typename Tag::object_type, StableTag> ().erase_positions (first, last);
   }
 
@@ -1430,10 +1435,49 @@ private:
 
   tl::vector<LayerBase *> m_layers;
   db::Cell *mp_cell;  //  HINT: contains "dirty" in bit 0 and "editable" in bit 1
+  unsigned int m_layer_index;
+  unsigned int m_regions_reported;
 
   void invalidate_state ();
+  void invalidate_state (const db::Box &box);
+  bool tracks_regions () const;
   void do_insert (const Shapes &d);
 
+  //  the region affected by changing the given shape (empty if regions are not tracked)
+  template <class Sh>
+  db::Box region_of (const Sh &sh) const
+  {
+    return tracks_regions () ? db::box_convert<Sh> () (sh) : db::Box ();
+  }
+
+  //  the region affected by changing the shapes [from, to) (empty if regions are not tracked)
+  template <class Sh, class Iter>
+  db::Box region_of (Iter from, Iter to) const
+  {
+    db::Box box;
+    if (tracks_regions ()) {
+      db::box_convert<Sh> bc;
+      for (Iter i = from; i != to; ++i) {
+        box += bc (*i);
+      }
+    }
+    return box;
+  }
+
+  //  the region affected by changing the shapes at the positions [from, to) (empty if regions are not tracked)
+  template <class Sh, class Iter>
+  db::Box region_of_positions (Iter from, Iter to) const
+  {
+    db::Box box;
+    if (tracks_regions ()) {
+      db::box_convert<Sh> bc;
+      for (Iter i = from; i != to; ++i) {
+        box += bc (**i);
+      }
+    }
+    return box;
+  }
+
   //  extract dirty flag from mp_cell
   bool is_dirty () const 
   {
@@ -336,7 +336,7 @@ Shapes::erase_shape_by_tag_ws (Tag /*tag*/, StableTag /*stable_tag*/, const shap
     if (manager () && manager ()->transacting ()) {
       db::layer_op<typename Tag::object_type, StableTag>::queue_or_append (manager (), this, false /*not insert*/, *i);
     }
-    invalidate_state ();  //  HINT: must come before the change is done!
+    invalidate_state (region_of (*i));  //  HINT: must come before the change is done!
     l.erase (i);
 
   } else {
@@ -348,7 +348,7 @@ Shapes::erase_shape_by_tag_ws (Tag /*tag*/, StableTag /*stable_tag*/, const shap
     if (manager () && manager ()->transacting ()) {
       db::layer_op<swp_type, StableTag>::queue_or_append (manager (), this, false /*not insert*/, *i);
     }
-    invalidate_state ();  //  HINT: must come before the change is done!
+    invalidate_state (region_of (*i));  //  HINT: must come before the change is done!
     l.erase (i);
 
   }
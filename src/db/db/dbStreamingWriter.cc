@@ -0,0 +1,213 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "dbStreamingWriter.h"
+#include "dbStream.h"
+#include "tlClassRegistry.h"
+#include "tlAssert.h"
+#include "tlStream.h"
+
+namespace db
+{
+
+StreamingWriter::StreamingWriter (tl::OutputStream &stream, const db::SaveLayoutOptions &options, double dbu)
+  : mp_stream (&stream), m_options (options), mp_writer (0), 
+    m_streaming (false), m_started (false), m_in_cell (false), m_finished (false),
+    m_cell (0), m_buffer_size (100000), m_buffered (0)
+{
+  for (tl::Registrar<db::StreamFormatDeclaration>::iterator fmt = tl::Registrar<db::StreamFormatDeclaration>::begin (); fmt != tl::Registrar<db::StreamFormatDeclaration>::end () && ! mp_writer; ++fmt) {
+    if (m_options.format () == fmt->format_name ()) {
+      mp_writer = fmt->create_writer ();
+    }
+  }
+  if (! mp_writer) {
+    throw tl::Exception (tl::to_string (QObject::tr ("Unknown stream format: %s")), m_options.format ());
+  }
+
+  m_streaming = mp_writer->supports_streaming ();
+
+  m_layout.dbu (dbu);
+  m_layout.start_changes ();
+}
+
+StreamingWriter::~StreamingWriter ()
+{
+  m_layout.end_changes ();
+
+  if (mp_writer) {
+    delete mp_writer;
+  }
+  mp_writer = 0;
+}
+
+unsigned int 
+StreamingWriter::add_layer (const db::LayerProperties &lp)
+{
+  for (db::Layout::layer_iterator li = m_layout.begin_layers (); li != m_layout.end_layers (); ++li) {
+    if ((*li).second->log_equal (lp)) {
+      return (*li).first;
+    }
+  }
+
+  return m_layout.insert_layer (lp);
+}
+
+db::cell_index_type 
+StreamingWriter::add_cell (const std::string &name)
+{
+  std::pair<bool, db::cell_index_type> c = m_layout.cell_by_name (name.c_str ());
+  if (c.first) {
+    return c.second;
+  } else {
+    return m_layout.add_cell (name.c_str ());
+  }
+}
+
+void 
+StreamingWriter::set_cell_prop_id (db::cell_index_type cell_index, db::properties_id_type prop_id)
+{
+  m_layout.cell (cell_index).prop_id (prop_id);
+}
+
+void 
+StreamingWriter::start ()
+{
+  if (! m_started) {
+    m_started = true;
+    if (m_streaming) {
+      mp_writer->begin_streaming (m_layout, *mp_stream, m_options);
+    }
+  }
+}
+
+void 
+StreamingWriter::begin_cell (db::cell_index_type cell_index)
+{
+  if (m_finished) {
+    throw tl::Exception (tl::to_string (QObject::tr ("Streaming writer has been finished already")));
+  }
+  if (m_in_cell) {
+    throw tl::Exception (tl::to_string (QObject::tr ("Cell '%s' is still open - only one cell can be written at a time")), m_layout.cell_name (m_cell));
+  }
+  if (! m_layout.is_valid_cell_index (cell_index)) {
+    throw tl::Exception (tl::to_string (QObject::tr ("Not a valid cell index: %lu")), (unsigned long) cell_index);
+  }
+
+  start ();
+
+  m_in_cell = true;
+  m_cell = cell_index;
+  m_buffered = 0;
+
+  if (m_streaming) {
+    mp_writer->begin_streaming_cell (cell_index);
+  }
+}
+
+void 
+StreamingWriter::check_in_cell ()
+{
+  if (! m_in_cell) {
+    throw tl::Exception (tl::to_string (QObject::tr ("No cell is open in the streaming writer")));
+  }
+}
+
+void
+StreamingWriter::insert (unsigned int layer, const db::Region &region)
+{
+  for (db::Region::const_iterator p = region.begin (); ! p.at_end (); ++p) {
+    insert (layer, *p);
+  }
+}
+
+void 
+StreamingWriter::insert (const db::CellInstArray &inst)
+{
+  check_in_cell ();
+  m_layout.cell (m_cell).insert (inst);
+  inc_buffer ();
+}
+
+void 
+StreamingWriter::insert (const db::CellInstArrayWithProperties &inst)
+{
+  check_in_cell ();
+  m_layout.cell (m_cell).insert (inst);
+  inc_buffer ();
+}
+
+void 
+StreamingWriter::flush ()
+{
+  if (m_in_cell && m_buffered > 0) {
+
+    mp_writer->write_streaming_cell_content (m_cell);
+
+    db::Cell &cell = m_layout.cell (m_cell);
+    cell.clear_insts ();
+    cell.clear_shapes ();
+
+  }
+
+  m_buffered = 0;
+}
+
+void 
+StreamingWriter::end_cell ()
+{
+  check_in_cell ();
+
+  if (m_streaming) {
+    flush ();
+    mp_writer->end_streaming_cell (m_cell);
+  }
+
+  m_in_cell = false;
+}
+
+void 
+StreamingWriter::finish ()
+{
+  if (m_in_cell) {
+    end_cell ();
+  }
+
+  if (m_finished) {
+    return;
+  }
+
+  start ();
+  m_finished = true;
+
+  if (m_streaming) {
+    mp_writer->end_streaming ();
+  } else {
+    //  fallback for formats not supporting streaming: write everything now
+    m_layout.end_changes ();
+    mp_writer->write (m_layout, *mp_stream, m_options);
+    m_layout.start_changes ();
+  }
+}
+
+}
+
@@ -0,0 +1,219 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#ifndef HDR_dbStreamingWriter
+#define HDR_dbStreamingWriter
+
+#include "dbCommon.h"
+
+#include "dbWriter.h"
+#include "dbLayout.h"
+#include "dbRegion.h"
+
+namespace tl
+{
+  class OutputStream;
+}
+
+namespace db
+{
+
+/**
+ *  @brief A writer that accepts cells and shapes incrementally
+ *
+ *  In contrast to db::Writer, this writer does not require a full layout.
+ *  Instead, cells, shapes and instances are specified one after another:
+ *
+ *  @code
+ *  db::StreamingWriter writer (stream, options, 0.001);
+ *  unsigned int l1 = writer.add_layer (db::LayerProperties (1, 0));
+ *  db::cell_index_type top = writer.add_cell ("TOP");
+ *  writer.begin_cell (top);
+ *  writer.insert (l1, db::Box (0, 0, 1000, 1000));
+ *  ...
+ *  writer.end_cell ();
+ *  writer.finish ();
+ *  @endcode
+ *
+ *  The shapes are buffered in a scratch layout and are written in chunks of
+ *  the given buffer size. So the memory required does not depend on the 
+ *  number of shapes. Cells need to be written in one piece - only one cell 
+ *  can be open at a time. Cells may be referenced by instances before they 
+ *  are written.
+ *
+ *  Formats which do not support streaming (see WriterBase::supports_streaming)
+ *  are supported too, but for these, all content is kept in memory until
+ *  "finish" is called.
+ *
+ *  Layers should be declared before the first cell is written. Properties IDs
+ *  need to be taken from the properties repository of this object.
+ */
+class DB_PUBLIC StreamingWriter
+{
+public:
+  /**
+   *  @brief Constructor
+   *
+   *  @param stream The stream to write to
+   *  @param options The save options - these specify the format and the format specific options
+   *  @param dbu The database unit of the coordinates given to this object
+   */
+  StreamingWriter (tl::OutputStream &stream, const db::SaveLayoutOptions &options, double dbu);
+
+  /**
+   *  @brief Destructor
+   *  "finish" is not called by the destructor - if not called, the file is incomplete.
+   */
+  ~StreamingWriter ();
+
+  /**
+   *  @brief Sets the buffer size 
+   *  The buffer size is the number of objects collected before they are written. The default is 100000.
+   */
+  void set_buffer_size (size_t n)
+  {
+    m_buffer_size = std::max (size_t (1), n);
+  }
+
+  /**
+   *  @brief Gets the buffer size 
+   */
+  size_t buffer_size () const
+  {
+    return m_buffer_size;
+  }
+
+  /**
+   *  @brief Gets the database unit
+   */
+  double dbu () const
+  {
+    return m_layout.dbu ();
+  }
+
+  /**
+   *  @brief Gets the properties repository for the properties IDs
+   */
+  db::PropertiesRepository &properties_repository ()
+  {
+    return m_layout.properties_repository ();
+  }
+
+  /**
+   *  @brief Declares a layer and returns the layer index
+   *  If a layer with the given properties was declared already, this layer's index is returned.
+   */
+  unsigned int add_layer (const db::LayerProperties &lp);
+
+  /**
+   *  @brief Declares a cell and returns the cell index
+   *  The cell index can be used for "begin_cell" and for instances. If a cell with the 
+   *  given name exists already, this cell's index is returned.
+   */
+  db::cell_index_type add_cell (const std::string &name);
+
+  /**
+   *  @brief Sets the properties ID of the given cell
+   *  This method needs to be called before the cell is begun.
+   */
+  void set_cell_prop_id (db::cell_index_type cell_index, db::properties_id_type prop_id);
+
+  /**
+   *  @brief Begins writing the given cell
+   */
+  void begin_cell (db::cell_index_type cell_index);
+
+  /**
+   *  @brief Returns true, if the given cell is the current one
+   */
+  bool in_cell (db::cell_index_type cell_index) const
+  {
+    return m_in_cell && m_cell == cell_index;
+  }
+
+  /**
+   *  @brief Adds a shape to the current cell
+   *  Any shape type accepted by db::Shapes can be given.
+   */
+  template <class Sh>
+  void insert (unsigned int layer, const Sh &shape)
+  {
+    check_in_cell ();
+    m_layout.cell (m_cell).shapes (layer).insert (shape);
+    inc_buffer ();
+  }
+
+  /**
+   *  @brief Adds all polygons from the given region to the current cell
+   */
+  void insert (unsigned int layer, const db::Region &region);
+
+  /**
+   *  @brief Adds an instance to the current cell
+   */
+  void insert (const db::CellInstArray &inst);
+
+  /**
+   *  @brief Adds an instance with properties to the current cell
+   */
+  void insert (const db::CellInstArrayWithProperties &inst);
+
+  /**
+   *  @brief Finishes the current cell
+   */
+  void end_cell ();
+
+  /**
+   *  @brief Finishes writing
+   */
+  void finish ();
+
+private:
+  tl::OutputStream *mp_stream;
+  db::SaveLayoutOptions m_options;
+  db::WriterBase *mp_writer;
+  db::Layout m_layout;
+  bool m_streaming;
+  bool m_started;
+  bool m_in_cell;
+  bool m_finished;
+  db::cell_index_type m_cell;
+  size_t m_buffer_size;
+  size_t m_buffered;
+
+  void check_in_cell ();
+  void start ();
+  void flush ();
+
+  void inc_buffer ()
+  {
+    if (m_streaming && ++m_buffered >= m_buffer_size) {
+      flush ();
+    }
+  }
+};
+
+}
+
+#endif
+
@@ -151,4 +151,62 @@ void compare_layouts (tl::TestBase *_this, const db::Layout &layout, const std::
   }
 }
 
+// ---------------------------------------------------------------------------------------------
+//  CountingReaderReceiver implementation
+
+CountingReaderReceiver::CountingReaderReceiver ()
+  : mp_layout (0), m_layers (0), m_nesting_errors (0), m_current (-1)
+{ }
+
+void 
+CountingReaderReceiver::begin_file (const db::Layout &layout)
+{
+  mp_layout = &layout;
+}
+
+void 
+CountingReaderReceiver::layer (unsigned int /*layer_index*/, const db::LayerProperties & /*lp*/)
+{
+  ++m_layers;
+}
+
+void 
+CountingReaderReceiver::begin_cell (db::cell_index_type cell_index, const std::string & /*name*/)
+{
+  if (m_current >= 0) {
+    ++m_nesting_errors;
+  }
+  m_current = long (cell_index);
+  m_counts [cell_index];
+}
+
+void 
+CountingReaderReceiver::shape (unsigned int /*layer_index*/, const db::Shape & /*shape*/)
+{
+  m_counts [db::cell_index_type (m_current)].first += 1;
+}
+
+void 
+CountingReaderReceiver::instance (const db::Instance & /*instance*/)
+{
+  m_counts [db::cell_index_type (m_current)].second += 1;
+}
+
+void 
+CountingReaderReceiver::end_cell (db::cell_index_type cell_index)
+{
+  if (m_current != long (cell_index)) {
+    ++m_nesting_errors;
+  }
+  m_current = -1;
+}
+
+void 
+CountingReaderReceiver::end_file (const db::Layout &layout)
+{
+  for (std::map<db::cell_index_type, std::pair<size_t, size_t> >::const_iterator c = m_counts.begin (); c != m_counts.end (); ++c) {
+    m_counts_by_name [layout.cell_name (c->first)] = c->second;
+  }
+}
+
 }
@@ -25,8 +25,10 @@
 
 #include "dbCommon.h"
 #include "dbTypes.h"
+#include "dbReader.h"
 
 #include <string>
+#include <map>
 
 namespace tl
 {
@@ -72,6 +74,36 @@ void DB_PUBLIC compare_layouts (tl::TestBase *_this, const db::Layout &layout, c
  */
 void DB_PUBLIC compare_layouts (tl::TestBase *_this, const db::Layout &layout, const std::string &au_file, const db::LayerMap &lmap, bool read_all_others, NormalizationMode norm = WriteGDS2, db::Coord tolerance = 0);
 
+/**
+ *  @brief A reader receiver counting shapes and instances per cell
+ *
+ *  This receiver is used for testing the streaming mode of the readers. 
+ *  After reading, m_counts_by_name holds the number of shapes (first) and 
+ *  instances (second) per cell name. m_nesting_errors counts begin_cell/end_cell 
+ *  pairs which are not properly nested.
+ */
+class DB_PUBLIC CountingReaderReceiver
+  : public db::ReaderReceiver
+{
+public:
+  CountingReaderReceiver ();
+
+  virtual void begin_file (const db::Layout &layout);
+  virtual void layer (unsigned int layer_index, const db::LayerProperties &lp);
+  virtual void begin_cell (db::cell_index_type cell_index, const std::string &name);
+  virtual void shape (unsigned int layer_index, const db::Shape &shape);
+  virtual void instance (const db::Instance &instance);
+  virtual void end_cell (db::cell_index_type cell_index);
+  virtual void end_file (const db::Layout &layout);
+
+  const db::Layout *mp_layout;
+  unsigned int m_layers;
+  unsigned int m_nesting_errors;
+  long m_current;
+  std::map<db::cell_index_type, std::pair<size_t, size_t> > m_counts;
+  std::map<std::string, std::pair<size_t, size_t> > m_counts_by_name;
+};
+
 }
 
 #endif
@@ -22,13 +22,30 @@
 
 
 #include "dbTilingProcessor.h"
+#include "dbStreamingWriter.h"
 
 #include "tlExpression.h"
 #include "tlProgress.h"
+#include "tlProfiler.h"
 #include "tlThreadedWorkers.h"
+#include "tlThreadPool.h"
 #include "gsiDecl.h"
 
 #include <cmath>
+#include <algorithm>
+#include <memory>
+#include <limits>
+
+#if !defined(_WIN32)
+#  include <unistd.h>
+#  include <poll.h>
+#  include <signal.h>
+#  include <sys/types.h>
+#  include <sys/wait.h>
+#  include <errno.h>
+#  include <string.h>
+#  include <stdio.h>
+#endif
 
 namespace db
 {
@@ -62,6 +79,36 @@ private:
   db::Coord m_ep_sizing;
 };
 
+/**
+ *  @brief A helper class for the generic implementation of the streaming writer insert functionality
+ */
+class StreamingWriterInserter
+{
+public:
+  StreamingWriterInserter (db::StreamingWriter *writer, unsigned int layer, const db::ICplxTrans &trans, db::Coord ep_sizing)
+    : mp_writer (writer), m_layer (layer), m_trans (trans), m_ep_sizing (ep_sizing)
+  {
+    //  .. nothing yet ..
+  }
+
+  template <class T>
+  void operator() (const T &t)
+  {
+    mp_writer->insert (m_layer, t.transformed (m_trans));
+  }
+
+  void operator() (const db::EdgePair &ep)
+  {
+    mp_writer->insert (m_layer, ep.normalized ().to_polygon (m_ep_sizing).transformed (m_trans));
+  }
+
+private:
+  db::StreamingWriter *mp_writer;
+  unsigned int m_layer;
+  const db::ICplxTrans m_trans;
+  db::Coord m_ep_sizing;
+};
+
 /**
  *  @brief A helper class for the generic implementation of the region insert functionality
  */
@@ -192,6 +239,11 @@ public:
     mp_layout->end_changes ();
   }
 
+  bool accepts_sub_tiles () const
+  {
+    return true;
+  }
+
 private:
   db::Layout *mp_layout;
   db::Cell *mp_cell;
@@ -199,6 +251,44 @@ private:
   db::Coord m_ep_sizing;
 };
 
+class TileStreamingWriterOutputReceiver
+  : public db::TileOutputReceiver
+{
+public:
+  TileStreamingWriterOutputReceiver (db::StreamingWriter *writer, db::cell_index_type cell, unsigned int layer, db::Coord e)
+    : mp_writer (writer), m_cell (cell), m_layer (layer), m_ep_sizing (e)
+  {
+    //  .. nothing yet ..
+  }
+
+  void put (size_t /*ix*/, size_t /*iy*/, const db::Box &tile, size_t /*id*/, const tl::Variant &obj, double dbu, const db::ICplxTrans &trans, bool clip)
+  {
+    db::ICplxTrans t (db::ICplxTrans (dbu / mp_writer->dbu ()) * trans);
+    StreamingWriterInserter inserter (mp_writer, m_layer, t, m_ep_sizing);
+
+    insert_var (inserter, obj, tile, clip);
+  }
+
+  void begin (size_t /*nx*/, size_t /*ny*/, const db::DPoint & /*p0*/, double /*dx*/, double /*dy*/, const db::DBox & /*frame*/)
+  { 
+    //  open the target cell unless it is open already (i.e. by another output)
+    if (! mp_writer->in_cell (m_cell)) {
+      mp_writer->begin_cell (m_cell);
+    }
+  }
+
+  bool accepts_sub_tiles () const
+  {
+    return true;
+  }
+
+private:
+  db::StreamingWriter *mp_writer;
+  db::cell_index_type m_cell;
+  unsigned int m_layer;
+  db::Coord m_ep_sizing;
+};
+
 class TileRegionOutputReceiver
   : public db::TileOutputReceiver
 {
@@ -220,6 +310,11 @@ public:
     }
   }
 
+  bool accepts_sub_tiles () const
+  {
+    return true;
+  }
+
 private:
   db::Region *mp_region;
   db::Coord m_ep_sizing;
@@ -246,6 +341,11 @@ public:
     }
   }
 
+  bool accepts_sub_tiles () const
+  {
+    return true;
+  }
+
 private:
   db::Edges *mp_edges;
 };
@@ -266,281 +366,1317 @@ public:
     insert_var (inserter, obj, tile, clip);
   }
 
+  bool accepts_sub_tiles () const
+  {
+    return true;
+  }
+
 private:
   db::EdgePairs *mp_edge_pairs;
 };
 
-class TilingProcessorJob
-  : public tl::JobBase
+struct TilingProcessorTile
 {
-public:
-  TilingProcessorJob (TilingProcessor *proc, int nworkers, bool has_tiles)
-    : tl::JobBase (nworkers),
-      mp_proc (proc),
-      m_has_tiles (has_tiles),
-      m_progress (0)
+  TilingProcessorTile (const std::string &_tile_desc, size_t _ix, size_t _iy, const db::DBox &_clip_box, const db::DBox &_region)
+    : tile_desc (_tile_desc), ix (_ix), iy (_iy), clip_box (_clip_box), region (_region)
   {
     //  .. nothing yet ..
   }
 
-  bool has_tiles () const
-  {
-    return m_has_tiles;
-  }
-
-  void next_progress () 
-  {
-    QMutexLocker locker (&m_mutex);
-    ++m_progress;
-  }
-
-  void update_progress (tl::RelativeProgress &progress) 
-  {
-    unsigned int p;
-    {
-      QMutexLocker locker (&m_mutex);
-      p = m_progress;
-    }
-
-    progress.set (p, true /*force yield*/);
-  }
-
-  TilingProcessor *processor () const
-  {
-    return mp_proc;
-  }
-
-  virtual tl::Worker *create_worker ();
-
-private:
-  TilingProcessor *mp_proc;
-  bool m_has_tiles;
-  unsigned int m_progress;
-  QMutex m_mutex;
+  std::string tile_desc;
+  size_t ix, iy;
+  db::DBox clip_box, region;
 };
 
 class TilingProcessorTask
   : public tl::Task
 {
 public:
-  TilingProcessorTask (const std::string &tile_desc, size_t ix, size_t iy, const db::DBox &clip_box, const db::DBox &region, const std::string &script, size_t script_index)
-    : m_tile_desc (tile_desc), m_ix (ix), m_iy (iy), m_clip_box (clip_box), m_region (region), m_script (script), m_script_index (script_index)
+  TilingProcessorTask (const std::vector<TilingProcessorTile> &tiles, const std::string &script, size_t script_index, TileInputCache *cache = 0)
+    : m_tiles (tiles), m_script (script), m_script_index (script_index), mp_op (0), mp_cache (cache)
   {
     //  .. nothing yet ..
   }
 
-  const std::string &tile_desc () const
+  TilingProcessorTask (const std::vector<TilingProcessorTile> &tiles, const TileOperation *op, size_t script_index, TileInputCache *cache = 0)
+    : m_tiles (tiles), m_script_index (script_index), mp_op (op), mp_cache (cache)
   {
-    return m_tile_desc;
+    //  .. nothing yet ..
   }
-  
-  const db::DBox &clip_box () const
+
+  const std::vector<TilingProcessorTile> &tiles () const
   {
-    return m_clip_box;
+    return m_tiles;
   }
 
-  size_t ix () const
+  const std::string &script () const
   {
-    return m_ix;
+    return m_script;
   }
-  
-  size_t iy () const
+
+  size_t script_index () const
   {
-    return m_iy;
+    return m_script_index;
   }
-  
-  const db::DBox &region () const
+
+  const TileOperation *op () const
   {
-    return m_region;
+    return mp_op;
   }
-  
-  const std::string &script () const
+
+  TileInputCache *cache () const
   {
-    return m_script;
+    return mp_cache;
   }
 
-  size_t script_index () const
+  TilingProcessorTask *clone () const
   {
-    return m_script_index;
+    if (mp_op) {
+      return new TilingProcessorTask (m_tiles, mp_op, m_script_index, mp_cache);
+    } else {
+      return new TilingProcessorTask (m_tiles, m_script, m_script_index, mp_cache);
+    }
   }
 
 private:
-  std::string m_tile_desc;
-  size_t m_ix, m_iy;
-  db::DBox m_clip_box, m_region;
+  std::vector<TilingProcessorTile> m_tiles;
   std::string m_script;
   size_t m_script_index;
+  const TileOperation *mp_op;
+  TileInputCache *mp_cache;
 };
 
-class TilingProcessorWorker
-  : public tl::Worker
+/**
+ *  @brief A cache for the region inputs of a batch of adjacent tiles
+ *
+ *  The cache fetches the shapes for all tiles of a batch in a single pass and 
+ *  distributes them over the tiles. Shapes in the overlapping tile borders are 
+ *  fetched once only. The cache is shared by the tasks of one batch (one per 
+ *  script or operation). It is filled by the first task and released when the 
+ *  last task has finished.
+ */
+class TileInputCache
 {
 public:
-  TilingProcessorWorker (TilingProcessorJob *job)
-    : tl::Worker (), mp_job (job)
+  TileInputCache (const TilingProcessor *proc, const std::vector<TilingProcessorTile> &tiles, size_t users)
+    : mp_proc (proc), m_tiles (tiles), m_users (users), m_valid (false)
   {
     //  .. nothing yet ..
   }
 
-  void perform_task (tl::Task *task) 
+  void acquire ()
   {
-    TilingProcessorTask *tile_task = dynamic_cast <TilingProcessorTask *> (task);
-    if (tile_task) {
-      do_perform (tile_task);
+    QMutexLocker locker (&m_mutex);
+    if (! m_valid) {
+      fetch ();
+      m_valid = true;
     }
   }
 
-private:
-  TilingProcessorJob *mp_job;
-
-  void do_perform (const TilingProcessorTask *task);
-};
-
-class TilingProcessorReceiverFunction
-  : public tl::EvalFunction
-{
-public:
-  TilingProcessorReceiverFunction (TilingProcessor *proc)
-    : mp_proc (proc)
+  void release ()
   {
-    //  .. nothing yet ..
+    QMutexLocker locker (&m_mutex);
+    if (m_users > 0 && --m_users == 0) {
+      m_polygons.clear ();
+    }
   }
 
-  void execute (const tl::ExpressionParserContext & /*context*/, tl::Variant &out, const std::vector<tl::Variant> &args) const
+  const std::vector<db::Polygon> *polygons (size_t input, size_t slot) const
   {
-    out = mp_proc->receiver (args);
+    if (input < m_polygons.size () && slot < m_polygons [input].size ()) {
+      return &m_polygons [input][slot];
+    } else {
+      return 0;
+    }
   }
 
 private:
-  TilingProcessor *mp_proc;
+  const TilingProcessor *mp_proc;
+  std::vector<TilingProcessorTile> m_tiles;
+  size_t m_users;
+  bool m_valid;
+  QMutex m_mutex;
+  std::vector<std::vector<std::vector<db::Polygon> > > m_polygons;
+
+  void fetch ();
 };
 
-class TilingProcessorOutputFunction
-  : public tl::EvalFunction
+void
+TileInputCache::fetch ()
 {
-public:
-  TilingProcessorOutputFunction (TilingProcessor *proc, size_t ix, size_t iy, const db::Box &tile_box)
-    : mp_proc (proc), m_ix (ix), m_iy (iy), m_tile_box (tile_box)
-  {
-    //  .. nothing yet ..
+  m_polygons.clear ();
+  m_polygons.resize (mp_proc->m_inputs.size ());
+
+  db::DBox strip;
+  for (std::vector<TilingProcessorTile>::const_iterator t = m_tiles.begin (); t != m_tiles.end (); ++t) {
+    strip += t->region;
   }
 
-  void execute (const tl::ExpressionParserContext & /*context*/, tl::Variant & /*out*/, const std::vector<tl::Variant> &args) const 
-  {
-    mp_proc->put (m_ix, m_iy, m_tile_box, args);
+  size_t index = 0;
+  for (std::vector<TilingProcessor::InputSpec>::const_iterator i = mp_proc->m_inputs.begin (); i != mp_proc->m_inputs.end (); ++i, ++index) {
+
+    //  edge inputs are not cached
+    if (! i->region) {
+      continue;
+    }
+
+    std::vector<std::vector<db::Polygon> > &buckets = m_polygons [index];
+    buckets.resize (m_tiles.size ());
+
+    //  the tile regions in the input's coordinate space
+    std::vector<db::Box> boxes;
+    for (std::vector<TilingProcessorTile>::const_iterator t = m_tiles.begin (); t != m_tiles.end (); ++t) {
+      boxes.push_back (mp_proc->input_region (index, t->region));
+    }
+
+    db::ICplxTrans trans;
+    db::Polygon poly;
+
+    for (db::RecursiveShapeIterator iter = mp_proc->input_iter (index, true, strip, trans); ! iter.at_end (); ++iter) {
+
+      if (! (iter.shape ().is_polygon () || iter.shape ().is_path () || iter.shape ().is_box ())) {
+        continue;
+      }
+
+      db::Box box = iter.shape ().bbox ().transformed (iter.trans ());
+
+      bool fetched = false;
+      for (size_t n = 0; n < boxes.size (); ++n) {
+        if (box.touches (boxes [n])) {
+          if (! fetched) {
+            iter.shape ().polygon (poly);
+            poly.transform (trans * iter.trans (), false);
+            fetched = true;
+          }
+          buckets [n].push_back (poly);
+        }
+      }
+
+    }
+
   }
+}
 
-private:
-  TilingProcessor *mp_proc;
-  size_t m_ix, m_iy;
-  db::Box m_tile_box; 
-};
+namespace
+{
 
-class TilingProcessorCountFunction
-  : public tl::EvalFunction
+/**
+ *  @brief A list of input caches which owns the caches
+ */
+class TileInputCacheList
+  : public std::vector<TileInputCache *>
 {
 public:
-  TilingProcessorCountFunction (TilingProcessor * /*proc*/)
+  ~TileInputCacheList ()
   {
-    //  .. nothing yet ..
+    for (iterator c = begin (); c != end (); ++c) {
+      delete *c;
+    }
   }
+};
 
-  void execute (const tl::ExpressionParserContext & /*context*/, tl::Variant & /*out*/, const std::vector<tl::Variant> & /*args*/) const 
+}
+
+/**
+ *  @brief A list of tasks which owns the tasks
+ */
+class TilingProcessorTaskList
+  : public std::vector<TilingProcessorTask *>
+{
+public:
+  ~TilingProcessorTaskList ()
   {
-    // TODO: ... implement ..
+    for (iterator t = begin (); t != end (); ++t) {
+      delete *t;
+    }
   }
 };
 
-void
-TilingProcessorWorker::do_perform (const TilingProcessorTask *tile_task)
+/**
+ *  @brief Creates a region from the cached polygons
+ */
+static db::Region *
+cached_region (const std::vector<db::Polygon> &polygons, bool merged_semantics)
 {
-  tl::Eval eval (&mp_job->processor ()->top_eval ());
-
-  db::Box clip_box_dbu = db::Box::world ();
+  db::Region *region = new db::Region (polygons.begin (), polygons.end ());
+  region->set_merged_semantics (merged_semantics);
+  return region;
+}
 
-  eval.set_var ("_dbu", tl::Variant (mp_job->processor ()->dbu ()));
+/**
+ *  @brief Executes the tasks of one run of the tiling processor
+ *
+ *  The object is shared by all threads executing the tasks. Threads fetch the
+ *  next task with "next_task" and report errors with "log_error". Errors don't
+ *  stop the execution of the other tasks.
+ */
+class TilingProcessorWorker
+{
+public:
+  TilingProcessorWorker (TilingProcessor *proc, bool has_tiles, const std::vector<TilingProcessorTask *> &tasks = std::vector<TilingProcessorTask *> ())
+    : mp_proc (proc), m_has_tiles (has_tiles), m_tasks (tasks), m_next_task (0)
+  {
+    //  .. nothing yet ..
+  }
 
-  if (! mp_job->has_tiles ()) { 
-    eval.set_var ("_tile", tl::Variant ());
-  } else {
+  bool has_tiles () const
+  {
+    return m_has_tiles;
+  }
 
-    clip_box_dbu = db::Box (tile_task->clip_box ().transformed (db::DCplxTrans (mp_job->processor ()->dbu ()).inverted ()));
+  TilingProcessor *processor () const
+  {
+    return mp_proc;
+  }
 
-    db::Region r;
-    r.insert (clip_box_dbu);
-    eval.set_var ("_tile", tl::Variant (r));
+  void next_progress () 
+  {
+    ++m_progress;
+  }
 
+  void update_progress (tl::RelativeProgress &progress) 
+  {
+    progress.set (m_progress.get (), true /*force yield*/);
   }
 
+  const TilingProcessorTask *next_task ()
   {
-    db::Box frame_box_dbu = db::Box (mp_job->processor ()->frame ().transformed (db::DCplxTrans (mp_job->processor ()->dbu ()).inverted ()));
+    QMutexLocker locker (&m_lock);
+    return m_next_task < m_tasks.size () ? m_tasks [m_next_task++] : 0;
+  }
 
-    db::Region r;
-    r.insert (frame_box_dbu);
-    eval.set_var ("_frame", tl::Variant (r));
+  void log_error (const std::string &msg)
+  {
+    QMutexLocker locker (&m_lock);
+    m_error_messages.push_back (msg);
   }
 
-  for (std::vector<TilingProcessor::InputSpec>::const_iterator i = mp_job->processor ()->begin_inputs (); i != mp_job->processor ()->end_inputs (); ++i) {
+  const std::vector<std::string> &error_messages () const
+  {
+    return m_error_messages;
+  }
 
-    double dbu = mp_job->processor ()->dbu ();
-    if (mp_job->processor ()->scale_to_dbu () && i->iter.layout ()) {
-      dbu = i->iter.layout ()->dbu ();
+  void perform (const TilingProcessorTask *tile_task)
+  {
+    TileInputCache *cache = tile_task->cache ();
+    if (cache) {
+      cache->acquire ();
     }
 
-    double sf = dbu / mp_job->processor ()->dbu ();
-
-    if (! mp_job->has_tiles ()) { 
-
-      if (i->region) {
-        eval.set_var (i->name, tl::Variant (db::Region (i->iter, db::ICplxTrans (sf) * i->trans, i->merged_semantics)));
-      } else {
-        eval.set_var (i->name, tl::Variant (db::Edges (i->iter, db::ICplxTrans (sf) * i->trans, i->merged_semantics)));
-      }
-
-    } else {
-
-      db::Box region_dbu = db::Box (tile_task->region ().transformed ((db::DCplxTrans (dbu) * db::DCplxTrans (i->trans)).inverted ()));
-      region_dbu &= i->iter.region ();
-
-      db::RecursiveShapeIterator iter;
-      if (! region_dbu.empty ()) {
-        iter = i->iter;
-        iter.confine_region (region_dbu);
+    try {
+      for (size_t n = 0; n < tile_task->tiles ().size (); ++n) {
+        do_perform (tile_task, tile_task->tiles () [n], n);
       }
-
-      if (i->region) {
-        eval.set_var (i->name, tl::Variant (db::Region (iter, db::ICplxTrans (sf) * i->trans, i->merged_semantics)));
-      } else {
-        eval.set_var (i->name, tl::Variant (db::Edges (iter, db::ICplxTrans (sf) * i->trans, i->merged_semantics)));
+    } catch (...) {
+      if (cache) {
+        cache->release ();
       }
-
+      throw;
     }
 
+    if (cache) {
+      cache->release ();
+    }
   }
 
-  eval.define_function ("_output", new TilingProcessorOutputFunction (mp_job->processor (), tile_task->ix (), tile_task->iy (), clip_box_dbu));
-  eval.define_function ("_rec", new TilingProcessorReceiverFunction (mp_job->processor ()));
-  eval.define_function ("_count", new TilingProcessorCountFunction (mp_job->processor ()));
-
-  if (tl::verbosity () >= (mp_job->has_tiles () ? 20 : 10)) {
-    tl::info << "TilingProcessor: script #" << (tile_task->script_index () + 1) << ", tile " << tile_task->tile_desc ();
-  }
-
-  tl::SelfTimer timer (tl::verbosity () >= (mp_job->has_tiles () ? 21 : 11), "Elapsed time");
+  void perform_all (const tl::TaskGroup *group);
 
-  tl::Expression ex;
-  eval.parse (ex, tile_task->script ());
-  ex.execute ();
+private:
+  TilingProcessor *mp_proc;
+  bool m_has_tiles;
+  tl::ProgressCounter m_progress;
+  std::vector<TilingProcessorTask *> m_tasks;
+  size_t m_next_task;
+  std::vector<std::string> m_error_messages;
+  QMutex m_lock;
 
-  mp_job->next_progress ();
-}
+  void do_perform (const TilingProcessorTask *task, const TilingProcessorTile &tile, size_t slot);
+};
 
-tl::Worker *
-TilingProcessorJob::create_worker ()
+/**
+ *  @brief Executes tasks until all tasks are done or the group is cancelled
+ *
+ *  With a null group, the tasks are executed in the calling thread.
+ */
+void
+TilingProcessorWorker::perform_all (const tl::TaskGroup *group)
+{
+  const TilingProcessorTask *task;
+  while ((! group || ! group->is_cancelled ()) && (task = next_task ()) != 0) {
+    try {
+      perform (task);
+    } catch (tl::Exception &ex) {
+      log_error (ex.msg ());
+    } catch (std::exception &ex) {
+      log_error (ex.what ());
+    } catch (...) {
+      log_error (tl::to_string (QObject::tr ("Unspecific error")));
+    }
+  }
+}
+
+/**
+ *  @brief A task of the thread pool executing tiling processor tasks
+ *
+ *  One such task is submitted per thread. This way, the number of threads
+ *  specified for the tiling processor is respected.
+ */
+class TilingProcessorPoolTask
+  : public tl::PoolTask
+{
+public:
+  TilingProcessorPoolTask (TilingProcessorWorker *worker)
+    : mp_worker (worker)
+  {
+    //  .. nothing yet ..
+  }
+
+  virtual void run ()
+  {
+    mp_worker->perform_all (group ());
+  }
+
+private:
+  TilingProcessorWorker *mp_worker;
+};
+
+/**
+ *  @brief A job executing tiling processor tasks in a single worker thread
+ *
+ *  This job is used inside the worker processes. There, the tasks are executed in
+ *  a separate thread, so they don't report progress through the parent's progress
+ *  adaptor (i.e. the UI) and errors are captured by the job.
+ */
+class TilingProcessorJob
+  : public tl::JobBase
+{
+public:
+  TilingProcessorJob (TilingProcessorWorker *worker)
+    : tl::JobBase (1), mp_worker (worker)
+  {
+    //  .. nothing yet ..
+  }
+
+  TilingProcessorWorker *worker () const
+  {
+    return mp_worker;
+  }
+
+  virtual tl::Worker *create_worker ();
+
+private:
+  TilingProcessorWorker *mp_worker;
+};
+
+class TilingProcessorJobWorker
+  : public tl::Worker
+{
+public:
+  TilingProcessorJobWorker (TilingProcessorJob *job)
+    : tl::Worker (), mp_job (job)
+  {
+    //  .. nothing yet ..
+  }
+
+  void perform_task (tl::Task *task) 
+  {
+    TilingProcessorTask *tile_task = dynamic_cast <TilingProcessorTask *> (task);
+    if (tile_task) {
+      mp_job->worker ()->perform (tile_task);
+    }
+  }
+
+private:
+  TilingProcessorJob *mp_job;
+};
+
+tl::Worker *
+TilingProcessorJob::create_worker ()
+{
+  return new TilingProcessorJobWorker (this);
+}
+
+class TilingProcessorReceiverFunction
+  : public tl::EvalFunction
+{
+public:
+  TilingProcessorReceiverFunction (TilingProcessor *proc)
+    : mp_proc (proc)
+  {
+    //  .. nothing yet ..
+  }
+
+  void execute (const tl::ExpressionParserContext & /*context*/, tl::Variant &out, const std::vector<tl::Variant> &args) const
+  {
+    out = mp_proc->receiver (args);
+  }
+
+private:
+  TilingProcessor *mp_proc;
+};
+
+class TilingProcessorOutputFunction
+  : public tl::EvalFunction
+{
+public:
+  TilingProcessorOutputFunction (TilingProcessor *proc, size_t ix, size_t iy, const db::Box &tile_box)
+    : mp_proc (proc), m_ix (ix), m_iy (iy), m_tile_box (tile_box)
+  {
+    //  .. nothing yet ..
+  }
+
+  void execute (const tl::ExpressionParserContext & /*context*/, tl::Variant & /*out*/, const std::vector<tl::Variant> &args) const 
+  {
+    mp_proc->put (m_ix, m_iy, m_tile_box, args);
+  }
+
+private:
+  TilingProcessor *mp_proc;
+  size_t m_ix, m_iy;
+  db::Box m_tile_box; 
+};
+
+class TilingProcessorCountFunction
+  : public tl::EvalFunction
+{
+public:
+  TilingProcessorCountFunction (TilingProcessor * /*proc*/)
+  {
+    //  .. nothing yet ..
+  }
+
+  void execute (const tl::ExpressionParserContext & /*context*/, tl::Variant & /*out*/, const std::vector<tl::Variant> & /*args*/) const 
+  {
+    // TODO: ... implement ..
+  }
+};
+
+void
+TilingProcessorWorker::do_perform (const TilingProcessorTask *tile_task, const TilingProcessorTile &tile, size_t slot)
+{
+  tl::ProfileZone zone ("TilingProcessor::tile");
+
+  TilingProcessor *proc = mp_proc;
+
+  db::Box clip_box_dbu = db::Box::world ();
+  if (m_has_tiles) {
+    clip_box_dbu = db::Box (tile.clip_box.transformed (db::DCplxTrans (proc->dbu ()).inverted ()));
+  }
+
+  if (tl::verbosity () >= (m_has_tiles ? 20 : 10)) {
+    tl::info << "TilingProcessor: " << (tile_task->op () ? "operation" : "script") << " #" << (tile_task->script_index () + 1) << ", tile " << tile.tile_desc;
+  }
+
+  tl::SelfTimer timer (tl::verbosity () >= (m_has_tiles ? 21 : 11), "Elapsed time");
+
+  if (tile_task->op ()) {
+
+    TileContext context (proc, tile.ix, tile.iy, m_has_tiles, clip_box_dbu, tile.region, tile_task->cache (), slot);
+    tile_task->op ()->process (context);
+
+    next_progress ();
+    return;
+
+  }
+
+  tl::Eval eval (&proc->top_eval ());
+
+  eval.set_var ("_dbu", tl::Variant (proc->dbu ()));
+
+  if (! m_has_tiles) { 
+    eval.set_var ("_tile", tl::Variant ());
+  } else {
+    db::Region r;
+    r.insert (clip_box_dbu);
+    eval.set_var ("_tile", tl::Variant (r));
+  }
+
+  {
+    db::Box frame_box_dbu = db::Box (proc->frame ().transformed (db::DCplxTrans (proc->dbu ()).inverted ()));
+
+    db::Region r;
+    r.insert (frame_box_dbu);
+    eval.set_var ("_frame", tl::Variant (r));
+  }
+
+  size_t index = 0;
+  for (std::vector<TilingProcessor::InputSpec>::const_iterator i = proc->begin_inputs (); i != proc->end_inputs (); ++i, ++index) {
+
+    const std::vector<db::Polygon> *cached = tile_task->cache () ? tile_task->cache ()->polygons (index, slot) : 0;
+    if (i->region && cached) {
+      std::auto_ptr<db::Region> r (cached_region (*cached, i->merged_semantics));
+      eval.set_var (i->name, tl::Variant (*r));
+      continue;
+    }
+
+    db::ICplxTrans trans;
+    db::RecursiveShapeIterator iter = proc->input_iter (index, m_has_tiles, tile.region, trans);
+
+    if (i->region) {
+      eval.set_var (i->name, tl::Variant (db::Region (iter, trans, i->merged_semantics)));
+    } else {
+      eval.set_var (i->name, tl::Variant (db::Edges (iter, trans, i->merged_semantics)));
+    }
+
+  }
+
+  eval.define_function ("_output", new TilingProcessorOutputFunction (proc, tile.ix, tile.iy, clip_box_dbu));
+  eval.define_function ("_rec", new TilingProcessorReceiverFunction (proc));
+  eval.define_function ("_count", new TilingProcessorCountFunction (proc));
+
+  tl::Expression ex;
+  eval.parse (ex, tile_task->script ());
+  ex.execute ();
+
+  next_progress ();
+}
+
+// ----------------------------------------------------------------------------------
+//  TileContext implementation
+
+TileContext::TileContext (TilingProcessor *proc, size_t ix, size_t iy, bool has_tiles, const db::Box &tile, const db::DBox &region, const TileInputCache *cache, size_t cache_slot)
+  : mp_proc (proc), m_ix (ix), m_iy (iy), m_has_tiles (has_tiles), m_tile (tile), m_region (region), mp_cache (cache), m_cache_slot (cache_slot)
+{
+  m_regions.resize (proc->inputs (), (db::Region *) 0);
+  m_edges.resize (proc->inputs (), (db::Edges *) 0);
+}
+
+TileContext::~TileContext ()
 {
-  return new TilingProcessorWorker (this);
+  for (std::vector<db::Region *>::const_iterator r = m_regions.begin (); r != m_regions.end (); ++r) {
+    delete *r;
+  }
+  for (std::vector<db::Edges *>::const_iterator e = m_edges.begin (); e != m_edges.end (); ++e) {
+    delete *e;
+  }
+}
+
+double
+TileContext::dbu () const
+{
+  return mp_proc->dbu ();
+}
+
+size_t
+TileContext::inputs () const
+{
+  return mp_proc->inputs ();
+}
+
+const db::Region &
+TileContext::region (size_t index)
+{
+  tl_assert (index < m_regions.size ());
+
+  const std::vector<db::Polygon> *cached = mp_cache ? mp_cache->polygons (index, m_cache_slot) : 0;
+  if (! m_regions [index] && cached) {
+    m_regions [index] = cached_region (*cached, mp_proc->m_inputs [index].merged_semantics);
+  } else if (! m_regions [index]) {
+    db::ICplxTrans trans;
+    db::RecursiveShapeIterator iter = mp_proc->input_iter (index, m_has_tiles, m_region, trans);
+    m_regions [index] = new db::Region (iter, trans, mp_proc->m_inputs [index].merged_semantics);
+  }
+
+  return *m_regions [index];
+}
+
+const db::Edges &
+TileContext::edges (size_t index)
+{
+  tl_assert (index < m_edges.size ());
+
+  if (! m_edges [index]) {
+    db::ICplxTrans trans;
+    db::RecursiveShapeIterator iter = mp_proc->input_iter (index, m_has_tiles, m_region, trans);
+    m_edges [index] = new db::Edges (iter, trans, mp_proc->m_inputs [index].merged_semantics);
+  }
+
+  return *m_edges [index];
+}
+
+void
+TileContext::output (size_t index, const db::Region &region, bool clip)
+{
+  mp_proc->put (m_ix, m_iy, m_tile, index, tl::Variant::make_variant_ref (&region), clip);
+}
+
+void
+TileContext::output (size_t index, const db::Edges &edges, bool clip)
+{
+  mp_proc->put (m_ix, m_iy, m_tile, index, tl::Variant::make_variant_ref (&edges), clip);
+}
+
+void
+TileContext::output (size_t index, const db::EdgePairs &edge_pairs, bool clip)
+{
+  mp_proc->put (m_ix, m_iy, m_tile, index, tl::Variant::make_variant_ref (&edge_pairs), clip);
 }
 
+// ----------------------------------------------------------------------------------
+//  Multi-process execution
+
+/**
+ *  @brief The record types of the result stream
+ */
+enum TilingProcessorRecordType
+{
+  RecordOutput = 1,
+  RecordTaskDone = 2,
+  RecordError = 3
+};
+
+/**
+ *  @brief The object types of the result stream
+ */
+enum TilingProcessorObjectType
+{
+  ObjectNil = 0,
+  ObjectRegion = 1,
+  ObjectEdges = 2,
+  ObjectEdgePairs = 3,
+  ObjectPolygon = 4,
+  ObjectBox = 5,
+  ObjectEdge = 6,
+  ObjectEdgePair = 7,
+  ObjectDouble = 8,
+  ObjectLong = 9,
+  ObjectULong = 10,
+  ObjectBool = 11,
+  ObjectString = 12
+};
+
+/**
+ *  @brief Serializes the output of a worker process
+ *
+ *  The writer collects the records in a buffer. The data is written in the
+ *  native representation since the parent and the worker processes run the same 
+ *  binary.
+ */
+class TilingProcessorResultWriter
+{
+public:
+  TilingProcessorResultWriter ()
+  {
+    //  .. nothing yet ..
+  }
+
+  void put (size_t ix, size_t iy, const db::Box &tile, size_t index, const tl::Variant &obj, bool clip)
+  {
+    size_t pos = m_buffer.size ();
+
+    try {
+      write<unsigned char> (RecordOutput);
+      write<uint64_t> (ix);
+      write<uint64_t> (iy);
+      write (tile);
+      write<uint64_t> (index);
+      write<unsigned char> (clip ? 1 : 0);
+      write (obj);
+    } catch (...) {
+      //  drop the incomplete record
+      m_buffer.resize (pos);
+      throw;
+    }
+  }
+
+  void task_done ()
+  {
+    write<unsigned char> (RecordTaskDone);
+  }
+
+  void error (const std::string &msg)
+  {
+    write<unsigned char> (RecordError);
+    write (msg);
+  }
+
+  const std::vector<char> &buffer () const
+  {
+    return m_buffer;
+  }
+
+  void clear ()
+  {
+    m_buffer.clear ();
+  }
+
+private:
+  std::vector<char> m_buffer;
+
+  template <class T>
+  void write (const T &t)
+  {
+    const char *cp = reinterpret_cast<const char *> (&t);
+    m_buffer.insert (m_buffer.end (), cp, cp + sizeof (T));
+  }
+
+  void write (const std::string &s)
+  {
+    write<uint64_t> (s.size ());
+    m_buffer.insert (m_buffer.end (), s.begin (), s.end ());
+  }
+
+  void write (const db::Box &box)
+  {
+    write (box.left ());
+    write (box.bottom ());
+    write (box.right ());
+    write (box.top ());
+  }
+
+  void write (const db::Edge &edge)
+  {
+    write (edge.x1 ());
+    write (edge.y1 ());
+    write (edge.x2 ());
+    write (edge.y2 ());
+  }
+
+  void write (const db::EdgePair &ep)
+  {
+    write (ep.first ());
+    write (ep.second ());
+  }
+
+  template <class Iter>
+  void write_contour (Iter from, Iter to)
+  {
+    write<uint64_t> (std::distance (from, to));
+    for (Iter p = from; p != to; ++p) {
+      write ((*p).x ());
+      write ((*p).y ());
+    }
+  }
+
+  void write (const db::Polygon &poly)
+  {
+    write<uint32_t> (poly.holes ());
+    write_contour (poly.begin_hull (), poly.end_hull ());
+    for (unsigned int h = 0; h < poly.holes (); ++h) {
+      write_contour (poly.begin_hole (h), poly.end_hole (h));
+    }
+  }
+
+  void write (const tl::Variant &obj)
+  {
+    if (obj.is_nil ()) {
+      write<unsigned char> (ObjectNil);
+    } else if (obj.is_user<db::Region> ()) {
+      const db::Region &region = obj.to_user<db::Region> ();
+      write<unsigned char> (ObjectRegion);
+      write<uint64_t> (region.size ());
+      for (db::Region::const_iterator p = region.begin (); ! p.at_end (); ++p) {
+        write (*p);
+      }
+    } else if (obj.is_user<db::Edges> ()) {
+      const db::Edges &edges = obj.to_user<db::Edges> ();
+      write<unsigned char> (ObjectEdges);
+      write<uint64_t> (edges.size ());
+      for (db::Edges::const_iterator e = edges.begin (); ! e.at_end (); ++e) {
+        write (*e);
+      }
+    } else if (obj.is_user<db::EdgePairs> ()) {
+      const db::EdgePairs &edge_pairs = obj.to_user<db::EdgePairs> ();
+      write<unsigned char> (ObjectEdgePairs);
+      write<uint64_t> (edge_pairs.size ());
+      for (db::EdgePairs::const_iterator e = edge_pairs.begin (); e != edge_pairs.end (); ++e) {
+        write (*e);
+      }
+    } else if (obj.is_user<db::Polygon> ()) {
+      write<unsigned char> (ObjectPolygon);
+      write (obj.to_user<db::Polygon> ());
+    } else if (obj.is_user<db::SimplePolygon> ()) {
+      const db::SimplePolygon &sp = obj.to_user<db::SimplePolygon> ();
+      db::Polygon poly;
+      poly.assign_hull (sp.begin_hull (), sp.end_hull ());
+      write<unsigned char> (ObjectPolygon);
+      write (poly);
+    } else if (obj.is_user<db::Box> ()) {
+      write<unsigned char> (ObjectBox);
+      write (obj.to_user<db::Box> ());
+    } else if (obj.is_user<db::Edge> ()) {
+      write<unsigned char> (ObjectEdge);
+      write (obj.to_user<db::Edge> ());
+    } else if (obj.is_user<db::EdgePair> ()) {
+      write<unsigned char> (ObjectEdgePair);
+      write (obj.to_user<db::EdgePair> ());
+    } else if (obj.is_double ()) {
+      write<unsigned char> (ObjectDouble);
+      write<double> (obj.to_double ());
+    } else if (obj.is_bool ()) {
+      write<unsigned char> (ObjectBool);
+      write<unsigned char> (obj.to_bool () ? 1 : 0);
+    } else if (obj.is_long () || obj.is_longlong () || obj.is_char ()) {
+      write<unsigned char> (ObjectLong);
+      write<long long> (obj.to_longlong ());
+    } else if (obj.is_ulong () || obj.is_ulonglong ()) {
+      write<unsigned char> (ObjectULong);
+      write<unsigned long long> (obj.to_ulonglong ());
+    } else if (obj.is_a_string ()) {
+      write<unsigned char> (ObjectString);
+      write (std::string (obj.to_string ()));
+    } else {
+      throw tl::Exception (tl::to_string (QObject::tr ("This type of output is not supported in multi-process mode: %s")), obj.to_parsable_string ());
+    }
+  }
+};
+
+#if !defined(_WIN32)
+
+/**
+ *  @brief Ignores SIGPIPE while the object is alive
+ */
+class SigPipeBlocker
+{
+public:
+  SigPipeBlocker ()
+  {
+    m_handler = signal (SIGPIPE, SIG_IGN);
+  }
+
+  ~SigPipeBlocker ()
+  {
+    signal (SIGPIPE, m_handler);
+  }
+
+private:
+  void (*m_handler) (int);
+};
+
+/**
+ *  @brief Executes the tiling processor's tasks in forked worker processes
+ *
+ *  The parent hands out the tasks one by one through a command pipe per worker. 
+ *  The workers send back the output through a result pipe per worker and report
+ *  the completion of every task. Only the parent talks to the receivers.
+ */
+class TilingProcessorProcesses
+{
+public:
+  TilingProcessorProcesses (TilingProcessor *proc, TilingProcessorWorker *worker, const std::vector<TilingProcessorTask *> &tasks)
+    : mp_proc (proc), mp_worker (worker), m_tasks (tasks), m_next_task (0)
+  {
+    //  .. nothing yet ..
+  }
+
+  ~TilingProcessorProcesses ()
+  {
+    terminate ();
+  }
+
+  void run (size_t nprocesses, tl::RelativeProgress &progress);
+
+  const std::vector<std::string> &error_messages () const
+  {
+    return m_error_messages;
+  }
+
+private:
+  struct Child
+  {
+    Child () : pid (-1), cmd_fd (-1), res_fd (-1), busy (false) { }
+    pid_t pid;
+    int cmd_fd, res_fd;
+    bool busy;
+  };
+
+  TilingProcessor *mp_proc;
+  TilingProcessorWorker *mp_worker;
+  const std::vector<TilingProcessorTask *> &m_tasks;
+  size_t m_next_task;
+  std::vector<Child> m_children;
+  std::vector<std::string> m_error_messages;
+
+  void child_main (int cmd_fd, int res_fd);
+  void send_next (Child &child);
+  void receive (Child &child);
+  void terminate ();
+
+  static void write_all (int fd, const char *data, size_t n);
+  static void read_all (int fd, char *data, size_t n);
+
+  template <class T>
+  static T read (int fd)
+  {
+    T t;
+    read_all (fd, reinterpret_cast<char *> (&t), sizeof (T));
+    return t;
+  }
+
+  static std::string read_string (int fd);
+  static db::Box read_box (int fd);
+  static db::Edge read_edge (int fd);
+  static db::Polygon read_polygon (int fd);
+  static tl::Variant read_object (int fd);
+};
+
+void
+TilingProcessorProcesses::write_all (int fd, const char *data, size_t n)
+{
+  while (n > 0) {
+    ssize_t w = ::write (fd, data, n);
+    if (w < 0 && errno == EINTR) {
+      continue;
+    } else if (w <= 0) {
+      throw tl::Exception (tl::to_string (QObject::tr ("Communication with worker process failed: %s")), strerror (errno));
+    }
+    data += w;
+    n -= size_t (w);
+  }
+}
+
+void
+TilingProcessorProcesses::read_all (int fd, char *data, size_t n)
+{
+  while (n > 0) {
+    ssize_t r = ::read (fd, data, n);
+    if (r < 0 && errno == EINTR) {
+      continue;
+    } else if (r == 0) {
+      throw tl::Exception (tl::to_string (QObject::tr ("Worker process terminated unexpectedly")));
+    } else if (r < 0) {
+      throw tl::Exception (tl::to_string (QObject::tr ("Communication with worker process failed: %s")), strerror (errno));
+    }
+    data += r;
+    n -= size_t (r);
+  }
+}
+
+std::string
+TilingProcessorProcesses::read_string (int fd)
+{
+  std::string s;
+  s.resize (size_t (read<uint64_t> (fd)));
+  if (! s.empty ()) {
+    read_all (fd, &s [0], s.size ());
+  }
+  return s;
+}
+
+db::Box
+TilingProcessorProcesses::read_box (int fd)
+{
+  db::Coord l = read<db::Coord> (fd);
+  db::Coord b = read<db::Coord> (fd);
+  db::Coord r = read<db::Coord> (fd);
+  db::Coord t = read<db::Coord> (fd);
+  //  NOTE: don't use the box constructor which normalizes - an empty box must stay empty
+  db::Box box;
+  if (l <= r && b <= t) {
+    box = db::Box (l, b, r, t);
+  }
+  return box;
+}
+
+db::Edge
+TilingProcessorProcesses::read_edge (int fd)
+{
+  db::Coord x1 = read<db::Coord> (fd);
+  db::Coord y1 = read<db::Coord> (fd);
+  db::Coord x2 = read<db::Coord> (fd);
+  db::Coord y2 = read<db::Coord> (fd);
+  return db::Edge (x1, y1, x2, y2);
+}
+
+db::Polygon
+TilingProcessorProcesses::read_polygon (int fd)
+{
+  db::Polygon poly;
+
+  uint32_t holes = read<uint32_t> (fd);
+
+  std::vector<db::Point> pts;
+  for (uint32_t c = 0; c <= holes; ++c) {
+
+    pts.clear ();
+    uint64_t n = read<uint64_t> (fd);
+    pts.reserve (size_t (n));
+    for (uint64_t i = 0; i < n; ++i) {
+      db::Coord x = read<db::Coord> (fd);
+      db::Coord y = read<db::Coord> (fd);
+      pts.push_back (db::Point (x, y));
+    }
+
+    if (c == 0) {
+      poly.assign_hull (pts.begin (), pts.end (), false /*don't compress*/);
+    } else {
+      poly.insert_hole (pts.begin (), pts.end (), false /*don't compress*/);
+    }
+
+  }
+
+  return poly;
+}
+
+tl::Variant
+TilingProcessorProcesses::read_object (int fd)
+{
+  unsigned char type = read<unsigned char> (fd);
+
+  if (type == ObjectNil) {
+    return tl::Variant ();
+  } else if (type == ObjectRegion) {
+    db::Region region;
+    for (uint64_t n = read<uint64_t> (fd); n > 0; --n) {
+      region.insert (read_polygon (fd));
+    }
+    return tl::Variant (region);
+  } else if (type == ObjectEdges) {
+    db::Edges edges;
+    for (uint64_t n = read<uint64_t> (fd); n > 0; --n) {
+      edges.insert (read_edge (fd));
+    }
+    return tl::Variant (edges);
+  } else if (type == ObjectEdgePairs) {
+    db::EdgePairs edge_pairs;
+    for (uint64_t n = read<uint64_t> (fd); n > 0; --n) {
+      db::Edge e1 = read_edge (fd);
+      db::Edge e2 = read_edge (fd);
+      edge_pairs.insert (e1, e2);
+    }
+    return tl::Variant (edge_pairs);
+  } else if (type == ObjectPolygon) {
+    return tl::Variant (read_polygon (fd));
+  } else if (type == ObjectBox) {
+    return tl::Variant (read_box (fd));
+  } else if (type == ObjectEdge) {
+    return tl::Variant (read_edge (fd));
+  } else if (type == ObjectEdgePair) {
+    db::Edge e1 = read_edge (fd);
+    db::Edge e2 = read_edge (fd);
+    return tl::Variant (db::EdgePair (e1, e2));
+  } else if (type == ObjectDouble) {
+    return tl::Variant (read<double> (fd));
+  } else if (type == ObjectLong) {
+    return tl::Variant (read<long long> (fd));
+  } else if (type == ObjectULong) {
+    return tl::Variant (read<unsigned long long> (fd));
+  } else if (type == ObjectBool) {
+    return tl::Variant (read<unsigned char> (fd) != 0);
+  } else if (type == ObjectString) {
+    return tl::Variant (read_string (fd));
+  } else {
+    throw tl::Exception (tl::to_string (QObject::tr ("Invalid object type %d received from worker process")), int (type));
+  }
+}
+
+void
+TilingProcessorProcesses::child_main (int cmd_fd, int res_fd)
+{
+  TilingProcessorResultWriter writer;
+  mp_proc->mp_result_writer = &writer;
+
+  //  NOTE: the tasks are executed in a worker thread of the child process. This way they
+  //  don't report progress through the parent's progress adaptor (i.e. the UI) and errors 
+  //  are captured by the job.
+  TilingProcessorWorker worker (mp_proc, mp_worker->has_tiles ());
+  TilingProcessorJob job (&worker);
+
+  while (true) {
+
+    uint64_t index = read<uint64_t> (cmd_fd);
+    if (index >= m_tasks.size ()) {
+      break;
+    }
+
+    job.schedule (m_tasks [index]->clone ());
+    job.start ();
+    while (job.is_running ()) {
+      job.wait (100);
+    }
+
+    if (job.has_error ()) {
+      std::vector<std::string> errors = job.error_messages ();
+      for (std::vector<std::string>::const_iterator e = errors.begin (); e != errors.end (); ++e) {
+        writer.error (*e);
+      }
+    }
+
+    writer.task_done ();
+
+    write_all (res_fd, &writer.buffer ().front (), writer.buffer ().size ());
+    writer.clear ();
+
+  }
+}
+
+void
+TilingProcessorProcesses::send_next (Child &child)
+{
+  uint64_t index = uint64_t (m_next_task < m_tasks.size () ? m_next_task++ : m_tasks.size ());
+  child.busy = (index < m_tasks.size ());
+  write_all (child.cmd_fd, reinterpret_cast<const char *> (&index), sizeof (index));
+}
+
+void
+TilingProcessorProcesses::receive (Child &child)
+{
+  while (true) {
+
+    unsigned char record = read<unsigned char> (child.res_fd);
+
+    if (record == RecordTaskDone) {
+
+      mp_worker->next_progress ();
+      send_next (child);
+      return;
+
+    } else if (record == RecordError) {
+
+      m_error_messages.push_back (read_string (child.res_fd));
+
+    } else if (record == RecordOutput) {
+
+      size_t ix = size_t (read<uint64_t> (child.res_fd));
+      size_t iy = size_t (read<uint64_t> (child.res_fd));
+      db::Box tile = read_box (child.res_fd);
+      size_t index = size_t (read<uint64_t> (child.res_fd));
+      bool clip = read<unsigned char> (child.res_fd) != 0;
+      tl::Variant obj = read_object (child.res_fd);
+
+      mp_proc->put (ix, iy, tile, index, obj, clip);
+
+    } else {
+      throw tl::Exception (tl::to_string (QObject::tr ("Invalid record type %d received from worker process")), int (record));
+    }
+
+  }
+}
+
+void
+TilingProcessorProcesses::run (size_t nprocesses, tl::RelativeProgress &progress)
+{
+  nprocesses = std::min (nprocesses, m_tasks.size ());
+
+  //  Flush the output streams, so the children don't inherit pending output
+  fflush (stdout);
+  fflush (stderr);
+
+  //  A worker process terminating unexpectedly must not kill the parent
+  //  when it sends the next task
+  SigPipeBlocker sigpipe_blocker;
+
+  for (size_t i = 0; i < nprocesses; ++i) {
+
+    int cmd_pipe [2], res_pipe [2];
+    if (pipe (cmd_pipe) != 0) {
+      throw tl::Exception (tl::to_string (QObject::tr ("Unable to create pipe for worker process: %s")), strerror (errno));
+    }
+    if (pipe (res_pipe) != 0) {
+      close (cmd_pipe [0]);
+      close (cmd_pipe [1]);
+      throw tl::Exception (tl::to_string (QObject::tr ("Unable to create pipe for worker process: %s")), strerror (errno));
+    }
+
+    pid_t pid = fork ();
+    if (pid < 0) {
+      close (cmd_pipe [0]);
+      close (cmd_pipe [1]);
+      close (res_pipe [0]);
+      close (res_pipe [1]);
+      throw tl::Exception (tl::to_string (QObject::tr ("Unable to create worker process: %s")), strerror (errno));
+    }
+
+    if (pid == 0) {
+
+      //  worker process: close the parent's ends of the pipes including those of the
+      //  previously created children
+      close (cmd_pipe [1]);
+      close (res_pipe [0]);
+      for (std::vector<Child>::const_iterator c = m_children.begin (); c != m_children.end (); ++c) {
+        close (c->cmd_fd);
+        close (c->res_fd);
+      }
+
+      int status = 0;
+      try {
+        child_main (cmd_pipe [0], res_pipe [1]);
+      } catch (...) {
+        status = 1;
+      }
+
+      //  NOTE: _exit skips the static destructors and atexit handlers which belong to the parent
+      _exit (status);
+
+    }
+
+    close (cmd_pipe [0]);
+    close (res_pipe [1]);
+
+    m_children.push_back (Child ());
+    m_children.back ().pid = pid;
+    m_children.back ().cmd_fd = cmd_pipe [1];
+    m_children.back ().res_fd = res_pipe [0];
+
+  }
+
+  for (std::vector<Child>::iterator c = m_children.begin (); c != m_children.end (); ++c) {
+    send_next (*c);
+  }
+
+  std::vector<pollfd> fds;
+
+  while (true) {
+
+    fds.clear ();
+    for (std::vector<Child>::const_iterator c = m_children.begin (); c != m_children.end (); ++c) {
+      if (c->busy) {
+        pollfd pfd;
+        pfd.fd = c->res_fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        fds.push_back (pfd);
+      }
+    }
+
+    if (fds.empty ()) {
+      break;
+    }
+
+    int n = poll (&fds.front (), fds.size (), 100);
+    if (n < 0 && errno != EINTR) {
+      throw tl::Exception (tl::to_string (QObject::tr ("Communication with worker process failed: %s")), strerror (errno));
+    }
+
+    if (n > 0) {
+      for (std::vector<pollfd>::const_iterator f = fds.begin (); f != fds.end (); ++f) {
+        if (f->revents != 0) {
+          for (std::vector<Child>::iterator c = m_children.begin (); c != m_children.end (); ++c) {
+            if (c->res_fd == f->fd) {
+              receive (*c);
+              break;
+            }
+          }
+        }
+      }
+    }
+
+    //  This may throw an exception, if the cancel button has been pressed.
+    mp_worker->update_progress (progress);
+
+  }
+
+  //  all children have received the termination request by now
+  terminate ();
+}
+
+void
+TilingProcessorProcesses::terminate ()
+{
+  for (std::vector<Child>::iterator c = m_children.begin (); c != m_children.end (); ++c) {
+    if (c->busy) {
+      kill (c->pid, SIGTERM);
+    }
+    close (c->cmd_fd);
+    close (c->res_fd);
+    int status = 0;
+    waitpid (c->pid, &status, 0);
+  }
+  m_children.clear ();
+}
+
+#endif
+
 // ----------------------------------------------------------------------------------
 //  The tiling processor implementation
 
@@ -552,7 +1688,8 @@ TilingProcessor::TilingProcessor ()
     m_tile_origin_given (false),
     m_tile_bx (0.0), m_tile_by (0.0),
     m_threads (0), m_dbu (0.001), m_dbu_specific (0.001), m_dbu_specific_set (false),
-    m_scale_to_dbu (true)
+    m_scale_to_dbu (true), m_adaptive (false), m_cache_inputs (false),
+    m_processes (0), mp_result_writer (0)
 {
   //  .. nothing yet ..
 }
@@ -574,6 +1711,11 @@ TilingProcessor::input (const std::string &name, const db::RecursiveShapeIterato
 TilingProcessor::~TilingProcessor ()
 {
   m_outputs.clear ();
+
+  for (std::vector<TileOperation *>::const_iterator o = m_operations.begin (); o != m_operations.end (); ++o) {
+    delete *o;
+  }
+  m_operations.clear ();
 }
 
 void
@@ -625,6 +1767,14 @@ TilingProcessor::queue (const std::string &script)
   m_scripts.push_back (script);
 }
 
+void  
+TilingProcessor::queue (TileOperation *op)
+{
+  if (op) {
+    m_operations.push_back (op);
+  }
+}
+
 void  
 TilingProcessor::var (const std::string &name, const tl::Variant &value)
 {
@@ -678,6 +1828,16 @@ TilingProcessor::output (const std::string &name, db::Layout &layout, db::cell_i
   m_outputs.back ().receiver = new TileLayoutOutputReceiver (&layout, &layout.cell (cell_index), layer, ep_ext);
 }
 
+void   
+TilingProcessor::output (const std::string &name, db::StreamingWriter &writer, db::cell_index_type cell_index, const db::LayerProperties &lp, db::Coord ep_ext)
+{
+  m_top_eval.set_var (name, m_outputs.size ());
+  m_outputs.push_back (OutputSpec ());
+  m_outputs.back ().name = name;
+  m_outputs.back ().id = 0;
+  m_outputs.back ().receiver = new TileStreamingWriterOutputReceiver (&writer, cell_index, writer.add_layer (lp), ep_ext);
+}
+
 void 
 TilingProcessor::output (const std::string &name, db::Region &region, db::Coord ep_ext)
 {
@@ -733,8 +1893,6 @@ TilingProcessor::receiver (const std::vector<tl::Variant> &args)
 void 
 TilingProcessor::put (size_t ix, size_t iy, const db::Box &tile, const std::vector<tl::Variant> &args)
 {
-  QMutexLocker locker (&m_output_mutex);
-
   if (args.size () < 2 || args.size () > 3) {
     throw tl::Exception (tl::to_string (QObject::tr ("_output function requires two or three arguments: handle and object and a clip flag (optional)")));
   }
@@ -746,12 +1904,366 @@ TilingProcessor::put (size_t ix, size_t iy, const db::Box &tile, const std::vect
     throw tl::Exception (tl::to_string (QObject::tr ("Invalid handle (first argument) in _output function call")));
   }
 
-  m_outputs[index].receiver->put (ix, iy, tile, m_outputs[index].id, args[1], dbu (), m_outputs[index].trans, clip);
+  put (ix, iy, tile, index, args[1], clip);
+}
+
+void 
+TilingProcessor::put (size_t ix, size_t iy, const db::Box &tile, size_t index, const tl::Variant &obj, bool clip)
+{
+  QMutexLocker locker (&m_output_mutex);
+
+  if (index >= m_outputs.size ()) {
+    throw tl::Exception (tl::to_string (QObject::tr ("Invalid output index %d in tile operation")), int (index));
+  }
+
+  //  in a worker process, the output is sent to the parent
+  if (mp_result_writer) {
+    mp_result_writer->put (ix, iy, tile, index, obj, clip);
+    return;
+  }
+
+  m_outputs[index].receiver->put (ix, iy, tile, m_outputs[index].id, obj, dbu (), m_outputs[index].trans, clip && ! tile.empty ());
+}
+
+db::RecursiveShapeIterator
+TilingProcessor::input_iter (size_t index, bool has_tiles, const db::DBox &region, db::ICplxTrans &trans) const
+{
+  const InputSpec &i = m_inputs [index];
+
+  double input_dbu = dbu ();
+  if (scale_to_dbu () && i.iter.layout ()) {
+    input_dbu = i.iter.layout ()->dbu ();
+  }
+
+  trans = db::ICplxTrans (input_dbu / dbu ()) * i.trans;
+
+  if (! has_tiles) {
+    return i.iter;
+  }
+
+  db::Box region_dbu = input_region (index, region);
+
+  db::RecursiveShapeIterator iter;
+  if (! region_dbu.empty ()) {
+    iter = i.iter;
+    iter.confine_region (region_dbu);
+  }
+
+  return iter;
+}
+
+db::Box
+TilingProcessor::input_region (size_t index, const db::DBox &region) const
+{
+  const InputSpec &i = m_inputs [index];
+
+  double input_dbu = dbu ();
+  if (scale_to_dbu () && i.iter.layout ()) {
+    input_dbu = i.iter.layout ()->dbu ();
+  }
+
+  db::Box region_dbu = db::Box (region.transformed ((db::DCplxTrans (input_dbu) * db::DCplxTrans (i.trans)).inverted ()));
+  region_dbu &= i.iter.region ();
+  return region_dbu;
+}
+
+namespace
+{
+
+/**
+ *  @brief A helper computing the tile costs for a hierarchical input
+ *
+ *  The shape counts are computed per cell and cell subtree. Subtrees and arrays
+ *  falling entirely into a single tile are not expanded but contribute with the 
+ *  precomputed count weighted by the number of placements. Hence only the parts
+ *  of the hierarchy crossing tile boundaries need to be looked at in detail.
+ */
+class HierarchicalCostEstimator
+{
+public:
+  HierarchicalCostEstimator (const db::RecursiveShapeIterator &iter, const db::CplxTrans &t, const db::DPoint &origin, double cw, double ch, size_t nx, size_t ny, std::vector<size_t> &costs)
+    : mp_layout (iter.layout ()), m_t (t), m_origin (origin), m_cw (cw), m_ch (ch), m_nx (nx), m_ny (ny), mp_costs (&costs)
+  {
+    if (iter.multiple_layers ()) {
+      m_layers = iter.layers ();
+      m_box_convert = db::box_convert<db::CellInst> (*mp_layout);
+    } else {
+      m_layers.push_back (iter.layer ());
+      m_box_convert = db::box_convert<db::CellInst> (*mp_layout, iter.layer ());
+    }
+
+    m_counts.resize (mp_layout->cells (), std::numeric_limits<size_t>::max ());
+  }
+
+  void add (db::cell_index_type ci, const db::ICplxTrans &trans, const db::Box &region)
+  {
+    const db::Cell &cell = mp_layout->cell (ci);
+
+    db::Box box = cell_bbox (cell);
+    if (box.empty () || ! box.transformed (trans).touches (region)) {
+      return;
+    }
+
+    size_t index = 0;
+    if (single_tile (box.transformed (trans), index)) {
+      (*mp_costs) [index] += subtree_count (ci);
+      return;
+    }
+
+    for (std::vector<unsigned int>::const_iterator l = m_layers.begin (); l != m_layers.end (); ++l) {
+      for (db::ShapeIterator s = cell.shapes (*l).begin (db::ShapeIterator::All); ! s.at_end (); ++s) {
+        (*mp_costs) [tile_of (trans * s->bbox ().center ())] += 1;
+      }
+    }
+
+    for (db::Cell::const_iterator i = cell.begin (); ! i.at_end (); ++i) {
+
+      db::Box array_box = i->cell_inst ().bbox (m_box_convert);
+      if (array_box.empty () || ! array_box.transformed (trans).touches (region)) {
+        continue;
+      }
+
+      if (single_tile (array_box.transformed (trans), index)) {
+        (*mp_costs) [index] += subtree_count (i->cell_index ()) * i->cell_inst ().size ();
+        continue;
+      }
+
+      for (db::CellInstArray::iterator a = i->cell_inst ().begin (); ! a.at_end (); ++a) {
+        add (i->cell_index (), trans * i->complex_trans (*a), region);
+      }
+
+    }
+  }
+
+private:
+  const db::Layout *mp_layout;
+  std::vector<unsigned int> m_layers;
+  db::box_convert<db::CellInst> m_box_convert;
+  db::CplxTrans m_t;
+  db::DPoint m_origin;
+  double m_cw, m_ch;
+  size_t m_nx, m_ny;
+  std::vector<size_t> *mp_costs;
+  std::vector<size_t> m_counts;
+
+  db::Box cell_bbox (const db::Cell &cell) const
+  {
+    if (m_layers.size () == 1) {
+      return cell.bbox (m_layers.front ());
+    }
+
+    db::Box box;
+    for (std::vector<unsigned int>::const_iterator l = m_layers.begin (); l != m_layers.end (); ++l) {
+      box += cell.bbox (*l);
+    }
+    return box;
+  }
+
+  size_t subtree_count (db::cell_index_type ci)
+  {
+    if (m_counts [ci] == std::numeric_limits<size_t>::max ()) {
+
+      const db::Cell &cell = mp_layout->cell (ci);
+
+      size_t c = 0;
+      for (std::vector<unsigned int>::const_iterator l = m_layers.begin (); l != m_layers.end (); ++l) {
+        c += cell.shapes (*l).size ();
+      }
+      for (db::Cell::const_iterator i = cell.begin (); ! i.at_end (); ++i) {
+        c += subtree_count (i->cell_index ()) * i->cell_inst ().size ();
+      }
+
+      m_counts [ci] = c;
+
+    }
+    return m_counts [ci];
+  }
+
+  size_t tile_of (const db::DPoint &c) const
+  {
+    double fx = floor ((c.x () - m_origin.x ()) / m_cw);
+    double fy = floor ((c.y () - m_origin.y ()) / m_ch);
+    size_t x = size_t (std::max (0.0, std::min (double (m_nx - 1), fx)));
+    size_t y = size_t (std::max (0.0, std::min (double (m_ny - 1), fy)));
+    return y * m_nx + x;
+  }
+
+  size_t tile_of (const db::Point &p) const
+  {
+    return tile_of (m_t * p);
+  }
+
+  bool single_tile (const db::Box &box, size_t &index) const
+  {
+    db::DBox b = m_t * box;
+    index = tile_of (b.p1 ());
+    return index == tile_of (b.p2 ());
+  }
+};
+
+}
+
+void
+TilingProcessor::estimate_costs (const db::DPoint &origin, double cw, double ch, size_t nx, size_t ny, std::vector<size_t> &costs) const
+{
+  costs.clear ();
+  costs.resize (nx * ny, 0);
+
+  if (nx == 0 || ny == 0 || cw < 1e-10 || ch < 1e-10) {
+    return;
+  }
+
+  //  NOTE: the shape count is a crude estimate, but it's cheap to obtain and good
+  //  enough to tell dense areas from sparse or empty ones.
+  for (std::vector<InputSpec>::const_iterator i = m_inputs.begin (); i != m_inputs.end (); ++i) {
+
+    double input_dbu = dbu ();
+    if (scale_to_dbu () && i->iter.layout ()) {
+      input_dbu = i->iter.layout ()->dbu ();
+    }
+
+    db::CplxTrans t = db::CplxTrans (input_dbu) * db::CplxTrans (i->trans);
+
+    if (i->iter.layout () && i->iter.top_cell () && i->iter.max_depth () == std::numeric_limits<int>::max ()) {
+
+      //  hierarchical inputs: count per cell, not per shape
+      i->iter.layout ()->update ();
+
+      HierarchicalCostEstimator estimator (i->iter, t, origin, cw, ch, nx, ny, costs);
+      estimator.add (i->iter.top_cell ()->cell_index (), db::ICplxTrans (), i->iter.region ());
+
+    } else {
+
+      for (db::RecursiveShapeIterator s = i->iter; ! s.at_end (); ++s) {
+
+        db::DPoint c = t * (s.trans () * s.shape ().bbox ().center ());
+
+        double fx = floor ((c.x () - origin.x ()) / cw);
+        double fy = floor ((c.y () - origin.y ()) / ch);
+        size_t x = size_t (std::max (0.0, std::min (double (nx - 1), fx)));
+        size_t y = size_t (std::max (0.0, std::min (double (ny - 1), fy)));
+
+        costs [y * nx + x] += 1;
+
+      }
+
+    }
+
+  }
+}
+
+namespace
+{
+
+/**
+ *  @brief A tile batch: a set of tiles executed by one task and the estimated cost
+ */
+struct TilingProcessorBatch
+{
+  TilingProcessorBatch () : cost (0), cacheable (true) { }
+
+  std::vector<TilingProcessorTile> tiles;
+  size_t cost;
+  //  true, if the tiles form a contiguous strip so the inputs can be fetched at once
+  bool cacheable;
+};
+
+/**
+ *  @brief Moves the tiles collected so far into a new batch
+ */
+void
+flush_batch (std::vector<TilingProcessorBatch> &batches, TilingProcessorBatch &batch)
+{
+  if (! batch.tiles.empty ()) {
+    batches.push_back (batch);
+    batch.tiles.clear ();
+    batch.cost = 0;
+  }
+}
+
+struct CostGreater
+{
+  bool operator() (const TilingProcessorBatch &a, const TilingProcessorBatch &b) const
+  {
+    return a.cost > b.cost;
+  }
+};
+
+/**
+ *  @brief The subdivision of a tile in adaptive mode (per dimension)
+ *  This value must be a power of two and determines the minimum sub-tile size.
+ */
+const size_t adaptive_subdivision = 4;
+
+/**
+ *  @brief The maximum number of empty tiles combined into a single task
+ */
+const size_t adaptive_empty_batch = 16;
+
+/**
+ *  @brief The maximum number of tiles sharing one input cache
+ */
+const size_t max_cache_batch = 16;
+
+/**
+ *  @brief Gets the cost of an area of n x n cells of the cost histogram
+ */
+size_t
+area_cost (const std::vector<size_t> &costs, size_t nx, size_t x0, size_t y0, size_t n)
+{
+  size_t cost = 0;
+  for (size_t y = y0; y < y0 + n; ++y) {
+    for (size_t x = x0; x < x0 + n; ++x) {
+      cost += costs [y * nx + x];
+    }
+  }
+  return cost;
+}
+
+/**
+ *  @brief Recursively splits an area of the cost histogram into sub-tiles
+ *
+ *  x0, y0 and n specify the area of cells with the lower-left cell (x0, y0) and n x n cells.
+ */
+void
+split_tile (std::vector<TilingProcessorBatch> &batches, const std::vector<size_t> &costs, size_t nx, size_t x0, size_t y0, size_t n, size_t threshold,
+            size_t ix, size_t iy, const std::string &tile_desc, const db::DPoint &origin, double cw, double ch, const db::DVector &border, double dbu)
+{
+  size_t cost = area_cost (costs, nx, x0, y0, n);
+
+  if (cost > threshold && n > 1) {
+    size_t h = n / 2;
+    split_tile (batches, costs, nx, x0, y0, h, threshold, ix, iy, tile_desc, origin, cw, ch, border, dbu);
+    split_tile (batches, costs, nx, x0 + h, y0, h, threshold, ix, iy, tile_desc, origin, cw, ch, border, dbu);
+    split_tile (batches, costs, nx, x0, y0 + h, h, threshold, ix, iy, tile_desc, origin, cw, ch, border, dbu);
+    split_tile (batches, costs, nx, x0 + h, y0 + h, h, threshold, ix, iy, tile_desc, origin, cw, ch, border, dbu);
+    return;
+  }
+
+  //  snap the sub-tile to the database unit grid - the same coordinates will give the same
+  //  snapped values, so the sub-tiles will still be seamless
+  db::DBox clip_box (dbu * floor (0.5 + (origin.x () + x0 * cw) / dbu + 1e-10),
+                     dbu * floor (0.5 + (origin.y () + y0 * ch) / dbu + 1e-10),
+                     dbu * floor (0.5 + (origin.x () + (x0 + n) * cw) / dbu + 1e-10),
+                     dbu * floor (0.5 + (origin.y () + (y0 + n) * ch) / dbu + 1e-10));
+
+  std::string desc = tile_desc;
+  if (n < adaptive_subdivision) {
+    desc += " (" + clip_box.to_string () + ")";
+  }
+
+  batches.push_back (TilingProcessorBatch ());
+  batches.back ().cost = cost;
+  batches.back ().tiles.push_back (TilingProcessorTile (desc, ix, iy, clip_box, clip_box.enlarged (border)));
+}
+
 }
 
 void  
 TilingProcessor::execute (const std::string &desc)
 {
+  tl::ProfileZone zone ("TilingProcessor::execute");
+
   db::DBox tot_box = m_frame;
 
   if (tot_box.empty ()) {
@@ -813,7 +2325,14 @@ TilingProcessor::execute (const std::string &desc)
   //  is just a single tile.
   bool has_tiles = (ntiles_w > 1 || ntiles_h > 1 || ! m_frame.empty ());
 
-  TilingProcessorJob job (this, m_threads, has_tiles);
+  //  NOTE: the caches and tasks need to be declared before the task group, so they are destroyed
+  //  after the pool tasks have finished
+  TileInputCacheList caches;
+
+  //  the tasks are collected first and then executed by the pool threads or the worker processes
+  TilingProcessorTaskList tasks;
+
+  size_t todo_count = 0;
 
   double l = 0.0, b = 0.0;
 
@@ -830,86 +2349,237 @@ TilingProcessor::execute (const std::string &desc)
       b = dbu () * floor (0.5 + (tot_box.center ().y () - ntiles_h * 0.5 * tile_height) / dbu () + 1e-10);
     }
 
-    //  create the TilingProcessor tasks
-    for (size_t ix = 0; ix < ntiles_w; ++ix) {
+    std::vector<TilingProcessorBatch> batches;
+
+    //  with input caching, adjacent tiles of a column are combined into batches. The batch size
+    //  is chosen to leave enough batches for the threads.
+    size_t batch_size = 1;
+    if (m_cache_inputs) {
+      batch_size = (ntiles_w * ntiles_h) / (4 * std::max (size_t (1), m_threads));
+      batch_size = std::max (size_t (1), std::min (std::min (batch_size, ntiles_h), max_cache_batch));
+    }
+
+    if (m_adaptive && ntiles_w * ntiles_h > 1) {
+
+      //  sub-tiles are delivered with the indexes of their tile, hence we can only split
+      //  tiles if all receivers can handle that
+      bool split_tiles = true;
+      for (std::vector<OutputSpec>::const_iterator o = m_outputs.begin (); o != m_outputs.end () && split_tiles; ++o) {
+        if (o->receiver && ! o->receiver->accepts_sub_tiles ()) {
+          split_tiles = false;
+        }
+      }
+
+      size_t nx = ntiles_w * adaptive_subdivision, ny = ntiles_h * adaptive_subdivision;
+      double cw = tile_width / adaptive_subdivision, ch = tile_height / adaptive_subdivision;
+
+      std::vector<size_t> costs;
+      {
+        tl::SelfTimer timer (tl::verbosity () >= 21, "Estimating tile costs");
+        estimate_costs (db::DPoint (l, b), cw, ch, nx, ny, costs);
+      }
+
+      //  tiles with more than twice the average cost are split
+      size_t total_cost = 0;
+      for (std::vector<size_t>::const_iterator c = costs.begin (); c != costs.end (); ++c) {
+        total_cost += *c;
+      }
 
-      for (size_t iy = 0; iy < ntiles_h; ++iy) {
+      size_t threshold = std::max (size_t (1), (2 * total_cost) / (ntiles_w * ntiles_h));
 
-        db::DBox clip_box (l + ix * tile_width, b + iy * tile_height, l + (ix + 1) * tile_width, b + (iy + 1) * tile_height);
-        db::DBox region = clip_box.enlarged (db::DVector (m_tile_bx, m_tile_by));
+      TilingProcessorBatch empty_tiles;
+      empty_tiles.cacheable = false;
 
-        std::string tile_desc = tl::sprintf ("%d/%d,%d/%d", ix + 1, ntiles_w, iy + 1, ntiles_h);
+      for (size_t ix = 0; ix < ntiles_w; ++ix) {
+
+        //  the tiles which are not split are combined into column strips like in the non-adaptive case
+        TilingProcessorBatch strip;
+
+        for (size_t iy = 0; iy < ntiles_h; ++iy) {
+
+          std::string tile_desc = tl::sprintf ("%d/%d,%d/%d", ix + 1, ntiles_w, iy + 1, ntiles_h);
+
+          size_t c = area_cost (costs, nx, ix * adaptive_subdivision, iy * adaptive_subdivision, adaptive_subdivision);
+
+          db::DBox clip_box (l + ix * tile_width, b + iy * tile_height, l + (ix + 1) * tile_width, b + (iy + 1) * tile_height);
+          db::DBox region = clip_box.enlarged (db::DVector (m_tile_bx, m_tile_by));
+
+          if (c == 0) {
+
+            //  empty tiles are combined into one task to reduce the overhead
+            flush_batch (batches, strip);
+            empty_tiles.tiles.push_back (TilingProcessorTile (tile_desc, ix, iy, clip_box, region));
+            if (empty_tiles.tiles.size () >= adaptive_empty_batch) {
+              flush_batch (batches, empty_tiles);
+            }
+
+          } else if (split_tiles && c > threshold) {
+
+            flush_batch (batches, strip);
+            split_tile (batches, costs, nx, ix * adaptive_subdivision, iy * adaptive_subdivision, adaptive_subdivision, threshold,
+                        ix, iy, tile_desc, db::DPoint (l, b), cw, ch, db::DVector (m_tile_bx, m_tile_by), dbu ());
+
+          } else {
+
+            strip.tiles.push_back (TilingProcessorTile (tile_desc, ix, iy, clip_box, region));
+            strip.cost += c;
+            if (strip.tiles.size () >= batch_size) {
+              flush_batch (batches, strip);
+            }
+
+          }
+
+        }
+
+        flush_batch (batches, strip);
+
+      }
+
+      flush_batch (batches, empty_tiles);
+
+      //  largest tasks first, so the small ones fill the gaps at the end
+      std::stable_sort (batches.begin (), batches.end (), CostGreater ());
+
+      if (tl::verbosity () >= 20) {
+        tl::info << "TilingProcessor: adaptive tiling uses " << batches.size () << " tasks for " << ntiles_w * ntiles_h << " tiles";
+      }
+
+    } else {
+
+      for (size_t ix = 0; ix < ntiles_w; ++ix) {
+
+        for (size_t iy = 0; iy < ntiles_h; ++iy) {
+
+          db::DBox clip_box (l + ix * tile_width, b + iy * tile_height, l + (ix + 1) * tile_width, b + (iy + 1) * tile_height);
+          db::DBox region = clip_box.enlarged (db::DVector (m_tile_bx, m_tile_by));
+
+          std::string tile_desc = tl::sprintf ("%d/%d,%d/%d", ix + 1, ntiles_w, iy + 1, ntiles_h);
+
+          if (iy % batch_size == 0) {
+            batches.push_back (TilingProcessorBatch ());
+          }
+          batches.back ().tiles.push_back (TilingProcessorTile (tile_desc, ix, iy, clip_box, region));
 
-        size_t si = 0;
-        for (std::vector <std::string>::const_iterator s = m_scripts.begin (); s != m_scripts.end (); ++s, ++si) {
-          job.schedule (new TilingProcessorTask (tile_desc, ix, iy, clip_box, region, *s, si));
         }
 
       }
 
     }
 
+    //  create the TilingProcessor tasks
+    for (std::vector<TilingProcessorBatch>::const_iterator t = batches.begin (); t != batches.end (); ++t) {
+
+      TileInputCache *cache = 0;
+      if (m_cache_inputs && t->cacheable && t->tiles.size () > 1) {
+        cache = new TileInputCache (this, t->tiles, m_scripts.size () + m_operations.size ());
+        caches.push_back (cache);
+      }
+
+      size_t si = 0;
+      for (std::vector <std::string>::const_iterator s = m_scripts.begin (); s != m_scripts.end (); ++s, ++si) {
+        tasks.push_back (new TilingProcessorTask (t->tiles, *s, si, cache));
+      }
+      for (std::vector <TileOperation *>::const_iterator o = m_operations.begin (); o != m_operations.end (); ++o, ++si) {
+        tasks.push_back (new TilingProcessorTask (t->tiles, *o, si, cache));
+      }
+
+      todo_count += t->tiles.size () * (m_scripts.size () + m_operations.size ());
+
+    }
+
   } else {
 
     ntiles_w = ntiles_h = 0;
 
     size_t si = 0;
+    std::vector<TilingProcessorTile> all;
+    all.push_back (TilingProcessorTile ("all", 0, 0, db::DBox (), db::DBox ()));
+
     for (std::vector <std::string>::const_iterator s = m_scripts.begin (); s != m_scripts.end (); ++s, ++si) {
-      job.schedule (new TilingProcessorTask ("all", 0, 0, db::DBox (), db::DBox (), *s, si));
+      tasks.push_back (new TilingProcessorTask (all, *s, si));
+    }
+    for (std::vector <TileOperation *>::const_iterator o = m_operations.begin (); o != m_operations.end (); ++o, ++si) {
+      tasks.push_back (new TilingProcessorTask (all, *o, si));
     }
 
   }
 
-  //  TODO: there should be a general scheme of how thread-specific progress is merged
-  //  into a global one ..
-  size_t todo_count = ntiles_w * ntiles_h * m_scripts.size ();
   tl::RelativeProgress progress (desc, todo_count, 1);
 
+  TilingProcessorWorker worker (this, has_tiles, tasks);
+  tl::TaskGroup group;
+
+  std::vector<std::string> error_messages;
+
   try {
 
-    try {
+    for (std::vector<OutputSpec>::iterator o = m_outputs.begin (); o != m_outputs.end (); ++o) {
+      if (o->receiver) {
+        o->receiver->set_processor (this);
+        o->receiver->begin (ntiles_w, ntiles_h, db::DPoint (l, b), tile_width, tile_height, frame);
+      }
+    }
 
-      for (std::vector<OutputSpec>::iterator o = m_outputs.begin (); o != m_outputs.end (); ++o) {
-        if (o->receiver) {
-          o->receiver->set_processor (this);
-          o->receiver->begin (ntiles_w, ntiles_h, db::DPoint (l, b), tile_width, tile_height, frame);
-        }
+#if !defined(_WIN32)
+    if (m_processes > 1 && ! tasks.empty ()) {
+
+      TilingProcessorProcesses processes (this, &worker, tasks);
+      processes.run (m_processes, progress);
+      error_messages = processes.error_messages ();
+
+    } else
+#endif
+    if (m_threads == 0) {
+
+      worker.perform_all (0);
+      error_messages = worker.error_messages ();
+
+    } else {
+
+      //  one pool task per thread - each one executes tiling processor tasks until all are done
+      for (size_t i = 0; i < std::min (m_threads, tasks.size ()); ++i) {
+        group.run (new TilingProcessorPoolTask (&worker));
       }
 
-      job.start ();
-      while (job.is_running ()) {
-        //  This may throw an exception, if the cancel button has been pressed.
-        job.update_progress (progress);
-        job.wait (100);
+      //  This may throw an exception, if the cancel button has been pressed.
+      while (! group.wait_for (100)) {
+        worker.update_progress (progress);
       }
 
-      for (std::vector<OutputSpec>::iterator o = m_outputs.begin (); o != m_outputs.end (); ++o) {
-        if (o->receiver) {
-          o->receiver->finish (!job.has_error ());
-          o->receiver->set_processor (0);
-        }
+      error_messages = worker.error_messages ();
+
+    }
+
+    for (std::vector<OutputSpec>::iterator o = m_outputs.begin (); o != m_outputs.end (); ++o) {
+      if (o->receiver) {
+        o->receiver->finish (error_messages.empty ());
+        o->receiver->set_processor (0);
       }
+    }
+
+  } catch (...) {
 
+    //  stop the pool tasks before the receivers are finished
+    group.cancel ();
+    try {
+      group.wait ();
     } catch (...) {
-      for (std::vector<OutputSpec>::iterator o = m_outputs.begin (); o != m_outputs.end (); ++o) {
-        if (o->receiver) {
-          o->receiver->finish (false);
-          o->receiver->set_processor (0);
-        }
+      //  the tasks don't throw - errors are collected by the worker
+    }
+
+    for (std::vector<OutputSpec>::iterator o = m_outputs.begin (); o != m_outputs.end (); ++o) {
+      if (o->receiver) {
+        o->receiver->finish (false);
+        o->receiver->set_processor (0);
       }
-      throw;
     }
 
-  } catch (tl::BreakException &ex) {
-    job.terminate ();
-    throw ex;
-  } catch (tl::Exception &ex) {
-    job.terminate ();
-    throw ex;
+    throw;
+
   }
 
-  if (job.has_error ()) {
-    throw tl::Exception (tl::to_string (QObject::tr ("Errors occured during processing. First error message says:\n")) + job.error_messages ().front ());
+  if (! error_messages.empty ()) {
+    throw tl::Exception (tl::to_string (QObject::tr ("Errors occured during processing. First error message says:\n")) + error_messages.front ());
   }
 }
 
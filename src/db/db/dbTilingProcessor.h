@@ -41,6 +41,9 @@ namespace db
 {
 
 class TilingProcessor;
+class TileInputCache;
+class TilingProcessorResultWriter;
+class StreamingWriter;
 
 /**
  *  @brief A receiver for the output data 
@@ -110,6 +113,17 @@ public:
    */
   virtual void finish (bool /*success*/) { }
 
+  /**
+   *  @brief Returns a value indicating whether the receiver can take sub-tiles
+   *
+   *  In adaptive mode, the processor may split expensive tiles into sub-tiles. Sub-tiles
+   *  are delivered with the indexes of the tile they belong to, hence the receiver will
+   *  see multiple "put" calls for the same tile, each with a different tile box.
+   *  Receivers which are keyed by the tile index must not accept sub-tiles.
+   *  If one of the receivers does not accept sub-tiles, no tile is split.
+   */
+  virtual bool accepts_sub_tiles () const { return false; }
+
   /**
    *  @brief Gets the tiling processor the receiver is attached to
    *
@@ -392,12 +406,160 @@ bool insert_var (X &inserter, const tl::Variant &obj, const db::Box &tile, bool
   }
 }
 
+/**
+ *  @brief The per-tile context of a native tile operation
+ *
+ *  This object is handed to TileOperation::process for each tile. It provides
+ *  the inputs confined to the tile (plus border) and delivers output to the
+ *  output channels of the tiling processor. It is the C++ counterpart of the
+ *  "_tile", "_dbu", "_output" and input variables of the scripts.
+ *
+ *  Inputs and outputs are addressed by index, i.e. the order in which they
+ *  have been registered with the tiling processor. Inputs are created on first
+ *  request.
+ */
+class DB_PUBLIC TileContext
+{
+public:
+  /**
+   *  @brief Constructor
+   *
+   *  If a cache is given, region inputs are taken from the given slot of the cache.
+   */
+  TileContext (TilingProcessor *proc, size_t ix, size_t iy, bool has_tiles, const db::Box &tile, const db::DBox &region, const TileInputCache *cache = 0, size_t cache_slot = 0);
+
+  /**
+   *  @brief Destructor
+   */
+  ~TileContext ();
+
+  /**
+   *  @brief Gets the horizontal index of the tile
+   */
+  size_t ix () const
+  {
+    return m_ix;
+  }
+
+  /**
+   *  @brief Gets the vertical index of the tile
+   */
+  size_t iy () const
+  {
+    return m_iy;
+  }
+
+  /**
+   *  @brief Gets a value indicating whether the processor runs in tiled mode
+   */
+  bool has_tiles () const
+  {
+    return m_has_tiles;
+  }
+
+  /**
+   *  @brief Gets the tile box in database units
+   *
+   *  Without tiles, this box is the world box.
+   */
+  const db::Box &tile () const
+  {
+    return m_tile;
+  }
+
+  /**
+   *  @brief Gets the database unit used for the computation
+   */
+  double dbu () const;
+
+  /**
+   *  @brief Gets the number of inputs
+   */
+  size_t inputs () const;
+
+  /**
+   *  @brief Gets the input with the given index as a region
+   */
+  const db::Region &region (size_t index);
+
+  /**
+   *  @brief Gets the input with the given index as an edge collection
+   */
+  const db::Edges &edges (size_t index);
+
+  /**
+   *  @brief Delivers a region to the output channel with the given index
+   *
+   *  If "clip" is true, the output is clipped at the tile.
+   */
+  void output (size_t index, const db::Region &region, bool clip = true);
+
+  /**
+   *  @brief Delivers an edge collection to the output channel with the given index
+   */
+  void output (size_t index, const db::Edges &edges, bool clip = true);
+
+  /**
+   *  @brief Delivers an edge pair collection to the output channel with the given index
+   */
+  void output (size_t index, const db::EdgePairs &edge_pairs, bool clip = true);
+
+private:
+  TilingProcessor *mp_proc;
+  size_t m_ix, m_iy;
+  bool m_has_tiles;
+  db::Box m_tile;
+  db::DBox m_region;
+  const TileInputCache *mp_cache;
+  size_t m_cache_slot;
+  std::vector<db::Region *> m_regions;
+  std::vector<db::Edges *> m_edges;
+
+  TileContext (const TileContext &);
+  TileContext &operator= (const TileContext &);
+};
+
+/**
+ *  @brief A native tile operation
+ *
+ *  A tile operation is the C++ alternative to a script: instead of parsing
+ *  and evaluating an expression per tile, the processor calls "process" with
+ *  the tile's context. Operations are queued with TilingProcessor::queue
+ *  and run side by side with the scripts.
+ *
+ *  "process" is called from the worker threads, potentially for different
+ *  tiles at the same time. Hence it must not modify the operation object.
+ */
+class DB_PUBLIC TileOperation
+{
+public:
+  /**
+   *  @brief Constructor
+   */
+  TileOperation () { }
+
+  /**
+   *  @brief Destructor
+   */
+  virtual ~TileOperation () { }
+
+  /**
+   *  @brief Processes one tile
+   */
+  virtual void process (TileContext &context) const = 0;
+
+private:
+  TileOperation (const TileOperation &);
+  TileOperation &operator= (const TileOperation &);
+};
+
 /**
  *  @brief A processor for executing scripts on tiles of a layout
  *
  *  The idea of the tiling processor is to offer a way to execute scripts
  *  (written in tl::Expressions language) on tiles of a layout. Multiple
- *  scripts can be registered per tile.
+ *  scripts can be registered per tile. C++ code can queue TileOperation
+ *  objects instead of scripts to avoid the expression overhead.
  *
  *  Multiple inputs can be specified. Custom functions can be registered to 
  *  implement additional functionality.
@@ -472,6 +634,17 @@ public:
    */
   void output (const std::string &name, db::Layout &layout, db::cell_index_type cell, unsigned int layer, db::Coord ep_ext = 1);
 
+  /**
+   *  @brief Specifies output to a streaming writer
+   *
+   *  This version will write the output directly to a streaming writer into the
+   *  specified cell and layer. This avoids building a layout in memory.
+   *  The cell is opened when the processor starts, unless it is open already. 
+   *  It is not closed - this is left to the caller.
+   *  The ep_ext parameter specifies what extension to apply when converting edge pairs to polygons.
+   */
+  void output (const std::string &name, db::StreamingWriter &writer, db::cell_index_type cell, const db::LayerProperties &lp, db::Coord ep_ext = 1);
+
   /**
    *  @brief Specifies output to a region
    *
@@ -588,6 +761,56 @@ public:
    */
   void tile_origin (double xo, double yo);
 
+  /**
+   *  @brief Enables or disables adaptive tiling
+   *
+   *  In adaptive mode, the processor estimates the cost of every tile from a 
+   *  shape count histogram of the inputs before execution. Heavy tiles are 
+   *  split into sub-tiles, empty tiles are combined into a single task and 
+   *  the tasks are executed in the order of decreasing cost. This reduces the
+   *  time where threads sit idle at the end of the run.
+   *
+   *  Sub-tiles report the index of the tile they are part of and their own
+   *  box. Hence, receivers may see multiple "put" calls for one tile. Tiles are
+   *  only split if all receivers accept sub-tiles (see TileOutputReceiver::accepts_sub_tiles).
+   *  With input caching, the tiles which are not split are combined into batches.
+   *  Adaptive tiling is not used without tiles.
+   */
+  void set_adaptive (bool f)
+  {
+    m_adaptive = f;
+  }
+
+  /**
+   *  @brief Gets a value indicating whether adaptive tiling is enabled
+   */
+  bool adaptive () const
+  {
+    return m_adaptive;
+  }
+
+  /**
+   *  @brief Enables or disables input caching
+   *
+   *  With input caching, neighboring tiles are processed in batches. The region inputs
+   *  of a batch are fetched in a single pass over the hierarchy and distributed over 
+   *  the tiles. Shapes in the overlapping tile borders are fetched once only. 
+   *  This reduces the setup cost per tile which is significant for small tiles. 
+   *  Edge inputs are not cached. In adaptive mode, split tiles are not cached.
+   */
+  void set_cache_inputs (bool f)
+  {
+    m_cache_inputs = f;
+  }
+
+  /**
+   *  @brief Gets a value indicating whether input caching is enabled
+   */
+  bool cache_inputs () const
+  {
+    return m_cache_inputs;
+  }
+
   /**
    *  @brief Specifies the number of threads to use
    */
@@ -601,6 +824,33 @@ public:
     return m_threads;
   }
 
+  /**
+   *  @brief Specifies the number of worker processes to use
+   *
+   *  With more than one process, the tasks are executed in forked child processes
+   *  instead of threads. The children share the layout data with the parent and 
+   *  receive their tasks through a pipe. They send back the output in a binary form 
+   *  and the parent delivers it to the receivers. This way, scripts calling back into 
+   *  an interpreter don't serialize on the interpreter lock.
+   *
+   *  Only regions, edge and edge pair collections, boxes, polygons, edges, edge pairs 
+   *  and plain values can be delivered as output. "_rec" does not deliver the parent's 
+   *  receiver in child processes. On platforms without "fork", the processor uses 
+   *  threads instead.
+   */
+  void set_processes (size_t n)
+  {
+    m_processes = n;
+  }
+
+  /**
+   *  @brief Gets the number of worker processes
+   */
+  size_t processes () const
+  {
+    return m_processes;
+  }
+
   /**
    *  @brief Queue a script for execution with "execute"
    *
@@ -609,6 +859,35 @@ public:
    */
   void queue (const std::string &script);
 
+  /**
+   *  @brief Queue a native tile operation for execution with "execute"
+   *
+   *  The tiling processor takes ownership over the operation object. Operations
+   *  are executed on every tile like the scripts, but without the overhead of
+   *  the expression evaluation.
+   */
+  void queue (TileOperation *op);
+
+  /**
+   *  @brief Gets the number of inputs registered so far
+   *
+   *  This value can be used to obtain the index of the next input for TileContext.
+   */
+  size_t inputs () const
+  {
+    return m_inputs.size ();
+  }
+
+  /**
+   *  @brief Gets the number of outputs registered so far
+   *
+   *  This value can be used to obtain the index of the next output for TileContext.
+   */
+  size_t outputs () const
+  {
+    return m_outputs.size ();
+  }
+
   /**
    *  @brief Execute the job
    *
@@ -620,6 +899,9 @@ private:
   friend class TilingProcessorWorker;
   friend class TilingProcessorOutputFunction;
   friend class TilingProcessorReceiverFunction;
+  friend class TileContext;
+  friend class TileInputCache;
+  friend class TilingProcessorProcesses;
 
   struct InputSpec
   {
@@ -644,6 +926,10 @@ private:
   std::vector<InputSpec>::const_iterator end_inputs () const { return m_inputs.end (); }
 
   void put (size_t ix, size_t iy, const db::Box &tile, const std::vector<tl::Variant> &args);
+  void put (size_t ix, size_t iy, const db::Box &tile, size_t index, const tl::Variant &obj, bool clip);
+  db::RecursiveShapeIterator input_iter (size_t index, bool has_tiles, const db::DBox &region, db::ICplxTrans &trans) const;
+  db::Box input_region (size_t index, const db::DBox &region) const;
+  void estimate_costs (const db::DPoint &origin, double cw, double ch, size_t nx, size_t ny, std::vector<size_t> &costs) const;
   tl::Variant receiver (const std::vector<tl::Variant> &args);
   tl::Eval &top_eval () { return m_top_eval; }
 
@@ -660,7 +946,12 @@ private:
   double m_dbu, m_dbu_specific;
   bool m_dbu_specific_set;
   bool m_scale_to_dbu;
+  bool m_adaptive;
+  bool m_cache_inputs;
+  size_t m_processes;
+  TilingProcessorResultWriter *mp_result_writer;
   std::vector<std::string> m_scripts;
+  std::vector<TileOperation *> m_operations;
   QMutex m_output_mutex;
   tl::Eval m_top_eval;
 };
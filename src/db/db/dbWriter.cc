@@ -26,6 +26,7 @@
 #include "tlClassRegistry.h"
 #include "tlAssert.h"
 #include "tlStream.h"
+#include "tlProfiler.h"
 
 namespace db
 {
@@ -55,7 +56,11 @@ void
 Writer::write (db::Layout &layout, tl::OutputStream &stream)
 {
   tl_assert (mp_writer != 0);
+
+  tl::ProfileZone zone ("Writer::write");
+  size_t pos = stream.pos ();
   mp_writer->write (layout, stream, m_options);
+  zone.add_bytes (stream.pos () - pos);
 }
 
 }
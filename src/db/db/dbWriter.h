@@ -61,6 +61,48 @@ public:
    *  The layout is non-const since the writer may modify the meta information of the layout.
    */
   virtual void write (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options) = 0;
+
+  /**
+   *  @brief Returns true, if the writer supports the streaming mode
+   *
+   *  In streaming mode, the layout is written cell by cell and possibly in
+   *  multiple chunks per cell. See StreamingWriter for details.
+   *  The streaming methods below are only called if this method returns true.
+   */
+  virtual bool supports_streaming () const 
+  { 
+    return false; 
+  }
+
+  /**
+   *  @brief Streaming mode: starts writing
+   *
+   *  The layout is the scratch layout of the streaming writer. It provides 
+   *  the cells, layers and properties. Its cells hold the chunks of
+   *  content to write.
+   */
+  virtual void begin_streaming (db::Layout & /*layout*/, tl::OutputStream & /*stream*/, const db::SaveLayoutOptions & /*options*/) { }
+
+  /**
+   *  @brief Streaming mode: starts a new cell 
+   */
+  virtual void begin_streaming_cell (db::cell_index_type /*cell_index*/) { }
+
+  /**
+   *  @brief Streaming mode: writes the present content of the given cell 
+   *  This method may be called multiple times between begin_streaming_cell and end_streaming_cell.
+   */
+  virtual void write_streaming_cell_content (db::cell_index_type /*cell_index*/) { }
+
+  /**
+   *  @brief Streaming mode: finishes a cell 
+   */
+  virtual void end_streaming_cell (db::cell_index_type /*cell_index*/) { }
+
+  /**
+   *  @brief Streaming mode: finishes writing
+   */
+  virtual void end_streaming () { }
 };
 
 /**
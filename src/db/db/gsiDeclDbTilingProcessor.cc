@@ -53,6 +53,11 @@ public:
     }
   }
 
+  virtual bool accepts_sub_tiles () const
+  {
+    return true;
+  }
+
 private:
   double *mp_value;
 };
@@ -625,6 +630,44 @@ Class<db::TilingProcessor> decl_TilingProcessor ("TilingProcessor",
     "\n"
     "The tile border is given in micron.\n"
   ) + 
+  method ("adaptive=", &db::TilingProcessor::set_adaptive,
+    "@brief Enables or disables adaptive tiling\n"
+    "@args f\n"
+    "\n"
+    "In adaptive mode, the processor estimates the cost of every tile from the shape density of the inputs. "
+    "Heavy tiles are split into sub-tiles, empty tiles are combined into one task and the tasks are executed "
+    "largest first. This reduces the time where threads are idle at the end of the run. Sub-tiles report the "
+    "index of the tile they belong to, so a receiver may see multiple \\TileOutputReceiver#put calls for the same tile "
+    "with different tile boxes. Tiles are only split if all outputs accept that. Outputs to layouts, regions, edge "
+    "and edge pair collections and report databases do, receivers implemented in scripts don't. "
+    "The tiles which are not split are combined into batches if input caching is enabled (see \\cache_inputs=). "
+    "Adaptive tiling does not apply if no tiles are used.\n"
+    "\n"
+    "This method has been introduced in version 0.25.3."
+  ) + 
+  method ("adaptive?", &db::TilingProcessor::adaptive,
+    "@brief Gets a value indicating whether adaptive tiling is enabled\n"
+    "See \\adaptive= for a description of adaptive tiling.\n"
+    "\n"
+    "This method has been introduced in version 0.25.3."
+  ) + 
+  method ("cache_inputs=", &db::TilingProcessor::set_cache_inputs,
+    "@brief Enables or disables input caching\n"
+    "@args f\n"
+    "\n"
+    "With input caching, adjacent tiles are processed in batches. The region inputs of a batch are fetched "
+    "in a single pass and distributed over the tiles. Shapes in the overlapping tile borders are fetched only once. "
+    "This reduces the setup cost per tile, which is significant for small tiles. Edge inputs are not cached. "
+    "In adaptive mode, tiles which are split into sub-tiles are not cached (see \\adaptive=).\n"
+    "\n"
+    "This method has been introduced in version 0.25.3."
+  ) + 
+  method ("cache_inputs?", &db::TilingProcessor::cache_inputs,
+    "@brief Gets a value indicating whether input caching is enabled\n"
+    "See \\cache_inputs= for a description of input caching.\n"
+    "\n"
+    "This method has been introduced in version 0.25.3."
+  ) + 
   method ("threads=", &db::TilingProcessor::set_threads,
     "@brief Specifies the number of threads to use\n"
     "@args n\n"
@@ -632,6 +675,26 @@ Class<db::TilingProcessor> decl_TilingProcessor ("TilingProcessor",
   method ("threads", &db::TilingProcessor::threads,
     "@brief Gets the number of threads to use\n"
   ) + 
+  method ("processes=", &db::TilingProcessor::set_processes,
+    "@brief Specifies the number of worker processes to use\n"
+    "@args n\n"
+    "\n"
+    "With more than one process, the tasks are not executed in threads but in worker processes which are "
+    "forked from the current process. The workers share the layout data with the current process and send "
+    "back the output in a binary form. Scripts calling back into the interpreter will scale with the number "
+    "of processes while they are serialized on the interpreter when running in threads.\n"
+    "\n"
+    "Only regions, edge and edge pair collections, boxes, polygons, edges, edge pairs and plain values "
+    "can be delivered to the outputs in this mode. Receivers are always called in the current process. "
+    "Worker processes are not available on Windows - there, threads are used.\n"
+    "\n"
+    "This method has been introduced in version 0.25.3."
+  ) + 
+  method ("processes", &db::TilingProcessor::processes,
+    "@brief Gets the number of worker processes to use\n"
+    "\n"
+    "This method has been introduced in version 0.25.3."
+  ) + 
   method ("queue", &db::TilingProcessor::queue,
     "@brief Queues a script for parallel execution\n"
     "@args script\n"
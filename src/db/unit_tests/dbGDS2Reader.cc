@@ -23,10 +23,13 @@
 
 
 #include "dbGDS2Reader.h"
+#include "dbReader.h"
 #include "dbLayoutDiff.h"
+#include "dbTestSupport.h"
 #include "tlUnitTest.h"
 
 #include <iostream>
+#include <map>
 
 unsigned char data [] = {
   0x00,0x06,0x00,0x02,0x02,0x58,0x00,0x1c,0x01,0x02,0x00,0x02,0x00,0x02,0x00,0x08,
@@ -347,3 +350,189 @@ TEST(2)
   }
 }
 
+
+static size_t num_shapes (const db::Layout &layout, const char *cn)
+{
+  std::pair<bool, db::cell_index_type> c = layout.cell_by_name (cn);
+  if (! c.first) {
+    return 0;
+  }
+
+  size_t n = 0;
+  for (unsigned int l = 0; l < layout.layers (); ++l) {
+    if (layout.is_valid_layer (l)) {
+      n += layout.cell (c.second).shapes (l).size ();
+    }
+  }
+  return n;
+}
+
+//  Selective reading: top cell and region
+TEST(3) 
+{
+  tl::InputMemoryStream im ((const char *) data, sizeof (data));
+
+  db::Manager m;
+
+  db::Layout layout (&m);
+  {
+    tl::InputStream file (im);
+    db::GDS2Reader reader (file);
+    reader.read (layout);
+  }
+
+  db::LoadLayoutOptions options;
+  options.get_options<db::GDS2ReaderOptions> ().top_cell = "INV2";
+
+  db::Layout layout_sub (&m);
+  {
+    im.reset ();
+    tl::InputStream file (im);
+    db::GDS2Reader reader (file);
+    reader.read (layout_sub, options);
+    EXPECT_EQ (reader.libname (), "LIB.DB");
+  }
+
+  EXPECT_EQ (fabs (layout_sub.dbu () / 0.001 - 1.0) < 1e-6, true);
+  EXPECT_EQ (layout_sub.cells (), size_t (2));
+  EXPECT_EQ (layout_sub.cell_by_name ("RINGO").first, false);
+  EXPECT_EQ (layout_sub.cell_by_name ("INV2").first, true);
+  EXPECT_EQ (layout_sub.cell_by_name ("TRANS").first, true);
+  EXPECT_EQ (num_shapes (layout_sub, "INV2"), num_shapes (layout, "INV2"));
+  EXPECT_EQ (num_shapes (layout_sub, "TRANS"), num_shapes (layout, "TRANS"));
+  EXPECT_EQ (layout_sub.cell (layout_sub.cell_by_name ("INV2").second).cell_instances (), layout.cell (layout.cell_by_name ("INV2").second).cell_instances ());
+
+  //  a region outside of everything: no shapes, but the hierarchy is kept
+  options = db::LoadLayoutOptions ();
+  options.get_options<db::GDS2ReaderOptions> ().region = db::DBox (-1000.0, -1000.0, -999.0, -999.0);
+
+  db::Layout layout_empty (&m);
+  {
+    im.reset ();
+    tl::InputStream file (im);
+    db::GDS2Reader reader (file);
+    reader.read (layout_empty, options);
+  }
+
+  EXPECT_EQ (layout_empty.cells (), size_t (3));
+  EXPECT_EQ (num_shapes (layout_empty, "RINGO"), size_t (0));
+  EXPECT_EQ (num_shapes (layout_empty, "INV2"), size_t (0));
+  EXPECT_EQ (num_shapes (layout_empty, "TRANS"), size_t (0));
+
+  //  a region covering everything: same as reading the full layout
+  options.get_options<db::GDS2ReaderOptions> ().region = db::DBox (-1000.0, -1000.0, 1000.0, 1000.0);
+
+  db::Layout layout_all (&m);
+  {
+    im.reset ();
+    tl::InputStream file (im);
+    db::GDS2Reader reader (file);
+    reader.read (layout_all, options);
+  }
+
+  EXPECT_EQ (layout_all.cells (), size_t (3));
+  EXPECT_EQ (num_shapes (layout_all, "RINGO"), num_shapes (layout, "RINGO"));
+  EXPECT_EQ (num_shapes (layout_all, "INV2"), num_shapes (layout, "INV2"));
+  EXPECT_EQ (num_shapes (layout_all, "TRANS"), num_shapes (layout, "TRANS"));
+}
+
+//  Streaming mode
+TEST(4) 
+{
+  tl::InputMemoryStream im ((const char *) data, sizeof (data));
+
+  db::Manager m;
+
+  db::Layout layout (&m);
+  {
+    tl::InputStream file (im);
+    db::GDS2Reader reader (file);
+    reader.read (layout);
+  }
+
+  db::CountingReaderReceiver rec;
+  {
+    im.reset ();
+    tl::InputStream file (im);
+    db::Reader reader (file);
+    reader.read (rec, db::LoadLayoutOptions ());
+  }
+
+  EXPECT_EQ (rec.m_nesting_errors, (unsigned int) 0);
+  EXPECT_EQ (rec.m_layers, layout.layers ());
+  EXPECT_EQ (rec.m_counts_by_name.size (), size_t (3));
+
+  const char *cells[] = { "RINGO", "INV2", "TRANS" };
+  for (unsigned int i = 0; i < sizeof (cells) / sizeof (cells [0]); ++i) {
+    const db::Cell &cell = layout.cell (layout.cell_by_name (cells [i]).second);
+    EXPECT_EQ (rec.m_counts_by_name [cells [i]].first, num_shapes (layout, cells [i]));
+    EXPECT_EQ (rec.m_counts_by_name [cells [i]].second, cell.cell_instances ());
+  }
+}
+
+static std::string positions_to_string (const std::vector<size_t> &positions)
+{
+  std::string s;
+  for (std::vector<size_t>::const_iterator p = positions.begin (); p != positions.end (); ++p) {
+    if (! s.empty ()) {
+      s += ",";
+    }
+    s += tl::to_string (*p);
+  }
+  return s;
+}
+
+//  Structure index: order of the structures to read
+TEST(5)
+{
+  std::vector<std::string> top;
+  top.push_back ("A");
+
+  //  bottom-up file: A -> B -> C, B -> D
+  db::GDS2StructureIndex bottom_up;
+  bottom_up.add ("A", 400).children.push_back ("B");
+  db::GDS2StructureIndex::Structure &b = bottom_up.add ("B", 300);
+  b.children.push_back ("C");
+  b.children.push_back ("D");
+  bottom_up.add ("C", 100);
+  bottom_up.add ("D", 200);
+  bottom_up.add ("X", 50);
+
+  EXPECT_EQ (positions_to_string (bottom_up.positions_for_subtrees (top, false)), "100,200,300,400");
+  //  one sweep per hierarchy level
+  EXPECT_EQ (positions_to_string (bottom_up.positions_for_subtrees (top, true)), "400,300,100,200");
+
+  //  top-down file: a single sweep
+  db::GDS2StructureIndex top_down;
+  top_down.add ("A", 100).children.push_back ("B");
+  top_down.add ("B", 200).children.push_back ("C");
+  top_down.add ("C", 300);
+  top_down.set_context_info_pos (10);
+
+  EXPECT_EQ (positions_to_string (top_down.positions_for_subtrees (top, true)), "10,100,200,300");
+  EXPECT_EQ (positions_to_string (top_down.positions_for_subtrees (top, false)), "10,100,200,300");
+}
+
+//  Structure index: the cache keeps a limited number of indexes
+TEST(6)
+{
+  std::vector<std::string> files;
+  for (unsigned int i = 0; i < 20; ++i) {
+    std::string fn = tmp_file (tl::sprintf ("t6_%d.gds", i));
+    {
+      tl::OutputStream os (fn);
+      os << "dummy";
+    }
+    files.push_back (fn);
+    db::GDS2StructureIndex index;
+    index.add ("TOP", i);
+    db::GDS2StructureIndex::put_cached (fn, index);
+  }
+
+  db::GDS2StructureIndex index;
+  EXPECT_EQ (db::GDS2StructureIndex::get_cached (files.front (), index), false);
+
+  EXPECT_EQ (db::GDS2StructureIndex::get_cached (files.back (), index), true);
+  EXPECT_EQ (index.structure ("TOP") != 0, true);
+  EXPECT_EQ (index.structure ("TOP")->pos, size_t (19));
+}
@@ -464,3 +464,123 @@ TEST(4)
   prop_id = g.properties_repository ().properties_id (ps);
   EXPECT_EQ (el.property_ids_dirty, true);
 }
+
+namespace
+{
+
+struct RegionListener
+  : public tl::Object
+{
+  void region_changed (db::cell_index_type ci, unsigned int layer, const db::Box &box)
+  {
+    if (! regions.empty ()) {
+      regions += ";";
+    }
+    regions += tl::to_string (ci) + ":" + tl::to_string (layer) + ":" + (box.empty () ? std::string ("*") : box.to_string ());
+  }
+
+  std::string regions;
+};
+
+}
+
+TEST(5)
+{
+  //  Changed regions
+
+  db::Manager m;
+  db::Layout g (true, &m);
+  RegionListener rl;
+
+  unsigned int l1 = g.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = g.insert_layer (db::LayerProperties (2, 0));
+  db::cell_index_type ci = g.add_cell ("TOP");
+  db::Cell &top = g.cell (ci);
+
+  EXPECT_EQ (g.tracks_regions (), false);
+  top.shapes (l1).insert (db::Box (0, 0, 100, 100));
+
+  g.region_changed_event.add (&rl, &RegionListener::region_changed);
+  EXPECT_EQ (g.tracks_regions (), true);
+
+  //  regions are reported on every change
+  top.shapes (l1).insert (db::Box (100, 0, 200, 100));
+  top.shapes (l1).insert (db::Box (200, 0, 300, 100));
+  db::Shape s = top.shapes (l2).insert (db::Polygon (db::Box (0, 0, 10, 20)));
+  EXPECT_EQ (rl.regions, "0:0:(100,0;200,100);0:0:(200,0;300,100);0:1:(0,0;10,20)");
+
+  //  replacing a shape by one of a different type erases and inserts
+  rl.regions.clear ();
+  s = top.shapes (l2).replace (s, db::Box (-20, -20, 10, 10));
+  EXPECT_EQ (rl.regions, "0:1:(0,0;10,20);0:1:(-20,-20;10,10)");
+
+  //  replacing a shape by one of the same type reports the old and new region
+  rl.regions.clear ();
+  top.shapes (l2).replace (s, db::Box (-10, -10, 10, 10));
+  EXPECT_EQ (rl.regions, "0:1:(-20,-20;10,10)");
+
+  rl.regions.clear ();
+  s = *top.shapes (l2).begin (db::ShapeIterator::All);
+  top.shapes (l2).erase_shape (s);
+  EXPECT_EQ (rl.regions, "0:1:(-10,-10;10,10)");
+
+  //  undo and redo report the regions too
+  rl.regions.clear ();
+  m.transaction ("insert");
+  top.shapes (l1).insert (db::Box (1000, 1000, 1100, 1200));
+  m.commit ();
+  EXPECT_EQ (rl.regions, "0:0:(1000,1000;1100,1200)");
+
+  rl.regions.clear ();
+  m.undo ();
+  EXPECT_EQ (rl.regions, "0:0:(1000,1000;1100,1200)");
+
+  rl.regions.clear ();
+  m.redo ();
+  EXPECT_EQ (rl.regions, "0:0:(1000,1000;1100,1200)");
+
+  //  clearing a layer reports the whole layer
+  rl.regions.clear ();
+  top.clear (l2);
+  top.clear (l1);
+  EXPECT_EQ (rl.regions, "0:0:*");
+
+  //  no regions are reported while the layout is under construction
+  rl.regions.clear ();
+  g.start_changes ();
+  top.shapes (l1).insert (db::Box (0, 0, 100, 100));
+  g.end_changes ();
+  EXPECT_EQ (rl.regions, "");
+}
+
+TEST(6)
+{
+  //  Changed regions: many changes without update
+
+  db::Layout g;
+  RegionListener rl;
+
+  unsigned int l1 = g.insert_layer (db::LayerProperties (1, 0));
+  db::cell_index_type ci = g.add_cell ("TOP");
+  db::Cell &top = g.cell (ci);
+
+  g.region_changed_event.add (&rl, &RegionListener::region_changed);
+
+  //  after the first 64 regions, the whole layer is reported once
+  for (int i = 0; i < 100; ++i) {
+    top.shapes (l1).insert (db::Box (i * 10, 0, i * 10 + 5, 5));
+  }
+
+  std::string expected;
+  for (int i = 0; i < 64; ++i) {
+    expected += "0:0:" + db::Box (i * 10, 0, i * 10 + 5, 5).to_string () + ";";
+  }
+  expected += "0:0:*";
+  EXPECT_EQ (rl.regions, expected);
+
+  //  after an update, the regions are reported again
+  g.update ();
+  rl.regions.clear ();
+  top.shapes (l1).insert (db::Box (0, 100, 10, 110));
+  EXPECT_EQ (rl.regions, "0:0:(0,100;10,110)");
+}
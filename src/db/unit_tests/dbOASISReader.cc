@@ -22,11 +22,15 @@
 
 
 #include "dbOASISReader.h"
+#include "dbReader.h"
+#include "dbCommonReader.h"
 #include "dbTextWriter.h"
 #include "tlLog.h"
+#include "dbTestSupport.h"
 #include "tlUnitTest.h"
 
 #include <stdlib.h>
+#include <map>
 
 TEST(1_1)
 {
@@ -4125,3 +4129,99 @@ TEST(100)
   EXPECT_EQ (std::string (os.string ()), std::string (expected))
 }
 
+//  Streaming mode
+TEST(101)
+{
+  std::string fn (tl::testsrc ());
+  fn += "/testdata/oasis/xgeometry_test.oas";
+
+  db::Layout layout;
+  {
+    tl::InputStream stream (fn);
+    db::Reader reader (stream);
+    reader.read (layout);
+  }
+
+  db::CountingReaderReceiver rec;
+  {
+    tl::InputStream stream (fn);
+    db::Reader reader (stream);
+    reader.read (rec, db::LoadLayoutOptions ());
+  }
+
+  size_t nrec = rec.m_counts_by_name.size ();
+
+  size_t ncells = 0;
+  for (db::Layout::const_iterator c = layout.begin (); c != layout.end (); ++c) {
+
+    if (c->is_ghost_cell ()) {
+      continue;
+    }
+    ++ncells;
+
+    size_t nshapes = 0;
+    for (unsigned int l = 0; l < layout.layers (); ++l) {
+      if (layout.is_valid_layer (l)) {
+        for (db::ShapeIterator s = c->shapes (l).begin (db::ShapeIterator::All); ! s.at_end (); ++s) {
+          ++nshapes;
+        }
+      }
+    }
+
+    std::pair<size_t, size_t> counts = rec.m_counts_by_name [layout.cell_name (c->cell_index ())];
+    EXPECT_EQ (counts.first, nshapes);
+    EXPECT_EQ (counts.second, c->cell_instances ());
+
+  }
+
+  EXPECT_EQ (nrec, ncells);
+}
+
+//  Skipping of shapes on unmapped layers must maintain the modal property variables
+TEST(102)
+{
+  const char *expected = 
+    "begin_lib 0.001\n"
+    "begin_cell {A}\n"
+    "set props {\n"
+    "  {{PROP0} {25,-124,Property string value for ID 13}}\n"
+    "}\n"
+    "textp $props 2 1 0 0 {1000 0} {A}\n"
+    "end_cell\n"
+    "end_lib\n"
+  ;
+
+  std::string fn (tl::testsrc ());
+  fn += "/testdata/oasis/t11.1.oas";
+
+  db::Layout layout_full;
+  {
+    tl::InputStream stream (fn);
+    db::Reader reader (stream);
+    reader.read (layout_full);
+  }
+
+  db::Layout layout;
+  {
+    db::LayerMap lmap;
+    lmap.map (db::LDPair (2, 1), layout.insert_layer (db::LayerProperties (2, 1)));
+
+    db::LoadLayoutOptions options;
+    options.get_options<db::CommonReaderOptions> ().layer_map = lmap;
+    options.get_options<db::CommonReaderOptions> ().create_other_layers = false;
+
+    tl::InputStream stream (fn);
+    db::Reader reader (stream);
+    reader.set_warnings_as_errors (true);
+    reader.read (layout, options);
+  }
+
+  tl::OutputStringStream os;
+  tl::OutputStream ostream (os);
+  db::TextWriter writer (ostream);
+  writer.write (layout);
+  EXPECT_EQ (std::string (os.string ()), std::string (expected))
+
+  //  the properties of the skipped shapes are not registered
+  EXPECT_EQ (layout.properties_repository ().end_id () < layout_full.properties_repository ().end_id (), true);
+}
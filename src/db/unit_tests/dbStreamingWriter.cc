@@ -0,0 +1,186 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "dbStreamingWriter.h"
+#include "dbTilingProcessor.h"
+#include "dbLayoutDiff.h"
+#include "dbReader.h"
+#include "dbGDS2WriterBase.h"
+#include "dbOASISWriter.h"
+#include "tlUnitTest.h"
+
+static void make_ref_layout (db::Layout &ly)
+{
+  unsigned int l1 = ly.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = ly.insert_layer (db::LayerProperties (2, 0));
+
+  db::cell_index_type top = ly.add_cell ("TOP");
+  db::cell_index_type child = ly.add_cell ("CHILD");
+
+  for (int i = 0; i < 20; ++i) {
+    ly.cell (child).shapes (l1).insert (db::Box (i * 100, 0, i * 100 + 50, 500));
+  }
+  ly.cell (child).shapes (l2).insert (db::Polygon (db::Box (0, 0, 2000, 100)));
+  ly.cell (child).shapes (l2).insert (db::Text ("T", db::Trans (db::Vector (100, 200))));
+
+  ly.cell (top).shapes (l1).insert (db::Box (-1000, -1000, 5000, -500));
+  ly.cell (top).insert (db::CellInstArray (db::CellInst (child), db::Trans (), db::Vector (0, 1000), db::Vector (3000, 0), 3, 2));
+  ly.cell (top).insert (db::CellInstArray (db::CellInst (child), db::Trans (db::Trans::r90, db::Vector (-2000, 0))));
+}
+
+static void write_streaming (const db::Layout &ly, tl::OutputStream &stream, const db::SaveLayoutOptions &options)
+{
+  db::StreamingWriter writer (stream, options, ly.dbu ());
+  writer.set_buffer_size (7);
+
+  std::map<unsigned int, unsigned int> layer_map;
+  for (db::Layout::layer_iterator l = ly.begin_layers (); l != ly.end_layers (); ++l) {
+    layer_map [(*l).first] = writer.add_layer (*(*l).second);
+  }
+
+  std::map<db::cell_index_type, db::cell_index_type> cell_map;
+  for (db::Layout::const_iterator c = ly.begin (); c != ly.end (); ++c) {
+    cell_map [c->cell_index ()] = writer.add_cell (ly.cell_name (c->cell_index ()));
+  }
+
+  //  top-down order: child cells are referenced before they are written
+  for (db::Layout::top_down_const_iterator c = ly.begin_top_down (); c != ly.end_top_down (); ++c) {
+
+    const db::Cell &cell = ly.cell (*c);
+    writer.begin_cell (cell_map [*c]);
+
+    for (db::Cell::const_iterator i = cell.begin (); ! i.at_end (); ++i) {
+      db::CellInstArray inst = i->cell_inst ();
+      inst.object ().cell_index (cell_map [inst.object ().cell_index ()]);
+      writer.insert (inst);
+    }
+
+    for (std::map<unsigned int, unsigned int>::const_iterator l = layer_map.begin (); l != layer_map.end (); ++l) {
+      for (db::ShapeIterator s = cell.shapes (l->first).begin (db::ShapeIterator::All); ! s.at_end (); ++s) {
+        if (s->is_box ()) {
+          writer.insert (l->second, s->box ());
+        } else if (s->is_text ()) {
+          db::Text t;
+          s->text (t);
+          writer.insert (l->second, t);
+        } else {
+          db::Polygon p;
+          s->polygon (p);
+          writer.insert (l->second, p);
+        }
+      }
+    }
+
+    writer.end_cell ();
+
+  }
+
+  writer.finish ();
+}
+
+static void run_test (tl::TestBase *_this, const std::string &format, const char *ext)
+{
+  db::Layout ly;
+  make_ref_layout (ly);
+
+  std::string tmp_file = _this->tmp_file (std::string ("tmp.") + ext);
+
+  {
+    tl::OutputStream stream (tmp_file);
+    db::SaveLayoutOptions options;
+    options.set_format (format);
+    write_streaming (ly, stream, options);
+  }
+
+  db::Layout ly_read;
+  {
+    tl::InputStream file (tmp_file);
+    db::Reader reader (file);
+    reader.read (ly_read);
+  }
+
+  bool equal = db::compare_layouts (ly, ly_read, db::layout_diff::f_verbose, 0);
+  EXPECT_EQ (equal, true);
+}
+
+TEST(1_GDS2)
+{
+  run_test (_this, "GDS2", "gds");
+}
+
+TEST(2_OASIS)
+{
+  run_test (_this, "OASIS", "oas");
+}
+
+//  TilingProcessor output to a streaming writer
+TEST(3)
+{
+  db::Layout ly;
+  unsigned int l1 = ly.insert_layer (db::LayerProperties (1, 0));
+  db::cell_index_type ly_top = ly.add_cell ("TOP");
+
+  db::Region r;
+  for (int i = 0; i < 100; ++i) {
+    db::Box b (i * 1000, 0, i * 1000 + 500, 1000);
+    ly.cell (ly_top).shapes (l1).insert (b);
+    r.insert (b);
+  }
+
+  std::string tmp_file = _this->tmp_file ("tmp.gds");
+
+  {
+    tl::OutputStream stream (tmp_file);
+    db::SaveLayoutOptions options;
+    options.set_format ("GDS2");
+
+    db::StreamingWriter writer (stream, options, 0.001);
+    writer.set_buffer_size (10);
+    db::cell_index_type top = writer.add_cell ("TOP");
+
+    db::TilingProcessor tp;
+    tp.input ("i", db::RecursiveShapeIterator (ly, ly.cell (ly_top), l1));
+    tp.output ("o", writer, top, db::LayerProperties (10, 0));
+    tp.queue ("_output(o, i)");
+    tp.tile_size (10.0, 10.0);
+    tp.set_threads (2);
+    tp.execute ("test");
+
+    writer.end_cell ();
+    writer.finish ();
+  }
+
+  db::Layout ly_read;
+  {
+    tl::InputStream file (tmp_file);
+    db::Reader reader (file);
+    reader.read (ly_read);
+  }
+
+  EXPECT_EQ (ly_read.cells (), size_t (1));
+  std::pair<bool, db::cell_index_type> top = ly_read.cell_by_name ("TOP");
+  EXPECT_EQ (top.first, true);
+
+  db::Region rr (db::RecursiveShapeIterator (ly_read, ly_read.cell (top.second), 0));
+  EXPECT_EQ ((rr ^ r).empty (), true);
+}
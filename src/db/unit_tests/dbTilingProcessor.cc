@@ -30,6 +30,7 @@
 #include "dbSaveLayoutOptions.h"
 
 #include <cstdlib>
+#include <set>
 
 unsigned int get_rand()
 {
@@ -385,3 +386,371 @@ TEST(4)
 
 }
 
+
+class AndOutsideOperation
+  : public db::TileOperation
+{
+public:
+  virtual void process (db::TileContext &context) const
+  {
+    db::Region r = context.region (0) & context.region (1);
+    if (context.has_tiles ()) {
+      r &= db::Region (context.tile ());
+    }
+    context.output (0, r, false);
+
+    if (! context.has_tiles ()) {
+      context.output (1, context.region (0).selected_outside (context.region (1)), false);
+    } else {
+      context.output (2, db::Region (context.tile ()), false);
+    }
+  }
+};
+
+TEST(5)
+{
+  //  native tile operations vs. scripts
+
+  db::Layout ly;
+  unsigned int l1 = ly.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = ly.insert_layer (db::LayerProperties (2, 0));
+  unsigned int o1 = ly.insert_layer (db::LayerProperties (10, 0));
+  unsigned int o2 = ly.insert_layer (db::LayerProperties (11, 0));
+  unsigned int o3 = ly.insert_layer (db::LayerProperties (12, 0));
+  db::cell_index_type top = ly.add_cell ("TOP");
+  db::cell_index_type c1 = ly.add_cell ("C1");
+  db::cell_index_type c2 = ly.add_cell ("C2");
+  ly.cell (c1).shapes (l1).insert (db::Box (0, 0, 30, 30));
+  ly.cell (c2).shapes (l2).insert (db::Box (0, 0, 30, 30));
+  ly.cell (top).insert (db::CellInstArray (c1, db::Trans (db::Vector (0, 0))));
+  ly.cell (top).insert (db::CellInstArray (c1, db::Trans (db::Vector (50, 0))));
+  ly.cell (top).insert (db::CellInstArray (c1, db::Trans (db::Vector (50, 40))));
+  ly.cell (top).insert (db::CellInstArray (c2, db::Trans (db::Vector (10, 10))));
+  ly.cell (top).insert (db::CellInstArray (c2, db::Trans (db::Vector (80, 40))));
+  ly.cell (top).insert (db::CellInstArray (c2, db::Trans (db::Vector (110, 40))));
+  ly.cell (top).shapes (l2).insert (db::Box (60, 10, 70, 20));
+
+  db::TilingProcessor tp;
+  EXPECT_EQ (tp.inputs (), size_t (0));
+  tp.input ("i1", db::RecursiveShapeIterator (ly, ly.cell (top), l1));
+  tp.input ("i2", db::RecursiveShapeIterator (ly, ly.cell (top), l2));
+  EXPECT_EQ (tp.inputs (), size_t (2));
+  tp.output ("o1", ly, top, o1);
+  tp.output ("o2", ly, top, o2);
+  tp.output ("o3", ly, top, o3);
+  EXPECT_EQ (tp.outputs (), size_t (3));
+  tp.queue (new AndOutsideOperation ());
+  tp.execute ("test");
+
+  EXPECT_EQ (to_s (ly, top, o1), "polygon (60,10;60,20;70,20;70,10);polygon (10,10;10,30;30,30;30,10)");
+  EXPECT_EQ (to_s (ly, top, o2), "polygon (50,40;50,70;80,70;80,40)");
+  EXPECT_EQ (to_s (ly, top, o3), "");
+
+  ly.clear_layer (o1);
+  ly.clear_layer (o2);
+
+  tp.tile_size (0.025, 0.025);
+  tp.execute ("test");
+
+  EXPECT_EQ (to_s (ly, top, o1), "polygon (10,10;10,23;20,23;20,10);polygon (10,23;10,30;20,30;20,23);polygon (20,10;20,23;30,23;30,10);polygon (20,23;20,30;30,30;30,23);polygon (60,10;60,20;70,20;70,10)");
+  EXPECT_EQ (to_s (ly, top, o2), "");
+  EXPECT_EQ (to_s (ly, top, o3), "polygon (-5,-2;-5,23;20,23;20,-2);polygon (-5,23;-5,48;20,48;20,23);polygon (-5,48;-5,73;20,73;20,48);polygon (20,-2;20,23;45,23;45,-2);polygon (20,23;20,48;45,48;45,23);polygon (20,48;20,73;45,73;45,48);polygon (45,-2;45,23;70,23;70,-2);polygon (45,23;45,48;70,48;70,23);polygon (45,48;45,73;70,73;70,48);polygon (70,-2;70,23;95,23;95,-2);polygon (70,23;70,48;95,48;95,23);polygon (70,48;70,73;95,73;95,48);polygon (95,-2;95,23;120,23;120,-2);polygon (95,23;95,48;120,48;120,23);polygon (95,48;95,73;120,73;120,48);polygon (120,-2;120,23;145,23;145,-2);polygon (120,23;120,48;145,48;145,23);polygon (120,48;120,73;145,73;145,48)");
+}
+
+class PutCountingReceiver
+  : public db::TileOutputReceiver
+{
+public:
+  PutCountingReceiver (bool sub_tiles = true)
+    : puts (0), m_sub_tiles (sub_tiles)
+  {
+    //  .. nothing yet ..
+  }
+
+  virtual void put (size_t ix, size_t iy, const db::Box & /*tile*/, size_t /*id*/, const tl::Variant & /*obj*/, double /*dbu*/, const db::ICplxTrans & /*trans*/, bool /*clip*/)
+  {
+    ++puts;
+    tiles.insert (std::make_pair (ix, iy));
+  }
+
+  virtual bool accepts_sub_tiles () const
+  {
+    return m_sub_tiles;
+  }
+
+  size_t puts;
+  std::set<std::pair<size_t, size_t> > tiles;
+
+private:
+  bool m_sub_tiles;
+};
+
+TEST(6)
+{
+  //  adaptive tiling
+
+  db::Layout ly;
+  unsigned int l1 = ly.insert_layer (db::LayerProperties (1, 0));
+  unsigned int o1 = ly.insert_layer (db::LayerProperties (10, 0));
+  unsigned int o2 = ly.insert_layer (db::LayerProperties (11, 0));
+  db::cell_index_type top = ly.add_cell ("TOP");
+
+  //  a dense cluster in the lower left and a single box in the upper right corner
+  for (int x = 0; x < 40; ++x) {
+    for (int y = 0; y < 40; ++y) {
+      ly.cell (top).shapes (l1).insert (db::Box (x * 50, y * 50, x * 50 + 30, y * 50 + 30));
+    }
+  }
+  ly.cell (top).shapes (l1).insert (db::Box (19000, 19000, 20000, 20000));
+
+  size_t puts_plain = 0, puts_adaptive = 0;
+
+  for (int adaptive = 0; adaptive < 2; ++adaptive) {
+
+    PutCountingReceiver *counter = new PutCountingReceiver ();
+
+    db::TilingProcessor tp;
+    tp.input ("i1", db::RecursiveShapeIterator (ly, ly.cell (top), l1));
+    tp.output ("o", ly, top, adaptive ? o2 : o1);
+    tp.output ("c", 0, counter, db::ICplxTrans ());
+    tp.tile_size (4.0, 4.0);
+    tp.tile_border (0.1, 0.1);
+    tp.set_adaptive (adaptive != 0);
+    EXPECT_EQ (tp.adaptive (), adaptive != 0);
+    tp.set_threads (2);
+    tp.queue ("var x = i1.sized(10); _output(o, x); _output(c, x)");
+    tp.execute ("test");
+
+    (adaptive ? puts_adaptive : puts_plain) = counter->puts;
+
+  }
+
+  //  6x6 tiles without adaptive mode, the dense tile is split in adaptive mode
+  EXPECT_EQ (puts_plain, size_t (36));
+  EXPECT_EQ (puts_adaptive > puts_plain, true);
+
+  db::Region r1 (db::RecursiveShapeIterator (ly, ly.cell (top), o1));
+  db::Region r2 (db::RecursiveShapeIterator (ly, ly.cell (top), o2));
+  EXPECT_EQ (r1.empty (), false);
+  EXPECT_EQ ((r1 ^ r2).empty (), true);
+  EXPECT_EQ (r1.area (), r2.area ());
+}
+
+TEST(7)
+{
+  //  input caching
+
+  db::Layout ly;
+  unsigned int l1 = ly.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = ly.insert_layer (db::LayerProperties (2, 0));
+  unsigned int o1 = ly.insert_layer (db::LayerProperties (10, 0));
+  unsigned int o2 = ly.insert_layer (db::LayerProperties (11, 0));
+  unsigned int o3 = ly.insert_layer (db::LayerProperties (12, 0));
+  db::cell_index_type top = ly.add_cell ("TOP");
+  db::cell_index_type c1 = ly.add_cell ("C1");
+  db::cell_index_type c2 = ly.add_cell ("C2");
+  ly.cell (c1).shapes (l1).insert (db::Box (0, 0, 30, 30));
+  ly.cell (c2).shapes (l2).insert (db::Box (0, 0, 30, 30));
+  ly.cell (top).insert (db::CellInstArray (c1, db::Trans (db::Vector (0, 0))));
+  ly.cell (top).insert (db::CellInstArray (c1, db::Trans (db::Vector (50, 0))));
+  ly.cell (top).insert (db::CellInstArray (c1, db::Trans (db::Vector (50, 40))));
+  ly.cell (top).insert (db::CellInstArray (c2, db::Trans (db::Vector (10, 10))));
+  ly.cell (top).insert (db::CellInstArray (c2, db::Trans (db::Vector (80, 40))));
+  ly.cell (top).insert (db::CellInstArray (c2, db::Trans (db::Vector (110, 40))));
+  ly.cell (top).shapes (l2).insert (db::Box (60, 10, 70, 20));
+
+  std::string o1_expected = "polygon (10,10;10,23;20,23;20,10);polygon (10,23;10,30;20,30;20,23);polygon (20,10;20,23;30,23;30,10);polygon (20,23;20,30;30,30;30,23);polygon (60,10;60,20;70,20;70,10)";
+
+  for (int mode = 0; mode < 2; ++mode) {
+
+    ly.clear_layer (o1);
+    ly.clear_layer (o2);
+    ly.clear_layer (o3);
+
+    db::TilingProcessor tp;
+    tp.input ("i1", db::RecursiveShapeIterator (ly, ly.cell (top), l1));
+    tp.input ("i2", db::RecursiveShapeIterator (ly, ly.cell (top), l2));
+    tp.output ("o1", ly, top, o1);
+    tp.output ("o2", ly, top, o2);
+    tp.output ("o3", ly, top, o3);
+    if (mode == 0) {
+      tp.queue ("_output(o1, _tile ? (i1 & i2 & _tile) : (i1 & i2), false)");
+      tp.queue ("!_tile && _output(o2, i1.outside(i2), false)");
+    } else {
+      tp.queue (new AndOutsideOperation ());
+    }
+    tp.tile_size (0.025, 0.025);
+    tp.set_cache_inputs (true);
+    EXPECT_EQ (tp.cache_inputs (), true);
+    tp.execute ("test");
+
+    EXPECT_EQ (to_s (ly, top, o1), o1_expected);
+    EXPECT_EQ (to_s (ly, top, o2), "");
+
+  }
+}
+
+#if !defined(_WIN32)
+
+TEST(8)
+{
+  //  multi-process execution
+
+  db::Layout ly;
+  unsigned int l1 = ly.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = ly.insert_layer (db::LayerProperties (2, 0));
+  db::cell_index_type top = ly.add_cell ("TOP");
+
+  for (int x = 0; x < 20; ++x) {
+    for (int y = 0; y < 20; ++y) {
+      ly.cell (top).shapes (l1).insert (db::Box (x * 100, y * 100, x * 100 + 60, y * 100 + 60));
+      ly.cell (top).shapes (l2).insert (db::Box (x * 100 + 30, y * 100 + 30, x * 100 + 90, y * 100 + 90));
+    }
+  }
+
+  unsigned int o[2][3];
+  size_t edge_pairs[2] = { 0, 0 };
+  double area[2] = { 0.0, 0.0 };
+
+  for (int mode = 0; mode < 2; ++mode) {
+
+    for (int i = 0; i < 3; ++i) {
+      o[mode][i] = ly.insert_layer (db::LayerProperties (10 + mode * 10 + i, 0));
+    }
+
+    db::EdgePairs ep;
+
+    db::TilingProcessor tp;
+    tp.input ("i1", db::RecursiveShapeIterator (ly, ly.cell (top), l1));
+    tp.input ("i2", db::RecursiveShapeIterator (ly, ly.cell (top), l2));
+    tp.output ("o1", ly, top, o[mode][0]);
+    tp.output ("o2", ly, top, o[mode][1]);
+    tp.output ("o3", ly, top, o[mode][2]);
+    tp.output ("ep", ep);
+    tp.tile_size (0.5, 0.5);
+    tp.tile_border (0.1, 0.1);
+    tp.set_processes (mode == 0 ? 0 : 3);
+    EXPECT_EQ (tp.processes (), size_t (mode == 0 ? 0 : 3));
+    tp.queue ("_output(o1, i1 & i2)");
+    tp.queue ("_output(o2, i1 ^ i2)");
+    tp.queue ("_output(o3, (i1 - i2).sized(5))");
+    tp.queue ("_output(ep, i1.space_check(50))");
+    tp.queue (new AndOutsideOperation ());
+    tp.execute ("test");
+
+    edge_pairs[mode] = ep.size ();
+    area[mode] = db::Region (db::RecursiveShapeIterator (ly, ly.cell (top), o[mode][0])).area ();
+
+  }
+
+  for (int i = 0; i < 3; ++i) {
+    db::Region r0 (db::RecursiveShapeIterator (ly, ly.cell (top), o[0][i]));
+    db::Region r1 (db::RecursiveShapeIterator (ly, ly.cell (top), o[1][i]));
+    EXPECT_EQ (r0.empty (), false);
+    EXPECT_EQ ((r0 ^ r1).empty (), true);
+  }
+
+  EXPECT_EQ (edge_pairs[0] > 0, true);
+  EXPECT_EQ (edge_pairs[1], edge_pairs[0]);
+  EXPECT_EQ (area[1], area[0]);
+}
+
+#endif
+
+TEST(9)
+{
+  //  adaptive tiling with a hierarchical input
+
+  db::Layout ly;
+  unsigned int l1 = ly.insert_layer (db::LayerProperties (1, 0));
+  unsigned int o1 = ly.insert_layer (db::LayerProperties (10, 0));
+  unsigned int o2 = ly.insert_layer (db::LayerProperties (11, 0));
+  db::cell_index_type top = ly.add_cell ("TOP");
+  db::cell_index_type c1 = ly.add_cell ("C1");
+  db::cell_index_type c2 = ly.add_cell ("C2");
+
+  //  a dense cluster in the lower left formed by an array of arrays and a single 
+  //  box in the upper right corner
+  ly.cell (c1).shapes (l1).insert (db::Box (0, 0, 30, 30));
+  ly.cell (c2).insert (db::CellInstArray (db::CellInst (c1), db::Trans (), db::Vector (50, 0), db::Vector (0, 50), 4, 4));
+  ly.cell (top).insert (db::CellInstArray (db::CellInst (c2), db::Trans (), db::Vector (200, 0), db::Vector (0, 200), 10, 10));
+  ly.cell (top).shapes (l1).insert (db::Box (19000, 19000, 20000, 20000));
+
+  size_t puts_plain = 0, puts_adaptive = 0;
+
+  for (int adaptive = 0; adaptive < 2; ++adaptive) {
+
+    PutCountingReceiver *counter = new PutCountingReceiver ();
+
+    db::TilingProcessor tp;
+    tp.input ("i1", db::RecursiveShapeIterator (ly, ly.cell (top), l1));
+    tp.output ("o", ly, top, adaptive ? o2 : o1);
+    tp.output ("c", 0, counter, db::ICplxTrans ());
+    tp.tile_size (4.0, 4.0);
+    tp.tile_border (0.1, 0.1);
+    tp.set_adaptive (adaptive != 0);
+    tp.set_threads (2);
+    tp.queue ("var x = i1.sized(10); _output(o, x); _output(c, x)");
+    tp.execute ("test");
+
+    (adaptive ? puts_adaptive : puts_plain) = counter->puts;
+
+  }
+
+  //  the dense tile is split in adaptive mode like for the flat case
+  EXPECT_EQ (puts_plain, size_t (36));
+  EXPECT_EQ (puts_adaptive > puts_plain, true);
+
+  db::Region r1 (db::RecursiveShapeIterator (ly, ly.cell (top), o1));
+  db::Region r2 (db::RecursiveShapeIterator (ly, ly.cell (top), o2));
+  EXPECT_EQ (r1.empty (), false);
+  EXPECT_EQ ((r1 ^ r2).empty (), true);
+  EXPECT_EQ (r1.area (), r2.area ());
+}
+
+TEST(10)
+{
+  //  adaptive tiling with a receiver not accepting sub-tiles and input caching
+
+  db::Layout ly;
+  unsigned int l1 = ly.insert_layer (db::LayerProperties (1, 0));
+  unsigned int o1 = ly.insert_layer (db::LayerProperties (10, 0));
+  unsigned int o2 = ly.insert_layer (db::LayerProperties (11, 0));
+  db::cell_index_type top = ly.add_cell ("TOP");
+
+  for (int x = 0; x < 40; ++x) {
+    for (int y = 0; y < 40; ++y) {
+      ly.cell (top).shapes (l1).insert (db::Box (x * 50, y * 50, x * 50 + 30, y * 50 + 30));
+    }
+  }
+  for (int x = 0; x < 6; ++x) {
+    ly.cell (top).shapes (l1).insert (db::Box (x * 4000, 19000, x * 4000 + 1000, 20000));
+  }
+
+  for (int adaptive = 0; adaptive < 2; ++adaptive) {
+
+    PutCountingReceiver *counter = new PutCountingReceiver (false);
+
+    db::TilingProcessor tp;
+    tp.input ("i1", db::RecursiveShapeIterator (ly, ly.cell (top), l1));
+    tp.output ("o", ly, top, adaptive ? o2 : o1);
+    tp.output ("c", 0, counter, db::ICplxTrans ());
+    tp.tile_size (4.0, 4.0);
+    tp.tile_border (0.1, 0.1);
+    tp.set_adaptive (adaptive != 0);
+    tp.set_cache_inputs (true);
+    tp.set_threads (2);
+    tp.queue ("var x = i1.sized(10); _output(o, x); _output(c, x)");
+    tp.execute ("test");
+
+    //  one put per tile - the receiver does not see sub-tiles
+    EXPECT_EQ (counter->puts, size_t (36));
+    EXPECT_EQ (counter->tiles.size (), size_t (36));
+
+  }
+
+  db::Region r1 (db::RecursiveShapeIterator (ly, ly.cell (top), o1));
+  db::Region r2 (db::RecursiveShapeIterator (ly, ly.cell (top), o2));
+  EXPECT_EQ (r1.empty (), false);
+  EXPECT_EQ ((r1 ^ r2).empty (), true);
+}
@@ -53,6 +53,7 @@ SOURCES = \
   dbShapeRepository.cc \
   dbShapes.cc \
   dbStreamLayers.cc \
+  dbStreamingWriter.cc \
   dbText.cc \
   dbTilingProcessor.cc \
   dbTrans.cc \
@@ -24,6 +24,8 @@
 #include "dbReader.h"
 #include "dbTestSupport.h"
 #include "lymMacro.h"
+#include "dbRegion.h"
+#include "dbRecursiveShapeIterator.h"
 
 TEST(1)
 {
@@ -141,3 +143,122 @@ TEST(3)
 
   db::compare_layouts (_this, layout, au, db::NoNormalization);
 }
+
+//  runs a test script which produces layers 100.. in normal mode and the same layers
+//  in 200.. in a special mode and compares both
+static void run_mode_test (tl::TestBase *_this, const std::string &file)
+{
+  std::string rs = tl::testsrc ();
+  rs += "/testdata/drc/";
+  rs += file;
+
+  std::string input = tl::testsrc ();
+  input += "/testdata/drc/drctest.gds";
+
+  std::string output = _this->tmp_file ("tmp.gds");
+
+  {
+    //  Set some variables
+    lym::Macro config;
+    config.set_text (tl::sprintf (
+        "$drc_test_source = \"%s\"\n"
+        "$drc_test_target = \"%s\"\n"
+      , input, output)
+    );
+    config.set_interpreter (lym::Macro::Ruby);
+    EXPECT_EQ (config.run (), 0);
+  }
+
+  lym::Macro drc;
+  drc.load_from (rs);
+  EXPECT_EQ (drc.run (), 0);
+
+  db::Layout layout;
+
+  {
+    tl::InputStream stream (output);
+    db::Reader reader (stream);
+    reader.read (layout);
+  }
+
+  db::cell_index_type top = layout.cell_by_name ("TOP").second;
+
+  for (int l = 100; l < 200; ++l) {
+
+    unsigned int l_ref = 0, l_mode = 0;
+    bool has_ref = false;
+    for (db::Layout::layer_iterator li = layout.begin_layers (); li != layout.end_layers (); ++li) {
+      if ((*li).second->log_equal (db::LayerProperties (l, 0))) {
+        l_ref = (*li).first;
+        has_ref = true;
+      } else if ((*li).second->log_equal (db::LayerProperties (l + 100, 0))) {
+        l_mode = (*li).first;
+      }
+    }
+
+    //  the test script produces consecutive layers starting with 100
+    if (! has_ref) {
+      EXPECT_EQ (l > 100, true);
+      break;
+    }
+
+    db::Region r_ref (db::RecursiveShapeIterator (layout, layout.cell (top), l_ref));
+    db::Region r_mode (db::RecursiveShapeIterator (layout, layout.cell (top), l_mode));
+
+    EXPECT_EQ (r_ref.empty (), false);
+    EXPECT_EQ ((r_ref ^ r_mode).to_string (), "");
+
+  }
+}
+
+//  fused tiling mode must render the same results than flat mode
+TEST(4)
+{
+  run_mode_test (_this, "drcSimpleTests_4.drc");
+}
+
+//  deferred mode must render the same results than normal mode
+TEST(5)
+{
+  run_mode_test (_this, "drcSimpleTests_5.drc");
+}
+
+//  profiling mode
+TEST(6)
+{
+  std::string rs = tl::testsrc ();
+  rs += "/testdata/drc/drcSimpleTests_6.drc";
+
+  std::string input = tl::testsrc ();
+  input += "/testdata/drc/drctest.gds";
+
+  std::string output = this->tmp_file ("tmp.gds");
+  std::string profile = this->tmp_file ("profile.json");
+
+  {
+    //  Set some variables
+    lym::Macro config;
+    config.set_text (tl::sprintf (
+        "$drc_test_source = \"%s\"\n"
+        "$drc_test_target = \"%s\"\n"
+        "$drc_test_profile = \"%s\"\n"
+      , input, output, profile)
+    );
+    config.set_interpreter (lym::Macro::Ruby);
+    EXPECT_EQ (config.run (), 0);
+  }
+
+  lym::Macro drc;
+  drc.load_from (rs);
+  EXPECT_EQ (drc.run (), 0);
+
+  std::string json;
+  {
+    tl::InputStream stream (profile);
+    json = stream.read_all ();
+  }
+
+  EXPECT_EQ (json.find ("\"line\": \"drcSimpleTests_6.drc:11\", \"operations\": [ \"sized\", \"&\" ], \"modes\": [ \"flat") != std::string::npos, true);
+  EXPECT_EQ (json.find ("\"line\": \"drcSimpleTests_6.drc:13\", \"operations\": [ \"space_check\" ]") != std::string::npos, true);
+  EXPECT_EQ (json.find ("\"total_wall\": ") != std::string::npos, true);
+}
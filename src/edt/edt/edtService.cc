@@ -37,6 +37,9 @@
 namespace edt
 {
 
+//  Shape selections with more objects are displayed with bulk markers
+const size_t max_individual_shape_markers = 10000;
+
 // -------------------------------------------------------------
 //  Convert buttons to an angle constraint
 
@@ -241,7 +244,8 @@ void
 Service::highlight (unsigned int n)
 {
   for (std::vector<lay::ViewObject *>::iterator r = m_markers.begin (); r != m_markers.end (); ++r) {
-    (*r)->visible (n-- == 0);
+    //  bulk markers represent many objects and cannot highlight a single one
+    (*r)->visible (n-- == 0 || dynamic_cast<lay::BulkMarker *> (*r) != 0);
   }
 }
 
@@ -1346,12 +1350,18 @@ Service::move_markers (const db::DTrans &t)
 
     for (std::vector<lay::ViewObject *>::iterator r = m_markers.begin (); r != m_markers.end (); ++r) {
 
+      db::DCplxTrans dt = db::DCplxTrans (t) * db::DCplxTrans (m_move_trans).inverted ();
+
       lay::GenericMarkerBase *marker = dynamic_cast<lay::GenericMarkerBase *> (*r);
       if (marker) {
-        db::DCplxTrans dt = db::DCplxTrans (t) * db::DCplxTrans (m_move_trans).inverted ();
         marker->set_trans (dt * marker->trans ());
       }
 
+      lay::BulkMarker *bulk_marker = dynamic_cast<lay::BulkMarker *> (*r);
+      if (bulk_marker) {
+        bulk_marker->set_trans (dt * bulk_marker->trans ());
+      }
+
     }
 
     m_move_trans = t;
@@ -1377,6 +1387,11 @@ Service::selection_to_view ()
 void 
 Service::do_selection_to_view ()
 {
+  if (! m_cell_inst_service && m_selection.size () > max_individual_shape_markers) {
+    do_bulk_selection_to_view ();
+    return;
+  }
+
   //  Hint: this is a lower bound:
   m_markers.reserve (m_selection.size ());
 
@@ -1458,6 +1473,59 @@ Service::do_selection_to_view ()
   }
 }
 
+void 
+Service::do_bulk_selection_to_view ()
+{
+  //  One marker for the primary and one for the secondary selection. Texts get their own 
+  //  marker since their origins are shown as crosses.
+  lay::BulkMarker *primary = new lay::BulkMarker (view ());
+  lay::BulkMarker *secondary = new lay::BulkMarker (view ());
+  if (m_indicate_secondary_selection) {
+    secondary->set_dither_pattern (3);
+  }
+  lay::BulkMarker *texts = new lay::BulkMarker (view ());
+  texts->set_vertex_shape (lay::ViewOp::Cross);
+  texts->set_vertex_size (9 /*cross vertex size*/);
+
+  //  build the transformation variants cache
+  TransformationVariants tv (view ());
+
+  for (std::set<lay::ObjectInstPath>::iterator r = m_selection.begin (); r != m_selection.end (); ++r) {
+
+    const std::vector<db::DCplxTrans> *tv_list = tv.per_cv_and_layer (r->cv_index (), r->layer ());
+    if (tv_list == 0) {
+      continue;
+    }
+
+    const lay::CellView &cv = view ()->cellview (r->cv_index ());
+
+    //  compute the global transformation including movement, context and explicit transformation
+    double dbu = cv->layout ().dbu ();
+    db::ICplxTrans gt = db::VCplxTrans (1.0 / dbu) * db::DCplxTrans (m_move_trans) * db::CplxTrans (dbu) * cv.context_trans () * r->trans ();
+
+    lay::BulkMarker *marker = primary;
+    if (r->shape ().is_text ()) {
+      marker = texts;
+    } else if (r->seq () > 0) {
+      marker = secondary;
+    }
+
+    for (std::vector<db::DCplxTrans>::const_iterator t = tv_list->begin (); t != tv_list->end (); ++t) {
+      marker->insert (r->shape (), *t * db::CplxTrans (dbu) * gt);
+    }
+
+  }
+
+  lay::BulkMarker *markers[] = { primary, secondary, texts };
+  for (unsigned int i = 0; i < sizeof (markers) / sizeof (markers [0]); ++i) {
+    if (markers [i]->empty ()) {
+      delete markers [i];
+    } else {
+      m_markers.push_back (markers [i]);
+    }
+  }
+}
+
 void 
 Service::set_selection (std::vector <lay::ObjectInstPath>::const_iterator s1, std::vector <lay::ObjectInstPath>::const_iterator s2)
 {
@@ -559,6 +559,11 @@ private:
    */
   void do_selection_to_view ();
 
+  /**
+   *  @brief Update m_markers for a large shape selection using bulk markers
+   */
+  void do_bulk_selection_to_view ();
+
   /**
    *  @brief Update m_markers with the new transformation to reflect the movement
    */
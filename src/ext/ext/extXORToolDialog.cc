@@ -31,7 +31,7 @@
 #include "dbLayoutUtils.h"
 #include "tlTimer.h"
 #include "tlProgress.h"
-#include "tlThreadedWorkers.h"
+#include "tlThreadPool.h"
 #include "tlExceptions.h"
 #include "tlMath.h"
 #include "layCellView.h"
@@ -42,6 +42,7 @@
 #include "ui_XORToolDialog.h"
 
 #include <stdio.h>
+#include <memory>
 
 #include <QMessageBox>
 
@@ -351,8 +352,15 @@ XORToolDialog::output_changed (int index)
 }
 
 
+class XORTask;
+
+/**
+ *  @brief The XOR job: holds the configuration and collects the results
+ *
+ *  The XOR tasks are collected first and are executed in a thread pool
+ *  with "run".
+ */
 class XORJob
-  : public tl::JobBase
 {
 public:
   enum EmptyLayerHandling
@@ -362,8 +370,7 @@ public:
     EL_process          // include in processing - the non-empty layer will be merged
   };
 
-  XORJob (int nworkers, 
-          output_mode_t output_mode, 
+  XORJob (output_mode_t output_mode, 
           db::BooleanOp::BoolOp op,
           EmptyLayerHandling el_handling,
           double dbu,
@@ -375,8 +382,7 @@ public:
           const std::vector <std::vector <unsigned int> > &sub_output_layers,
           rdb::Database *rdb,
           rdb::Cell *rdb_cell)
-    : tl::JobBase (nworkers),
-      m_output_mode (output_mode),
+    : m_output_mode (output_mode),
       m_op (op),
       m_el_handling (el_handling),
       m_has_tiles (false),
@@ -390,7 +396,6 @@ public:
       m_sub_output_layers (sub_output_layers),
       m_rdb (rdb),
       m_rdb_cell (rdb_cell),
-      m_progress (0),
       m_nx (0), m_ny (0)
   {
   }
@@ -449,7 +454,6 @@ public:
 
   void next_progress () 
   {
-    QMutexLocker locker (&m_mutex);
     ++m_progress;
   }
 
@@ -475,15 +479,13 @@ public:
 
   void update_progress (XORProgress &progress)
   {
-    unsigned int p;
     {
       QMutexLocker locker (&m_mutex);
-      p = m_progress;
       progress.configure (m_dbu, m_nx, m_ny, m_tolerances);
       progress.merge_results (m_results);
     }    
 
-    progress.set (p, true /*force yield*/);
+    progress.set (m_progress.get (), true /*force yield*/);
   }
 
   void issue_string (unsigned int tol_index, unsigned int layer_index, const std::string &s)
@@ -532,9 +534,17 @@ public:
     }
   }
 
-  virtual tl::Worker *create_worker ();
+  ~XORJob ();
+
+  void schedule (XORTask *task)
+  {
+    m_tasks.push_back (task);
+  }
+
+  void run (tl::TaskGroup &group);
 
 private:
+  std::vector<XORTask *> m_tasks;
   output_mode_t m_output_mode;
   db::BooleanOp::BoolOp m_op;
   EmptyLayerHandling m_el_handling;
@@ -549,7 +559,7 @@ private:
   std::vector <std::vector <unsigned int> > m_sub_output_layers;
   rdb::Database *m_rdb;
   rdb::Cell *m_rdb_cell;
-  unsigned int m_progress;
+  tl::ProgressCounter m_progress;
   QMutex m_mutex;
   std::string m_result_string;
   size_t m_nx, m_ny;
@@ -557,11 +567,11 @@ private:
 };
 
 class XORTask
-  : public tl::Task
+  : public tl::PoolTask
 {
 public:
-  XORTask (const std::string &tile_desc, const db::Box &clip_box, const db::Box &region_a, const db::Box &region_b, unsigned int layer_index, const db::LayerProperties &lp, const std::vector<unsigned int> &la, const std::vector<unsigned int> &lb, int ix, int iy)
-    : m_tile_desc (tile_desc), m_clip_box (clip_box), m_region_a (region_a), m_region_b (region_b), m_layer_index (layer_index), m_lp (lp), m_la (la), m_lb (lb), m_ix (ix), m_iy (iy)
+  XORTask (XORJob *job, const std::string &tile_desc, const db::Box &clip_box, const db::Box &region_a, const db::Box &region_b, unsigned int layer_index, const db::LayerProperties &lp, const std::vector<unsigned int> &la, const std::vector<unsigned int> &lb, int ix, int iy)
+    : mp_job (job), m_tile_desc (tile_desc), m_clip_box (clip_box), m_region_a (region_a), m_region_b (region_b), m_layer_index (layer_index), m_lp (lp), m_la (la), m_lb (lb), m_ix (ix), m_iy (iy)
   {
     //  .. nothing yet ..
   }
@@ -616,7 +626,10 @@ public:
     return m_iy;
   }
 
+  virtual void run ();
+
 private:
+  XORJob *mp_job;
   std::string m_tile_desc;
   db::Box m_clip_box, m_region_a, m_region_b;
   unsigned int m_layer_index;
@@ -626,27 +639,18 @@ private:
 };
 
 class XORWorker
-  : public tl::Worker
 {
 public:
   XORWorker (XORJob *job)
-    : tl::Worker (), mp_job (job)
+    : mp_job (job)
   {
     //  .. nothing yet ..
   }
 
-  void perform_task (tl::Task *task) 
-  {
-    XORTask *xor_task = dynamic_cast <XORTask *> (task);
-    if (xor_task) {
-      do_perform (xor_task);
-    }
-  }
+  void do_perform (const XORTask *task);
 
 private:
   XORJob *mp_job;
-
-  void do_perform (const XORTask *task);
 };
 
 void
@@ -873,10 +877,28 @@ XORWorker::do_perform (const XORTask *xor_task)
 
 }
 
-tl::Worker *
-XORJob::create_worker ()
+void
+XORTask::run ()
 {
-  return new XORWorker (this);
+  XORWorker (mp_job).do_perform (this);
+}
+
+XORJob::~XORJob ()
+{
+  for (std::vector<XORTask *>::const_iterator t = m_tasks.begin (); t != m_tasks.end (); ++t) {
+    delete *t;
+  }
+  m_tasks.clear ();
+}
+
+void
+XORJob::run (tl::TaskGroup &group)
+{
+  std::vector<XORTask *> tasks;
+  tasks.swap (m_tasks);
+  for (std::vector<XORTask *>::const_iterator t = tasks.begin (); t != tasks.end (); ++t) {
+    group.run (*t);
+  }
 }
 
 void 
@@ -1239,7 +1261,7 @@ XORToolDialog::run_xor ()
     } else if (process_el) {
       el_handling = XORJob::EL_process;
     }
-    XORJob job (nworkers, output_mode, op, el_handling, dbu, cva, cvb, tolerances, sub_categories, layer_categories, sub_cells, sub_output_layers, rdb, rdb_cell);
+    XORJob job (output_mode, op, el_handling, dbu, cva, cvb, tolerances, sub_categories, layer_categories, sub_cells, sub_output_layers, rdb, rdb_cell);
 
     double common_dbu = tl::lcm (cva->layout ().dbu (), cvb->layout ().dbu ());
 
@@ -1328,7 +1350,7 @@ XORToolDialog::run_xor ()
 
           unsigned int layer_index = 0;
           for (std::map<db::LayerProperties, std::pair<std::vector<unsigned int>, std::vector<unsigned int> >, db::LPLogicalLessFunc>::const_iterator l = layers.begin (); l != layers.end (); ++l, ++layer_index) {
-            job.schedule (new XORTask (tile_desc, clip_box, region_a, region_b, layer_index, l->first, l->second.first, l->second.second, nw, nh));
+            job.schedule (new XORTask (&job, tile_desc, clip_box, region_a, region_b, layer_index, l->first, l->second.first, l->second.second, nw, nh));
           }
 
         }
@@ -1354,28 +1376,42 @@ XORToolDialog::run_xor ()
       db::LayoutLocker locker_a (& cva->layout ());
       db::LayoutLocker locker_b (& cvb->layout ());
 
-      try {
+      //  use the application's thread pool unless a different number of threads is requested
+      std::auto_ptr<tl::ThreadPool> own_pool;
+      tl::ThreadPool *pool = &tl::ThreadPool::instance ();
+      if (size_t (std::max (0, nworkers)) != pool->threads ()) {
+        own_pool.reset (new tl::ThreadPool (size_t (std::max (0, nworkers))));
+        pool = own_pool.get ();
+      }
 
-        job.start ();
-        while (job.is_running ()) {
-          //  This may throw an exception, if the cancel button has been pressed.
-          job.update_progress (progress);
-          job.wait (100);
-        }
+      std::string error;
+
+      {
+        //  NOTE: the group's destructor waits for the running tasks if the operation was cancelled
+        tl::TaskGroup group (pool);
+        job.run (group);
+
+        try {
 
-      } catch (tl::BreakException &ex) {
-        job.terminate ();
-        was_cancelled = true;
-      } catch (tl::Exception &ex) {
-        job.terminate ();
-        throw ex;
+          while (! group.wait_for (100)) {
+            //  This may throw an exception, if the cancel button has been pressed.
+            job.update_progress (progress);
+          }
+
+        } catch (tl::BreakException &ex) {
+          group.cancel ();
+          was_cancelled = true;
+        } catch (tl::Exception &ex) {
+          group.cancel ();
+          error = ex.msg ();
+        }
       }
 
-      if (job.has_error ()) {
+      if (! error.empty ()) {
         if (mp_view && output_mode == OMMarkerDatabase) {
           mp_view->remove_rdb (rdb_index);
         }
-        throw tl::Exception (tl::to_string (QObject::tr ("Errors occured during processing. First error message says:\n")) + job.error_messages ().front ());
+        throw tl::Exception (tl::to_string (QObject::tr ("Errors occured during processing. First error message says:\n")) + error);
       }
 
     }
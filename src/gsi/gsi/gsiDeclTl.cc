@@ -24,6 +24,7 @@
 #include "gsiDecl.h"
 #include "tlLog.h"
 #include "tlTimer.h"
+#include "tlProfiler.h"
 #include "tlProgress.h"
 #include "tlExpression.h"
 
@@ -192,6 +193,101 @@ Class<tl::Timer> decl_Timer ("Timer",
 
 }
 
+// ----------------------------------------------------------------
+//  Profiler binding
+
+namespace gsi
+{
+
+/**
+ *  @brief A pseudo class that wraps the profiler functionality
+ */
+class Profiler
+{
+public:
+  static void enter (const std::string &name)
+  {
+    tl::Profiler::enter (name);
+  }
+};
+
+}
+
+namespace tl {
+  template <> struct type_traits<gsi::Profiler> : public type_traits<void> {
+    typedef tl::false_tag has_copy_constructor;
+    typedef tl::false_tag has_default_constructor;
+  };
+}
+
+namespace gsi
+{
+
+Class<Profiler> decl_Profiler ("Profiler",
+  gsi::method ("enabled?", &tl::Profiler::is_enabled,
+    "@brief Gets a value indicating whether the profiler is enabled\n"
+  ) +
+  gsi::method ("enabled=", &tl::Profiler::set_enabled,
+    "@brief Enables or disables the profiler\n"
+    "@args f\n"
+    "\n"
+    "The profiler is enabled at startup if the KLAYOUT_PROFILE environment variable is set.\n"
+  ) +
+  gsi::method ("reset", &tl::Profiler::reset,
+    "@brief Clears the statistics collected so far\n"
+  ) +
+  gsi::method ("enter", &Profiler::enter,
+    "@brief Enters a zone with the given name\n"
+    "@args name\n"
+    "\n"
+    "Zones are nested: a zone entered while another zone is active becomes a child of this zone. "
+    "Every \\enter call needs to be balanced by a \\leave call.\n"
+  ) +
+  gsi::method ("leave", &tl::Profiler::leave,
+    "@brief Leaves the current zone\n"
+  ) +
+  gsi::method ("add_bytes", &tl::Profiler::add_bytes,
+    "@brief Adds the given number of bytes to the statistics of the current zone\n"
+    "@args n\n"
+  ) +
+  gsi::method ("report", &tl::Profiler::report,
+    "@brief Gets the statistics as a text table\n"
+    "\n"
+    "The table lists the zones as a tree. For every zone, the number of calls, the wall clock and CPU time, "
+    "the bytes reported and the peak memory of the process is given. The statistics of all threads are summed up.\n"
+  ) +
+  gsi::method ("to_json", &tl::Profiler::to_json,
+    "@brief Gets the profile in the Chrome trace event format\n"
+    "\n"
+    "The result can be loaded into a trace viewer (i.e. \"chrome://tracing\"). In addition to the trace events, "
+    "the \"zones\" list holds the statistics as given by \\report.\n"
+  ) +
+  gsi::method ("write_json", &tl::Profiler::write_json,
+    "@brief Writes the profile in the Chrome trace event format to the given file\n"
+    "@args path\n"
+  ),
+  "@brief The profiler\n"
+  "\n"
+  "The profiler collects timing statistics for nested zones. The readers and writers, the edge processor, "
+  "the Region operations, the tiling processor and the redraw thread report zones. Scripts can add their "
+  "own zones to find out where the time goes:\n"
+  "\n"
+  "@code\n"
+  "RBA::Profiler::enabled = true\n"
+  "RBA::Profiler::enter(\"my script\")\n"
+  "# ... do something\n"
+  "RBA::Profiler::leave\n"
+  "puts RBA::Profiler::report\n"
+  "@/code\n"
+  "\n"
+  "If the KLAYOUT_PROFILE environment variable is set to a file path, the profiler is enabled at startup "
+  "and the profile is written to this file in the Chrome trace event format at exit.\n"
+  "\n"
+  "This class has been introduced in version 0.25.3.\n"
+);
+
+}
+
 // ----------------------------------------------------------------
 //  Progress reporter objects
 
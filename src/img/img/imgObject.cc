@@ -35,6 +35,8 @@
 #include <sstream>
 #include <string>
 #include <memory.h>
+#include <list>
+#include <map>
 
 #include <QImage>
 #include <QMutex>
@@ -700,6 +702,7 @@ Object::Object ()
 {
   m_updates_enabled = false;
   mp_pixel_data = 0;
+  mp_tile_cache = 0;
 }
 
 Object::Object (size_t w, size_t h, const db::DCplxTrans &trans, bool color)
@@ -707,6 +710,7 @@ Object::Object (size_t w, size_t h, const db::DCplxTrans &trans, bool color)
 {
   m_updates_enabled = false;
   mp_pixel_data = 0;
+  mp_tile_cache = 0;
 
   mp_data = new DataHeader (w, h, color, false);
   mp_data->add_ref ();
@@ -734,6 +738,7 @@ Object::Object (size_t w, size_t h, const db::DCplxTrans &trans, unsigned char *
 {
   m_updates_enabled = false;
   mp_pixel_data = 0;
+  mp_tile_cache = 0;
   mp_data = 0;
   set_data (w, h, d);
   m_updates_enabled = true;
@@ -744,6 +749,7 @@ Object::Object (size_t w, size_t h, const db::DCplxTrans &trans, float *d)
 {
   m_updates_enabled = false;
   mp_pixel_data = 0;
+  mp_tile_cache = 0;
   mp_data = 0;
   set_data (w, h, d);
   m_updates_enabled = true;
@@ -754,6 +760,7 @@ Object::Object (size_t w, size_t h, const db::DCplxTrans &trans, const std::vect
 {
   m_updates_enabled = false;
   mp_pixel_data = 0;
+  mp_tile_cache = 0;
   mp_data = 0;
   set_data (w, h, d);
   m_updates_enabled = true;
@@ -764,6 +771,7 @@ Object::Object (size_t w, size_t h, const db::DCplxTrans &trans, unsigned char *
 {
   m_updates_enabled = false;
   mp_pixel_data = 0;
+  mp_tile_cache = 0;
   mp_data = 0;
   set_data (w, h, red, green, blue);
   m_updates_enabled = true;
@@ -774,6 +782,7 @@ Object::Object (size_t w, size_t h, const db::DCplxTrans &trans, float *red, flo
 {
   m_updates_enabled = false;
   mp_pixel_data = 0;
+  mp_tile_cache = 0;
   mp_data = 0;
   set_data (w, h, red, green, blue);
   m_updates_enabled = true;
@@ -784,6 +793,7 @@ Object::Object (size_t w, size_t h, const db::DCplxTrans &trans, const std::vect
 {
   m_updates_enabled = false;
   mp_pixel_data = 0;
+  mp_tile_cache = 0;
   mp_data = 0;
   set_data (w, h, red, green, blue);
   m_updates_enabled = true;
@@ -794,6 +804,7 @@ Object::Object (const std::string &filename, const db::DCplxTrans &trans)
 {
   m_updates_enabled = false;
   mp_pixel_data = 0;
+  mp_tile_cache = 0;
 
   mp_data = 0;
   read_file ();
@@ -805,6 +816,7 @@ Object::Object (size_t w, size_t h, const db::Matrix3d &trans, bool color)
 {
   m_updates_enabled = false;
   mp_pixel_data = 0;
+  mp_tile_cache = 0;
 
   mp_data = new DataHeader (w, h, color, false);
   mp_data->add_ref ();
@@ -834,6 +846,7 @@ Object::Object (size_t w, size_t h, const db::Matrix3d &trans, unsigned char *d)
 {
   m_updates_enabled = false;
   mp_pixel_data = 0;
+  mp_tile_cache = 0;
   mp_data = 0;
   set_data (w, h, d);
   m_updates_enabled = true;
@@ -844,6 +857,7 @@ Object::Object (size_t w, size_t h, const db::Matrix3d &trans, float *d)
 {
   m_updates_enabled = false;
   mp_pixel_data = 0;
+  mp_tile_cache = 0;
   mp_data = 0;
   set_data (w, h, d);
   m_updates_enabled = true;
@@ -854,6 +868,7 @@ Object::Object (size_t w, size_t h, const db::Matrix3d &trans, const std::vector
 {
   m_updates_enabled = false;
   mp_pixel_data = 0;
+  mp_tile_cache = 0;
   mp_data = 0;
   set_data (w, h, d);
   m_updates_enabled = true;
@@ -864,6 +879,7 @@ Object::Object (size_t w, size_t h, const db::Matrix3d &trans, unsigned char *re
 {
   m_updates_enabled = false;
   mp_pixel_data = 0;
+  mp_tile_cache = 0;
   mp_data = 0;
   set_data (w, h, red, green, blue);
   m_updates_enabled = true;
@@ -874,6 +890,7 @@ Object::Object (size_t w, size_t h, const db::Matrix3d &trans, float *red, float
 {
   m_updates_enabled = false;
   mp_pixel_data = 0;
+  mp_tile_cache = 0;
   mp_data = 0;
   set_data (w, h, red, green, blue);
   m_updates_enabled = true;
@@ -884,6 +901,7 @@ Object::Object (size_t w, size_t h, const db::Matrix3d &trans, const std::vector
 {
   m_updates_enabled = false;
   mp_pixel_data = 0;
+  mp_tile_cache = 0;
   mp_data = 0;
   set_data (w, h, red, green, blue);
   m_updates_enabled = true;
@@ -894,6 +912,7 @@ Object::Object (const std::string &filename, const db::Matrix3d &trans)
 {
   m_updates_enabled = false;
   mp_pixel_data = 0;
+  mp_tile_cache = 0;
 
   mp_data = 0;
   read_file ();
@@ -904,6 +923,7 @@ Object::Object (const img::Object &d)
 {
   m_updates_enabled = false;
   mp_pixel_data = 0;
+  mp_tile_cache = 0;
 
   mp_data = 0;
   *this = d;
@@ -1755,6 +1775,7 @@ void
 Object::set_mask (size_t x, size_t y, bool m) 
 {
   if (mp_data && x < width () && y < height ()) {
+    invalidate_pixel_data ();
     mp_data->set_mask ()[x + y * width ()] = m;
     if (m_updates_enabled) {
       property_changed ();
@@ -1996,33 +2017,193 @@ void get_min_max (const float *data, size_t n, double &min, double &max)
   }
 }
 
-void 
-Object::validate_pixel_data () const
+/**
+ *  @brief Sets up the lookup tables for the red, green and blue channel
+ */
+static void
+setup_lookup_tables (DataHeader *data, const DataMapping &data_mapping, double min_value, double max_value, tl::DataMappingLookupTable *lut)
 {
-  if (mp_data != 0 && mp_pixel_data == 0 && ! is_empty ()) {
+  size_t n = data->data_length ();
 
-    size_t n = data_length ();
+  double min = 0.0, max = 255.0;
+  if (! data->is_byte_data () && ! data->is_color ()) {
+    get_min_max (data->float_data (), n, min, max);
+  }
 
-    lay::color_t *nc_pixel_data = new lay::color_t [n];
-    mp_pixel_data = nc_pixel_data;
+  for (unsigned int i = 0; i < 3; ++i) {
+
+    lut[i].set_data_mapping (data_mapping.create_data_mapping (! data->is_color (), min_value, max_value, i));
 
-    double min = 0.0, max = 255.0;
-    if (! mp_data->is_byte_data () && ! mp_data->is_color ()) {
-      get_min_max (mp_data->float_data (), n, min, max);
+    if (! data->is_byte_data () && data->is_color ()) {
+      get_min_max (data->float_data (i), n, min, max);
     }
+    lut[i].update_table (min, max, 1.0, 1 << ((2 - i) * 8));
 
-    tl::DataMappingLookupTable lut[3];
+  }
+}
 
-    for (unsigned int i = 0; i < 3; ++i) {
+// --------------------------------------------------------------------------------------
+//  PixelTileCache definition and implementation
+
+//  the maximum number of tiles kept per image (about 64MB of pixel data)
+const size_t max_cached_pixel_tiles = 256;
+
+//  the maximum number of samples per direction taken for one pixel of a downsampled level
+const size_t max_downsampling_samples = 4;
+
+/**
+ *  @brief A cache for the RGB pixel data tiles of an image
+ *
+ *  The tiles are computed on demand from the image data. The cache keeps a limited 
+ *  number of tiles and drops the least recently used ones. The cache is specific for
+ *  a certain data mapping and needs to be recreated if the data or the mapping changes.
+ */
+class PixelTileCache
+{
+public:
+  PixelTileCache (DataHeader *data, const DataMapping &data_mapping, double min_value, double max_value)
+    : mp_data (data)
+  {
+    setup_lookup_tables (mp_data, data_mapping, min_value, max_value, m_lut);
+  }
+
+  ~PixelTileCache ()
+  {
+    for (tile_map::iterator t = m_tiles.begin (); t != m_tiles.end (); ++t) {
+      delete t->second.first;
+    }
+    m_tiles.clear ();
+  }
+
+  const PixelTile &tile (unsigned int level, size_t tx, size_t ty)
+  {
+    key_type key (level, std::make_pair (tx, ty));
+
+    tile_map::iterator t = m_tiles.find (key);
+    if (t != m_tiles.end ()) {
+      //  mark as most recently used
+      m_lru.splice (m_lru.end (), m_lru, t->second.second);
+      return *t->second.first;
+    }
+
+    if (m_tiles.size () >= max_cached_pixel_tiles) {
+      tile_map::iterator lru = m_tiles.find (m_lru.front ());
+      delete lru->second.first;
+      m_tiles.erase (lru);
+      m_lru.pop_front ();
+    }
+
+    PixelTile *new_tile = new PixelTile ();
+    compute (level, tx, ty, *new_tile);
+
+    m_lru.push_back (key);
+    m_tiles.insert (std::make_pair (key, std::make_pair (new_tile, --m_lru.end ())));
+
+    return *new_tile;
+  }
+
+private:
+  typedef std::pair<unsigned int, std::pair<size_t, size_t> > key_type;
+  typedef std::list<key_type> lru_list;
+  typedef std::map<key_type, std::pair<PixelTile *, lru_list::iterator> > tile_map;
+
+  DataHeader *mp_data;
+  tl::DataMappingLookupTable m_lut [3];
+  tile_map m_tiles;
+  lru_list m_lru;
+
+  void compute (unsigned int level, size_t tx, size_t ty, PixelTile &tile) const
+  {
+    const size_t ts = PixelTile::tile_size;
+
+    size_t w = mp_data->width (), h = mp_data->height ();
+    size_t f = size_t (1) << level;
+    size_t lw = (w + f - 1) >> level, lh = (h + f - 1) >> level;
+    size_t step = std::max (size_t (1), f / max_downsampling_samples);
+
+    bool color = mp_data->is_color ();
+    unsigned int channels = color ? 3 : 1;
+
+    const unsigned char *byte_data [3] = { 0, 0, 0 };
+    const float *float_data [3] = { 0, 0, 0 };
+    for (unsigned int c = 0; c < channels; ++c) {
+      if (mp_data->is_byte_data ()) {
+        byte_data [c] = color ? mp_data->byte_data (c) : mp_data->byte_data ();
+      } else {
+        float_data [c] = color ? mp_data->float_data (c) : mp_data->float_data ();
+      }
+    }
+
+    const unsigned char *mask = mp_data->mask ();
+
+    tile.pixels.resize (ts * ts, 0);
+    if (mask) {
+      tile.mask.resize (ts * ts, 0);
+    }
+
+    for (size_t y = 0; y < ts && ty * ts + y < lh; ++y) {
+
+      size_t y0 = (ty * ts + y) << level;
+      size_t y1 = std::min (y0 + f, h);
+
+      for (size_t x = 0; x < ts && tx * ts + x < lw; ++x) {
+
+        size_t x0 = (tx * ts + x) << level;
+        size_t x1 = std::min (x0 + f, w);
+
+        //  average the (unmasked) samples of the original pixels covered by this pixel.
+        //  The samples are mapped before they are averaged since the mapping is not linear
+        //  in general (i.e. false color).
+        unsigned int sum [3] = { 0, 0, 0 };
+        size_t nsamples = 0, nused = 0;
+
+        for (size_t yy = y0; yy < y1; yy += step) {
+          for (size_t xx = x0; xx < x1; xx += step) {
+            size_t i = xx + yy * w;
+            ++nsamples;
+            if (! mask || mask [i]) {
+              ++nused;
+              for (unsigned int c = 0; c < 3; ++c) {
+                unsigned int cc = color ? c : 0;
+                double v = byte_data [cc] ? double (byte_data [cc][i]) : double (float_data [cc][i]);
+                sum [c] += (m_lut [c] (v) >> ((2 - c) * 8)) & 0xff;
+              }
+            }
+          }
+        }
+
+        size_t n = x + y * ts;
+
+        if (nused > 0) {
+          lay::color_t pixel = 0;
+          for (unsigned int c = 0; c < 3; ++c) {
+            pixel |= lay::color_t ((sum [c] + nused / 2) / nused) << ((2 - c) * 8);
+          }
+          tile.pixels [n] = pixel;
+        }
 
-      lut[i].set_data_mapping (m_data_mapping.create_data_mapping (! mp_data->is_color (), m_min_value, m_max_value, i));
+        if (mask) {
+          tile.mask [n] = (nused * 2 >= nsamples);
+        }
 
-      if (! mp_data->is_byte_data () && mp_data->is_color ()) {
-        get_min_max (mp_data->float_data (i), n, min, max);
       }
-      lut[i].update_table (min, max, 1.0, 1 << ((2 - i) * 8));
 
     }
+  }
+};
+
+void 
+Object::validate_pixel_data () const
+{
+  if (mp_data != 0 && mp_pixel_data == 0 && ! is_empty ()) {
+
+    size_t n = data_length ();
+
+    lay::color_t *nc_pixel_data = new lay::color_t [n];
+    mp_pixel_data = nc_pixel_data;
+
+    tl::DataMappingLookupTable lut[3];
+    setup_lookup_tables (mp_data, m_data_mapping, m_min_value, m_max_value, lut);
 
     if (mp_data->is_byte_data ()) {
 
@@ -2129,6 +2310,32 @@ Object::validate_pixel_data () const
   }
 }
 
+unsigned int
+Object::pixel_levels () const
+{
+  size_t n = std::max (width (), height ());
+
+  unsigned int levels = 1;
+  while (n > size_t (PixelTile::tile_size)) {
+    n = (n + 1) / 2;
+    ++levels;
+  }
+
+  return levels;
+}
+
+const PixelTile &
+Object::pixel_tile (unsigned int level, size_t tx, size_t ty) const
+{
+  tl_assert (mp_data != 0);
+
+  if (! mp_tile_cache) {
+    mp_tile_cache = new PixelTileCache (mp_data, m_data_mapping, m_min_value, m_max_value);
+  }
+
+  return mp_tile_cache->tile (level, tx, ty);
+}
+
 void
 Object::invalidate_pixel_data ()
 {
@@ -2136,6 +2343,10 @@ Object::invalidate_pixel_data ()
     delete [] mp_pixel_data;
     mp_pixel_data = 0;
   }
+  if (mp_tile_cache != 0) {
+    delete mp_tile_cache;
+    mp_tile_cache = 0;
+  }
 }
 
 void
@@ -43,6 +43,32 @@
 namespace img {
   
 class DataHeader;
+class PixelTileCache;
+
+/**
+ *  @brief A tile of RGB pixel data
+ *
+ *  A tile is a square block of tile_size x tile_size pixels from one resolution level of 
+ *  an image (see Object::pixel_tile). The pixels are stored row by row. Tiles at the right 
+ *  and top border of the image are used partially only.
+ */
+struct IMG_PUBLIC PixelTile
+{
+  /**
+   *  @brief The width and height of a tile in pixels
+   */
+  enum { tile_size = 256 };
+
+  /**
+   *  @brief The RGB pixel values
+   */
+  std::vector<lay::color_t> pixels;
+
+  /**
+   *  @brief The mask values (empty if the image does not have a mask)
+   */
+  std::vector<unsigned char> mask;
+};
 
 /**
  *  @brief A structure describing the data mapping of an image object
@@ -877,6 +903,26 @@ public:
     return mp_pixel_data;
   }
 
+  /**
+   *  @brief Gets the number of resolution levels of the pixel data
+   *
+   *  Level 0 is the original resolution. Each further level reduces the resolution by a factor 
+   *  of two until the image fits into a single tile.
+   */
+  unsigned int pixel_levels () const;
+
+  /**
+   *  @brief Gets a tile of RGB pixel data obtained by applying the LUT's
+   *
+   *  "level" is the resolution level and "tx" and "ty" are the column and row of the tile 
+   *  within this level. On the downsampled levels, a pixel's color is the average of the 
+   *  mapped colors of the original pixels it covers. In contrast to "pixel_data", only the tiles requested are 
+   *  mapped and only a limited number of tiles is kept. The reference stays valid until the 
+   *  next call of this method or until the image is modified.
+   *  The image must not be empty.
+   */
+  const PixelTile &pixel_tile (unsigned int level, size_t tx, size_t ty) const;
+
   /**
    *  @brief Load the data from the given file
    *
@@ -958,6 +1004,7 @@ private:
   DataMapping m_data_mapping;
   bool m_visible;
   mutable const lay::color_t *mp_pixel_data;
+  mutable PixelTileCache *mp_tile_cache;
   std::vector <db::DPoint> m_landmarks;
   int m_z_position;
   bool m_updates_enabled;
@@ -81,7 +81,7 @@ private:
 // -------------------------------------------------------------
 
 static void
-draw_scanline (unsigned int level, const img::Object &image_object, QImage &qimage, int y, const db::Matrix3d &t, const db::Matrix3d &it, const db::DPoint &q1, const db::DPoint &q2)
+draw_scanline (unsigned int level, unsigned int tile_level, const img::Object &image_object, QImage &qimage, int y, const db::Matrix3d &t, const db::Matrix3d &it, const db::DPoint &q1, const db::DPoint &q2)
 {
   double source_width = image_object.width ();
   double source_height = image_object.height ();
@@ -104,8 +104,8 @@ draw_scanline (unsigned int level, const img::Object &image_object, QImage &qima
 
   if (level < 7 && xstop > xstart + 1 && fabs (xm - (xstart + xstop) / 2) > 1.0 && xm > xstart + 1 && xm < xstop - 1) {
 
-    draw_scanline (level + 1, image_object, qimage, y, t, it, q1, qm);
-    draw_scanline (level + 1, image_object, qimage, y, t, it, qm, q2);
+    draw_scanline (level + 1, tile_level, image_object, qimage, y, t, it, q1, qm);
+    draw_scanline (level + 1, tile_level, image_object, qimage, y, t, it, qm, q2);
 
   } else {
 
@@ -114,16 +114,29 @@ draw_scanline (unsigned int level, const img::Object &image_object, QImage &qima
     double dpy = (p2.y () - p1.y ()) / double (xstop - xstart);
 
     QRgb *scanline_data = (QRgb *) qimage.scanLine (qimage.height () - y - 1) + xstart;
-    QRgb *pixel_data = (QRgb *) image_object.pixel_data ();
-    const unsigned char *mask_data = image_object.mask ();
+
+    const size_t ts = img::PixelTile::tile_size;
+    const img::PixelTile *tile = 0;
+    size_t tile_x = 0, tile_y = 0;
 
     for (int x = xstart; x < xstop; ++x) {
 
       if (px >= 0 && px < source_width && py >= 0 && py < source_height) {
 
-        size_t n = size_t (floor (px) + floor (py) * source_width);
-        if (! mask_data || mask_data [n]) {
-          *scanline_data = pixel_data [n];
+        //  pixel coordinates in the resolution level
+        size_t lx = size_t (px) >> tile_level;
+        size_t ly = size_t (py) >> tile_level;
+
+        size_t tx = lx / ts, ty = ly / ts;
+        if (! tile || tx != tile_x || ty != tile_y) {
+          tile = &image_object.pixel_tile (tile_level, tx, ty);
+          tile_x = tx;
+          tile_y = ty;
+        }
+
+        size_t n = (lx - tx * ts) + (ly - ty * ts) * ts;
+        if (tile->mask.empty () || tile->mask [n]) {
+          *scanline_data = tile->pixels [n];
         }
 
       }
@@ -165,6 +178,23 @@ draw_image (const img::Object &image_object, const lay::Viewport &vp, lay::ViewO
   int y1 = int (floor (std::max (0.0, image_box.bottom ())));
   int y2 = int (floor (std::min (double (qimage.height ()) - 1, image_box.top ())));
 
+  db::DBox visible_box = image_box & db::DBox (0.0, 0.0, qimage.width (), qimage.height ());
+  if (visible_box.empty () || image_object.is_empty ()) {
+    return;
+  }
+
+  //  Pick the resolution level: one pixel of that level must not be larger than a pixel of the 
+  //  canvas. The scale is taken at the center of the visible part in the finer direction.
+  db::DPoint c = it.trans (visible_box.center ());
+  double dx = (it.trans (visible_box.center () + db::DVector (1.0, 0.0)) - c).length ();
+  double dy = (it.trans (visible_box.center () + db::DVector (0.0, 1.0)) - c).length ();
+  double scale = std::min (dx, dy);
+
+  unsigned int tile_level = 0;
+  while (tile_level + 1 < image_object.pixel_levels () && double (size_t (2) << tile_level) <= scale) {
+    ++tile_level;
+  }
+
   for (int y = y1; y <= y2; ++y) {
 
     db::DEdge scanline (db::DPoint (image_box.left (), y), db::DPoint (image_box.right (), y));
@@ -173,7 +203,7 @@ draw_image (const img::Object &image_object, const lay::Viewport &vp, lay::ViewO
     //  clip the transformed scanline to the original image 
     std::pair<bool, db::DEdge> clipped = scanline.clipped_line (source_image_box);
     if (clipped.first) {
-      draw_scanline (0, image_object, qimage, y, t, it, clipped.second.p1 (), clipped.second.p2 ());
+      draw_scanline (0, tile_level, image_object, qimage, y, t, it, clipped.second.p1 (), clipped.second.p2 ());
     }
 
   }
@@ -304,3 +304,102 @@ TEST(3)
   EXPECT_EQ (image.mask (1, 2), false);
 }
 
+
+//  pixel tiles
+TEST(4) 
+{
+  const size_t w = 600, h = 300;
+  const size_t ts = img::PixelTile::tile_size;
+
+  //  the values are constant over blocks of 4x4 pixels, so the downsampled levels 
+  //  deliver the original values
+  unsigned char *data = new unsigned char [w * h];
+  for (size_t y = 0; y < h; ++y) {
+    for (size_t x = 0; x < w; ++x) {
+      data [x + y * w] = (unsigned char) ((x / 4 + (y / 4) * 7) % 200);
+    }
+  }
+
+  img::Object image (w, h, db::DCplxTrans (), data);
+  image.set_mask (8, 12, false);
+  for (size_t y = 0; y < 4; ++y) {
+    for (size_t x = 0; x < 4; ++x) {
+      image.set_mask (100 + x, 40 + y, false);
+    }
+  }
+
+  EXPECT_EQ (image.pixel_levels (), (unsigned int) 3);
+
+  const lay::color_t *pixel_data = image.pixel_data ();
+
+  size_t points[][2] = { { 0, 0 }, { 8, 12 }, { 255, 255 }, { 256, 0 }, { 599, 299 }, { 100, 40 }, { 517, 260 }, { 333, 111 } };
+
+  for (unsigned int level = 0; level < 3; ++level) {
+
+    for (size_t i = 0; i < sizeof (points) / sizeof (points [0]); ++i) {
+
+      size_t x = points [i][0], y = points [i][1];
+      size_t lx = x >> level, ly = y >> level;
+
+      const img::PixelTile &tile = image.pixel_tile (level, lx / ts, ly / ts);
+      size_t n = lx % ts + (ly % ts) * ts;
+
+      EXPECT_EQ (tile.pixels.size (), ts * ts);
+      EXPECT_EQ (tile.mask.size (), ts * ts);
+
+      if (x == 8 && y == 12) {
+        //  single masked pixels vanish on the downsampled levels
+        EXPECT_EQ (tile.mask [n] != 0, level > 0);
+      } else if (x == 100 && y == 40) {
+        EXPECT_EQ (tile.mask [n] != 0, false);
+      } else {
+        EXPECT_EQ (tile.mask [n] != 0, true);
+      }
+
+      if (tile.mask [n]) {
+        EXPECT_EQ (tile.pixels [n], pixel_data [(lx << level) + (ly << level) * w]);
+      }
+
+    }
+
+  }
+
+  //  modifying the image invalidates the tiles
+  lay::color_t p0 = image.pixel_tile (0, 1, 0).pixels [1];
+  image.set_pixel (257, 0, 199.0);
+  EXPECT_EQ (image.pixel_tile (0, 1, 0).pixels [1] != p0, true);
+  EXPECT_EQ (image.pixel_tile (0, 1, 0).pixels [1], image.pixel_data () [257]);
+}
+
+TEST(5) 
+{
+  const size_t w = 300, h = 300;
+
+  //  a checkerboard of black and white pixels
+  unsigned char *data = new unsigned char [w * h];
+  for (size_t y = 0; y < h; ++y) {
+    for (size_t x = 0; x < w; ++x) {
+      data [x + y * w] = ((x + y) % 2) ? 255 : 0;
+    }
+  }
+
+  img::Object image (w, h, db::DCplxTrans (), data);
+
+  //  with a non-linear mapping, the colors need to be averaged, not the values
+  img::DataMapping dm (image.data_mapping ());
+  dm.gamma = 3.0;
+  image.set_data_mapping (dm);
+
+  const lay::color_t *pixel_data = image.pixel_data ();
+  lay::color_t c0 = pixel_data [0], c1 = pixel_data [1];
+  EXPECT_EQ (c0 != c1, true);
+
+  lay::color_t avg = 0;
+  for (unsigned int s = 0; s < 24; s += 8) {
+    avg |= ((((c0 >> s) & 0xff) + ((c1 >> s) & 0xff) + 1) / 2) << s;
+  }
+
+  EXPECT_EQ (image.pixel_tile (1, 0, 0).pixels [0], avg);
+  EXPECT_EQ (image.pixel_tile (1, 0, 0).pixels [17], avg);
+  EXPECT_EQ (image.pixel_tile (2, 0, 0).pixels [5], avg);
+}
@@ -63,7 +63,7 @@ lym.depends += gsi $$LANG_DEPENDS
 lay.depends += laybasic ant img edt lym
 ext.depends += lay
 lib.depends += db
-buddies.depends += rdb lib $$LANG_DEPENDS
+buddies.depends += rdb lib laybasic $$LANG_DEPENDS
 
 equals(HAVE_QTBINDINGS, "1") {
   SUBDIRS += gsiqt
@@ -0,0 +1,152 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "gsiDecl.h"
+#include "layBatchRenderer.h"
+#include "layLayoutView.h"
+
+namespace gsi
+{
+
+static unsigned int load_layout1 (lay::BatchRenderer *r, const std::string &filename)
+{
+  return r->load_layout (filename, db::LoadLayoutOptions (), std::string ());
+}
+
+static unsigned int load_layout2 (lay::BatchRenderer *r, const std::string &filename, const db::LoadLayoutOptions &options)
+{
+  return r->load_layout (filename, options, std::string ());
+}
+
+static unsigned int load_layout3 (lay::BatchRenderer *r, const std::string &filename, const db::LoadLayoutOptions &options, const std::string &technology)
+{
+  return r->load_layout (filename, options, technology);
+}
+
+Class<lay::BatchRenderer> decl_BatchRenderer ("BatchRenderer",
+  gsi::method ("view", &lay::BatchRenderer::view,
+    "@brief Gets the view used for rendering\n"
+    "The view is never shown. It can be used to configure the drawing, i.e. with \\LayoutView#set_config, "
+    "or to select the cell to draw."
+  ) +
+  gsi::method_ext ("load_layout", &load_layout1, gsi::arg ("filename"),
+    "@brief Loads a layout\n"
+    "The layout replaces the layout loaded before. The top cell is drawn with all hierarchy levels. "
+    "Returns the index of the cellview created."
+  ) +
+  gsi::method_ext ("load_layout", &load_layout2, gsi::arg ("filename"), gsi::arg ("options"),
+    "@brief Loads a layout with the given reader options\n"
+    "See the first variant for details."
+  ) +
+  gsi::method_ext ("load_layout", &load_layout3, gsi::arg ("filename"), gsi::arg ("options"), gsi::arg ("technology"),
+    "@brief Loads a layout with the given reader options and technology\n"
+    "See the first variant for details."
+  ) +
+  gsi::method ("load_layer_props", &lay::BatchRenderer::load_layer_props, gsi::arg ("filename"),
+    "@brief Loads the layer properties from the given file\n"
+    "This method must be called after the layout has been loaded."
+  ) +
+  gsi::method ("set_size", &lay::BatchRenderer::set_size, gsi::arg ("width"), gsi::arg ("height"),
+    "@brief Sets the size of the images in pixels\n"
+    "The default size is 640x480 pixels."
+  ) +
+  gsi::method ("width", &lay::BatchRenderer::width,
+    "@brief Gets the width of the images in pixels\n"
+  ) +
+  gsi::method ("height", &lay::BatchRenderer::height,
+    "@brief Gets the height of the images in pixels\n"
+  ) +
+  gsi::method ("linewidth=", &lay::BatchRenderer::set_linewidth, gsi::arg ("linewidth"),
+    "@brief Sets the width of a line in pixels (usually 1) or 0 for default\n"
+  ) +
+  gsi::method ("linewidth", &lay::BatchRenderer::linewidth,
+    "@brief Gets the width of a line in pixels\n"
+  ) +
+  gsi::method ("oversampling=", &lay::BatchRenderer::set_oversampling, gsi::arg ("oversampling"),
+    "@brief Sets the oversampling factor (1..3) or 0 for default\n"
+  ) +
+  gsi::method ("oversampling", &lay::BatchRenderer::oversampling,
+    "@brief Gets the oversampling factor\n"
+  ) +
+  gsi::method ("resolution=", &lay::BatchRenderer::set_resolution, gsi::arg ("resolution"),
+    "@brief Sets the resolution (pixel size compared to a screen pixel, i.e 1/oversampling) or 0 for default\n"
+  ) +
+  gsi::method ("resolution", &lay::BatchRenderer::resolution,
+    "@brief Gets the resolution\n"
+  ) +
+  gsi::method ("monochrome=", &lay::BatchRenderer::set_monochrome, gsi::arg ("monochrome"),
+    "@brief Sets a value indicating whether to produce monochrome images\n"
+  ) +
+  gsi::method ("monochrome?", &lay::BatchRenderer::monochrome,
+    "@brief Gets a value indicating whether to produce monochrome images\n"
+  ) +
+  gsi::method ("threads=", &lay::BatchRenderer::set_threads, gsi::arg ("threads"),
+    "@brief Sets the number of threads\n"
+    "The threads are used for drawing the layout and for writing the images. With 0 threads, "
+    "drawing and writing happens synchronously. The default is 1."
+  ) +
+  gsi::method ("threads", &lay::BatchRenderer::threads,
+    "@brief Gets the number of threads\n"
+  ) +
+#if defined(HAVE_QTBINDINGS)
+  gsi::method ("render", &lay::BatchRenderer::render, gsi::arg ("box"),
+    "@brief Renders the given box into a \\QImage\n"
+    "The box is given in micrometer units. An empty box will render the whole layout."
+  ) +
+#endif
+  gsi::method ("render_to_file", &lay::BatchRenderer::render_to_file, gsi::arg ("box"), gsi::arg ("filename"),
+    "@brief Renders the given box and writes the image to the given file\n"
+    "The box is given in micrometer units. An empty box will render the whole layout. "
+    "The image is written in PNG format. Unless the number of threads is 0, the image is written "
+    "in the background while the next image is drawn. Use \\wait to make sure all images are written."
+  ) +
+  gsi::method ("render_to_files", &lay::BatchRenderer::render_to_files, gsi::arg ("boxes"), gsi::arg ("filenames"),
+    "@brief Renders the given boxes and writes the images to the given files\n"
+    "The boxes are given in micrometer units. For each box, a file name must be given. "
+    "This method returns when all images are written."
+  ) +
+  gsi::method ("wait", &lay::BatchRenderer::wait,
+    "@brief Waits until all images are written\n"
+    "If an image could not be written, this method will raise an error."
+  ),
+  "@brief A renderer for producing images of layouts without a main window\n"
+  "\n"
+  "The batch renderer produces images of layout regions. It does not require a main window "
+  "and is intended to render many images, i.e. thumbnails of review locations:\n"
+  "\n"
+  "@code\n"
+  "r = RBA::BatchRenderer::new\n"
+  "r.load_layout(\"layout.gds\")\n"
+  "r.load_layer_props(\"layers.lyp\")\n"
+  "r.set_size(200, 200)\n"
+  "r.threads = 4\n"
+  "r.render_to_file(RBA::DBox::new(0, 0, 10, 10), \"image1.png\")\n"
+  "r.render_to_file(RBA::DBox::new(10, 0, 20, 10), \"image2.png\")\n"
+  "r.wait\n"
+  "@/code\n"
+  "\n"
+  "This class has been introduced in version 0.25.3."
+);
+
+}
+
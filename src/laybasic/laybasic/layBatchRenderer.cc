@@ -0,0 +1,250 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "layBatchRenderer.h"
+#include "layLayoutView.h"
+#include "layViewport.h"
+#include "tlThreadedWorkers.h"
+#include "tlException.h"
+#include "tlString.h"
+#include "tlInternational.h"
+#include "tlVariant.h"
+#include "tlTimer.h"
+#include "tlLog.h"
+
+#include <QImageWriter>
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace lay
+{
+
+// -------------------------------------------------------------
+//  ImageWriterJob definition and implementation
+
+/**
+ *  @brief A task writing one image
+ */
+class ImageWriterTask
+  : public tl::Task
+{
+public:
+  ImageWriterTask (const QImage &image, const std::string &filename, const std::vector<std::pair<std::string, std::string> > &texts)
+    : m_image (image), m_filename (filename), m_texts (texts)
+  { }
+
+  QImage m_image;
+  std::string m_filename;
+  std::vector<std::pair<std::string, std::string> > m_texts;
+};
+
+/**
+ *  @brief The job writing the images in the background
+ *
+ *  Errors are collected by the job itself since the job is restarted for
+ *  images scheduled after the queue ran empty.
+ */
+class ImageWriterJob
+  : public tl::JobBase
+{
+public:
+  ImageWriterJob (int nworkers)
+    : tl::JobBase (nworkers)
+  { }
+
+  void add_error (const std::string &msg)
+  {
+    QMutexLocker locker (&m_lock);
+    m_errors.push_back (msg);
+  }
+
+  std::vector<std::string> take_errors ()
+  {
+    QMutexLocker locker (&m_lock);
+    std::vector<std::string> errors;
+    errors.swap (m_errors);
+    return errors;
+  }
+
+protected:
+  virtual tl::Worker *create_worker ();
+
+private:
+  QMutex m_lock;
+  std::vector<std::string> m_errors;
+};
+
+class ImageWriterWorker
+  : public tl::Worker
+{
+public:
+  ImageWriterWorker (ImageWriterJob *job)
+    : mp_job (job)
+  { }
+
+protected:
+  virtual void perform_task (tl::Task *task)
+  {
+    ImageWriterTask *wt = dynamic_cast<ImageWriterTask *> (task);
+    if (! wt) {
+      return;
+    }
+
+    QImageWriter writer (tl::to_qstring (wt->m_filename), QByteArray ("PNG"));
+
+    //  see LayoutView::save_image_with_options
+    for (std::vector<std::pair<std::string, std::string> >::const_iterator t = wt->m_texts.begin (); t != wt->m_texts.end (); ++t) {
+      writer.setText (tl::to_qstring (t->first), tl::to_qstring (t->second));
+    }
+
+    if (! writer.write (wt->m_image)) {
+      mp_job->add_error (tl::sprintf (tl::to_string (QObject::tr ("Unable to write image to file: %s (%s)")), wt->m_filename, tl::to_string (writer.errorString ())));
+    } else if (tl::verbosity () >= 20) {
+      tl::info << "Saved image to " << wt->m_filename;
+    }
+  }
+
+private:
+  ImageWriterJob *mp_job;
+};
+
+tl::Worker *
+ImageWriterJob::create_worker ()
+{
+  return new ImageWriterWorker (this);
+}
+
+// -------------------------------------------------------------
+//  BatchRenderer implementation
+
+BatchRenderer::BatchRenderer ()
+  : m_width (640), m_height (480), m_linewidth (0), m_oversampling (0), m_resolution (0.0), m_monochrome (false), m_threads (0)
+{
+  mp_view.reset (new lay::LayoutView (0, false, 0, 0, "batch_renderer_view", lay::LayoutView::LV_Naked + lay::LayoutView::LV_NoZoom + lay::LayoutView::LV_NoServices + lay::LayoutView::LV_NoGrid));
+  mp_writer.reset (new ImageWriterJob (0));
+  set_threads (1);
+}
+
+BatchRenderer::~BatchRenderer ()
+{
+  //  write pending images, but don't throw from the destructor
+  mp_writer->wait ();
+  mp_writer.reset (0);
+  mp_view.reset (0);
+}
+
+void
+BatchRenderer::set_threads (int n)
+{
+  if (n < 0) {
+    n = 0;
+  }
+
+  if (n != m_threads) {
+    mp_writer->wait ();
+    mp_writer->set_num_workers (n);
+  }
+
+  m_threads = n;
+
+  mp_view->set_synchronous (n == 0);
+  mp_view->set_drawing_workers (n);
+}
+
+unsigned int
+BatchRenderer::load_layout (const std::string &filename, const db::LoadLayoutOptions &options, const std::string &technology)
+{
+  unsigned int cv_index = mp_view->load_layout (filename, options, technology, false /*replace*/);
+  mp_view->max_hier ();
+  return cv_index;
+}
+
+void
+BatchRenderer::load_layer_props (const std::string &filename)
+{
+  mp_view->load_layer_props (filename);
+}
+
+db::DBox
+BatchRenderer::target_box (const db::DBox &box) const
+{
+  return box.empty () ? mp_view->full_box () : box;
+}
+
+QImage
+BatchRenderer::render (const db::DBox &box)
+{
+  return mp_view->get_image_with_options (m_width, m_height, m_linewidth, m_oversampling, m_resolution, QColor (), QColor (), QColor (), target_box (box), m_monochrome);
+}
+
+void
+BatchRenderer::render_to_file (const db::DBox &box, const std::string &filename)
+{
+  QImage image = render (box);
+
+  std::vector<std::pair<std::string, std::string> > texts;
+  for (unsigned int i = 0; i < mp_view->cellviews (); ++i) {
+    const lay::CellView &cv = mp_view->cellview (i);
+    if (cv.is_valid ()) {
+      texts.push_back (std::make_pair ("Cell" + tl::to_string (int (i) + 1), std::string (cv->layout ().cell_name (cv.cell_index ()))));
+    }
+  }
+  texts.push_back (std::make_pair (std::string ("Rect"), lay::Viewport (m_width, m_height, target_box (box)).box ().to_string ()));
+
+  mp_writer->schedule (new ImageWriterTask (image, filename, texts));
+
+  //  (re)start the writer if required - in synchronous mode, this will write the image
+  if (! mp_writer->is_running ()) {
+    mp_writer->start ();
+  }
+}
+
+void
+BatchRenderer::render_to_files (const std::vector<db::DBox> &boxes, const std::vector<std::string> &filenames)
+{
+  if (boxes.size () != filenames.size ()) {
+    throw tl::Exception (tl::to_string (QObject::tr ("The number of boxes (%d) does not match the number of file names (%d)")), int (boxes.size ()), int (filenames.size ()));
+  }
+
+  tl::SelfTimer timer (tl::verbosity () >= 11, tl::to_string (QObject::tr ("Render images")));
+
+  for (size_t i = 0; i < boxes.size (); ++i) {
+    render_to_file (boxes [i], filenames [i]);
+  }
+
+  wait ();
+}
+
+void
+BatchRenderer::wait ()
+{
+  mp_writer->wait ();
+
+  std::vector<std::string> errors = mp_writer->take_errors ();
+  if (! errors.empty ()) {
+    throw tl::Exception (tl::join (errors, "\n"));
+  }
+}
+
+}
+
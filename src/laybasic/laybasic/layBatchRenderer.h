@@ -0,0 +1,253 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#ifndef HDR_layBatchRenderer
+#define HDR_layBatchRenderer
+
+#include "laybasicCommon.h"
+
+#include "dbBox.h"
+#include "dbLoadLayoutOptions.h"
+#include "tlTypeTraits.h"
+
+#include <QImage>
+#include <QColor>
+
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace lay
+{
+
+class LayoutView;
+class ImageWriterJob;
+
+/**
+ *  @brief A renderer producing images of layout regions without a visible view
+ *
+ *  The batch renderer is intended for generating many images of a layout, i.e. thumbnails
+ *  of review locations. It employs a hidden layout view which is never shown, so no main
+ *  window is required. The layout is drawn into an image buffer using the drawing workers
+ *  of the view. When images are saved, the images are encoded and written in the background
+ *  while the next image is drawn.
+ *
+ *  The renderer is configured by loading a layout and optionally a layer properties file.
+ *  Further configuration can be done through the view object (see "view").
+ */
+class LAYBASIC_PUBLIC BatchRenderer
+{
+public:
+  /**
+   *  @brief Constructor
+   */
+  BatchRenderer ();
+
+  /**
+   *  @brief Destructor
+   */
+  ~BatchRenderer ();
+
+  /**
+   *  @brief Gets the view object used for rendering
+   *
+   *  The view can be used to configure the drawing (i.e. through "config_set").
+   */
+  lay::LayoutView *view ()
+  {
+    return mp_view.get ();
+  }
+
+  /**
+   *  @brief Loads a layout
+   *
+   *  The layout replaces any layout loaded before. The top cell is shown and all hierarchy
+   *  levels are drawn. Returns the index of the cellview created.
+   */
+  unsigned int load_layout (const std::string &filename, const db::LoadLayoutOptions &options, const std::string &technology);
+
+  /**
+   *  @brief Loads the layer properties from the given file
+   */
+  void load_layer_props (const std::string &filename);
+
+  /**
+   *  @brief Sets the image size in pixels
+   */
+  void set_size (unsigned int width, unsigned int height)
+  {
+    m_width = width;
+    m_height = height;
+  }
+
+  /**
+   *  @brief Gets the image width
+   */
+  unsigned int width () const
+  {
+    return m_width;
+  }
+
+  /**
+   *  @brief Gets the image height
+   */
+  unsigned int height () const
+  {
+    return m_height;
+  }
+
+  /**
+   *  @brief Sets the line width (0 for default)
+   */
+  void set_linewidth (int lw)
+  {
+    m_linewidth = lw;
+  }
+
+  /**
+   *  @brief Gets the line width
+   */
+  int linewidth () const
+  {
+    return m_linewidth;
+  }
+
+  /**
+   *  @brief Sets the oversampling factor (0 for default)
+   */
+  void set_oversampling (int os)
+  {
+    m_oversampling = os;
+  }
+
+  /**
+   *  @brief Gets the oversampling factor
+   */
+  int oversampling () const
+  {
+    return m_oversampling;
+  }
+
+  /**
+   *  @brief Sets the resolution (0 for default)
+   */
+  void set_resolution (double r)
+  {
+    m_resolution = r;
+  }
+
+  /**
+   *  @brief Gets the resolution
+   */
+  double resolution () const
+  {
+    return m_resolution;
+  }
+
+  /**
+   *  @brief Sets a value indicating whether to produce monochrome images
+   */
+  void set_monochrome (bool f)
+  {
+    m_monochrome = f;
+  }
+
+  /**
+   *  @brief Gets a value indicating whether to produce monochrome images
+   */
+  bool monochrome () const
+  {
+    return m_monochrome;
+  }
+
+  /**
+   *  @brief Sets the number of threads
+   *
+   *  The threads are used for drawing and for writing the images. A value of 0
+   *  will make the renderer draw and write the images synchronously.
+   */
+  void set_threads (int n);
+
+  /**
+   *  @brief Gets the number of threads
+   */
+  int threads () const
+  {
+    return m_threads;
+  }
+
+  /**
+   *  @brief Renders the given box into an image
+   *
+   *  The box is given in micrometer units. An empty box will render the whole layout.
+   */
+  QImage render (const db::DBox &box);
+
+  /**
+   *  @brief Renders the given box and writes the image to the given file in PNG format
+   *
+   *  Unless the number of threads is 0, the image is written in the background.
+   *  Call "wait" to ensure all images are written.
+   */
+  void render_to_file (const db::DBox &box, const std::string &filename);
+
+  /**
+   *  @brief Renders a list of boxes to the given files
+   *
+   *  "boxes" and "filenames" must have the same length, otherwise an exception is thrown.
+   *  This method waits until all images are written.
+   */
+  void render_to_files (const std::vector<db::DBox> &boxes, const std::vector<std::string> &filenames);
+
+  /**
+   *  @brief Waits until all images are written
+   *
+   *  If an error occured while writing an image, this method will throw an exception.
+   */
+  void wait ();
+
+private:
+  std::auto_ptr<lay::LayoutView> mp_view;
+  std::auto_ptr<lay::ImageWriterJob> mp_writer;
+  unsigned int m_width, m_height;
+  int m_linewidth, m_oversampling;
+  double m_resolution;
+  bool m_monochrome;
+  int m_threads;
+
+  db::DBox target_box (const db::DBox &box) const;
+
+  BatchRenderer (const BatchRenderer &);
+  BatchRenderer &operator= (const BatchRenderer &);
+};
+
+}
+
+namespace tl {
+  template <> struct type_traits<lay::BatchRenderer> : public type_traits<void> {
+    typedef tl::false_tag has_copy_constructor;
+  };
+}
+
+#endif
+
@@ -23,6 +23,7 @@
 
 #include "layBitmap.h"
 #include "layBitmapRenderer.h"
+#include "layBitmapKernels.h"
 #include "layFixedFont.h"
 #include "tlAlgorithm.h"
 
@@ -365,6 +366,12 @@ Bitmap::fill (unsigned int y, unsigned int x1, unsigned int x2)
   } else if (b > 0) {
 
     *sl++ |= ~masks [x1 % 32];
+    if (b > 8) {
+      //  long spans are filled by the vectorized kernel
+      lay::fill_words (sl, b - 1);
+      sl += b - 1;
+      b = 1;
+    }
     while (b > 1) {
       *sl++ |= all_ones;
       b--;
@@ -380,6 +387,41 @@ Bitmap::fill (unsigned int y, unsigned int x1, unsigned int x2)
   }
 }
 
+void 
+Bitmap::clear (unsigned int y, unsigned int x1, unsigned int x2)
+{
+  //  empty scanlines don't need to be cleared
+  if (m_scanlines.empty () || m_scanlines [y] == 0 || x2 <= x1) {
+    return;
+  }
+
+  unsigned int b1 = x1 / 32;
+
+  uint32_t *sl = m_scanlines [y];
+  sl += b1;
+
+  unsigned int b = x2 / 32 - b1;
+  if (b == 0) {
+
+    *sl &= ~(masks [x2 % 32] & ~masks [x1 % 32]);
+
+  } else {
+
+    *sl++ &= masks [x1 % 32];
+    while (b > 1) {
+      *sl++ = 0;
+      b--;
+    }
+
+    unsigned int m = masks [x2 % 32];
+    //  Hint: see "fill"
+    if (m) {
+      *sl &= ~m;
+    }
+
+  }
+}
+
 struct PosCompareF 
 {
   bool operator() (const RenderEdge &a, const RenderEdge &b) const
@@ -246,6 +246,18 @@ public:
    */
   void fill (unsigned int y, unsigned int x1, unsigned int x2);
 
+  /**
+   *  @brief Clear method 
+   *
+   *  Clears a line at scanline y, starting from x1 and ending
+   *  with x2 (exclusive). The same restrictions than for "fill" apply.
+   *
+   *  @param y The scanline
+   *  @param x1 The start coordinate
+   *  @param x2 The end coordinate
+   */
+  void clear (unsigned int y, unsigned int x1, unsigned int x2);
+
   /**
    *  @brief Merges the "from" bitmap into this
    *
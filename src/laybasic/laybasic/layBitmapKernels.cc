@@ -0,0 +1,372 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "layBitmapKernels.h"
+
+//  The vectorized kernels are compiled with the "target" function attribute, so no
+//  specific compiler options are required. They are selected only if the CPU supports them.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || (__GNUC__ * 100 + __GNUC_MINOR__ >= 409))
+#  define LAY_HAVE_X86_KERNELS
+#  include <immintrin.h>
+#endif
+
+namespace lay
+{
+
+const uint32_t fill_bits   = 0xff000000; // fill alpha value with ones
+
+// -------------------------------------------------------------
+//  Generic implementation
+
+static void
+fill_words_generic (uint32_t *words, unsigned int n)
+{
+  while (n-- > 0) {
+    *words++ = 0xffffffff;
+  }
+}
+
+static void
+mask_scanline_generic (uint32_t *data, const uint32_t *sl, const uint32_t *pattern, unsigned int stride, unsigned int n)
+{
+  const uint32_t *p = pattern;
+  while (n-- > 0) {
+    *data++ = *sl++ & *p++;
+    if (p == pattern + stride) {
+      p = pattern;
+    }
+  }
+}
+
+static void
+compose_scanline_generic (lay::color_t *pt, const uint32_t *data, unsigned int nplanes, unsigned int nwords, const std::pair<lay::color_t, lay::color_t> *masks, unsigned int width, bool transparent)
+{
+  unsigned int i = 0;
+  for (unsigned int x = 0; x < width; x += 32, ++i) {
+
+    lay::color_t y[32];
+    lay::color_t z[32];
+    for (int k = 0; k < 32; ++k) {
+      y[k] = transparent ? 0 : fill_bits;
+      z[k] = lay::wordones;
+    }
+
+    const uint32_t *dptr = data + nplanes * nwords + i;
+    for (int j = int (nplanes) - 1; j >= 0; --j) {
+
+      dptr -= nwords;
+
+      uint32_t d = *dptr;
+      if (d != 0) {
+
+        if (transparent) {
+          uint32_t m = 1;
+          for (unsigned int k = 0; k < 32 && x + k < width; ++k, m <<= 1) {
+            if ((d & m) != 0) {
+              y [k] |= (masks [j].first & z [k]) | fill_bits;
+              z [k] &= masks [j].second;
+            }
+          }
+        } else {
+          uint32_t m = 1;
+          for (unsigned int k = 0; k < 32 && x + k < width; ++k, m <<= 1) {
+            if ((d & m) != 0) {
+              y [k] |= masks [j].first & z [k];
+              z [k] &= masks [j].second;
+            }
+          }
+        }
+
+      }
+
+    }
+
+    for (unsigned int k = 0; k < 32 && x + k < width; ++k) {
+      *pt = (*pt & z[k]) | y[k];
+      ++pt;
+    }
+
+  }
+}
+
+#if defined(LAY_HAVE_X86_KERNELS)
+
+// -------------------------------------------------------------
+//  SSE2 implementation
+
+__attribute__((target("sse2"))) static void
+fill_words_sse2 (uint32_t *words, unsigned int n)
+{
+  __m128i ones = _mm_set1_epi32 (-1);
+  for ( ; n >= 4; n -= 4, words += 4) {
+    _mm_storeu_si128 ((__m128i *) words, ones);
+  }
+  fill_words_generic (words, n);
+}
+
+__attribute__((target("sse2"))) static void
+mask_scanline_sse2 (uint32_t *data, const uint32_t *sl, const uint32_t *pattern, unsigned int stride, unsigned int n)
+{
+  //  patterns whose stride does not divide the vector size are not vectorized
+  if (stride == 1 || stride == 2 || stride == 4) {
+
+    __m128i p = _mm_set_epi32 (pattern [3 % stride], pattern [2 % stride], pattern [1 % stride], pattern [0]);
+    for ( ; n >= 4; n -= 4, data += 4, sl += 4) {
+      _mm_storeu_si128 ((__m128i *) data, _mm_and_si128 (_mm_loadu_si128 ((const __m128i *) sl), p));
+    }
+
+  }
+
+  mask_scanline_generic (data, sl, pattern, stride, n);
+}
+
+__attribute__((target("sse2"))) static void
+compose_scanline_sse2 (lay::color_t *pt, const uint32_t *data, unsigned int nplanes, unsigned int nwords, const std::pair<lay::color_t, lay::color_t> *masks, unsigned int width, bool transparent)
+{
+  const __m128i bits = _mm_set_epi32 (8, 4, 2, 1);
+  const __m128i fill = _mm_set1_epi32 (transparent ? int (fill_bits) : 0);
+
+  unsigned int i = 0;
+  for (unsigned int x = 0; x < width; x += 32, ++i) {
+
+    //  groups of 4 pixels
+    for (unsigned int k = 0; k < 32 && x + k < width; k += 4) {
+
+      __m128i y = _mm_set1_epi32 (transparent ? 0 : int (fill_bits));
+      __m128i z = _mm_set1_epi32 (-1);
+
+      const uint32_t *dptr = data + nplanes * nwords + i;
+      for (int j = int (nplanes) - 1; j >= 0; --j) {
+
+        dptr -= nwords;
+
+        uint32_t d = (*dptr >> k) & 0xf;
+        if (d != 0) {
+          __m128i m = _mm_cmpeq_epi32 (_mm_and_si128 (_mm_set1_epi32 (int (d)), bits), bits);
+          __m128i first = _mm_set1_epi32 (int (masks [j].first));
+          __m128i second = _mm_set1_epi32 (int (masks [j].second));
+          y = _mm_or_si128 (y, _mm_and_si128 (m, _mm_or_si128 (_mm_and_si128 (first, z), fill)));
+          z = _mm_andnot_si128 (_mm_andnot_si128 (second, m), z);
+        }
+
+      }
+
+      if (x + k + 4 <= width) {
+        __m128i p = _mm_loadu_si128 ((const __m128i *) pt);
+        _mm_storeu_si128 ((__m128i *) pt, _mm_or_si128 (_mm_and_si128 (p, z), y));
+        pt += 4;
+      } else {
+        uint32_t yy[4], zz[4];
+        _mm_storeu_si128 ((__m128i *) yy, y);
+        _mm_storeu_si128 ((__m128i *) zz, z);
+        for (unsigned int kk = 0; x + k + kk < width; ++kk) {
+          *pt = (*pt & zz[kk]) | yy[kk];
+          ++pt;
+        }
+      }
+
+    }
+
+  }
+}
+
+// -------------------------------------------------------------
+//  AVX2 implementation
+
+__attribute__((target("avx2"))) static void
+fill_words_avx2 (uint32_t *words, unsigned int n)
+{
+  __m256i ones = _mm256_set1_epi32 (-1);
+  for ( ; n >= 8; n -= 8, words += 8) {
+    _mm256_storeu_si256 ((__m256i *) words, ones);
+  }
+  fill_words_generic (words, n);
+}
+
+__attribute__((target("avx2"))) static void
+mask_scanline_avx2 (uint32_t *data, const uint32_t *sl, const uint32_t *pattern, unsigned int stride, unsigned int n)
+{
+  //  patterns whose stride does not divide the vector size are not vectorized
+  if (stride == 1 || stride == 2 || stride == 4 || stride == 8) {
+
+    __m256i p = _mm256_set_epi32 (pattern [7 % stride], pattern [6 % stride], pattern [5 % stride], pattern [4 % stride],
+                                  pattern [3 % stride], pattern [2 % stride], pattern [1 % stride], pattern [0]);
+    for ( ; n >= 8; n -= 8, data += 8, sl += 8) {
+      _mm256_storeu_si256 ((__m256i *) data, _mm256_and_si256 (_mm256_loadu_si256 ((const __m256i *) sl), p));
+    }
+
+  }
+
+  mask_scanline_generic (data, sl, pattern, stride, n);
+}
+
+__attribute__((target("avx2"))) static void
+compose_scanline_avx2 (lay::color_t *pt, const uint32_t *data, unsigned int nplanes, unsigned int nwords, const std::pair<lay::color_t, lay::color_t> *masks, unsigned int width, bool transparent)
+{
+  const __m256i bits = _mm256_set_epi32 (128, 64, 32, 16, 8, 4, 2, 1);
+  const __m256i fill = _mm256_set1_epi32 (transparent ? int (fill_bits) : 0);
+
+  unsigned int i = 0;
+  for (unsigned int x = 0; x < width; x += 32, ++i) {
+
+    //  groups of 8 pixels
+    for (unsigned int k = 0; k < 32 && x + k < width; k += 8) {
+
+      __m256i y = _mm256_set1_epi32 (transparent ? 0 : int (fill_bits));
+      __m256i z = _mm256_set1_epi32 (-1);
+
+      const uint32_t *dptr = data + nplanes * nwords + i;
+      for (int j = int (nplanes) - 1; j >= 0; --j) {
+
+        dptr -= nwords;
+
+        uint32_t d = (*dptr >> k) & 0xff;
+        if (d != 0) {
+          __m256i m = _mm256_cmpeq_epi32 (_mm256_and_si256 (_mm256_set1_epi32 (int (d)), bits), bits);
+          __m256i first = _mm256_set1_epi32 (int (masks [j].first));
+          __m256i second = _mm256_set1_epi32 (int (masks [j].second));
+          y = _mm256_or_si256 (y, _mm256_and_si256 (m, _mm256_or_si256 (_mm256_and_si256 (first, z), fill)));
+          z = _mm256_andnot_si256 (_mm256_andnot_si256 (second, m), z);
+        }
+
+      }
+
+      if (x + k + 8 <= width) {
+        __m256i p = _mm256_loadu_si256 ((const __m256i *) pt);
+        _mm256_storeu_si256 ((__m256i *) pt, _mm256_or_si256 (_mm256_and_si256 (p, z), y));
+        pt += 8;
+      } else {
+        uint32_t yy[8], zz[8];
+        _mm256_storeu_si256 ((__m256i *) yy, y);
+        _mm256_storeu_si256 ((__m256i *) zz, z);
+        for (unsigned int kk = 0; x + k + kk < width; ++kk) {
+          *pt = (*pt & zz[kk]) | yy[kk];
+          ++pt;
+        }
+      }
+
+    }
+
+  }
+}
+
+#endif
+
+// -------------------------------------------------------------
+//  Kernel selection
+
+struct BitmapKernelTable
+{
+  void (*fill_words) (uint32_t *, unsigned int);
+  void (*mask_scanline) (uint32_t *, const uint32_t *, const uint32_t *, unsigned int, unsigned int);
+  void (*compose_scanline) (lay::color_t *, const uint32_t *, unsigned int, unsigned int, const std::pair<lay::color_t, lay::color_t> *, unsigned int, bool);
+};
+
+static const BitmapKernelTable kernel_tables [] = {
+  { &fill_words_generic, &mask_scanline_generic, &compose_scanline_generic },
+#if defined(LAY_HAVE_X86_KERNELS)
+  { &fill_words_sse2, &mask_scanline_sse2, &compose_scanline_sse2 },
+  { &fill_words_avx2, &mask_scanline_avx2, &compose_scanline_avx2 }
+#else
+  { &fill_words_generic, &mask_scanline_generic, &compose_scanline_generic },
+  { &fill_words_generic, &mask_scanline_generic, &compose_scanline_generic }
+#endif
+};
+
+static BitmapKernels s_kernels = BitmapKernelsGeneric;
+static const BitmapKernelTable *sp_kernels = &kernel_tables [BitmapKernelsGeneric];
+
+bool
+bitmap_kernels_available (BitmapKernels kernels)
+{
+  if (kernels == BitmapKernelsGeneric) {
+    return true;
+  }
+
+#if defined(LAY_HAVE_X86_KERNELS)
+  __builtin_cpu_init ();
+  if (kernels == BitmapKernelsSSE2) {
+    return __builtin_cpu_supports ("sse2");
+  } else if (kernels == BitmapKernelsAVX2) {
+    return __builtin_cpu_supports ("avx2");
+  }
+#endif
+
+  return false;
+}
+
+BitmapKernels
+bitmap_kernels ()
+{
+  return s_kernels;
+}
+
+void
+set_bitmap_kernels (BitmapKernels kernels)
+{
+  if (! bitmap_kernels_available (kernels)) {
+    kernels = BitmapKernelsGeneric;
+  }
+
+  s_kernels = kernels;
+  sp_kernels = &kernel_tables [kernels];
+}
+
+namespace
+{
+  //  selects the best kernels available at startup
+  struct BitmapKernelsInitializer
+  {
+    BitmapKernelsInitializer ()
+    {
+      if (bitmap_kernels_available (BitmapKernelsAVX2)) {
+        set_bitmap_kernels (BitmapKernelsAVX2);
+      } else if (bitmap_kernels_available (BitmapKernelsSSE2)) {
+        set_bitmap_kernels (BitmapKernelsSSE2);
+      }
+    }
+  };
+
+  static BitmapKernelsInitializer s_initializer;
+}
+
+void
+fill_words (uint32_t *words, unsigned int n)
+{
+  sp_kernels->fill_words (words, n);
+}
+
+void
+mask_scanline (uint32_t *data, const uint32_t *sl, const uint32_t *pattern, unsigned int stride, unsigned int n)
+{
+  sp_kernels->mask_scanline (data, sl, pattern, stride, n);
+}
+
+void
+compose_scanline (lay::color_t *pixels, const uint32_t *data, unsigned int nplanes, unsigned int nwords, const std::pair<lay::color_t, lay::color_t> *masks, unsigned int width, bool transparent)
+{
+  sp_kernels->compose_scanline (pixels, data, nplanes, nwords, masks, width, transparent);
+}
+
+}
+
@@ -0,0 +1,99 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#ifndef HDR_layBitmapKernels
+#define HDR_layBitmapKernels
+
+#include "laybasicCommon.h"
+#include "layViewOp.h"
+
+#include <stdint.h>
+
+#include <utility>
+
+namespace lay
+{
+
+/**
+ *  @brief The implementations of the bitmap kernels
+ *
+ *  The kernels are the inner loops of the bitmap fill and the bitmap-to-image
+ *  conversion. Vectorized implementations are provided for x86 CPUs supporting
+ *  SSE2 or AVX2. The best implementation available is selected at startup. All
+ *  implementations deliver the same results.
+ */
+enum BitmapKernels
+{
+  BitmapKernelsGeneric = 0,
+  BitmapKernelsSSE2 = 1,
+  BitmapKernelsAVX2 = 2
+};
+
+/**
+ *  @brief Gets a value indicating whether the given kernel implementation is available on this machine
+ */
+LAYBASIC_PUBLIC bool bitmap_kernels_available (BitmapKernels kernels);
+
+/**
+ *  @brief Gets the kernel implementation currently used
+ */
+LAYBASIC_PUBLIC BitmapKernels bitmap_kernels ();
+
+/**
+ *  @brief Selects the kernel implementation
+ *
+ *  This method is intended for testing. If the given implementation is not
+ *  available, the generic one is used.
+ */
+LAYBASIC_PUBLIC void set_bitmap_kernels (BitmapKernels kernels);
+
+/**
+ *  @brief Sets n words to all ones
+ */
+LAYBASIC_PUBLIC void fill_words (uint32_t *words, unsigned int n);
+
+/**
+ *  @brief Masks a scanline with a pattern
+ *
+ *  This function computes data[i] = sl[i] & pattern[i % stride] for the n words of the scanline.
+ */
+LAYBASIC_PUBLIC void mask_scanline (uint32_t *data, const uint32_t *sl, const uint32_t *pattern, unsigned int stride, unsigned int n);
+
+/**
+ *  @brief Composes a scanline of an image from scanlines of multiple planes
+ *
+ *  "data" holds "nplanes" scanlines with "nwords" words each. "masks" holds an
+ *  OR and AND mask for every plane. The last plane is the topmost one: where a pixel
+ *  is set, the OR mask is applied to the color bits not masked by the planes above. Then
+ *  the AND mask masks the color bits for the planes below. Finally, the unmasked bits
+ *  of the image pixels are kept and the composed bits are added.
+ *
+ *  If "transparent" is true, the alpha channel of the pixels covered by a plane is set.
+ *  "width" is the number of pixels in "pixels".
+ */
+LAYBASIC_PUBLIC void compose_scanline (lay::color_t *pixels, const uint32_t *data, unsigned int nplanes, unsigned int nwords, const std::pair<lay::color_t, lay::color_t> *masks, unsigned int width, bool transparent);
+
+}
+
+#endif
+
@@ -23,6 +23,7 @@
 
 #include "layBitmapsToImage.h"
 #include "layBitmap.h"
+#include "layBitmapKernels.h"
 #include "layDitherPattern.h"
 #include "layLineStyles.h"
 #include "tlTimer.h"
@@ -37,21 +38,7 @@ namespace lay
 static void
 render_scanline_std (const uint32_t *dp, unsigned int ds, const lay::Bitmap *pbitmap, unsigned int y, unsigned int w, unsigned int /*h*/, uint32_t *data)
 {
-  const uint32_t *ps = pbitmap->scanline (y);
-  const uint32_t *dm = dp;
-
-  unsigned int x = w;
-  while (x >= lay::wordlen) {
-    *data++ = *ps++ & *dm++;
-    if (dm == dp + ds) {
-      dm = dp;
-    }
-    x -= lay::wordlen;
-  }
-
-  if (x > 0) {
-    *data = *ps & *dm;
-  }
+  lay::mask_scanline (data, pbitmap->scanline (y), dp, ds, (w + lay::wordlen - 1) / lay::wordlen);
 }
 
 static void
@@ -529,7 +516,6 @@ bitmaps_to_image_rgb (const std::vector<lay::ViewOp> &view_ops_in,
     masks.erase (masks.begin (), masks.end ());
 
     const uint32_t needed_bits = 0x00ffffff; // alpha channel not needed
-    const uint32_t fill_bits   = 0xff000000; // fill alpha value with ones
     uint32_t *dptr = buffer;
     uint32_t ne_mask = (1 << (y % slice));
     for (unsigned int i = 0; i < view_ops.size (); ++i) {
@@ -579,69 +565,7 @@ bitmaps_to_image_rgb (const std::vector<lay::ViewOp> &view_ops_in,
     if (masks.size () > 0) {
 
       lay::color_t *pt = (lay::color_t *) pimage->scanLine (height - 1 - y);
-      uint32_t *dptr_end = dptr; 
-
-      unsigned int i = 0;
-      for (unsigned int x = 0; x < width; x += 32, ++i) {
-
-        lay::color_t y[32];
-        if (transparent) {
-          for (int i = 0; i < 32; ++i) {
-            y[i] = 0;
-          }
-        } else {
-          for (int i = 0; i < 32; ++i) {
-            y[i] = fill_bits;
-          }
-        };
-
-        lay::color_t z[32] = { 
-          lay::wordones, lay::wordones, lay::wordones, lay::wordones, 
-          lay::wordones, lay::wordones, lay::wordones, lay::wordones, 
-          lay::wordones, lay::wordones, lay::wordones, lay::wordones, 
-          lay::wordones, lay::wordones, lay::wordones, lay::wordones, 
-          lay::wordones, lay::wordones, lay::wordones, lay::wordones, 
-          lay::wordones, lay::wordones, lay::wordones, lay::wordones, 
-          lay::wordones, lay::wordones, lay::wordones, lay::wordones, 
-          lay::wordones, lay::wordones, lay::wordones, lay::wordones, 
-        };
-
-        dptr = dptr_end - nwords + i;
-        for (int j = masks.size () - 1; j >= 0; --j) {
-
-          uint32_t d = *dptr;
-          if (d != 0) {
-
-            if (transparent) {
-              uint32_t m = 1;
-              for (unsigned int k = 0; k < 32 && x + k < width; ++k, m <<= 1) {
-                if ((d & m) != 0) {
-                  y [k] |= (masks [j].first & z [k]) | fill_bits;
-                  z [k] &= masks [j].second;
-                }
-              }
-            } else {
-              uint32_t m = 1;
-              for (unsigned int k = 0; k < 32 && x + k < width; ++k, m <<= 1) {
-                if ((d & m) != 0) {
-                  y [k] |= masks [j].first & z [k];
-                  z [k] &= masks [j].second;
-                }
-              }
-            }
-
-          }
-
-          dptr -= nwords;
-
-        }
-
-        for (unsigned int k = 0; k < 32 && x + k < width; ++k) {
-          *pt = (*pt & z[k]) | y[k];
-          ++pt;
-        }
-
-      }
+      lay::compose_scanline (pt, buffer, (unsigned int) masks.size (), nwords, &masks.front (), width, transparent);
 
     }
 
@@ -382,12 +382,9 @@ CellSelectionForm::select_entry (lay::CellView::cell_index_type ci)
 
   //  select the current entry
   QModelIndex mi;
-  for (int c = 0; c < model->toplevel_items (); ++c) {
-    lay::CellTreeItem *item = model->toplevel_item (c);
-    if (item->cell_index () == ci) {
-      mi = model->model_index (item);
-      break;
-    }
+  int c = model->find_toplevel_item (ci);
+  if (c >= 0) {
+    mi = model->model_index (model->toplevel_item (c));
   }
         
   if (mi.isValid ()) {
@@ -734,12 +731,9 @@ LibraryCellSelectionForm::select_pcell_entry (db::pcell_id_type pci)
 
   //  select the current entry
   QModelIndex mi;
-  for (int c = 0; c < model->toplevel_items (); ++c) {
-    lay::CellTreeItem *item = model->toplevel_item (c);
-    if (item->is_pcell () && item->cell_index () == pci) {
-      mi = model->model_index (item);
-      break;
-    }
+  int c = model->find_toplevel_item (pci, true);
+  if (c >= 0) {
+    mi = model->model_index (model->toplevel_item (c));
   }
         
   if (mi.isValid ()) {
@@ -773,12 +767,9 @@ LibraryCellSelectionForm::select_entry (lay::CellView::cell_index_type ci)
 
   //  select the current entry
   QModelIndex mi;
-  for (int c = 0; c < model->toplevel_items (); ++c) {
-    lay::CellTreeItem *item = model->toplevel_item (c);
-    if (item->cell_index () == ci) {
-      mi = model->model_index (item);
-      break;
-    }
+  int c = model->find_toplevel_item (ci);
+  if (c >= 0) {
+    mi = model->model_index (model->toplevel_item (c));
   }
         
   if (mi.isValid ()) {
@@ -24,6 +24,7 @@
 #include "layCellTreeModel.h"
 #include "layLayoutView.h"
 #include "tlGlobPattern.h"
+#include "tlThreadPool.h"
 #include "dbPCellHeader.h"
 
 #include <QTreeView>
@@ -37,37 +38,133 @@
 namespace lay {
 
 // --------------------------------------------------------------------
-//  A compare functor for the cell tree items by area
+//  Sorting of the cell tree entries
 
-struct cmp_cell_tree_items_f 
+static std::string
+cell_display_text (const db::Layout *layout, bool is_pcell, size_t index)
 {
-  cmp_cell_tree_items_f (CellTreeModel::Sorting s)
+  if (is_pcell) {
+    return layout->pcell_header (index)->get_name ();
+  } else if (layout->is_valid_cell_index (index)) {
+    return layout->cell (index).get_display_name ();
+  } else {
+    return std::string ();
+  }
+}
+
+namespace
+{
+
+/**
+ *  @brief The precomputed sort key of a cell tree entry
+ *
+ *  Computing the display text is expensive, so it is done once per entry
+ *  rather than once per comparison.
+ */
+struct CellTreeSortKey
+{
+  std::string name;
+  db::Box::area_type area;
+  std::pair<bool, size_t> id;
+};
+
+/**
+ *  @brief Computes the sort keys for a range of entries (used with tl::parallel_for)
+ */
+struct ComputeSortKey
+{
+  ComputeSortKey (const db::Layout *layout, const std::vector<std::pair<bool, size_t> > *ids, std::vector<CellTreeSortKey> *keys, CellTreeModel::Sorting sorting)
+    : mp_layout (layout), mp_ids (ids), mp_keys (keys), m_sorting (sorting)
+  { }
+
+  void operator() (size_t i) const
+  {
+    const std::pair<bool, size_t> &id = (*mp_ids) [i];
+    CellTreeSortKey &key = (*mp_keys) [i];
+    key.id = id;
+    key.name = cell_display_text (mp_layout, id.first, id.second);
+    if (m_sorting != CellTreeModel::ByName && ! id.first && mp_layout->is_valid_cell_index (id.second)) {
+      key.area = mp_layout->cell (id.second).bbox ().area ();
+    } else {
+      key.area = 0;
+    }
+  }
+
+private:
+  const db::Layout *mp_layout;
+  const std::vector<std::pair<bool, size_t> > *mp_ids;
+  std::vector<CellTreeSortKey> *mp_keys;
+  CellTreeModel::Sorting m_sorting;
+};
+
+/**
+ *  @brief A compare functor for the sort keys 
+ *
+ *  With area sorting, PCells are considered smaller than cells and entries with the same area 
+ *  are sorted by name.
+ */
+struct cmp_cell_tree_sort_keys_f
+{
+  cmp_cell_tree_sort_keys_f (CellTreeModel::Sorting s)
     : m_sorting (s)
   { }
 
-  bool operator() (const CellTreeItem *a, const CellTreeItem *b)
+  bool operator() (const CellTreeSortKey *a, const CellTreeSortKey *b) const
   {
-    if (m_sorting == CellTreeModel::ByArea) {
-      if (a->by_area_equal_than (b)) {
-        return a->by_name_less_than (b);
-      } else {
-        return a->by_area_less_than (b);
+    if (m_sorting != CellTreeModel::ByName) {
+      if (a->id.first != b->id.first) {
+        return (m_sorting == CellTreeModel::ByArea) == (a->id.first > b->id.first);
+      } else if (a->area != b->area) {
+        return (m_sorting == CellTreeModel::ByArea) == (a->area < b->area);
       }
-    } else if (m_sorting == CellTreeModel::ByAreaReverse) {
-      if (a->by_area_equal_than (b)) {
-        return a->by_name_less_than (b);
-      } else {
-        return b->by_area_less_than (a);
-      }
-    } else {
-      return a->by_name_less_than (b);
     }
+    return a->name < b->name;
   }
 
 private:
   CellTreeModel::Sorting m_sorting;
 };
 
+}
+
+//  below this number of entries, the sort keys are computed in the calling thread
+const size_t min_parallel_sort_keys = 10000;
+
+/**
+ *  @brief Sorts the cell tree entries given by (is_pcell, cell index or PCell id)
+ */
+static void
+sort_cell_tree_entries (const db::Layout *layout, std::vector<std::pair<bool, size_t> > &ids, CellTreeModel::Sorting sorting)
+{
+  if (ids.size () < 2) {
+    return;
+  }
+
+  std::vector<CellTreeSortKey> keys (ids.size ());
+  ComputeSortKey compute (layout, &ids, &keys, sorting);
+  if (ids.size () < min_parallel_sort_keys) {
+    for (size_t i = 0; i < ids.size (); ++i) {
+      compute (i);
+    }
+  } else {
+    //  Cell::bbox () updates the layout lazily which must not happen from multiple threads
+    layout->update ();
+    tl::parallel_for (0, ids.size (), compute);
+  }
+
+  std::vector<const CellTreeSortKey *> sorted;
+  sorted.reserve (keys.size ());
+  for (std::vector<CellTreeSortKey>::const_iterator k = keys.begin (); k != keys.end (); ++k) {
+    sorted.push_back (&*k);
+  }
+
+  std::sort (sorted.begin (), sorted.end (), cmp_cell_tree_sort_keys_f (sorting));
+
+  for (size_t i = 0; i < sorted.size (); ++i) {
+    ids [i] = sorted [i]->id;
+  }
+}
+
 // --------------------------------------------------------------------
 //  A compare functor for the cell tree items vs. name
 
@@ -103,13 +200,7 @@ CellTreeItem::~CellTreeItem ()
 std::string 
 CellTreeItem::display_text () const
 {
-  if (m_is_pcell) {
-    return name ();
-  } else if (mp_layout->is_valid_cell_index (m_cell_index)) {
-    return mp_layout->cell (m_cell_index).get_display_name ();
-  } else {
-    return std::string ();
-  }
+  return cell_display_text (mp_layout, m_is_pcell, m_cell_index);
 }
 
 int 
@@ -127,17 +218,19 @@ CellTreeItem::child (int index)
 
     const db::Cell *cell = & mp_layout->cell (m_cell_index);
 
-    m_children.reserve (m_child_count);
-
+    std::vector<std::pair<bool, size_t> > ids;
+    ids.reserve (m_child_count);
     for (db::Cell::child_cell_iterator child = cell->begin_child_cells (); ! child.at_end (); ++child) {
-      CellTreeItem *child_item = new CellTreeItem (mp_layout, this, false, *child, false, m_sorting);
-      m_children.push_back (child_item);
+      ids.push_back (std::make_pair (false, size_t (*child)));
     }
 
-    std::sort (m_children.begin (), m_children.end (), cmp_cell_tree_items_f (m_sorting));
+    sort_cell_tree_entries (mp_layout, ids, m_sorting);
 
-    for (size_t i = 0; i < m_children.size (); ++i) {
-      m_children [i]->set_index (i);
+    m_children.reserve (ids.size ());
+    for (size_t i = 0; i < ids.size (); ++i) {
+      CellTreeItem *child_item = new CellTreeItem (mp_layout, this, false, ids [i].second, false, m_sorting);
+      child_item->set_index (i);
+      m_children.push_back (child_item);
     }
 
   }
@@ -240,7 +333,8 @@ CellTreeModel::CellTreeModel (QWidget *parent, lay::LayoutView *view, int cv_ind
     mp_parent (parent), 
     mp_view (view), 
     m_cv_index (cv_index),
-    mp_base (base)
+    mp_base (base),
+    m_toplevel_flat (false)
 {
   mp_view->cell_visibility_changed_event.add (this, &CellTreeModel::signal_data_changed);
   mp_view->cellview_changed_event.add (this, &CellTreeModel::signal_data_changed_with_int);
@@ -263,7 +357,8 @@ CellTreeModel::CellTreeModel (QWidget *parent, db::Layout *layout, unsigned int
     mp_parent (parent), 
     mp_view (0), 
     m_cv_index (-1),
-    mp_base (base)
+    mp_base (base),
+    m_toplevel_flat (false)
 {
   m_flat = ((flags & Flat) != 0) && ((flags & TopCells) == 0);
   m_pad = ((flags & NoPadding) == 0);
@@ -297,6 +392,7 @@ CellTreeModel::configure (lay::LayoutView *view, int cv_index, unsigned int flag
 
   std::vector<lay::CellTreeItem *> old_toplevel_items;
   old_toplevel_items.swap (m_toplevel);
+  m_toplevel_cells.clear ();
 
   if (view != mp_view) {
 
@@ -361,11 +457,10 @@ CellTreeModel::configure (lay::LayoutView *view, int cv_index, unsigned int flag
           if (! layout->is_valid_cell_index (*ci)) {
             //  can't translate this index
           } else if (parent == 0) {
-            for (int i = 0; i < int (m_toplevel.size ()) && !new_parent; ++i) {
-              if (m_toplevel [i]->cell_index () == *ci) {
-                new_parent = m_toplevel [i];
-                row = i;
-              }
+            int i = find_toplevel_item (*ci);
+            if (i >= 0) {
+              new_parent = get_toplevel_item (i);
+              row = i;
             }
           } else {
             for (int i = 0; i < parent->children () && !new_parent; ++i) {
@@ -398,7 +493,9 @@ CellTreeModel::configure (lay::LayoutView *view, int cv_index, unsigned int flag
 
   //  TODO: harden against exceptions
   for (std::vector<lay::CellTreeItem *>::iterator t = old_toplevel_items.begin (); t != old_toplevel_items.end (); ++t) {
-    delete *t;
+    if (*t) {
+      delete *t;
+    }
   }
 }
 
@@ -420,23 +517,31 @@ void
 CellTreeModel::clear_top_level ()
 {
   for (std::vector<CellTreeItem *>::iterator c = m_toplevel.begin (); c != m_toplevel.end (); ++c) {
-    delete *c;
+    if (*c) {
+      delete *c;
+    }
   }
   m_toplevel.clear ();
+  m_toplevel_cells.clear ();
 }
 
 void 
 CellTreeModel::build_top_level ()
 {
+  //  NOTE: the top level items are not created here but on demand (see get_toplevel_item).
+  //  Only the cell indexes are collected and sorted. This way, layouts with millions of cells
+  //  can be shown in flat mode without creating an item per cell.
+
+  m_toplevel_flat = true;
+
   if ((m_flags & Children) != 0) {
 
     m_flat = true; //  no "hierarchical children" yet.
 
     if (mp_base) {
-      m_toplevel.reserve (mp_base->child_cells ());
+      m_toplevel_cells.reserve (mp_base->child_cells ());
       for (db::Cell::child_cell_iterator child = mp_base->begin_child_cells (); ! child.at_end (); ++child) {
-        CellTreeItem *item = new CellTreeItem (mp_layout, 0, false, *child, true, m_sorting);
-        m_toplevel.push_back (item);
+        m_toplevel_cells.push_back (std::make_pair (false, size_t (*child)));
       }
     }
 
@@ -445,29 +550,28 @@ CellTreeModel::build_top_level ()
     m_flat = true; //  no "hierarchical parents" yet.
 
     if (mp_base) {
-      m_toplevel.reserve (mp_base->parent_cells ());
+      m_toplevel_cells.reserve (mp_base->parent_cells ());
       for (db::Cell::parent_cell_iterator parent = mp_base->begin_parent_cells (); parent != mp_base->end_parent_cells (); ++parent) {
-        CellTreeItem *item = new CellTreeItem (mp_layout, 0, false, *parent, true, m_sorting);
-        m_toplevel.push_back (item);
+        m_toplevel_cells.push_back (std::make_pair (false, size_t (*parent)));
       }
     }
 
   } else {
 
     if (m_flat) {
-      m_toplevel.reserve (mp_layout->cells ());
+      m_toplevel_cells.reserve (mp_layout->cells ());
+    } else {
+      m_toplevel_flat = ((m_flags & TopCells) != 0);
     }
 
     db::Layout::top_down_const_iterator top = mp_layout->begin_top_down ();
     while (top != mp_layout->end_top_down ()) {
 
       if (m_flat) {
-        CellTreeItem *item = new CellTreeItem (mp_layout, 0, false, *top, true, m_sorting);
-        m_toplevel.push_back (item);
+        m_toplevel_cells.push_back (std::make_pair (false, size_t (*top)));
       } else if (mp_layout->cell (*top).is_top ()) {
         if ((m_flags & BasicCells) == 0 || ! mp_layout->cell (*top).is_proxy ()) {
-          CellTreeItem *item = new CellTreeItem (mp_layout, 0, false, *top, (m_flags & TopCells) != 0, m_sorting);
-          m_toplevel.push_back (item);
+          m_toplevel_cells.push_back (std::make_pair (false, size_t (*top)));
         }
       } else {
         break;
@@ -479,18 +583,38 @@ CellTreeModel::build_top_level ()
 
     if ((m_flags & BasicCells) != 0) {
       for (db::Layout::pcell_iterator pc = mp_layout->begin_pcells (); pc != mp_layout->end_pcells (); ++pc) {
-        CellTreeItem *item = new CellTreeItem (mp_layout, 0, true, pc->second, true, m_sorting);
-        m_toplevel.push_back (item);
+        m_toplevel_cells.push_back (std::make_pair (true, size_t (pc->second)));
       }
     }
 
   }
 
-  std::sort (m_toplevel.begin (), m_toplevel.end (), cmp_cell_tree_items_f (m_sorting));
+  sort_cell_tree_entries (mp_layout, m_toplevel_cells, m_sorting);
+
+  m_toplevel.resize (m_toplevel_cells.size (), 0);
+}
+
+CellTreeItem *
+CellTreeModel::get_toplevel_item (size_t index) const
+{
+  CellTreeItem *&item = m_toplevel [index];
+  if (! item) {
+    const std::pair<bool, size_t> &id = m_toplevel_cells [index];
+    item = new CellTreeItem (mp_layout, 0, id.first, id.second, m_toplevel_flat, m_sorting);
+    item->set_index (index);
+  }
+  return item;
+}
 
-  for (size_t i = 0; i < m_toplevel.size (); ++i) {
-    m_toplevel [i]->set_index (i);
+int
+CellTreeModel::find_toplevel_item (size_t cell_index, bool is_pcell) const
+{
+  for (size_t i = 0; i < m_toplevel_cells.size (); ++i) {
+    if (m_toplevel_cells [i].second == cell_index && m_toplevel_cells [i].first == is_pcell) {
+      return int (i);
+    }
   }
+  return -1;
 }
 
 Qt::ItemFlags 
@@ -709,7 +833,7 @@ CellTreeModel::index (int row, int column, const QModelIndex &parent) const
       return createIndex (row, column, item->child (row));
     }
   } else if (row >= 0 && row < int (m_toplevel.size ())) {
-    return createIndex (row, column, m_toplevel [row]);
+    return createIndex (row, column, get_toplevel_item (row));
   } else {
     return QModelIndex ();
   }
@@ -752,7 +876,7 @@ CellTreeModel::toplevel_item (int index)
   if (mp_layout->under_construction () || (mp_layout->manager () && mp_layout->manager ()->transacting ())) {
     return 0;
   } else {
-    return m_toplevel [index];
+    return get_toplevel_item (index);
   }
 }
 
@@ -871,17 +995,54 @@ CellTreeModel::locate_prev ()
   }
 }
 
+namespace
+{
+
+//  flags for the search hits
+const char hit_self = 1;       //  the cell's name matches
+const char hit_below = 2;      //  some child cell's name matches
+
+/**
+ *  @brief Matches the cell names against the pattern (used with tl::parallel_for)
+ */
+struct MatchCellName
+{
+  MatchCellName (const db::Layout *layout, const tl::GlobPattern *pattern, const std::vector<std::pair<bool, size_t> > *ids, std::vector<char> *hits)
+    : mp_layout (layout), mp_pattern (pattern), mp_ids (ids), mp_hits (hits)
+  { }
+
+  void operator() (size_t i) const
+  {
+    bool is_pcell = mp_ids ? (*mp_ids) [i].first : false;
+    size_t ci = mp_ids ? (*mp_ids) [i].second : i;
+    if ((is_pcell || mp_layout->is_valid_cell_index (ci)) && mp_pattern->match (cell_display_text (mp_layout, is_pcell, ci))) {
+      (*mp_hits) [i] = hit_self;
+    }
+  }
+
+private:
+  const db::Layout *mp_layout;
+  const tl::GlobPattern *mp_pattern;
+  const std::vector<std::pair<bool, size_t> > *mp_ids;
+  std::vector<char> *mp_hits;
+};
+
+}
+
 void
-CellTreeModel::search_children (const tl::GlobPattern &pattern, CellTreeItem *item)
+CellTreeModel::search_children (const std::vector<char> &hits, CellTreeItem *item)
 {
   int children = item->children ();
   for (int i = 0; i < children; ++i) {
     CellTreeItem *c = item->child (i);
     if (c) {
-      if (c->name_matches (pattern)) {
+      char h = hits [c->cell_index ()];
+      if ((h & hit_self) != 0) {
         m_selected_indexes.push_back (model_index (c));
       }
-      search_children (pattern, c);
+      if ((h & hit_below) != 0) {
+        search_children (hits, c);
+      }
     }
   }
 }
@@ -900,12 +1061,37 @@ CellTreeModel::locate (const char *name, bool glob_pattern, bool case_sensitive,
   p.set_exact (!glob_pattern);
   p.set_header_match (true);
 
-  for (std::vector <CellTreeItem *>::const_iterator lc = m_toplevel.begin (); lc != m_toplevel.end (); ++lc) {
-    if ((*lc)->name_matches (p)) {
-      m_selected_indexes.push_back (model_index (*lc));
+  //  match the names of the top level entries - this does not require the items to be created
+
+  std::vector<char> top_hits (m_toplevel_cells.size (), 0);
+  tl::parallel_for (0, m_toplevel_cells.size (), MatchCellName (mp_layout, &p, &m_toplevel_cells, &top_hits));
+
+  //  for the hierarchical search, match all cell names and determine the cells below which a
+  //  match is found. Only those branches of the tree are expanded then.
+
+  std::vector<char> hits;
+  if (! top_only && ! m_flat) {
+
+    hits.resize (mp_layout->cells (), 0);
+    tl::parallel_for (0, hits.size (), MatchCellName (mp_layout, &p, 0, &hits));
+
+    for (db::Layout::bottom_up_const_iterator c = mp_layout->begin_bottom_up (); c != mp_layout->end_bottom_up (); ++c) {
+      const db::Cell &cell = mp_layout->cell (*c);
+      for (db::Cell::child_cell_iterator cc = cell.begin_child_cells (); ! cc.at_end () && (hits [*c] & hit_below) == 0; ++cc) {
+        if (hits [*cc] != 0) {
+          hits [*c] |= hit_below;
+        }
+      }
+    }
+
+  }
+
+  for (size_t i = 0; i < m_toplevel_cells.size (); ++i) {
+    if (top_hits [i]) {
+      m_selected_indexes.push_back (model_index (get_toplevel_item (i)));
     }
-    if (! top_only) {
-      search_children (p, *lc);
+    if (! hits.empty () && ! m_toplevel_cells [i].first && (hits [m_toplevel_cells [i].second] & hit_below) != 0) {
+      search_children (hits, get_toplevel_item (i));
     }
   }
 
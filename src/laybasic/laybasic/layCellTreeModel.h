@@ -123,9 +123,19 @@ public:
 
   /**
    *  @brief Return the top level item
+   *
+   *  Top level items are created on demand.
    */
   CellTreeItem *toplevel_item (int index);
 
+  /**
+   *  @brief Finds the top level item for the given cell index or PCell id
+   *
+   *  Returns the index of the top level item or -1 if there is no such item.
+   *  This method does not create items, hence it is cheap even for a large number of cells.
+   */
+  int find_toplevel_item (size_t cell_index, bool is_pcell = false) const;
+
   /**
    *  @brief Transform a CellTreeItem * to a QModelIndex
    */
@@ -222,14 +232,17 @@ private:
   const db::Layout *mp_layout;
   int m_cv_index;
   const db::Cell *mp_base;
-  std::vector <CellTreeItem *> m_toplevel;
+  mutable std::vector <CellTreeItem *> m_toplevel;
+  std::vector <std::pair<bool, size_t> > m_toplevel_cells;
+  bool m_toplevel_flat;
   std::set <QModelIndex> m_selected_indexes_set;
   std::vector <QModelIndex> m_selected_indexes;
   std::vector <QModelIndex>::const_iterator m_current_index;
 
   void build_top_level ();
   void clear_top_level ();
-  void search_children (const tl::GlobPattern &pattern, CellTreeItem *item);
+  CellTreeItem *get_toplevel_item (size_t index) const;
+  void search_children (const std::vector<char> &hits, CellTreeItem *item);
 };
 
 /**
@@ -24,6 +24,7 @@
 #include "layCellView.h"
 #include "layLayoutView.h"
 #include "layStream.h"
+#include "layDensityPyramid.h"
 #include "dbLayout.h"
 #include "dbWriter.h"
 #include "dbReader.h"
@@ -54,6 +55,7 @@ filename_for_caption (const std::string &fn)
 
 LayoutHandle::LayoutHandle (db::Layout *layout, const std::string &filename)
   : mp_layout (layout),
+    mp_density_pyramid (0),
     m_ref_count (0),
     m_filename (filename),
     m_dirty (false),
@@ -78,6 +80,8 @@ LayoutHandle::LayoutHandle (db::Layout *layout, const std::string &filename)
 
   }
 
+  mp_density_pyramid = new lay::DensityPyramid (mp_layout);
+
   mp_layout->hier_changed_event.add (this, &LayoutHandle::layout_changed);
   mp_layout->bboxes_changed_any_event.add (this, &LayoutHandle::layout_changed);
   mp_layout->cell_name_changed_event.add (this, &LayoutHandle::layout_changed);
@@ -95,6 +99,9 @@ LayoutHandle::~LayoutHandle ()
     tl::info << "Deleted layout " << name ();
   }
 
+  delete mp_density_pyramid;
+  mp_density_pyramid = 0;
+
   delete mp_layout;
   mp_layout = 0;
 
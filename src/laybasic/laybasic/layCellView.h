@@ -44,6 +44,7 @@ namespace lay
 {
 
 class LayoutView;
+class DensityPyramid;
 
 /**
  *  @brief A layout handle
@@ -95,6 +96,17 @@ public:
    */
   db::Layout &layout () const;
 
+  /**
+   *  @brief Gets the density pyramid for the layout
+   *
+   *  The density pyramid provides coverage maps of the cells which are used to
+   *  speed up the drawing of cells which are small on the screen.
+   */
+  lay::DensityPyramid &density_pyramid () const
+  {
+    return *mp_density_pyramid;
+  }
+
   /**
    *  @brief Sets the file name associated with this handle
    */
@@ -288,6 +300,7 @@ public:
 
 private:
   db::Layout *mp_layout;
+  lay::DensityPyramid *mp_density_pyramid;
   int m_ref_count;
   std::string m_name;
   std::string m_filename;
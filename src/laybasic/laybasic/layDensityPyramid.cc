@@ -0,0 +1,412 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "layDensityPyramid.h"
+#include "dbPolygonTools.h"
+
+#include <QMutexLocker>
+
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+namespace lay
+{
+
+// -------------------------------------------------------------
+//  DensityMap implementation
+
+DensityMap::DensityMap ()
+  : m_size (0)
+{
+  //  .. nothing yet ..
+}
+
+DensityMap::DensityMap (const db::Box &box, unsigned int size)
+  : m_box (box), m_size (1)
+{
+  while (m_size < size && m_size < (unsigned int) max_size) {
+    m_size *= 2;
+  }
+
+  if (! m_box.empty ()) {
+    m_levels.push_back (std::vector<row_type> (m_size, 0));
+  } else {
+    m_size = 0;
+  }
+}
+
+unsigned int
+DensityMap::bin_x (db::Coord x, bool upper) const
+{
+  int64_t w = std::max (int64_t (1), int64_t (m_box.width ()));
+  int64_t d = std::max (int64_t (0), std::min (w, int64_t (x) - int64_t (m_box.left ())));
+
+  int64_t i = upper ? (d * m_size + w - 1) / w - 1 : (d * m_size) / w;
+  return (unsigned int) std::max (int64_t (0), std::min (int64_t (m_size - 1), i));
+}
+
+unsigned int
+DensityMap::bin_y (db::Coord y, bool upper) const
+{
+  int64_t h = std::max (int64_t (1), int64_t (m_box.height ()));
+  int64_t d = std::max (int64_t (0), std::min (h, int64_t (y) - int64_t (m_box.bottom ())));
+
+  int64_t i = upper ? (d * m_size + h - 1) / h - 1 : (d * m_size) / h;
+  return (unsigned int) std::max (int64_t (0), std::min (int64_t (m_size - 1), i));
+}
+
+db::Coord
+DensityMap::bin_left (unsigned int level, unsigned int x) const
+{
+  return m_box.left () + db::Coord ((int64_t (m_box.width ()) * x) / size (level));
+}
+
+db::Coord
+DensityMap::bin_bottom (unsigned int level, unsigned int y) const
+{
+  return m_box.bottom () + db::Coord ((int64_t (m_box.height ()) * y) / size (level));
+}
+
+db::Box
+DensityMap::bin_box (unsigned int level, unsigned int x1, unsigned int x2, unsigned int y) const
+{
+  return db::Box (bin_left (level, x1), bin_bottom (level, y), bin_left (level, x2 + 1), bin_bottom (level, y + 1));
+}
+
+unsigned int
+DensityMap::level_for (double bin_size) const
+{
+  double d = double (std::max (m_box.width (), m_box.height ()));
+
+  unsigned int l = levels ();
+  while (l > 0) {
+    --l;
+    if (d / double (size (l)) <= bin_size) {
+      return l;
+    }
+  }
+
+  return 0;
+}
+
+void
+DensityMap::set (const db::Box &box)
+{
+  if (empty () || box.empty () || ! box.touches (m_box)) {
+    return;
+  }
+
+  unsigned int x1 = bin_x (box.left (), false);
+  unsigned int x2 = std::max (x1, bin_x (box.right (), true));
+  unsigned int y1 = bin_y (box.bottom (), false);
+  unsigned int y2 = std::max (y1, bin_y (box.top (), true));
+
+  row_type mask = (~row_type (0) >> (63 - x2)) & (~row_type (0) << x1);
+
+  std::vector<row_type> &rows = m_levels.front ();
+  for (unsigned int y = y1; y <= y2; ++y) {
+    rows [y] |= mask;
+  }
+}
+
+void
+DensityMap::set (const db::Polygon &polygon)
+{
+  db::Box box = polygon.box ();
+  if (empty () || box.empty () || ! box.touches (m_box)) {
+    return;
+  }
+
+  unsigned int x1 = bin_x (box.left (), false);
+  unsigned int x2 = std::max (x1, bin_x (box.right (), true));
+  unsigned int y1 = bin_y (box.bottom (), false);
+  unsigned int y2 = std::max (y1, bin_y (box.top (), true));
+
+  //  small polygons and boxes are represented by their bounding box
+  if (x2 - x1 < 2 || y2 - y1 < 2 || polygon.is_box ()) {
+    set (box);
+    return;
+  }
+
+  std::vector<row_type> &rows = m_levels.front ();
+  for (unsigned int y = y1; y <= y2; ++y) {
+    for (unsigned int x = x1; x <= x2; ++x) {
+      if ((rows [y] & (row_type (1) << x)) == 0 && db::interact (polygon, bin_box (0, x, y))) {
+        rows [y] |= (row_type (1) << x);
+      }
+    }
+  }
+}
+
+void
+DensityMap::finish ()
+{
+  if (empty ()) {
+    return;
+  }
+
+  m_levels.erase (m_levels.begin () + 1, m_levels.end ());
+
+  for (unsigned int n = m_size / 2; n > 0; n /= 2) {
+
+    const std::vector<row_type> &fine = m_levels.back ();
+    std::vector<row_type> coarse (n, 0);
+
+    for (unsigned int y = 0; y < n; ++y) {
+      row_type r = fine [y * 2] | fine [y * 2 + 1];
+      for (unsigned int x = 0; x < n; ++x) {
+        if ((r >> (x * 2)) & 3) {
+          coarse [y] |= (row_type (1) << x);
+        }
+      }
+    }
+
+    m_levels.push_back (coarse);
+
+  }
+}
+
+size_t
+DensityMap::memory () const
+{
+  size_t mem = sizeof (*this);
+  for (std::vector<std::vector<row_type> >::const_iterator l = m_levels.begin (); l != m_levels.end (); ++l) {
+    mem += sizeof (*l) + l->capacity () * sizeof (row_type);
+  }
+  return mem;
+}
+
+// -------------------------------------------------------------
+//  DensityPyramid implementation
+
+DensityPyramid::DensityPyramid (db::Layout *layout)
+  : mp_layout (layout), m_invalid (false)
+{
+  layout->hier_changed_event.add (this, &DensityPyramid::invalidate);
+  layout->bboxes_changed_event.add (this, &DensityPyramid::on_bboxes_changed);
+}
+
+DensityPyramid::~DensityPyramid ()
+{
+  //  .. nothing yet ..
+}
+
+void
+DensityPyramid::on_bboxes_changed (unsigned int layer)
+{
+  if (layer == std::numeric_limits<unsigned int>::max ()) {
+    invalidate ();
+  } else {
+    invalidate_layer (layer);
+  }
+}
+
+void
+DensityPyramid::invalidate ()
+{
+  QMutexLocker locker (&m_lock);
+  m_invalid = true;
+}
+
+void
+DensityPyramid::invalidate_layer (unsigned int layer)
+{
+  QMutexLocker locker (&m_lock);
+  m_invalid_layers.push_back (layer);
+}
+
+void
+DensityPyramid::update ()
+{
+  QMutexLocker locker (&m_lock);
+
+  if (m_invalid) {
+
+    m_maps.clear ();
+
+  } else if (! m_invalid_layers.empty ()) {
+
+    std::sort (m_invalid_layers.begin (), m_invalid_layers.end ());
+
+    for (map_type::iterator m = m_maps.begin (); m != m_maps.end (); ) {
+      map_type::iterator mm = m;
+      ++m;
+      if (std::binary_search (m_invalid_layers.begin (), m_invalid_layers.end (), mm->first.second)) {
+        m_maps.erase (mm);
+      }
+    }
+
+  }
+
+  m_invalid = false;
+  m_invalid_layers.clear ();
+}
+
+size_t
+DensityPyramid::size () const
+{
+  QMutexLocker locker (&m_lock);
+  return m_maps.size ();
+}
+
+size_t
+DensityPyramid::memory () const
+{
+  QMutexLocker locker (&m_lock);
+
+  size_t mem = 0;
+  for (map_type::const_iterator m = m_maps.begin (); m != m_maps.end (); ++m) {
+    mem += m->second.memory ();
+  }
+  return mem;
+}
+
+const DensityMap &
+DensityPyramid::map (db::cell_index_type ci, unsigned int layer, DensityPyramidMonitor *monitor)
+{
+  std::pair<db::cell_index_type, unsigned int> key (ci, layer);
+
+  {
+    QMutexLocker locker (&m_lock);
+    map_type::const_iterator m = m_maps.find (key);
+    if (m != m_maps.end ()) {
+      return m->second;
+    }
+  }
+
+  //  Hint: the map is computed without holding the lock. If two threads compute the
+  //  same map, the first one wins.
+  DensityMap map;
+  compute (map, ci, layer, monitor);
+
+  QMutexLocker locker (&m_lock);
+  return m_maps.insert (std::make_pair (key, map)).first->second;
+}
+
+void
+DensityPyramid::compute (DensityMap &map, db::cell_index_type ci, unsigned int layer, DensityPyramidMonitor *monitor)
+{
+  const db::Cell &cell = mp_layout->cell (ci);
+
+  db::Box box = cell.bbox (layer);
+  if (box.empty ()) {
+    return;
+  }
+
+  map = DensityMap (box, DensityMap::max_size);
+
+  double bin_w = double (box.width ()) / double (map.size ());
+  double bin_h = double (box.height ()) / double (map.size ());
+
+  size_t n = 0;
+
+  for (db::ShapeIterator s = cell.shapes (layer).begin (db::ShapeIterator::Boxes | db::ShapeIterator::Polygons | db::ShapeIterator::Edges | db::ShapeIterator::Paths); ! s.at_end (); ++s) {
+
+    if (monitor && (++n % 1000) == 0) {
+      monitor->check_abort ();
+    }
+
+    if (s->is_box () || s->is_edge ()) {
+      map.set (s->bbox ());
+    } else {
+      db::Polygon poly;
+      s->polygon (poly);
+      map.set (poly);
+    }
+
+  }
+
+  db::box_convert <db::CellInst> bc (*mp_layout, layer);
+
+  for (db::Cell::const_iterator inst = cell.begin (); ! inst.at_end (); ++inst) {
+
+    const db::CellInstArray &cell_inst = inst->cell_inst ();
+
+    db::cell_index_type child_ci = cell_inst.object ().cell_index ();
+    db::Box child_box = mp_layout->cell (child_ci).bbox (layer);
+    if (child_box.empty ()) {
+      continue;
+    }
+
+    //  dense regular arrays are represented by their bounding box
+    db::Vector a, b;
+    unsigned long na = 0, nb = 0;
+    if (cell_inst.size () > 1 && cell_inst.is_regular_array (a, b, na, nb) &&
+        (na <= 1 || (fabs (double (a.x ())) <= bin_w && fabs (double (a.y ())) <= bin_h)) &&
+        (nb <= 1 || (fabs (double (b.x ())) <= bin_w && fabs (double (b.y ())) <= bin_h))) {
+      map.set (cell_inst.bbox (bc));
+      continue;
+    }
+
+    for (db::CellInstArray::iterator p = cell_inst.begin (); ! p.at_end (); ++p) {
+
+      if (monitor && (++n % 1000) == 0) {
+        monitor->check_abort ();
+      }
+
+      db::ICplxTrans t = cell_inst.complex_trans (*p);
+      db::Box inst_box = child_box.transformed (t);
+
+      if (double (inst_box.width ()) <= 2.0 * bin_w && double (inst_box.height ()) <= 2.0 * bin_h) {
+
+        //  small instances are represented by their bounding box
+        map.set (inst_box);
+
+      } else {
+
+        //  larger instances are represented by the child's map on a level which is not coarser than ours
+        const DensityMap &child_map = this->map (child_ci, layer, monitor);
+        unsigned int l = child_map.level_for (std::min (bin_w, bin_h) / t.mag ());
+
+        for (unsigned int y = 0; y < child_map.size (l); ++y) {
+
+          DensityMap::row_type r = child_map.row (l, y);
+
+          unsigned int x = 0;
+          while (r != 0) {
+            if ((r & 1) != 0) {
+              unsigned int x1 = x;
+              while ((r & 2) != 0) {
+                r >>= 1;
+                ++x;
+              }
+              map.set (child_map.bin_box (l, x1, x, y).transformed (t));
+            }
+            r >>= 1;
+            ++x;
+          }
+
+        }
+
+      }
+
+    }
+
+  }
+
+  map.finish ();
+}
+
+}
+
@@ -0,0 +1,271 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#ifndef HDR_layDensityPyramid
+#define HDR_layDensityPyramid
+
+#include "laybasicCommon.h"
+
+#include "dbLayout.h"
+#include "tlObject.h"
+
+#include <QMutex>
+
+#include <map>
+#include <vector>
+
+namespace lay
+{
+
+/**
+ *  @brief A coverage raster of one cell on one layer
+ *
+ *  The map divides the bounding box of the cell on the layer into a grid of
+ *  size x size bins. A bin is set if some geometry of the cell or its child
+ *  cells touches the bin. The map is conservative: a bin may be set even though
+ *  the geometry just covers the bin's bounding box.
+ *
+ *  Besides the full resolution grid (level 0), the map provides coarser grids
+ *  with half the resolution per level (level 1: size / 2 bins per axis etc.).
+ *  A bin on a coarser level is set if one of the four bins below is set.
+ */
+class LAYBASIC_PUBLIC DensityMap
+{
+public:
+  /**
+   *  @brief The maximum number of bins per axis
+   */
+  enum { max_size = 64 };
+
+  typedef unsigned long long row_type;
+
+  /**
+   *  @brief Creates an empty map
+   */
+  DensityMap ();
+
+  /**
+   *  @brief Creates a map for the given box
+   *
+   *  "size" is the number of bins per axis. It is rounded up to the next power of two
+   *  and limited to max_size.
+   */
+  DensityMap (const db::Box &box, unsigned int size);
+
+  /**
+   *  @brief Gets the box covered by the map
+   */
+  const db::Box &box () const
+  {
+    return m_box;
+  }
+
+  /**
+   *  @brief Gets a value indicating whether the map is empty
+   */
+  bool empty () const
+  {
+    return m_levels.empty ();
+  }
+
+  /**
+   *  @brief Gets the number of levels
+   */
+  unsigned int levels () const
+  {
+    return (unsigned int) m_levels.size ();
+  }
+
+  /**
+   *  @brief Gets the number of bins per axis on the given level
+   */
+  unsigned int size (unsigned int level = 0) const
+  {
+    return m_size >> level;
+  }
+
+  /**
+   *  @brief Gets the bits for row y of the given level
+   *
+   *  Bit x of the row is set if bin (x, y) is set.
+   */
+  row_type row (unsigned int level, unsigned int y) const
+  {
+    return m_levels [level][y];
+  }
+
+  /**
+   *  @brief Gets a value indicating whether bin (x, y) is set on the given level
+   */
+  bool is_set (unsigned int level, unsigned int x, unsigned int y) const
+  {
+    return (row (level, y) & (row_type (1) << x)) != 0;
+  }
+
+  /**
+   *  @brief Gets the box of the bins from x1 to x2 (inclusive) in row y on the given level
+   */
+  db::Box bin_box (unsigned int level, unsigned int x1, unsigned int x2, unsigned int y) const;
+
+  /**
+   *  @brief Gets the box of bin (x, y) on the given level
+   */
+  db::Box bin_box (unsigned int level, unsigned int x, unsigned int y) const
+  {
+    return bin_box (level, x, x, y);
+  }
+
+  /**
+   *  @brief Gets the coarsest level whose bins are not larger than the given size
+   *
+   *  The size is given in the units of the box.
+   */
+  unsigned int level_for (double bin_size) const;
+
+  /**
+   *  @brief Marks the bins touched by the given box on level 0
+   */
+  void set (const db::Box &box);
+
+  /**
+   *  @brief Marks the bins on level 0 which interact with the given polygon
+   */
+  void set (const db::Polygon &polygon);
+
+  /**
+   *  @brief Computes the coarser levels from level 0
+   *
+   *  This method must be called after the bins have been set.
+   */
+  void finish ();
+
+  /**
+   *  @brief Gets the memory used by the map in bytes
+   */
+  size_t memory () const;
+
+private:
+  db::Box m_box;
+  unsigned int m_size;
+  std::vector<std::vector<row_type> > m_levels;
+
+  unsigned int bin_x (db::Coord x, bool upper) const;
+  unsigned int bin_y (db::Coord y, bool upper) const;
+  db::Coord bin_left (unsigned int level, unsigned int x) const;
+  db::Coord bin_bottom (unsigned int level, unsigned int y) const;
+};
+
+/**
+ *  @brief An interface for observing the computation of density maps
+ *
+ *  "check_abort" is called regularly while a map is computed. It may throw
+ *  an exception to abort the computation.
+ */
+class LAYBASIC_PUBLIC DensityPyramidMonitor
+{
+public:
+  virtual ~DensityPyramidMonitor () { }
+  virtual void check_abort () = 0;
+};
+
+/**
+ *  @brief A cache of density maps for the cells of a layout
+ *
+ *  The density pyramid delivers a DensityMap per cell and layer. The maps are
+ *  computed on demand and are kept until the layout changes. When a map is
+ *  computed, the maps of child cells are used for child instances which cover
+ *  more than a few bins. Smaller instances are represented by their bounding
+ *  boxes.
+ *
+ *  The redraw thread uses the maps to draw cells which are small on the screen
+ *  without traversing the shapes and instances.
+ *
+ *  "map" may be called from multiple threads. Layout changes only mark the maps
+ *  as invalid. The maps are discarded by "update", which must not be called
+ *  while other threads use the maps.
+ */
+class LAYBASIC_PUBLIC DensityPyramid
+  : public tl::Object
+{
+public:
+  /**
+   *  @brief Creates a pyramid for the given layout
+   */
+  DensityPyramid (db::Layout *layout);
+
+  /**
+   *  @brief Destructor
+   */
+  ~DensityPyramid ();
+
+  /**
+   *  @brief Gets the map for the given cell and layer
+   *
+   *  If the map is not available yet, it is computed. If a monitor is given, the
+   *  computation can be aborted by an exception thrown from the monitor. No map
+   *  is stored in that case.
+   */
+  const DensityMap &map (db::cell_index_type ci, unsigned int layer, DensityPyramidMonitor *monitor = 0);
+
+  /**
+   *  @brief Marks the maps as invalid
+   */
+  void invalidate ();
+
+  /**
+   *  @brief Marks the maps for the given layer as invalid
+   */
+  void invalidate_layer (unsigned int layer);
+
+  /**
+   *  @brief Discards the invalid maps
+   */
+  void update ();
+
+  /**
+   *  @brief Gets the number of maps present
+   */
+  size_t size () const;
+
+  /**
+   *  @brief Gets the memory used by the maps in bytes
+   */
+  size_t memory () const;
+
+private:
+  typedef std::map<std::pair<db::cell_index_type, unsigned int>, DensityMap> map_type;
+
+  const db::Layout *mp_layout;
+  map_type m_maps;
+  std::vector<unsigned int> m_invalid_layers;
+  bool m_invalid;
+  mutable QMutex m_lock;
+
+  void compute (DensityMap &map, db::cell_index_type ci, unsigned int layer, DensityPyramidMonitor *monitor);
+  void on_bboxes_changed (unsigned int layer);
+};
+
+}
+
+#endif
+
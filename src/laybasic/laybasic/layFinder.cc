@@ -22,6 +22,7 @@
 
 
 #include "tlProgress.h"
+#include "tlThreadPool.h"
 #include "layFinder.h"
 
 namespace lay
@@ -198,12 +199,42 @@ Finder::do_find (const db::Cell &cell, int level, const db::ICplxTrans &t)
   }
 }
 
+// -------------------------------------------------------------
+//  ShapeFinderBulkTask definition and implementation
+
+/**
+ *  @brief A task collecting the shapes for a range of cells visited in box mode
+ */
+class ShapeFinderBulkTask
+  : public tl::PoolTask
+{
+public:
+  ShapeFinderBulkTask (const ShapeFinder *finder, std::deque<ShapeFinder::BulkVisit> *visits, size_t from, size_t to)
+    : mp_finder (finder), mp_visits (visits), m_from (from), m_to (to)
+  {
+    //  .. nothing yet ..
+  }
+
+  virtual void run ()
+  {
+    for (size_t i = m_from; i < m_to && ! group ()->is_cancelled (); ++i) {
+      mp_finder->collect_visit ((*mp_visits) [i]);
+    }
+  }
+
+private:
+  const ShapeFinder *mp_finder;
+  std::deque<ShapeFinder::BulkVisit> *mp_visits;
+  size_t m_from, m_to;
+};
+
 // -------------------------------------------------------------
 //  ShapeFinder implementation
 
 ShapeFinder::ShapeFinder (bool point_mode, bool top_level_sel, db::ShapeIterator::flags_type flags, const std::set<lay::ObjectInstPath> *excludes)
   : Finder (point_mode, top_level_sel), 
     mp_excludes ((excludes && !excludes->empty ()) ? excludes : 0),
+    m_bulk_count (0),
     m_flags (flags), m_cv_index (0), m_topcell (0), 
     mp_prop_sel (0), m_inv_prop_sel (false), mp_progress (0)
 {
@@ -320,7 +351,9 @@ ShapeFinder::find (lay::LayoutView *view, const db::DBox &region_mu)
   m_cells_with_context.clear ();
   m_context_layers.clear ();
 
-  return ! m_founds.empty ();
+  collect_bulk (view);
+
+  return size () > 0;
 }
 
 bool 
@@ -336,10 +369,13 @@ ShapeFinder::find (lay::LayoutView *view, const lay::LayerProperties &lprops, co
 
   std::vector<int> layers;
   layers.push_back (lprops.layer_index ());
-  bool result = find_internal (view, lprops.cellview_index (), &lprops.prop_sel (), lprops.inverse_prop_sel (), lprops.hier_levels (), lprops.trans (), layers, region_mu);
+  find_internal (view, lprops.cellview_index (), &lprops.prop_sel (), lprops.inverse_prop_sel (), lprops.hier_levels (), lprops.trans (), layers, region_mu);
 
   mp_progress = 0;
-  return result;
+
+  collect_bulk (view);
+
+  return size () > 0;
 }
 
 bool 
@@ -376,6 +412,16 @@ ShapeFinder::find_internal (lay::LayoutView *view, unsigned int cv_index, const
     max_level = hier_sel.to_level (ctx_path_length, max_level);
   }
 
+  //  in box mode, the visited cells refer to the parameters of this call
+  if (! point_mode ()) {
+    m_bulk_contexts.push_back (BulkContext ());
+    m_bulk_contexts.back ().cv_index = m_cv_index;
+    m_bulk_contexts.back ().topcell = m_topcell;
+    m_bulk_contexts.back ().layers = layers;
+    m_bulk_contexts.back ().prop_sel = prop_sel;
+    m_bulk_contexts.back ().inv_prop_sel = inv_prop_sel;
+  }
+
   //  actually find
   try {
     start (view, cv, m_cv_index, trans, region, min_level, max_level, layers);
@@ -384,7 +430,133 @@ ShapeFinder::find_internal (lay::LayoutView *view, unsigned int cv_index, const
   }
 
   //  return true if anything was found
-  return ! m_founds.empty ();
+  return size () > 0;
+}
+
+void
+ShapeFinder::collect_bulk (lay::LayoutView *view)
+{
+  if (m_bulk_visits.empty ()) {
+    if (m_bulk_founds.empty ()) {
+      m_bulk_contexts.clear ();
+    }
+    return;
+  }
+
+  try {
+
+    //  the layouts are read from multiple threads, so they must not be sorted lazily
+    for (std::vector<BulkContext>::const_iterator c = m_bulk_contexts.begin (); c != m_bulk_contexts.end (); ++c) {
+      view->cellview (c->cv_index)->layout ().update ();
+    }
+
+    size_t n = m_bulk_visits.size ();
+    size_t chunk = tl::parallel_chunk_size (n, 0, 0);
+
+    tl::RelativeProgress progress (tl::to_string (QObject::tr ("Selecting ...")), (n + chunk - 1) / chunk, 1);
+    progress.set_format ("");
+
+    tl::TaskGroup group;
+    for (size_t i = 0; i < n; i += chunk) {
+      group.run (new ShapeFinderBulkTask (this, &m_bulk_visits, i, std::min (n, i + chunk)));
+    }
+    group.wait (progress);
+
+  } catch (...) {
+    m_bulk_visits.clear ();
+    throw;
+  }
+
+  //  keep the visits with results only
+  for (std::deque<BulkVisit>::iterator v = m_bulk_visits.begin (); v != m_bulk_visits.end (); ++v) {
+    if (! v->founds.empty ()) {
+      m_bulk_count += v->founds.size ();
+      m_bulk_founds.push_back (BulkVisit ());
+      BulkVisit &bv = m_bulk_founds.back ();
+      bv.context = v->context;
+      bv.cell = v->cell;
+      bv.search_box = v->search_box;
+      bv.path.swap (v->path);
+      bv.founds.swap (v->founds);
+    }
+  }
+
+  m_bulk_visits.clear ();
+}
+
+void
+ShapeFinder::collect_visit (BulkVisit &visit) const
+{
+  const BulkContext &context = m_bulk_contexts [visit.context];
+  const db::Cell &cell = *visit.cell;
+
+  for (std::vector<int>::const_iterator l = context.layers.begin (); l != context.layers.end (); ++l) {
+
+    if (context.layers.size () == 1 || cell.bbox ((unsigned int) *l).touches (visit.search_box)) {
+
+      const db::Shapes &shapes = cell.shapes ((unsigned int) *l);
+
+      db::ShapeIterator shape = shapes.begin_touching (visit.search_box, m_flags, context.prop_sel, context.inv_prop_sel);
+      while (! shape.at_end ()) {
+
+        //  in box mode, just test the boxes
+        if (shape->bbox ().inside (visit.search_box)) {
+
+          //  skip the shape if it's part of the excluded set
+          bool excluded = false;
+          if (mp_excludes != 0) {
+            lay::ObjectInstPath found;
+            make_path (found, visit, (unsigned int) *l, *shape);
+            excluded = (mp_excludes->find (found) != mp_excludes->end ());
+          }
+
+          if (! excluded) {
+            visit.founds.push_back (std::make_pair ((unsigned int) *l, *shape));
+          }
+
+        }
+
+        ++shape;
+
+      }
+
+    }
+
+  }
+}
+
+void
+ShapeFinder::make_path (lay::ObjectInstPath &path, const BulkVisit &visit, unsigned int layer, const db::Shape &shape) const
+{
+  const BulkContext &context = m_bulk_contexts [visit.context];
+
+  path.set_cv_index (context.cv_index);
+  path.set_topcell (context.topcell);
+  path.assign_path (visit.path.begin (), visit.path.end ());
+  path.set_layer (layer);
+  path.set_shape (shape);
+}
+
+const ShapeFinder::founds_vector_type &
+ShapeFinder::founds () const
+{
+  if (! m_bulk_founds.empty ()) {
+
+    size_t n = m_founds.size ();
+    m_founds.resize (n + m_bulk_count);
+
+    for (std::deque<BulkVisit>::const_iterator v = m_bulk_founds.begin (); v != m_bulk_founds.end (); ++v) {
+      for (std::vector<std::pair<unsigned int, db::Shape> >::const_iterator f = v->founds.begin (); f != v->founds.end (); ++f) {
+        make_path (m_founds [n++], *v, f->first, f->second);
+      }
+    }
+
+    m_bulk_founds.clear ();
+    m_bulk_count = 0;
+
+  }
+
+  return m_founds;
 }
 
 void
@@ -428,41 +600,13 @@ ShapeFinder::visit_cell (const db::Cell &cell, const db::Box &search_box, const
 
     checkpoint ();
 
-    for (std::vector<int>::const_iterator l = layers ().begin (); l != layers ().end (); ++l) {
-
-      if (layers ().size () == 1 || (layers ().size () > 1 && cell.bbox ((unsigned int) *l).touches (search_box))) {
-
-        const db::Shapes &shapes = cell.shapes ((unsigned int) *l);
-
-        db::ShapeIterator shape = shapes.begin_touching (search_box, m_flags, mp_prop_sel, m_inv_prop_sel);
-        while (! shape.at_end ()) {
-
-          checkpoint ();
-
-          //  in box mode, just test the boxes
-          if (shape->bbox ().inside (search_box)) {
-
-            m_founds.push_back (lay::ObjectInstPath ());
-            m_founds.back ().set_cv_index (m_cv_index);
-            m_founds.back ().set_topcell (m_topcell);
-            m_founds.back ().assign_path (path ().begin (), path ().end ());
-            m_founds.back ().set_layer (*l);
-            m_founds.back ().set_shape (*shape);
-
-            //  Remove the selection if it's part of the excluded set
-            if (mp_excludes != 0 && mp_excludes->find (m_founds.back ()) != mp_excludes->end ()) {
-              m_founds.pop_back ();
-            }
-
-          }
-
-          ++shape;
-
-        } 
-
-      }
-
-    }
+    //  in box mode, the shapes are collected later in the thread pool (see collect_bulk)
+    m_bulk_visits.push_back (BulkVisit ());
+    BulkVisit &visit = m_bulk_visits.back ();
+    visit.context = m_bulk_contexts.size () - 1;
+    visit.cell = &cell;
+    visit.search_box = search_box;
+    visit.path = path ();
 
   } else {
 
@@ -36,6 +36,8 @@
 #include "dbShape.h"
 #include "layObjectInstPath.h"
 
+#include <deque>
+
 namespace tl
 {
   class AbsoluteProgress;
@@ -174,10 +176,18 @@ private:
   db::box_convert <db::Cell> m_cell_box_convert;
 };
 
+class ShapeFinderBulkTask;
+
 /**
  *  @brief Shape finder utility class
  *
  *  This class specializes the finder to finding shapes.
+ *
+ *  In box mode, the hierarchy traversal just records the cells visited
+ *  together with their instantiation paths. The shapes of these cells are
+ *  collected afterwards in the thread pool. The results are kept in a compact
+ *  form (one path per visited cell) and the ObjectInstPath objects are built
+ *  only when the results are iterated.
  */
 class LAYBASIC_PUBLIC ShapeFinder
   : public Finder
@@ -195,12 +205,22 @@ public:
 
   iterator begin () const
   {
-    return m_founds.begin ();
+    return founds ().begin ();
   }
 
   iterator end () const
   {
-    return m_founds.end ();
+    return founds ().end ();
+  }
+
+  /**
+   *  @brief Gets the number of objects found
+   *
+   *  This method does not need to build the ObjectInstPath objects.
+   */
+  size_t size () const
+  {
+    return m_founds.size () + m_bulk_count;
   }
 
 protected:
@@ -237,6 +257,32 @@ protected:
   void checkpoint ();
 
 private:
+  friend class ShapeFinderBulkTask;
+
+  /**
+   *  @brief The parameters of one find_internal call in box mode
+   */
+  struct BulkContext
+  {
+    unsigned int cv_index;
+    db::cell_index_type topcell;
+    std::vector<int> layers;
+    const std::set<db::properties_id_type> *prop_sel;
+    bool inv_prop_sel;
+  };
+
+  /**
+   *  @brief A cell visited in box mode and the shapes found therein
+   */
+  struct BulkVisit
+  {
+    size_t context;
+    const db::Cell *cell;
+    db::Box search_box;
+    std::vector<db::InstElement> path;
+    std::vector<std::pair<unsigned int, db::Shape> > founds;
+  };
+
   virtual void visit_cell (const db::Cell &cell, const db::Box &search_box, const db::ICplxTrans &t, int /*level*/);
   bool find_internal (lay::LayoutView *view, 
                       unsigned int cv_index, 
@@ -246,9 +292,17 @@ private:
                       const std::vector<db::DCplxTrans> &trans_mu,
                       const std::vector<int> &layers, 
                       const db::DBox &region_mu);
+  void collect_bulk (lay::LayoutView *view);
+  void collect_visit (BulkVisit &visit) const;
+  void make_path (lay::ObjectInstPath &path, const BulkVisit &visit, unsigned int layer, const db::Shape &shape) const;
+  const founds_vector_type &founds () const;
 
   const std::set<lay::ObjectInstPath> *mp_excludes;
-  std::vector<lay::ObjectInstPath> m_founds;
+  mutable std::vector<lay::ObjectInstPath> m_founds;
+  std::vector<BulkContext> m_bulk_contexts;
+  std::deque<BulkVisit> m_bulk_visits;
+  mutable std::deque<BulkVisit> m_bulk_founds;
+  mutable size_t m_bulk_count;
   db::ShapeIterator::flags_type m_flags;
   unsigned int m_cv_index;
   db::cell_index_type m_topcell;
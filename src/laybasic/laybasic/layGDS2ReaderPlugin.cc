@@ -145,6 +145,26 @@ static bool get_gds2_allow_big_records (const db::LoadLayoutOptions *options)
   return options->get_options<db::GDS2ReaderOptions> ().allow_big_records;
 }
 
+static void set_gds2_top_cell (db::LoadLayoutOptions *options, const std::string &n)
+{
+  options->get_options<db::GDS2ReaderOptions> ().top_cell = n;
+}
+
+static std::string get_gds2_top_cell (const db::LoadLayoutOptions *options)
+{
+  return options->get_options<db::GDS2ReaderOptions> ().top_cell;
+}
+
+static void set_gds2_region (db::LoadLayoutOptions *options, const db::DBox &r)
+{
+  options->get_options<db::GDS2ReaderOptions> ().region = r;
+}
+
+static db::DBox get_gds2_region (const db::LoadLayoutOptions *options)
+{
+  return options->get_options<db::GDS2ReaderOptions> ().region;
+}
+
 //  extend lay::LoadLayoutOptions with the GDS2 options 
 static
 gsi::ClassExt<db::LoadLayoutOptions> gds2_reader_options (
@@ -183,6 +203,33 @@ gsi::ClassExt<db::LoadLayoutOptions> gds2_reader_options (
     "@brief Gets a value specifying whether to allow big records with a length of 32768 to 65535 bytes.\n"
     "See \\gds2_allow_big_records= method for a description of this property."
     "\nThis property has been added in version 0.18.\n"
+  ) +
+  gsi::method_ext ("gds2_top_cell=", &set_gds2_top_cell, gsi::arg ("name"),
+    "@brief Specifies a cell to load together with its subtree\n"
+    "\n"
+    "If this property is set to a non-empty string, only the cell with this name and the cells below it "
+    "are read. The reader employs a structure index built by a quick pre-scan of the file, so "
+    "other cells are not parsed at all. The index is cached in memory, so subsequent reads of the same "
+    "file are faster.\n"
+    "\nThis property has been added in version 0.25.3.\n"
+  ) +
+  gsi::method_ext ("gds2_top_cell", &get_gds2_top_cell,
+    "@brief Gets the name of the cell to load together with its subtree\n"
+    "See \\gds2_top_cell= method for a description of this property."
+    "\nThis property has been added in version 0.25.3.\n"
+  ) +
+  gsi::method_ext ("gds2_region=", &set_gds2_region, gsi::arg ("box"),
+    "@brief Specifies a region to load shapes from\n"
+    "\n"
+    "If this box is not empty, only shapes overlapping this box are read. The box is given in micrometer units "
+    "in the coordinate system of the top cell. The selection is conservative: some shapes outside the box may be "
+    "read too. Instances are not filtered.\n"
+    "\nThis property has been added in version 0.25.3.\n"
+  ) +
+  gsi::method_ext ("gds2_region", &get_gds2_region,
+    "@brief Gets the region to load shapes from\n"
+    "See \\gds2_region= method for a description of this property."
+    "\nThis property has been added in version 0.25.3.\n"
   ),
   ""
 );
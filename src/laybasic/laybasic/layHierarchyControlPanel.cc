@@ -767,25 +767,20 @@ HierarchyControlPanel::index_from_path (const cell_path_type &path, int cv_index
 
     if (m_flat) {
 
-      //  TODO: linear search might not be effective enough ..
-      for (int c = 0; c < model->toplevel_items (); ++c) {
-        CellTreeItem *item = model->toplevel_item (c);
-        if (item->cell_index () == path.back ()) {
-          return model->model_index (item);
-        }
+      int c = model->find_toplevel_item (path.back ());
+      if (c >= 0) {
+        return model->model_index (model->toplevel_item (c));
       }
 
     } else {
 
-      for (int c = 0; c < model->toplevel_items (); ++c) {
-        CellTreeItem *item = model->toplevel_item (c);
-        if (item->cell_index () == path.front ()) {
-          item = find_child_item (path.begin () + 1, path.end (), item);
-          if (item) {
-            return model->model_index (item);
-          }
+      int c = model->find_toplevel_item (path.front ());
+      if (c >= 0) {
+        CellTreeItem *item = find_child_item (path.begin () + 1, path.end (), model->toplevel_item (c));
+        if (item) {
+          return model->model_index (item);
         }
-      } 
+      }
 
     }
 
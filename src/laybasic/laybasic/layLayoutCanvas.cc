@@ -285,6 +285,7 @@ LayoutCanvas::LayoutCanvas (QWidget *parent, lay::LayoutView *view, const char *
     m_redraw_clearing (false),
     m_redraw_force_update (true),
     m_update_image (true),
+    m_redraw_partial (false),
     m_do_update_image_dm (this, &LayoutCanvas::do_update_image),
     m_do_end_of_drawing_dm (this, &LayoutCanvas::do_end_of_drawing),
     m_image_cache_size (1)
@@ -517,6 +518,8 @@ LayoutCanvas::prepare_drawing ()
 
       if (m_redraw_clearing) {
         mp_redraw_thread->start (mp_view->synchronous () ? 0 : mp_view->drawing_workers (), m_layers, m_viewport_l, 1.0 / double (m_oversampling * m_dpr), m_redraw_force_update);
+      } else if (m_redraw_partial) {
+        mp_redraw_thread->restart (m_need_redraw_layer, m_need_redraw_regions);
       } else {
         mp_redraw_thread->restart (m_need_redraw_layer);
       }
@@ -529,6 +532,8 @@ LayoutCanvas::prepare_drawing ()
     }
 
     m_need_redraw = false;
+    m_need_redraw_regions.clear ();
+    m_redraw_partial = false;
     m_redraw_force_update = false;
     m_update_image = true;
 
@@ -836,8 +841,12 @@ LayoutCanvas::image_with_options (unsigned int width, unsigned int height, int l
 
   lay::RedrawThread redraw_thread (&rd_canvas, mp_view);
 
-  //  render the layout
-  redraw_thread.start (0 /*synchroneous*/, m_layers, vp, resolution, true);
+  //  render the layout - unless in synchronous mode, the drawing workers are used and we wait for them to finish
+  int workers = mp_view->synchronous () ? 0 : mp_view->drawing_workers ();
+  redraw_thread.start (workers, m_layers, vp, resolution, true);
+  if (workers > 0) {
+    redraw_thread.wait ();
+  }
   redraw_thread.stop (); // safety
 
   //  paint the background objects. It uses "img" to paint on.
@@ -1037,6 +1046,31 @@ LayoutCanvas::redraw_new (std::vector<lay::RedrawLayerInfo> &layers)
 
 void
 LayoutCanvas::redraw_selected (const std::vector<int> &layers)
+{
+  m_redraw_partial = false;
+  m_need_redraw_regions.clear ();
+
+  do_redraw_selected (layers);
+}
+
+void
+LayoutCanvas::redraw_selected (const std::vector<int> &layers, const std::vector<db::DBox> &regions)
+{
+  //  a pending request for entire layers is not turned into a partial one
+  if (! m_need_redraw) {
+    m_redraw_partial = true;
+    m_need_redraw_regions.clear ();
+  }
+
+  if (m_redraw_partial) {
+    m_need_redraw_regions.insert (m_need_redraw_regions.end (), regions.begin (), regions.end ());
+  }
+
+  do_redraw_selected (layers);
+}
+
+void
+LayoutCanvas::do_redraw_selected (const std::vector<int> &layers)
 {
   stop_redraw ();
 
@@ -1071,6 +1105,8 @@ LayoutCanvas::change_visibility (const std::vector <bool> &visible)
 
   m_need_redraw = true;
   m_need_redraw_layer.clear ();
+  m_need_redraw_regions.clear ();
+  m_redraw_partial = false;
 
   update (); // produces a paintEvent()
 }
@@ -242,6 +242,16 @@ public:
    */
   void redraw_selected (const std::vector<int> &layers);
 
+  /**
+   *  @brief Issue a redraw request on selected regions of selected layers
+   *
+   *  The regions are given in micrometer units of the view's coordinate system.
+   *  Only these regions of the layers are redrawn if possible. Regions from 
+   *  multiple requests are accumulated. If a region-less request for the same 
+   *  drawing is issued, the layers are redrawn entirely.
+   */
+  void redraw_selected (const std::vector<int> &layers, const std::vector<db::DBox> &regions);
+
   /**
    *  @brief Set the oversampling factor
    *
@@ -375,6 +385,8 @@ private:
   bool m_redraw_force_update;
   bool m_update_image;
   std::vector<int> m_need_redraw_layer;
+  std::vector<db::DBox> m_need_redraw_regions;
+  bool m_redraw_partial;
   std::vector<lay::RedrawLayerInfo> m_layers;
 
   lay::RedrawThread *mp_redraw_thread;
@@ -399,6 +411,7 @@ private:
   void do_update_image ();
   void do_end_of_drawing ();
   void do_redraw_all (bool force_redraw = true);
+  void do_redraw_selected (const std::vector<int> &layers);
 
   void prepare_drawing ();
 };
@@ -245,6 +245,12 @@ struct OpDeleteLayerProps
 
 const int timer_interval = 500;
 
+//  the maximum number of changed regions collected per layer before the layer is redrawn entirely
+const size_t max_dirty_regions = 64;
+
+//  the maximum number of parent instances visited to map a changed region into the top cell
+const size_t max_dirty_region_instances = 1000;
+
 static LayoutView *ms_current = 0;
 
 LayoutView::LayoutView (db::Manager *manager, bool editable, lay::PluginRoot *root, QWidget *parent, const char *name, unsigned int options)
@@ -253,7 +259,8 @@ LayoutView::LayoutView (db::Manager *manager, bool editable, lay::PluginRoot *ro
     m_editable (editable),
     m_options (options),
     m_annotation_shapes (manager),
-    dm_prop_changed (this, &LayoutView::do_prop_changed) 
+    dm_prop_changed (this, &LayoutView::do_prop_changed),
+    dm_redraw_dirty_regions (this, &LayoutView::do_redraw_dirty_regions)
 {
   setObjectName (QString::fromUtf8 (name));
   init (manager, root, parent);
@@ -265,7 +272,8 @@ LayoutView::LayoutView (lay::LayoutView *source, db::Manager *manager, bool edit
     m_editable (editable),
     m_options (options),
     m_annotation_shapes (manager),
-    dm_prop_changed (this, &LayoutView::do_prop_changed)
+    dm_prop_changed (this, &LayoutView::do_prop_changed),
+    dm_redraw_dirty_regions (this, &LayoutView::do_redraw_dirty_regions)
 {
   setObjectName (QString::fromUtf8 (name));
 
@@ -388,6 +396,7 @@ LayoutView::init (db::Manager *mgr, lay::PluginRoot *root, QWidget * /*parent*/)
   m_drop_small_cells = false;
   m_drop_small_cells_value = 10;
   m_drop_small_cells_cond = DSC_Max;
+  m_density_pyramid_threshold = 0;
   m_draw_array_border_instances = false;
   m_dirty = false;
   m_activated = true;
@@ -657,6 +666,7 @@ void LayoutView::update_event_handlers ()
   for (unsigned int i = 0; i < cellviews (); ++i) {
     cellview (i)->layout ().hier_changed_event.add (this, &LayoutView::signal_hier_changed);
     cellview (i)->layout ().bboxes_changed_event.add (this, &LayoutView::signal_bboxes_from_layer_changed, i);
+    cellview (i)->layout ().region_changed_event.add (this, &LayoutView::signal_region_changed, i);
     cellview (i)->layout ().dbu_changed_event.add (this, &LayoutView::signal_bboxes_changed);
     cellview (i)->layout ().prop_ids_changed_event.add (this, &LayoutView::signal_prop_ids_changed);
     cellview (i)->layout ().layer_properties_changed_event.add (this, &LayoutView::signal_layer_properties_changed);
@@ -1285,6 +1295,13 @@ LayoutView::configure (const std::string &name, const std::string &value)
     drop_small_cells_value (n);
     return true;
 
+  } else if (name == cfg_density_pyramid_threshold) {
+
+    unsigned int n;
+    tl::from_string (value, n);
+    density_pyramid_threshold (n);
+    return true;
+
   } else if (name == cfg_array_border_instances) {
 
     bool f;
@@ -2157,10 +2174,14 @@ LayoutView::signal_bboxes_from_layer_changed (unsigned int cv_index, unsigned in
 
   } else {
 
-    //  redraw only the layers required for redrawing
-    for (std::vector<lay::RedrawLayerInfo>::const_iterator l = mp_canvas->get_redraw_layers ().begin (); l != mp_canvas->get_redraw_layers ().end (); ++l) {
-      if (l->cellview_index == int (cv_index) && l->layer_index == int (layer_index)) {
-        redraw_layer ((unsigned int) (l - mp_canvas->get_redraw_layers ().begin ()));
+    //  redraw only the layers required for redrawing - if the changed regions are known, 
+    //  the redraw is done by do_redraw_dirty_regions
+    std::pair<unsigned int, unsigned int> key (cv_index, layer_index);
+    if (m_dirty_regions.find (key) == m_dirty_regions.end () && m_dirty_layers.find (key) == m_dirty_layers.end ()) {
+      for (std::vector<lay::RedrawLayerInfo>::const_iterator l = mp_canvas->get_redraw_layers ().begin (); l != mp_canvas->get_redraw_layers ().end (); ++l) {
+        if (l->cellview_index == int (cv_index) && l->layer_index == int (layer_index)) {
+          redraw_layer ((unsigned int) (l - mp_canvas->get_redraw_layers ().begin ()));
+        }
       }
     }
 
@@ -2170,6 +2191,162 @@ LayoutView::signal_bboxes_from_layer_changed (unsigned int cv_index, unsigned in
   }
 }
 
+void
+LayoutView::signal_region_changed (unsigned int cv_index, db::cell_index_type ci, unsigned int layer_index, const db::Box &box)
+{
+  if (m_dirty_regions.empty () && m_dirty_layers.empty ()) {
+    dm_redraw_dirty_regions ();
+  }
+
+  std::pair<unsigned int, unsigned int> key (cv_index, layer_index);
+  if (m_dirty_layers.find (key) != m_dirty_layers.end ()) {
+    return;
+  }
+
+  dirty_regions_type &regions = m_dirty_regions [key];
+  if (box.empty () || regions.size () >= max_dirty_regions) {
+    //  too many or unknown regions: redraw the whole layer
+    m_dirty_regions.erase (key);
+    m_dirty_layers.insert (key);
+  } else if (! regions.empty () && regions.back ().first == ci && regions.back ().second.contains (box.p1 ()) && regions.back ().second.contains (box.p2 ())) {
+    //  already covered
+  } else {
+    regions.push_back (std::make_pair (ci, box));
+  }
+}
+
+namespace
+{
+
+//  A box converter delivering a fixed box for every cell instance
+struct FixedBoxConvert
+{
+  FixedBoxConvert (const db::Box &box) : m_box (box) { }
+
+  db::Box operator() (const db::CellInst &) const
+  {
+    return m_box;
+  }
+
+private:
+  db::Box m_box;
+};
+
+}
+
+bool
+LayoutView::dirty_regions_to_view (const lay::RedrawLayerInfo &li, const dirty_regions_type &dirty, std::vector<db::DBox> &regions) const
+{
+  const lay::CellView &cv = cellview (li.cellview_index);
+
+  //  the cell's context is not taken into account
+  if (! cv.is_valid () || ! cv.specific_path ().empty ()) {
+    return false;
+  }
+
+  const db::Layout &layout = cv->layout ();
+  if (layout.hier_dirty () || layout.under_construction ()) {
+    return false;
+  }
+
+  db::cell_index_type top = cv.cell_index ();
+
+  //  the regions inside the top cell are taken as they are. The regions inside child cells
+  //  are merged per cell and mapped into the top cell through the parent instances.
+  std::vector<db::Box> boxes;
+  std::map<db::cell_index_type, db::Box> child_boxes;
+  for (dirty_regions_type::const_iterator d = dirty.begin (); d != dirty.end (); ++d) {
+    if (d->first == top) {
+      boxes.push_back (d->second);
+    } else if (layout.is_valid_cell_index (d->first)) {
+      child_boxes [d->first] += d->second;
+    }
+  }
+
+  if (! child_boxes.empty ()) {
+
+    size_t ninst = 0;
+
+    for (db::Layout::bottom_up_const_iterator c = layout.begin_bottom_up (); c != layout.end_bottom_up () && ! child_boxes.empty (); ++c) {
+
+      std::map<db::cell_index_type, db::Box>::iterator cb = child_boxes.find (*c);
+      if (cb == child_boxes.end ()) {
+        continue;
+      }
+
+      if (*c == top) {
+        boxes.push_back (cb->second);
+      } else {
+        FixedBoxConvert bc (cb->second);
+        for (db::Cell::parent_inst_iterator p = layout.cell (*c).begin_parent_insts (); ! p.at_end (); ++p) {
+          if (++ninst > max_dirty_region_instances) {
+            return false;
+          }
+          child_boxes [p->parent_cell_index ()] += p->basic_child_inst ()->bbox (bc);
+        }
+      }
+
+      child_boxes.erase (*c);
+
+    }
+
+  }
+
+  db::CplxTrans dbu_trans (layout.dbu ());
+  for (std::vector<db::Box>::const_iterator b = boxes.begin (); b != boxes.end (); ++b) {
+    for (std::vector<db::DCplxTrans>::const_iterator t = li.trans.begin (); t != li.trans.end (); ++t) {
+      regions.push_back (*t * (dbu_trans * *b));
+    }
+  }
+
+  return true;
+}
+
+void
+LayoutView::do_redraw_dirty_regions ()
+{
+  std::vector<int> layers, partial_layers;
+  std::vector<db::DBox> regions;
+
+  const std::vector<lay::RedrawLayerInfo> &redraw_layers = mp_canvas->get_redraw_layers ();
+  for (std::vector<lay::RedrawLayerInfo>::const_iterator l = redraw_layers.begin (); l != redraw_layers.end (); ++l) {
+
+    if (l->cellview_index < 0 || l->layer_index < 0) {
+      continue;
+    }
+
+    int index = int (l - redraw_layers.begin ());
+    std::pair<unsigned int, unsigned int> key ((unsigned int) l->cellview_index, (unsigned int) l->layer_index);
+
+    std::map<std::pair<unsigned int, unsigned int>, dirty_regions_type>::const_iterator d = m_dirty_regions.find (key);
+    if (d != m_dirty_regions.end ()) {
+
+      std::vector<db::DBox> layer_regions;
+      if (! dirty_regions_to_view (*l, d->second, layer_regions)) {
+        layers.push_back (index);
+      } else if (! layer_regions.empty ()) {
+        partial_layers.push_back (index);
+        regions.insert (regions.end (), layer_regions.begin (), layer_regions.end ());
+      }
+
+    } else if (m_dirty_layers.find (key) != m_dirty_layers.end ()) {
+      layers.push_back (index);
+    }
+
+  }
+
+  m_dirty_regions.clear ();
+  m_dirty_layers.clear ();
+
+  //  Hint: if there are layers to redraw entirely, the partial layers will be redrawn entirely too
+  if (! partial_layers.empty ()) {
+    mp_canvas->redraw_selected (partial_layers, regions);
+  }
+  if (! layers.empty ()) {
+    mp_canvas->redraw_selected (layers);
+  }
+}
+
 void
 LayoutView::signal_bboxes_changed ()
 {
@@ -3647,6 +3824,10 @@ LayoutView::redraw_deco_layer ()
 void
 LayoutView::redraw ()
 {
+  //  changed regions are covered by the full redraw
+  m_dirty_regions.clear ();
+  m_dirty_layers.clear ();
+
   std::vector <lay::RedrawLayerInfo> layers;
 
   size_t nlayers = 0;
@@ -4173,6 +4354,15 @@ LayoutView::drop_small_cells_cond (drop_small_cells_cond_type t)
   }
 }
 
+void 
+LayoutView::density_pyramid_threshold (unsigned int px)
+{
+  if (px != m_density_pyramid_threshold) {
+    m_density_pyramid_threshold = px;
+    redraw ();
+  }
+}
+
 void 
 LayoutView::cell_box_color (QColor c)
 {
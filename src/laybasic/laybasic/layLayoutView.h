@@ -1772,6 +1772,23 @@ public:
     return m_drop_small_cells_cond;
   }
 
+  /**
+   *  @brief Write accessor to the density pyramid threshold
+   *
+   *  Cells whose width and height on the screen is not larger than this value (in pixels)
+   *  are drawn from the density pyramid instead of drawing the shapes. 0 disables this feature
+   *  (the default). Such cells are drawn without fill, stipples and texts.
+   */
+  void density_pyramid_threshold (unsigned int px);
+
+  /**
+   *  @brief Read accessor to the density pyramid threshold
+   */
+  unsigned int density_pyramid_threshold () const
+  {
+    return m_density_pyramid_threshold;
+  }
+
   /**
    *  @brief Gets a value indicating whether guiding shapes are visible
    */
@@ -2531,6 +2548,7 @@ public slots:
   //  event handlers used to connect to the layout object's events
   void signal_hier_changed ();
   void signal_bboxes_from_layer_changed (unsigned int cv_index, unsigned int layer_index);
+  void signal_region_changed (unsigned int cv_index, db::cell_index_type ci, unsigned int layer_index, const db::Box &box);
   void signal_bboxes_changed ();
   void signal_prop_ids_changed ();
   void signal_layer_properties_changed ();
@@ -2677,6 +2695,7 @@ private:
   bool m_drop_small_cells;
   unsigned int m_drop_small_cells_value;
   drop_small_cells_cond_type m_drop_small_cells_cond;
+  unsigned int m_density_pyramid_threshold;
 
   bool m_draw_array_border_instances;
 
@@ -2730,10 +2749,20 @@ private:
   bool m_visibility_changed;
   bool m_active_cellview_changed_event_enabled;
   tl::DeferredMethod<lay::LayoutView> dm_prop_changed;
+  tl::DeferredMethod<lay::LayoutView> dm_redraw_dirty_regions;
+
+  //  the regions changed by edits per cellview and layer, collected until the next redraw
+  //  NOTE: only shape changes are reported as regions. Instance changes (insert, move,
+  //  PCell parameter changes) change the hierarchy and still redraw all layers.
+  typedef std::vector<std::pair<db::cell_index_type, db::Box> > dirty_regions_type;
+  std::map<std::pair<unsigned int, unsigned int>, dirty_regions_type> m_dirty_regions;
+  std::set<std::pair<unsigned int, unsigned int> > m_dirty_layers;
 
   void init (db::Manager *mgr, lay::PluginRoot *root, QWidget *parent);
 
   void do_prop_changed ();
+  void do_redraw_dirty_regions ();
+  bool dirty_regions_to_view (const lay::RedrawLayerInfo &li, const dirty_regions_type &dirty, std::vector<db::DBox> &regions) const;
   void do_redraw (int layer);
   void do_redraw ();
   void do_transform (const db::DCplxTrans &tr);
@@ -545,6 +545,12 @@ LayoutViewConfigPage3f::setup (lay::PluginRoot *root)
   root->config_get (cfg_drop_small_cells_value, n);
   mp_ui->drop_small_cells_value_le->setText (tl::to_qstring (tl::to_string (n)));
 
+  n = 0;
+  root->config_get (cfg_density_pyramid_threshold, n);
+  mp_ui->density_pyramid_cbx->setChecked (n > 0);
+  //  propose a reasonable threshold if the feature is disabled
+  mp_ui->density_pyramid_threshold_le->setText (tl::to_qstring (tl::to_string (n > 0 ? n : 64)));
+
   root->config_get (cfg_array_border_instances, flag);
   mp_ui->array_border_insts_cbx->setChecked (flag);
 
@@ -573,6 +579,16 @@ LayoutViewConfigPage3f::commit (lay::PluginRoot *root)
     root->config_set (cfg_drop_small_cells_value, s);
   } catch (...) { }
 
+  if (! mp_ui->density_pyramid_cbx->isChecked ()) {
+    root->config_set (cfg_density_pyramid_threshold, 0);
+  } else {
+    try {
+      unsigned int s;
+      tl::from_string (tl::to_string (mp_ui->density_pyramid_threshold_le->text ()), s);
+      root->config_set (cfg_density_pyramid_threshold, s);
+    } catch (...) { }
+  }
+
   root->config_set (cfg_array_border_instances, mp_ui->array_border_insts_cbx->isChecked ());
 
   root->config_set (cfg_text_lazy_rendering, mp_ui->text_lazy_rendering_cbx->isChecked ());
@@ -1501,6 +1517,7 @@ public:
     options.push_back (std::pair<std::string, std::string> (cfg_drop_small_cells, "false"));
     options.push_back (std::pair<std::string, std::string> (cfg_drop_small_cells_cond, "0"));
     options.push_back (std::pair<std::string, std::string> (cfg_drop_small_cells_value, "10"));
+    options.push_back (std::pair<std::string, std::string> (cfg_density_pyramid_threshold, "0"));
     options.push_back (std::pair<std::string, std::string> (cfg_array_border_instances, "false"));
     options.push_back (std::pair<std::string, std::string> (cfg_bitmap_oversampling, "1"));
     options.push_back (std::pair<std::string, std::string> (cfg_image_cache_size, "1"));
@@ -1248,5 +1248,212 @@ DMarker::render (const Viewport &vp, ViewObjectCanvas &canvas)
 
 }
 
+// ------------------------------------------------------------------------
+
+BulkMarker::BulkMarker (lay::LayoutView *view)
+  : MarkerBase (view), m_needs_sort (false), mp_view (view)
+{ 
+  // .. nothing yet ..
+}
+
+BulkMarker::~BulkMarker ()
+{
+  // .. nothing yet ..
+}
+
+void
+BulkMarker::clear ()
+{
+  m_boxes.clear ();
+  m_polygons.clear ();
+  m_edge_pairs.clear ();
+  m_edges.clear ();
+  m_paths.clear ();
+  m_texts.clear ();
+  m_bbox = db::DBox ();
+
+  m_needs_sort = false;
+  redraw ();
+}
+
+void
+BulkMarker::invalidate ()
+{
+  //  Hint: a redraw is requested only once for a sequence of inserts
+  if (! m_needs_sort) {
+    m_needs_sort = true;
+    redraw ();
+  }
+}
+
+void
+BulkMarker::sort ()
+{
+  if (m_needs_sort) {
+    m_boxes.sort (db::box_convert<db::DBox> ());
+    m_polygons.sort (db::box_convert<db::DPolygon> ());
+    m_edge_pairs.sort (db::box_convert<db::DEdgePair> ());
+    m_edges.sort (db::box_convert<db::DEdge> ());
+    m_paths.sort (db::box_convert<db::DPath> ());
+    m_texts.sort (db::box_convert<db::DText> ());
+    m_needs_sort = false;
+  }
+}
+
+void 
+BulkMarker::insert (const db::DBox &box)
+{
+  if (! box.empty ()) {
+    m_boxes.insert (box);
+    m_bbox += box;
+    invalidate ();
+  }
+}
+
+void 
+BulkMarker::insert (const db::DPolygon &poly)
+{
+  m_polygons.insert (poly);
+  m_bbox += poly.box ();
+  invalidate ();
+}
+
+void 
+BulkMarker::insert (const db::DEdgePair &edge_pair)
+{
+  m_edge_pairs.insert (edge_pair);
+  m_bbox += edge_pair.bbox ();
+  invalidate ();
+}
+
+void 
+BulkMarker::insert (const db::DEdge &edge)
+{
+  m_edges.insert (edge);
+  m_bbox += edge.bbox ();
+  invalidate ();
 }
 
+void 
+BulkMarker::insert (const db::DPath &path)
+{
+  m_paths.insert (path);
+  m_bbox += path.box ();
+  invalidate ();
+}
+
+void 
+BulkMarker::insert (const db::DText &text)
+{
+  m_texts.insert (text);
+  m_bbox += text.box ();
+  invalidate ();
+}
+
+void 
+BulkMarker::insert (const db::Shape &shape, const db::CplxTrans &trans)
+{
+  if (shape.is_box ()) {
+    if (trans.is_ortho ()) {
+      insert (shape.box ().transformed (trans));
+    } else {
+      insert (db::Polygon (shape.box ()).transformed (trans));
+    }
+  } else if (shape.is_polygon ()) {
+    db::Polygon poly;
+    shape.polygon (poly);
+    insert (poly.transformed (trans));
+  } else if (shape.is_path ()) {
+    db::Path path;
+    shape.path (path);
+    insert (path.transformed (trans));
+  } else if (shape.is_text ()) {
+    db::Text text;
+    shape.text (text);
+    insert (text.transformed (trans));
+  } else if (shape.is_edge ()) {
+    db::Edge edge;
+    shape.edge (edge);
+    insert (edge.transformed (trans));
+  }
+}
+
+size_t
+BulkMarker::size () const
+{
+  return m_boxes.size () + m_polygons.size () + m_edge_pairs.size () + m_edges.size () + m_paths.size () + m_texts.size ();
+}
+
+void
+BulkMarker::set_trans (const db::DCplxTrans &trans)
+{
+  if (! m_trans.equal (trans)) {
+    m_trans = trans;
+    redraw ();
+  }
+}
+
+db::DBox
+BulkMarker::bbox () const
+{
+  return m_trans * m_bbox;
+}
+
+void 
+BulkMarker::render (const Viewport &vp, ViewObjectCanvas &canvas)
+{ 
+  if (empty ()) {
+    return;
+  }
+
+  lay::CanvasPlane *fill, *contour, *vertex, *text; 
+  get_bitmaps (vp, canvas, fill, contour, vertex, text);
+  if (contour == 0 && vertex == 0 && fill == 0 && text == 0) {
+    return;
+  }
+
+  sort ();
+
+  lay::Renderer &r = canvas.renderer ();
+
+  r.set_font (db::Font (mp_view->text_font ()));
+  r.apply_text_trans (mp_view->apply_text_trans ());
+  r.default_text_size (mp_view->default_text_size ());
+  r.set_precise (true);
+
+  db::DCplxTrans t = vp.trans () * m_trans;
+
+  //  Only the objects touching the visible region are drawn. The region is enlarged by 
+  //  some pixels, so the vertices and wide lines of objects just outside are not lost.
+  double enl = 16.0 / t.mag ();
+  db::DBox region = (m_trans.inverted () * vp.box ()).enlarged (db::DVector (enl, enl));
+
+  for (box_tree_type::touching_iterator b = m_boxes.begin_touching (region, db::box_convert<db::DBox> ()); ! b.at_end (); ++b) {
+    r.draw (*b, t, fill, contour, vertex, text);
+  }
+
+  for (polygon_tree_type::touching_iterator p = m_polygons.begin_touching (region, db::box_convert<db::DPolygon> ()); ! p.at_end (); ++p) {
+    r.draw (*p, t, fill, contour, vertex, text);
+  }
+
+  for (path_tree_type::touching_iterator p = m_paths.begin_touching (region, db::box_convert<db::DPath> ()); ! p.at_end (); ++p) {
+    r.draw (*p, t, fill, contour, vertex, text);
+  }
+
+  for (text_tree_type::touching_iterator x = m_texts.begin_touching (region, db::box_convert<db::DText> ()); ! x.at_end (); ++x) {
+    r.draw (*x, t, fill, contour, vertex, text);
+  }
+
+  for (edge_tree_type::touching_iterator e = m_edges.begin_touching (region, db::box_convert<db::DEdge> ()); ! e.at_end (); ++e) {
+    r.draw (*e, t, fill, contour, vertex, text);
+  }
+
+  for (edge_pair_tree_type::touching_iterator e = m_edge_pairs.begin_touching (region, db::box_convert<db::DEdgePair> ()); ! e.at_end (); ++e) {
+    r.draw (e->first (), t, fill, contour, vertex, text);
+    r.draw (e->second (), t, fill, contour, vertex, text);
+    db::DPolygon poly = e->normalized ().to_polygon (0);
+    r.draw (poly, t, fill, 0, 0, 0);
+  }
+}
+
+}
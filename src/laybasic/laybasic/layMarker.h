@@ -39,6 +39,8 @@
 #include "dbEdge.h"
 #include "dbEdgePair.h"
 #include "dbArray.h"
+#include "dbBoxTree.h"
+#include "dbBoxConvert.h"
 #include "gsi.h"
 
 #include <QColor>
@@ -800,6 +802,132 @@ private:
   lay::LayoutView *mp_view;
 };
 
+/**
+ *  @brief A marker for a large number of objects
+ *
+ *  This marker holds many objects which are drawn with a common style. Compared to
+ *  individual DMarker objects, it keeps the objects in compact containers and uses a
+ *  spatial index to render the visible objects only. All objects are rendered in one
+ *  pass. Hence this marker is suitable for highlighting large numbers of objects, i.e.
+ *  a big selection or the items of a marker database category.
+ *
+ *  The objects are given in micrometer units. An additional display transformation
+ *  can be specified which is applied before the objects are drawn.
+ */
+
+class LAYBASIC_PUBLIC BulkMarker
+  : public MarkerBase
+{
+public: 
+  /** 
+   *  @brief The constructor 
+   */ 
+  BulkMarker (lay::LayoutView *view);
+
+  /**
+   *  @brief The destructor
+   */
+  ~BulkMarker ();
+
+  /**
+   *  @brief Removes all objects
+   */
+  void clear ();
+
+  /**
+   *  @brief Adds a box
+   */
+  void insert (const db::DBox &box);
+
+  /**
+   *  @brief Adds a polygon
+   */
+  void insert (const db::DPolygon &poly);
+
+  /**
+   *  @brief Adds an edge pair
+   */
+  void insert (const db::DEdgePair &edge_pair);
+
+  /**
+   *  @brief Adds an edge
+   */
+  void insert (const db::DEdge &edge);
+
+  /**
+   *  @brief Adds a path
+   */
+  void insert (const db::DPath &path);
+
+  /**
+   *  @brief Adds a text
+   */
+  void insert (const db::DText &text);
+
+  /**
+   *  @brief Adds a shape
+   *
+   *  The shape is converted to micrometer units using the given transformation.
+   *  In contrast to ShapeMarker, the marker takes a copy of the shape's geometry.
+   */
+  void insert (const db::Shape &shape, const db::CplxTrans &trans);
+
+  /**
+   *  @brief Gets the number of objects
+   */
+  size_t size () const;
+
+  /**
+   *  @brief Returns true, if the marker does not hold any objects
+   */
+  bool empty () const
+  {
+    return size () == 0;
+  }
+
+  /**
+   *  @brief Sets the display transformation
+   */
+  void set_trans (const db::DCplxTrans &trans);
+
+  /**
+   *  @brief Gets the display transformation
+   */
+  const db::DCplxTrans &trans () const
+  {
+    return m_trans;
+  }
+
+  /**
+   *  @brief Gets the bounding box
+   */
+  virtual db::DBox bbox () const;
+  
+private:
+  typedef db::unstable_box_tree<db::DBox, db::DBox, db::box_convert<db::DBox> > box_tree_type;
+  typedef db::unstable_box_tree<db::DBox, db::DPolygon, db::box_convert<db::DPolygon> > polygon_tree_type;
+  typedef db::unstable_box_tree<db::DBox, db::DEdgePair, db::box_convert<db::DEdgePair> > edge_pair_tree_type;
+  typedef db::unstable_box_tree<db::DBox, db::DEdge, db::box_convert<db::DEdge> > edge_tree_type;
+  typedef db::unstable_box_tree<db::DBox, db::DPath, db::box_convert<db::DPath> > path_tree_type;
+  typedef db::unstable_box_tree<db::DBox, db::DText, db::box_convert<db::DText> > text_tree_type;
+
+  virtual void render (const Viewport &vp, ViewObjectCanvas &canvas);
+
+  void invalidate ();
+  void sort ();
+
+  box_tree_type m_boxes;
+  polygon_tree_type m_polygons;
+  edge_pair_tree_type m_edge_pairs;
+  edge_tree_type m_edges;
+  path_tree_type m_paths;
+  text_tree_type m_texts;
+  db::DBox m_bbox;
+  db::DCplxTrans m_trans;
+  bool m_needs_sort;
+  lay::LayoutView *mp_view;
+};
+
 }
 
 namespace tl {
@@ -811,6 +939,10 @@ namespace tl {
     typedef tl::false_tag has_copy_constructor;
     typedef tl::false_tag has_default_constructor;
   };
+  template <> struct type_traits<lay::BulkMarker> : public type_traits<void> {
+    typedef tl::false_tag has_copy_constructor;
+    typedef tl::false_tag has_default_constructor;
+  };
 }
 
 #endif
@@ -28,10 +28,12 @@
 #include "layRedrawThreadWorker.h"
 #include "tlLog.h"
 #include "tlAssert.h"
+#include "tlProgress.h"
 #include "dbHershey.h"
 #include "dbShape.h"
 
 #include <memory>
+#include <algorithm>
 
 namespace lay 
 {
@@ -53,11 +55,185 @@ RedrawThread::RedrawThread (lay::RedrawThreadCanvas *canvas, lay::LayoutView *vi
   m_custom_already_drawn = false;
   m_nlayers = 0;
   m_clock = tl::Clock::current ();
+  m_nworkers = 0;
+  m_active_workers = 0;
+  m_running = false;
+  m_stopping = false;
 }
 
 RedrawThread::~RedrawThread ()
 {
-  // .. nothing yet ..
+  //  NOTE: unlike "stop", this does not call "stopped" as the canvas may be gone already
+  {
+    QMutexLocker locker (&m_lock);
+    m_stopping = true;
+  }
+
+  //  cancels the group and waits for the pool tasks
+  mp_group.reset (0);
+
+  for (std::vector<RedrawThreadWorker *>::const_iterator w = m_workers.begin (); w != m_workers.end (); ++w) {
+    delete *w;
+  }
+  m_workers.clear ();
+
+  clear_tasks ();
+}
+
+// -------------------------------------------------------------
+//  RedrawThreadPoolTask definition and implementation
+
+/**
+ *  @brief A pool task executing drawing tasks with one worker
+ */
+class RedrawThreadPoolTask
+  : public tl::PoolTask
+{
+public:
+  RedrawThreadPoolTask (RedrawThread *redraw_thread, RedrawThreadWorker *worker)
+    : mp_redraw_thread (redraw_thread), mp_worker (worker)
+  {
+    //  .. nothing yet ..
+  }
+
+  virtual void run ()
+  {
+    mp_redraw_thread->perform_tasks (mp_worker);
+  }
+
+private:
+  RedrawThread *mp_redraw_thread;
+  RedrawThreadWorker *mp_worker;
+};
+
+// -------------------------------------------------------------
+//  RedrawThread implementation (continued)
+
+bool
+RedrawThread::is_running () const
+{
+  QMutexLocker locker (&m_lock);
+  return m_running;
+}
+
+void
+RedrawThread::set_num_workers (int nworkers)
+{
+  stop ();
+
+  //  the pool tasks have terminated now, so the workers can be deleted
+  mp_group.reset (0);
+
+  for (std::vector<RedrawThreadWorker *>::const_iterator w = m_workers.begin (); w != m_workers.end (); ++w) {
+    delete *w;
+  }
+  m_workers.clear ();
+
+  clear_tasks ();
+
+  m_nworkers = nworkers;
+}
+
+void
+RedrawThread::schedule (RedrawThreadTask *task)
+{
+  QMutexLocker locker (&m_lock);
+  m_tasks.push_back (task);
+}
+
+RedrawThreadTask *
+RedrawThread::next_task ()
+{
+  QMutexLocker locker (&m_lock);
+  if (m_tasks.empty ()) {
+    return 0;
+  }
+  RedrawThreadTask *task = m_tasks.front ();
+  m_tasks.pop_front ();
+  return task;
+}
+
+void
+RedrawThread::clear_tasks ()
+{
+  QMutexLocker locker (&m_lock);
+  for (std::deque<RedrawThreadTask *>::const_iterator t = m_tasks.begin (); t != m_tasks.end (); ++t) {
+    delete *t;
+  }
+  m_tasks.clear ();
+}
+
+void
+RedrawThread::perform_tasks (RedrawThreadWorker *worker)
+{
+  while (! is_stopping ()) {
+
+    std::auto_ptr<RedrawThreadTask> task (next_task ());
+    if (! task.get ()) {
+      break;
+    }
+
+    try {
+      worker->perform_task (task.get ());
+    } catch (tl::BreakException &) {
+      //  stop requested
+      break;
+    } catch (tl::Exception &ex) {
+      tl::error << tl::to_string (QObject::tr ("Worker thread: ")) << ex.msg ();
+    } catch (std::exception &ex) {
+      tl::error << tl::to_string (QObject::tr ("Worker thread: ")) << ex.what ();
+    } catch (...) {
+      tl::error << tl::to_string (QObject::tr ("Worker thread: ")) << tl::to_string (QObject::tr ("Unspecific error"));
+    }
+
+  }
+
+  //  the last worker reports the end of drawing unless we're stopping
+  if (m_nworkers > 0) {
+    QMutexLocker locker (&m_lock);
+    if (--m_active_workers == 0) {
+      if (! m_stopping) {
+        finished ();
+      }
+      m_running = false;
+    }
+  }
+}
+
+void
+RedrawThread::stop ()
+{
+  {
+    QMutexLocker locker (&m_lock);
+    if (! m_running) {
+      return;
+    }
+    m_stopping = true;
+  }
+
+  if (mp_group.get ()) {
+    mp_group->cancel ();
+    //  NOTE: the pool tasks don't throw
+    mp_group->wait ();
+  }
+
+  clear_tasks ();
+
+  {
+    QMutexLocker locker (&m_lock);
+    m_stopping = false;
+    m_running = false;
+  }
+
+  stopped ();
+}
+
+void
+RedrawThread::wait ()
+{
+  if (mp_group.get ()) {
+    mp_group->wait ();
+  }
 }
 
 void RedrawThread::layout_changed ()
@@ -80,8 +256,47 @@ RedrawThread::task_finished (int task_id)
   } else if (task_id == draw_boxes_queue_entry) {
     m_boxes_already_drawn = true;
   } else if (task_id >= 0 && task_id < int (m_layers.size ())) {
-    m_layers [task_id].enabled = false;
+    //  a layer may be drawn in multiple tiles: it is finished when the last tile is done
+    QMutexLocker locker (&m_tiles_lock);
+    if (task_id < int (m_pending_tiles.size ()) && --m_pending_tiles [task_id] <= 0) {
+      m_layers [task_id].enabled = false;
+    }
+  }
+}
+
+std::vector<db::Box>
+RedrawThread::make_tiles (int nlayers) const
+{
+  std::vector<db::Box> tiles;
+
+  //  Tiles are only required if there are fewer layers than workers. Otherwise
+  //  the workers are busy with the layers already.
+  if (nlayers <= 0 || num_workers () <= nlayers || m_redraw_regions.empty ()) {
+    return tiles;
+  }
+
+  db::Box bbox;
+  for (std::vector<db::Box>::const_iterator r = m_redraw_regions.begin (); r != m_redraw_regions.end (); ++r) {
+    bbox += *r;
+  }
+  if (bbox.empty ()) {
+    return tiles;
+  }
+
+  //  Use horizontal bands since the bitmaps are organized in scanlines
+  int ntiles = (num_workers () + nlayers - 1) / nlayers;
+  ntiles = std::min (ntiles, std::max (1, int (bbox.height () / min_tile_height)));
+  if (ntiles < 2) {
+    return tiles;
+  }
+
+  for (int i = 0; i < ntiles; ++i) {
+    db::Coord y1 = bbox.bottom () + db::Coord ((int64_t (bbox.height ()) * i) / ntiles);
+    db::Coord y2 = bbox.bottom () + db::Coord ((int64_t (bbox.height ()) * (i + 1)) / ntiles);
+    tiles.push_back (db::Box (bbox.left (), y1, bbox.right (), y2));
   }
+
+  return tiles;
 }
 
 std::vector<db::DBox> 
@@ -185,7 +400,7 @@ RedrawThread::start (int workers, const std::vector <lay::RedrawLayerInfo> &laye
   m_last_center = new_region.center ();
 
   std::vector<int> restart;
-  do_start (true, shift_vector, &layers, restart, workers);
+  do_start (true, shift_vector, &layers, restart, workers, false);
 }
 
 void  
@@ -195,7 +410,49 @@ RedrawThread::restart (const std::vector<int> &restart)
   m_redraw_regions.push_back (db::Box (db::Point (0, 0), db::Point (m_width, m_height)));
   m_valid_region = m_stored_region = db::DBox ();
 
-  do_start (false, 0, 0, restart, -1);
+  do_start (false, 0, 0, restart, -1, false);
+}
+
+void  
+RedrawThread::restart (const std::vector<int> &restart, const std::vector<db::DBox> &regions)
+{
+  //  Only the given regions of the layers need to be redrawn. This requires the image to be
+  //  complete: no other layer must be pending and cell frames and custom drawings must be drawn already.
+  bool partial = ! regions.empty () && m_boxes_already_drawn && m_custom_already_drawn;
+  for (std::vector<int>::const_iterator l = restart.begin (); l != restart.end () && partial; ++l) {
+    if (*l < 0 || *l >= int (m_layers.size ())) {
+      partial = false;
+    }
+  }
+  for (std::vector<lay::RedrawLayerInfo>::const_iterator l = m_layers.begin (); l != m_layers.end () && partial; ++l) {
+    if (l->visible && l->enabled) {
+      partial = false;
+    }
+  }
+
+  if (! partial) {
+    this->restart (restart);
+    return;
+  }
+
+  db::Box full (db::Point (0, 0), db::Point (m_width, m_height));
+  double margin = double (region_margin) / m_resolution;
+
+  m_redraw_regions.clear ();
+  for (std::vector<db::DBox>::const_iterator r = regions.begin (); r != regions.end (); ++r) {
+    db::Box rr = db::Box ((m_vp_trans * *r).enlarged (db::DVector (margin, margin)));
+    rr &= full;
+    if (! rr.empty ()) {
+      m_redraw_regions.push_back (rr);
+    }
+  }
+
+  //  nothing visible has changed
+  if (m_redraw_regions.empty ()) {
+    return;
+  }
+
+  do_start (false, 0, 0, restart, -1, true);
 }
 
 void  
@@ -207,7 +464,7 @@ RedrawThread::change_visibility (const std::vector<bool> &visibility)
 }
 
 void 
-RedrawThread::do_start (bool clear, const db::Vector *shift_vector, const std::vector <lay::RedrawLayerInfo> *layers, const std::vector<int> &restart, int nworkers)
+RedrawThread::do_start (bool clear, const db::Vector *shift_vector, const std::vector <lay::RedrawLayerInfo> *layers, const std::vector<int> &restart, int nworkers, bool partial)
 {
   // change the number of workers if required.
   if (nworkers >= 0 && nworkers != num_workers ()) {
@@ -240,6 +497,8 @@ RedrawThread::do_start (bool clear, const db::Vector *shift_vector, const std::v
       const lay::CellView &cv = mp_view->cellview (i);
       if (cv.is_valid () && ! cv->layout ().under_construction () && ! (cv->layout ().manager () && cv->layout ().manager ()->transacting ())) {
         cv->layout ().update ();
+        //  discard the density maps invalidated by layout changes - the drawing threads are not running now
+        cv->density_pyramid ().update ();
         //  attach to the layout object to receive change notifications to stop the redraw thread
         cv->layout ().hier_changed_event.add (this, &RedrawThread::layout_changed);
         cv->layout ().bboxes_changed_any_event.add (this, &RedrawThread::layout_changed);
@@ -284,7 +543,12 @@ RedrawThread::do_start (bool clear, const db::Vector *shift_vector, const std::v
           }
         }
 
-        mp_canvas->prepare (m_nlayers * planes_per_layer + special_planes_before + special_planes_after, m_width, m_height, m_resolution, shift_vector, &planes_to_init, mp_view->drawings ());
+        if (partial) {
+          //  clear only the regions to redraw - the remaining parts of the planes stay valid
+          mp_canvas->clear_plane_regions (planes_to_init, m_redraw_regions);
+        } else {
+          mp_canvas->prepare (m_nlayers * planes_per_layer + special_planes_before + special_planes_after, m_width, m_height, m_resolution, shift_vector, &planes_to_init, mp_view->drawings ());
+        }
 
         for (std::vector<int>::const_iterator l = restart.begin (); l != restart.end (); ++l) {
           if (*l >= 0 && *l < int (m_layers.size ())) {
@@ -306,9 +570,31 @@ RedrawThread::do_start (bool clear, const db::Vector *shift_vector, const std::v
         schedule (new RedrawThreadTask (draw_custom_queue_entry));
       }
 
+      //  Layers are drawn in tiles if there are fewer layers to draw than workers.
+      //  Only shape layers are tiled since cell frames come with texts.
+      int nlayers_to_draw = 0;
+      for (int i = 0; i < m_nlayers; ++i) {
+        if (m_layers [i].visible && m_layers [i].enabled) {
+          ++nlayers_to_draw;
+        }
+      }
+
+      std::vector<db::Box> tiles = make_tiles (nlayers_to_draw);
+
+      m_pending_tiles.clear ();
+      m_pending_tiles.resize (m_nlayers, 0);
+
       for (int i = 0; i < m_nlayers; ++i) {
         if (m_layers [i].visible && m_layers [i].enabled) {
-          schedule (new RedrawThreadTask (i));
+          if (! tiles.empty () && m_layers [i].layer_index >= 0) {
+            m_pending_tiles [i] = int (tiles.size ());
+            for (unsigned int t = 0; t < (unsigned int) tiles.size (); ++t) {
+              schedule (new RedrawThreadTask (i, t, tiles [t]));
+            }
+          } else {
+            m_pending_tiles [i] = 1;
+            schedule (new RedrawThreadTask (i));
+          }
         }
       }
 
@@ -344,21 +630,49 @@ RedrawThread::do_start (bool clear, const db::Vector *shift_vector, const std::v
 void
 RedrawThread::start ()
 {
-  JobBase::start ();
-}
+  if (m_nworkers <= 0) {
 
-tl::Worker *
-RedrawThread::create_worker ()
-{
-  return new RedrawThreadWorker (this);
-}
+    //  synchronous case: create a temporary worker and 
+    //  perform the tasks in the order they were delivered
+    {
+      QMutexLocker locker (&m_lock);
+      m_running = true;
+    }
 
-void 
-RedrawThread::setup_worker (tl::Worker *worker)
-{
-  RedrawThreadWorker *redraw_thread_worker = dynamic_cast<RedrawThreadWorker *> (worker);
-  if (redraw_thread_worker) {
-    redraw_thread_worker->setup (mp_view, mp_canvas, m_redraw_regions, m_vp_trans);
+    RedrawThreadWorker sync_worker (this);
+    sync_worker.setup (mp_view, mp_canvas, m_redraw_regions, m_vp_trans);
+    perform_tasks (&sync_worker);
+    clear_tasks ();
+
+    finished ();
+
+    QMutexLocker locker (&m_lock);
+    m_running = false;
+
+    return;
+
+  }
+
+  //  the previous run has finished already - a new group is required since the old one may be cancelled
+  mp_group.reset (new tl::TaskGroup ());
+
+  while (int (m_workers.size ()) < m_nworkers) {
+    m_workers.push_back (new RedrawThreadWorker (this));
+  }
+
+  for (std::vector<RedrawThreadWorker *>::const_iterator w = m_workers.begin (); w != m_workers.end (); ++w) {
+    (*w)->setup (mp_view, mp_canvas, m_redraw_regions, m_vp_trans);
+  }
+
+  {
+    QMutexLocker locker (&m_lock);
+    m_running = true;
+    m_active_workers = int (m_workers.size ());
+  }
+
+  //  one pool task per worker: the worker's state is used by this task only
+  for (std::vector<RedrawThreadWorker *>::const_iterator w = m_workers.begin (); w != m_workers.end (); ++w) {
+    mp_group->run (new RedrawThreadPoolTask (this, *w));
   }
 }
 
@@ -382,11 +696,8 @@ RedrawThread::done ()
   wakeup ();
 
   //  release the workers' resources
-  for (int i = 0; i < num_workers (); ++i) {
-    RedrawThreadWorker *w = dynamic_cast <RedrawThreadWorker *> (worker (i));
-    if (w) {
-      w->finish ();
-    }
+  for (std::vector<RedrawThreadWorker *>::const_iterator w = m_workers.begin (); w != m_workers.end (); ++w) {
+    (*w)->finish ();
   }
 
   //  send a signal to the canvas that the drawing has finished
@@ -26,6 +26,7 @@
 
 #include <vector>
 #include <set>
+#include <deque>
 #include <memory>
 
 #include <QThread>
@@ -41,18 +42,33 @@
 #include "layRedrawLayerInfo.h"
 #include "layCanvasPlane.h"
 #include "tlTimer.h"
-#include "tlThreadedWorkers.h"
+#include "tlThreadPool.h"
 
 namespace lay {
 
 class Viewport;
+class RedrawThreadTask;
+class RedrawThreadWorker;
 
 //  update (snapshot) interval in ms
 const int update_interval = 500;
 
+//  the minimum height of a tile in pixels
+const int min_tile_height = 64;
+
+//  the margin in screen pixels by which the regions of a partial redraw are enlarged
+const int region_margin = 8;
+
+/**
+ *  @brief The redraw scheduler
+ *
+ *  The drawing tasks are executed in the thread pool. One pool task is submitted per
+ *  worker. Each pool task owns one RedrawThreadWorker which carries the per-thread
+ *  drawing state and fetches drawing tasks until all are done. With 0 workers, the
+ *  tasks are executed synchronously in "start".
+ */
 class RedrawThread 
-  : public tl::Object,
-    public tl::JobBase
+  : public tl::Object
 {
 public:
   RedrawThread (lay::RedrawThreadCanvas *canvas, lay::LayoutView *view);
@@ -61,6 +77,7 @@ public:
   void commit (const std::vector <lay::RedrawLayerInfo> &layers, const lay::Viewport &vp, double resolution);
   void start (int workers, const std::vector <lay::RedrawLayerInfo> &layers, const lay::Viewport &vp, double resolution, bool force_redraw);
   void restart (const std::vector<int> &restart);
+  void restart (const std::vector<int> &restart, const std::vector<db::DBox> &regions);
   void wakeup_checked ();
   void wakeup ();
 
@@ -83,16 +100,59 @@ public:
 
   void task_finished (int id);
 
-protected:
-  tl::Worker *create_worker ();
-  void setup_worker (tl::Worker *worker);
-  void finished ();
-  void stopped ();
+  /**
+   *  @brief Gets the number of workers (0 for synchronous drawing)
+   */
+  int num_workers () const
+  {
+    return m_nworkers;
+  }
+
+  /**
+   *  @brief Gets a value indicating whether drawing is in progress
+   */
+  bool is_running () const;
+
+  /**
+   *  @brief Gets a value indicating whether a stop was requested
+   *
+   *  The workers check this flag and abort drawing if it is set.
+   */
+  bool is_stopping () const
+  {
+    return mp_group.get () && mp_group->is_cancelled ();
+  }
+
+  /**
+   *  @brief Stops drawing
+   *
+   *  This method waits until the workers have terminated.
+   */
+  void stop ();
+
+  /**
+   *  @brief Waits until drawing has finished
+   */
+  void wait ();
+
+  /**
+   *  @brief Executes drawing tasks with the given worker until all tasks are done
+   *
+   *  This method is called from the pool tasks.
+   */
+  void perform_tasks (RedrawThreadWorker *worker);
 
 private:
+  void finished ();
+  void stopped ();
   void start ();
-  void do_start (bool clear, const db::Vector *shift_vector, const std::vector <lay::RedrawLayerInfo> *layers, const std::vector<int> &restart, int workers);
+  void set_num_workers (int nworkers);
+  void schedule (RedrawThreadTask *task);
+  RedrawThreadTask *next_task ();
+  void clear_tasks ();
+  void do_start (bool clear, const db::Vector *shift_vector, const std::vector <lay::RedrawLayerInfo> *layers, const std::vector<int> &restart, int workers, bool partial);
   void done ();
+  std::vector<db::Box> make_tiles (int nlayers) const;
 
   void layout_changed ();
 
@@ -111,6 +171,8 @@ private:
   int m_width, m_height;
   double m_resolution;
   std::vector<db::Box> m_redraw_regions;
+  std::vector<int> m_pending_tiles;
+  QMutex m_tiles_lock;
   db::DBox m_stored_region, m_valid_region;
   db::DPoint m_last_center;
   db::DFTrans m_stored_fp;
@@ -124,6 +186,15 @@ private:
   QWaitCondition m_initial_wait_cond;
 
   std::auto_ptr<tl::SelfTimer> m_main_timer;
+
+  int m_nworkers;
+  std::vector<RedrawThreadWorker *> m_workers;
+  std::deque<RedrawThreadTask *> m_tasks;
+  std::auto_ptr<tl::TaskGroup> mp_group;
+  int m_active_workers;
+  bool m_running;
+  bool m_stopping;
+  mutable QMutex m_lock;
 };
 
 }
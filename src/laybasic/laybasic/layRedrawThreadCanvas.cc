@@ -322,6 +322,35 @@ BitmapRedrawThreadCanvas::prepare (unsigned int nlayers, unsigned int width, uns
   unlock ();
 }
 
+void 
+BitmapRedrawThreadCanvas::clear_plane_regions (const std::vector<int> &planes, const std::vector<db::Box> &regions)
+{
+  lock ();
+
+  db::Box full (0, 0, m_width, m_height);
+
+  for (std::vector<int>::const_iterator l = planes.begin (); l != planes.end (); ++l) {
+
+    if (*l < 0 || size_t (*l) >= mp_plane_buffers.size ()) {
+      continue;
+    }
+
+    lay::Bitmap *bitmap = mp_plane_buffers [*l];
+
+    for (std::vector<db::Box>::const_iterator r = regions.begin (); r != regions.end (); ++r) {
+      db::Box rr = *r & full;
+      if (! rr.empty ()) {
+        for (db::Coord y = rr.bottom (); y < rr.top (); ++y) {
+          bitmap->clear ((unsigned int) y, (unsigned int) rr.left (), (unsigned int) rr.right ());
+        }
+      }
+    }
+
+  }
+
+  unlock ();
+}
+
 void 
 BitmapRedrawThreadCanvas::set_plane (unsigned int n, const lay::CanvasPlane *plane)
 { 
@@ -334,6 +363,18 @@ BitmapRedrawThreadCanvas::set_plane (unsigned int n, const lay::CanvasPlane *pla
   unlock ();
 }
 
+void 
+BitmapRedrawThreadCanvas::merge_plane (unsigned int n, const lay::CanvasPlane *plane)
+{ 
+  lock ();
+  if (n < mp_plane_buffers.size ()) {
+    const lay::Bitmap *bitmap = dynamic_cast<const lay::Bitmap *> (plane);
+    tl_assert (bitmap != 0);
+    mp_plane_buffers [n]->merge (bitmap, 0, 0); 
+  }
+  unlock ();
+}
+
 void 
 BitmapRedrawThreadCanvas::set_drawing_plane (unsigned int d, unsigned int n, const lay::CanvasPlane *plane)
 { 
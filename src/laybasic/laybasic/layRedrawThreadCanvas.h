@@ -103,6 +103,18 @@ public:
     m_height = height;
   }
 
+  /**
+   *  @brief Clears the given regions of the given planes
+   *
+   *  This method is called from RedrawThread::start (), not from the
+   *  redraw thread. It is used instead of "prepare" if only parts of the 
+   *  planes are redrawn.
+   *
+   *  @param planes The plane indexes of the planes to clear
+   *  @param regions The regions to clear in pixel units
+   */
+  virtual void clear_plane_regions (const std::vector<int> &planes, const std::vector<db::Box> &regions) = 0;
+
   /**
    *  @brief Set a plane
    *
@@ -111,6 +123,15 @@ public:
    */
   virtual void set_plane (unsigned int n, const lay::CanvasPlane *plane) = 0;
 
+  /**
+   *  @brief Merge a plane into the plane with index n
+   *
+   *  This method is called from the redraw thread to transfer data for a certain plane.
+   *  In contrast to set_plane, the pixels of the given plane are added to the existing 
+   *  ones. This way, multiple workers can contribute to the same plane.
+   */
+  virtual void merge_plane (unsigned int n, const lay::CanvasPlane *plane) = 0;
+
   /**
    *  @brief Set a plane for the drawing number d and index n within the drawing.
    *
@@ -276,6 +297,14 @@ public:
    */
   virtual void prepare (unsigned int nlayers, unsigned int width, unsigned int height, double resolution, const db::Vector *shift_vector, const std::vector<int> *planes, const lay::Drawings *drawings);
   
+  /**
+   *  @brief Clears the given regions of the given planes
+   *
+   *  This method is called from RedrawThread::start (), not from the
+   *  redraw thread.
+   */
+  virtual void clear_plane_regions (const std::vector<int> &planes, const std::vector<db::Box> &regions);
+
   /**
    *  @brief Test a plane with the given index for emptiness
    */
@@ -289,6 +318,13 @@ public:
    */
   virtual void set_plane (unsigned int n, const lay::CanvasPlane *plane);
 
+  /**
+   *  @brief Merge a plane into the plane with index n
+   *
+   *  This method is called from the redraw thread.
+   */
+  virtual void merge_plane (unsigned int n, const lay::CanvasPlane *plane);
+
   /**
    *  @brief Set a plane for the drawing number d and index n within the drawing.
    *
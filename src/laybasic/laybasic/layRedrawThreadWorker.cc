@@ -24,6 +24,9 @@
 #include "layRedrawThreadWorker.h"
 #include "layRedrawThread.h"
 
+#include "tlProfiler.h"
+#include "tlProgress.h"
+
 namespace lay
 {
 
@@ -61,6 +64,8 @@ RedrawThreadWorker::RedrawThreadWorker (RedrawThread *redraw_thread)
   m_drop_small_cells = false;
   m_drop_small_cells_value = 0;
   m_drop_small_cells_cond = lay::LayoutView::DSC_Min;
+  m_density_pyramid_threshold = 0;
+  mp_density_pyramid = 0;
   m_draw_array_border_instances = false;
   m_abstract_mode_width = 0;
   m_child_context_enabled = false;
@@ -86,12 +91,9 @@ RedrawThreadWorker::~RedrawThreadWorker ()
 }
 
 void 
-RedrawThreadWorker::perform_task (tl::Task *task)
+RedrawThreadWorker::perform_task (const RedrawThreadTask *redraw_thread_task)
 {
-  RedrawThreadTask *redraw_thread_task = dynamic_cast <RedrawThreadTask *> (task);
-  if (! redraw_thread_task) {
-    return;
-  }
+  tl::ProfileZone zone ("RedrawThread::layer");
 
   m_cell_cache.clear ();
   m_mi_cache.clear ();
@@ -106,25 +108,45 @@ RedrawThreadWorker::perform_task (tl::Task *task)
 
     //  draw a layer
 
+    //  A task for a tile draws the part of the redraw region inside the tile on empty planes. These 
+    //  are merged into the canvas planes. Texts may extend beyond the tile, hence tile 0 draws the texts
+    //  for the whole region.
+    bool tiled = ! redraw_thread_task->tile_box ().empty ();
+    bool draw_texts = (redraw_thread_task->tile () == 0);
+
+    std::vector<db::Box> redraw_region;
+    if (tiled) {
+      for (std::vector<db::Box>::const_iterator r = m_redraw_region.begin (); r != m_redraw_region.end (); ++r) {
+        db::Box rr = *r & redraw_thread_task->tile_box ();
+        if (! rr.empty ()) {
+          redraw_region.push_back (rr);
+        }
+      }
+    } else {
+      redraw_region = m_redraw_region;
+    }
+
     //  HINT: the order in which the planes are delivered (the index stored in the first member of the pair below)
     //  must correspond with the order by which the ViewOp's are created inside LayoutView::set_view_ops
     m_buffers.clear ();
+    m_merge_buffers.clear ();
     for (unsigned int i = 0; i < (unsigned int) planes_per_layer / 3; ++i) {
 
+      //  plane 2 is the text plane which is not drawn in tiles
+      bool merge = tiled && i != 2;
+      bool draw = draw_texts || i != 2;
+
       //  context level planes
       unsigned int i1 = task_id * (planes_per_layer / 3) + special_planes_before + i;
-      mp_canvas->initialize_plane (m_planes[i], i1); 
-      m_buffers.push_back (std::make_pair (i1, m_planes [i]));
+      setup_layer_plane (i1, m_planes [i], merge, draw);
 
       //  child level planes (if used)
       unsigned int i2 = (task_id + m_nlayers) * (planes_per_layer / 3) + special_planes_before + i;
-      mp_canvas->initialize_plane (m_planes [i + planes_per_layer / 3], i2); 
-      m_buffers.push_back (std::make_pair (i2, m_planes [i + planes_per_layer / 3]));
+      setup_layer_plane (i2, m_planes [i + planes_per_layer / 3], merge, draw);
 
       //  current level planes
       unsigned int i3 = (task_id + m_nlayers * 2) * (planes_per_layer / 3) + special_planes_before + i;
-      mp_canvas->initialize_plane (m_planes [i + 2 * (planes_per_layer / 3)], i3); 
-      m_buffers.push_back (std::make_pair (i3, m_planes [i + 2 * (planes_per_layer / 3)]));
+      setup_layer_plane (i3, m_planes [i + 2 * (planes_per_layer / 3)], merge, draw);
 
     }
 
@@ -162,6 +184,8 @@ RedrawThreadWorker::perform_task (tl::Task *task)
         m_cv_index = li.cellview_index;
         db::cell_index_type ci = cv.cell_index ();
 
+        mp_density_pyramid = (m_density_pyramid_threshold > 0 ? &cv->density_pyramid () : 0);
+
         int ctx_path_length = int (m_cellviews [m_cv_index].specific_path ().size ());
 
         if (li.hier_levels.has_from_level ()) {
@@ -200,8 +224,10 @@ RedrawThreadWorker::perform_task (tl::Task *task)
 
           for (std::vector<db::DCplxTrans>::const_iterator t = li.trans.begin (); t != li.trans.end (); ++t) {
             db::CplxTrans trans = m_vp_trans * *t * db::CplxTrans (mp_layout->dbu ());
-            iterate_variants (m_redraw_region, ci, trans, &RedrawThreadWorker::draw_layer);
-            iterate_variants (text_redraw_regions, ci, trans, &RedrawThreadWorker::draw_text_layer);
+            iterate_variants (redraw_region, ci, trans, &RedrawThreadWorker::draw_layer);
+            if (draw_texts) {
+              iterate_variants (text_redraw_regions, ci, trans, &RedrawThreadWorker::draw_text_layer);
+            }
           }
 
         } else if (li.cell_frame) {
@@ -227,6 +253,7 @@ RedrawThreadWorker::perform_task (tl::Task *task)
 
         mp_prop_sel = 0;
         m_inv_prop_sel = false;
+        mp_density_pyramid = 0;
 
       }
 
@@ -443,6 +470,7 @@ RedrawThreadWorker::perform_task (tl::Task *task)
 
   transfer ();
   m_buffers.clear ();
+  m_merge_buffers.clear ();
 
   if (tl::verbosity () >= 30) {
     for (cell_cache_t::iterator cc = m_cell_cache.begin(); cc != m_cell_cache.end (); ++cc) {
@@ -520,6 +548,7 @@ RedrawThreadWorker::setup (LayoutView *view, RedrawThreadCanvas *canvas, const s
   m_drop_small_cells = view->drop_small_cells ();
   m_drop_small_cells_value = view->drop_small_cells_value ();
   m_drop_small_cells_cond = view->drop_small_cells_cond ();
+  m_density_pyramid_threshold = view->density_pyramid_threshold ();
   m_draw_array_border_instances = view->draw_array_border_instances ();
   m_abstract_mode_width = view->abstract_mode_width ();
   m_child_context_enabled = view->child_context_enabled ();
@@ -547,6 +576,25 @@ RedrawThreadWorker::transfer ()
   for (std::vector<std::pair<unsigned int, lay::CanvasPlane *> >::iterator b = m_buffers.begin (); b != m_buffers.end (); ++b) {
     mp_canvas->set_plane (b->first, b->second);
   }
+  for (std::vector<std::pair<unsigned int, lay::CanvasPlane *> >::iterator b = m_merge_buffers.begin (); b != m_merge_buffers.end (); ++b) {
+    mp_canvas->merge_plane (b->first, b->second);
+  }
+}
+
+void
+RedrawThreadWorker::setup_layer_plane (unsigned int n, lay::CanvasPlane *plane, bool merge, bool draw)
+{
+  if (! draw) {
+    //  not drawn by this task: the plane only serves as a scratch plane
+    plane->clear ();
+  } else if (merge) {
+    //  draw on an empty plane which is merged into the canvas plane
+    plane->clear ();
+    m_merge_buffers.push_back (std::make_pair (n, plane));
+  } else {
+    mp_canvas->initialize_plane (plane, n); 
+    m_buffers.push_back (std::make_pair (n, plane));
+  }
 }
 
 void 
@@ -1518,7 +1566,23 @@ bool draw_array_simplified (lay::Renderer *r, const db::Shape &array_shape, lay:
 
   return false;
 }
- 
+
+/**
+ *  @brief Places an instance on the sub-pixel grid
+ *
+ *  The displacement is rounded to 1/cell_cache_subpixels pixel. Instances with the same
+ *  fractional offset are drawn identically then, so a cached cell bitmap gives the same
+ *  image than drawing the cell, no matter whether the cache is used or not.
+ */
+static db::CplxTrans
+snap_to_subpixel_grid (const db::CplxTrans &t)
+{
+  db::CplxTrans ts = t;
+  ts.disp (db::DVector (floor (t.disp ().x () * cell_cache_subpixels + 0.5) / cell_cache_subpixels,
+                        floor (t.disp ().y () * cell_cache_subpixels + 0.5) / cell_cache_subpixels));
+  return ts;
+}
+
 void
 RedrawThreadWorker::draw_layer_wo_cache (int from_level, int to_level, db::cell_index_type ci, const db::CplxTrans &trans, const std::vector<db::Box> &vv, int level,
                                          lay::CanvasPlane *fill, lay::CanvasPlane *frame, lay::CanvasPlane *vertex, lay::CanvasPlane *text, const UpdateSnapshotCallback *update_snapshot)
@@ -1696,7 +1760,7 @@ RedrawThreadWorker::draw_layer_wo_cache (int from_level, int to_level, db::cell_
 
                   db::ICplxTrans t (cell_inst.complex_trans (*p));
                   db::Box new_vp = db::Box (t.inverted () * *v);
-                  draw_layer (from_level, to_level, new_ci, trans * t, new_vp, level + 1, fill, frame, vertex, text, update_snapshot);
+                  draw_layer (from_level, to_level, new_ci, snap_to_subpixel_grid (trans * t), new_vp, level + 1, fill, frame, vertex, text, update_snapshot);
 
                 } 
 
@@ -1804,6 +1868,11 @@ RedrawThreadWorker::draw_layer (int from_level, int to_level, db::cell_index_typ
         mp_renderer->draw (dbbox, 0, frame, vertex, 0);
       } 
 
+    } else if (use_density_map (cell, dbbox, level, to_level)) {
+
+      //  small cells: draw the coverage map instead of the shapes
+      draw_density_map (ci, trans, vp, frame, vertex);
+
     } else {
 
       //  create a set of boxes to look into
@@ -1818,35 +1887,57 @@ RedrawThreadWorker::draw_layer (int from_level, int to_level, db::cell_index_typ
         can_cache = false;
       }
 
-      //  only cache if we have more than one instance at all
-      if (can_cache && level > 0) {
-        db::Cell::parent_inst_iterator p = cell.begin_parent_insts ();
-        size_t n;
-        for (n = 0; !p.at_end () && n < 2; ++n) 
-          ;
+      //  only cache if we have more than one instance at all (array members count individually).
+      //  Cells on the top level or in the context are drawn once only.
+      if (level <= 0) {
+        can_cache = false;
+      } else if (can_cache) {
+        size_t n = 0;
+        for (db::Cell::parent_inst_iterator p = cell.begin_parent_insts (); ! p.at_end () && n < 2; ++p) {
+          n += p->basic_child_inst ()->size ();
+        }
         if (n <= 1) {
           can_cache = false;
         }
       }
 
+      db::CplxTrans trans_wo_disp;
+      db::DBox cell_box_trans;
+      db::DPoint d;
+      cell_cache_t::iterator cached_cell = m_cell_cache.end ();
+
       if (can_cache) {
 
-        db::CplxTrans trans_wo_disp = trans;
+        trans_wo_disp = trans;
         trans_wo_disp.disp (db::DVector ());
 
-        //  if we have the cell cached, use the cached bitmap
-        CellCacheKey key (to_level - level, ci, trans_wo_disp);
-        cell_cache_t::iterator cached_cell = m_cell_cache.find (key);
-        if (cached_cell == m_cell_cache.end ()) {
+        cell_box_trans = trans_wo_disp * cell_bbox;
 
+        //  the pixel position of the cell
+        d = cell_box_trans.lower_left () + trans.disp ();
+        d = db::DPoint (floor (d.x ()), floor (d.y ()));
+
+        //  the instances are placed on the sub-pixel grid (see snap_to_subpixel_grid), so the
+        //  fractional part of the displacement is a multiple of 1/cell_cache_subpixels
+        int fx = int (floor ((trans.disp ().x () - floor (trans.disp ().x ())) * cell_cache_subpixels + 0.5)) % cell_cache_subpixels;
+        int fy = int (floor ((trans.disp ().y () - floor (trans.disp ().y ())) * cell_cache_subpixels + 0.5)) % cell_cache_subpixels;
+
+        CellCacheKey key (to_level - level, ci, trans_wo_disp, fx, fy);
+        cached_cell = m_cell_cache.find (key);
+
+        if (cached_cell == m_cell_cache.end ()) {
           //  put the cell into the cache
           cached_cell = m_cell_cache.insert (std::make_pair (key, CellCacheInfo ())).first;
+        }
 
-          db::DBox cell_box_trans = trans_wo_disp * cell_bbox;
+      }
+
+      if (can_cache) {
 
-          //  Hint: this rounding scheme guarantees a integer-pixel shift vector at least for the first instance
-          db::DPoint d = cell_box_trans.lower_left () + trans.disp ();
-          d = db::DPoint (floor (d.x ()), floor (d.y ()));
+        //  if the cell was not cached yet, draw the cell into the cache bitmaps
+        if (cached_cell->second.fill == 0) {
+
+          //  Hint: this rounding scheme guarantees a integer-pixel shift vector for all instances with the same fractional offset
           cached_cell->second.offset = d - trans.disp ();
           db::CplxTrans drawing_trans = trans_wo_disp;
           drawing_trans.disp (db::DPoint () - cached_cell->second.offset);
@@ -1954,6 +2045,75 @@ RedrawThreadWorker::draw_layer (bool drawing_context, db::cell_index_type ci, co
   }
 }
 
+bool
+RedrawThreadWorker::use_density_map (const db::Cell &cell, const db::DBox &dbbox, int level, int to_level) const
+{
+  if (! mp_density_pyramid || dbbox.width () > double (m_density_pyramid_threshold) || dbbox.height () > double (m_density_pyramid_threshold)) {
+    return false;
+  }
+
+  //  the map covers the whole hierarchy below the cell and does not know about
+  //  property selections, hidden cells and array border instances
+  if (level + int (cell.hierarchy_levels ()) >= to_level || mp_prop_sel != 0 || m_draw_array_border_instances) {
+    return false;
+  }
+  if (m_cv_index < int (m_hidden_cells.size ()) && ! m_hidden_cells [m_cv_index].empty ()) {
+    return false;
+  }
+
+  return true;
+}
+
+void
+RedrawThreadWorker::draw_density_map (db::cell_index_type ci, const db::CplxTrans &trans, const db::Box &vp, lay::CanvasPlane *frame, lay::CanvasPlane *vertex)
+{
+  const lay::DensityMap &map = mp_density_pyramid->map (ci, m_layer, this);
+  if (map.empty ()) {
+    return;
+  }
+
+  //  use the coarsest level whose bins are not larger than one pixel and
+  //  paint the runs of covered bins like very small shapes
+  unsigned int l = map.level_for (1.0 / trans.mag ());
+
+  for (unsigned int y = 0; y < map.size (l); ++y) {
+
+    lay::DensityMap::row_type r = map.row (l, y);
+
+    unsigned int x = 0;
+    while (r != 0) {
+      if ((r & 1) != 0) {
+        unsigned int x1 = x;
+        while ((r & 2) != 0) {
+          r >>= 1;
+          ++x;
+        }
+        db::Box b = map.bin_box (l, x1, x, y);
+        if (b.touches (vp)) {
+          mp_renderer->draw (trans * b, 0, frame, vertex, 0);
+        }
+      }
+      r >>= 1;
+      ++x;
+    }
+
+  }
+}
+
+void
+RedrawThreadWorker::check_abort ()
+{
+  checkpoint ();
+}
+
+void
+RedrawThreadWorker::checkpoint ()
+{
+  if (mp_redraw_thread->is_stopping ()) {
+    throw tl::BreakException ();
+  }
+}
+
 bool
 RedrawThreadWorker::drop_cell (const db::Cell &cell, const db::CplxTrans &trans)
 {
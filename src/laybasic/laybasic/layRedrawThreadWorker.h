@@ -26,7 +26,7 @@
 
 #include "dbLayout.h"
 #include "layLayoutView.h"
-#include "tlThreadedWorkers.h"
+#include "layDensityPyramid.h"
 #include "tlTimer.h"
 
 #include <memory>
@@ -52,6 +52,10 @@ const int special_queue_entries = 2;
 const int draw_boxes_queue_entry = -1;
 const int draw_custom_queue_entry = -2;
 
+//  instances are placed on a grid of 1/cell_cache_subpixels pixel. Hence there are
+//  cell_cache_subpixels^2 cached bitmaps at most for one cell variant.
+const int cell_cache_subpixels = 4;
+
 /**
  *  @brief A compare operator for the cell variant cache
  */
@@ -69,14 +73,17 @@ public:
 };
 
 /**
- *  @brief A task object for the redraw thread worker (a tl::Task specialization)
+ *  @brief A task object for the redraw thread worker
+ *
+ *  A layer may be drawn by multiple tasks, each one responsible for a tile of the
+ *  redraw region. The tile box is empty if the task draws the whole region. 
+ *  Tile 0 also draws the texts of the layer.
  */
 class RedrawThreadTask
-  : public tl::Task
 {
 public: 
-  RedrawThreadTask (int id)
-    : m_id (id)
+  RedrawThreadTask (int id, unsigned int tile = 0, const db::Box &tile_box = db::Box ())
+    : m_id (id), m_tile (tile), m_tile_box (tile_box)
   { }
 
   int id () const
@@ -84,23 +91,44 @@ public:
     return m_id;
   }
 
+  unsigned int tile () const
+  {
+    return m_tile;
+  }
+
+  const db::Box &tile_box () const
+  {
+    return m_tile_box;
+  }
+
 private:
   int m_id;
+  unsigned int m_tile;
+  db::Box m_tile_box;
 };
 
 /**
  *  @brief An entry in the drawing cache
+ *
+ *  A cached bitmap can be copied to integer pixel positions only. Hence the
+ *  fractional part of the pixel position of the cell is part of the key: the
+ *  bitmap is used only for instances which are placed at the same fractional
+ *  pixel offset. For these, the result is identical to drawing the cell.
+ *  Instances are placed on a grid of 1/cell_cache_subpixels pixel, so there are
+ *  only few different offsets per cell variant.
+ *  "fx" and "fy" are the fractional offsets in units of 1/cell_cache_subpixels.
  */
 struct CellCacheKey 
 {
 public:
-  CellCacheKey (int n, db::cell_index_type c, const db::CplxTrans &t) 
-    : nlevels (n), ci (c), trans (t)
+  CellCacheKey (int n, db::cell_index_type c, const db::CplxTrans &t, int _fx = 0, int _fy = 0) 
+    : nlevels (n), ci (c), trans (t), fx (_fx), fy (_fy)
   { }
 
   int nlevels;
   db::cell_index_type ci;
   db::CplxTrans trans;
+  int fx, fy;
 
   bool operator< (const CellCacheKey &other) const
   {
@@ -110,6 +138,12 @@ public:
     if (ci != other.ci) {
       return ci < other.ci;
     }
+    if (fx != other.fx) {
+      return fx < other.fx;
+    }
+    if (fy != other.fy) {
+      return fy < other.fy;
+    }
     if (! trans.equal (other.trans)) {
       return trans.less (other.trans);
     }
@@ -156,10 +190,14 @@ public:
 };
 
 /**
- *  @brief A worker for the redraw thread (a tl::Worker specialization)
+ *  @brief A worker for the redraw thread
+ *
+ *  The worker holds the drawing state of one thread (renderer, planes and caches).
+ *  The redraw thread keeps one worker per thread of the thread pool, so the state 
+ *  is never shared between threads. The worker is kept over multiple redraw runs.
  */
 class RedrawThreadWorker 
-  : public tl::Worker
+  : private lay::DensityPyramidMonitor
 {
 public:
   typedef std::map<CellCacheKey, CellCacheInfo> cell_cache_t;
@@ -171,8 +209,12 @@ public:
   void setup (LayoutView *view, RedrawThreadCanvas *canvas, const std::vector<db::Box> &redraw_region, const db::DCplxTrans &vp_trans);
   void finish ();
 
-protected:
-  void perform_task (tl::Task *task);
+  /**
+   *  @brief Performs one task
+   *
+   *  If the redraw thread is stopped, this method throws a tl::BreakException.
+   */
+  void perform_task (const RedrawThreadTask *task);
 
 private:
   void draw_layer (bool drawing_context, db::cell_index_type ci, const db::CplxTrans &trans, const db::Box &vp, int level);
@@ -186,7 +228,12 @@ private:
   void draw_cell_properties (bool drawing_context, int level, const db::CplxTrans &trans, const db::Box &box, db::properties_id_type prop_id);
   void draw_cell_shapes (const db::CplxTrans &trans, const db::Cell &cell, const db::Box &vp, lay::CanvasPlane *fill, lay::CanvasPlane *frame, lay::CanvasPlane *vertex, lay::CanvasPlane *text);
   void test_snapshot (const UpdateSnapshotCallback *update_snapshot);
+  bool use_density_map (const db::Cell &cell, const db::DBox &dbbox, int level, int to_level) const;
+  void draw_density_map (db::cell_index_type ci, const db::CplxTrans &trans, const db::Box &vp, lay::CanvasPlane *frame, lay::CanvasPlane *vertex);
+  void check_abort ();
+  void checkpoint ();
   void transfer ();
+  void setup_layer_plane (unsigned int n, lay::CanvasPlane *plane, bool merge, bool draw);
   void iterate_variants (const std::vector <db::Box> &redraw_regions, db::cell_index_type ci, db::CplxTrans trans, void (RedrawThreadWorker::*what) (bool, db::cell_index_type ci, const db::CplxTrans &, const db::Box &, int level));
   void iterate_variants_rec (const std::vector <db::Box> &redraw_regions, db::cell_index_type ci, const db::CplxTrans &trans, int level, void (RedrawThreadWorker::*what) (bool, db::cell_index_type ci, const db::CplxTrans &, const db::Box &, int level), bool spread);
   bool cell_var_cached (db::cell_index_type ci, const db::CplxTrans &trans);
@@ -218,6 +265,8 @@ private:
   bool m_drop_small_cells;
   unsigned int m_drop_small_cells_value;
   lay::LayoutView::drop_small_cells_cond_type m_drop_small_cells_cond;
+  unsigned int m_density_pyramid_threshold;
+  lay::DensityPyramid *mp_density_pyramid;
   bool m_draw_array_border_instances;
   double m_abstract_mode_width;
   bool m_child_context_enabled;
@@ -238,6 +287,7 @@ private:
   bool m_inv_prop_sel;
   db::DCplxTrans m_vp_trans;
   std::vector<std::pair<unsigned int, lay::CanvasPlane *> > m_buffers;
+  std::vector<std::pair<unsigned int, lay::CanvasPlane *> > m_merge_buffers;
   unsigned int m_test_count;
   tl::Clock m_clock;
   std::auto_ptr<lay::Renderer> mp_renderer;
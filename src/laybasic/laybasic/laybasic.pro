@@ -79,6 +79,7 @@ RESOURCES = \
 
 SOURCES = \
   gtf.cc \
+  gsiDeclLayBatchRenderer.cc \
   gsiDeclLayDialogs.cc \
   gsiDeclLayLayers.cc \
   gsiDeclLayLayoutView.cc \
@@ -89,7 +90,9 @@ SOURCES = \
   layAbstractMenu.cc \
   layAbstractMenuProvider.cc \
   layAnnotationShapes.cc \
+  layBatchRenderer.cc \
   layBitmap.cc \
+  layBitmapKernels.cc \
   layBitmapRenderer.cc \
   layBitmapsToImage.cc \
   layBookmarkList.cc \
@@ -109,6 +112,7 @@ SOURCES = \
   layConfigurationDialog.cc \
   layConverters.cc \
   layCursor.cc \
+  layDensityPyramid.cc \
   layDialogs.cc \
   layDisplayState.cc \
   layDitherPattern.cc \
@@ -183,7 +187,9 @@ HEADERS = \
   layAbstractMenu.h \
   layAbstractMenuProvider.h \
   layAnnotationShapes.h \
+  layBatchRenderer.h \
   layBitmap.h \
+  layBitmapKernels.h \
   layBitmapRenderer.h \
   layBitmapsToImage.h \
   layBookmarkList.h \
@@ -203,6 +209,7 @@ HEADERS = \
   layConfigurationDialog.h \
   layConverters.h \
   layCursor.h \
+  layDensityPyramid.h \
   layDialogs.h \
   layDisplayState.h \
   layDitherPattern.h \
@@ -100,6 +100,7 @@ static const std::string cfg_drawing_workers ("drawing-workers");
 static const std::string cfg_drop_small_cells ("drop-small-cells");
 static const std::string cfg_drop_small_cells_cond ("drop-small-cells-condition");
 static const std::string cfg_drop_small_cells_value ("drop-small-cells-value");
+static const std::string cfg_density_pyramid_threshold ("density-pyramid-threshold");
 static const std::string cfg_array_border_instances ("draw-array-border-instances");
 static const std::string cfg_default_lyp_file ("default-layer-properties");
 static const std::string cfg_default_add_other_layers ("default-add-other-layers");
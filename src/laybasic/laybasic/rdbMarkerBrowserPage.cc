@@ -1446,6 +1446,7 @@ MarkerBrowserPage::MarkerBrowserPage (QWidget * /*parent*/)
     m_show_all (true),
     mp_view (0), 
     m_cv_index (0),
+    mp_marker (0),
     m_num_items (0), 
     m_view_changed (false),
     m_recursion_sentinel (false),
@@ -2175,38 +2176,32 @@ MarkerBrowserPage::do_update_markers ()
 
             if (polygon_value) {
 
-              mp_markers.push_back (new lay::DMarker (mp_view));
-              mp_markers.back ()->set (trans * polygon_value->value ());
+              marker ()->insert (trans * polygon_value->value ());
               m_markers_bbox += trans * polygon_value->value ().box ();
 
             } else if (edge_pair_value) {
 
-              mp_markers.push_back (new lay::DMarker (mp_view));
-              mp_markers.back ()->set (trans * edge_pair_value->value ());
+              marker ()->insert (trans * edge_pair_value->value ());
               m_markers_bbox += trans * db::DBox (edge_pair_value->value ().bbox ());
 
             } else if (edge_value) {
 
-              mp_markers.push_back (new lay::DMarker (mp_view));
-              mp_markers.back ()->set (trans * edge_value->value ());
+              marker ()->insert (trans * edge_value->value ());
               m_markers_bbox += trans * db::DBox (edge_value->value ().bbox ());
 
             } else if (box_value) {
 
-              mp_markers.push_back (new lay::DMarker (mp_view));
-              mp_markers.back ()->set (trans * box_value->value ());
+              marker ()->insert (trans * box_value->value ());
               m_markers_bbox += trans * box_value->value ();
 
             } else if (text_value) {
 
-              mp_markers.push_back (new lay::DMarker (mp_view));
-              mp_markers.back ()->set (trans * text_value->value ());
+              marker ()->insert (trans * text_value->value ());
               m_markers_bbox += trans * text_value->value ().box ();
 
             } else if (path_value) {
 
-              mp_markers.push_back (new lay::DMarker (mp_view));
-              mp_markers.back ()->set (trans * path_value->value ());
+              marker ()->insert (trans * path_value->value ());
               m_markers_bbox += trans * path_value->value ().box ();
 
             }
@@ -2217,14 +2212,6 @@ MarkerBrowserPage::do_update_markers ()
 
       }
 
-      for (std::vector<lay::DMarker *>::const_iterator m = mp_markers.begin (); m != mp_markers.end (); ++m) {
-        (*m)->set_color (m_marker_color);
-        (*m)->set_line_width (m_marker_line_width);
-        (*m)->set_vertex_size (m_marker_vertex_size);
-        (*m)->set_halo (m_marker_halo);
-        (*m)->set_dither_pattern (m_marker_dither_pattern);
-      }
-
     }
 
     //  Produce a marker label info text ..
@@ -2282,10 +2269,25 @@ MarkerBrowserPage::markers_current_changed (const QModelIndex & /*current*/, con
 void
 MarkerBrowserPage::release_markers ()
 {
-  for (std::vector<lay::DMarker *>::iterator m = mp_markers.begin (); m != mp_markers.end (); ++m) {
-    delete *m;
+  if (mp_marker) {
+    delete mp_marker;
+    mp_marker = 0;
+  }
+}
+
+lay::BulkMarker *
+MarkerBrowserPage::marker ()
+{
+  //  all markers are drawn by a single bulk marker which is created on demand
+  if (! mp_marker) {
+    mp_marker = new lay::BulkMarker (mp_view);
+    mp_marker->set_color (m_marker_color);
+    mp_marker->set_line_width (m_marker_line_width);
+    mp_marker->set_vertex_size (m_marker_vertex_size);
+    mp_marker->set_halo (m_marker_halo);
+    mp_marker->set_dither_pattern (m_marker_dither_pattern);
   }
-  mp_markers.clear ();
+  return mp_marker;
 }
 
 void 
@@ -35,7 +35,7 @@ class QAction;
 namespace lay
 {
   class LayoutView;
-  class DMarker;
+  class BulkMarker;
   class PluginRoot;
 }
 
@@ -183,7 +183,7 @@ private:
   QAction *m_show_all_action;
   lay::LayoutView *mp_view;
   unsigned int m_cv_index;
-  std::vector<lay::DMarker *> mp_markers;
+  lay::BulkMarker *mp_marker;
   db::DBox m_markers_bbox;
   size_t m_num_items;
   bool m_view_changed;
@@ -207,6 +207,7 @@ private:
   lay::PluginRoot *mp_plugin_root;
 
   void release_markers ();
+  lay::BulkMarker *marker ();
   void update_marker_list (int selection_mode);
   bool eventFilter (QObject *watched, QEvent *event);
   bool adv_tree (bool up);
@@ -0,0 +1,172 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "layBatchRenderer.h"
+#include "layLayoutView.h"
+#include "dbLayout.h"
+#include "dbWriter.h"
+#include "dbSaveLayoutOptions.h"
+#include "tlStream.h"
+#include "tlUnitTest.h"
+#include "tlInternational.h"
+
+#include <set>
+
+static size_t count_colors (const QImage &img)
+{
+  std::set<QRgb> colors;
+  for (int y = 0; y < img.height (); ++y) {
+    for (int x = 0; x < img.width (); ++x) {
+      colors.insert (img.pixel (x, y));
+    }
+  }
+  return colors.size ();
+}
+
+TEST(1)
+{
+  std::string input = tl::testsrc ();
+  input += "/testdata/bd/strm2clip_in.gds";
+
+  lay::BatchRenderer renderer;
+  renderer.set_size (100, 80);
+  renderer.set_threads (0);
+  renderer.load_layout (input, db::LoadLayoutOptions (), std::string ());
+
+  QImage img0 = renderer.render (db::DBox ());
+  EXPECT_EQ (img0.width (), 100);
+  EXPECT_EQ (img0.height (), 80);
+  EXPECT_EQ (count_colors (img0) > 1, true);
+
+  //  drawing with threads delivers the same image
+  renderer.set_threads (2);
+  EXPECT_EQ (renderer.threads (), 2);
+
+  QImage img2 = renderer.render (db::DBox ());
+  EXPECT_EQ (img2 == img0, true);
+
+  //  images are written in the background
+  std::string fn1 = tmp_file ("img1.png");
+  std::string fn2 = tmp_file ("img2.png");
+  renderer.render_to_file (db::DBox (), fn1);
+  renderer.render_to_file (db::DBox (0, -2, 9, 5), fn2);
+  renderer.wait ();
+
+  QImage img;
+  EXPECT_EQ (img.load (tl::to_qstring (fn1)), true);
+  EXPECT_EQ (img.width (), 100);
+  EXPECT_EQ (img.height (), 80);
+  EXPECT_EQ (img.convertToFormat (img0.format ()) == img0, true);
+
+  EXPECT_EQ (img.load (tl::to_qstring (fn2)), true);
+  EXPECT_EQ (img.width (), 100);
+
+  //  errors are reported by "wait"
+  renderer.render_to_file (db::DBox (), tmp_file ("does_not_exist/img.png"));
+  bool error = false;
+  try {
+    renderer.wait ();
+  } catch (tl::Exception &) {
+    error = true;
+  }
+  EXPECT_EQ (error, true);
+
+  //  the number of boxes and file names must match
+  std::vector<db::DBox> boxes;
+  boxes.push_back (db::DBox ());
+  error = false;
+  try {
+    renderer.render_to_files (boxes, std::vector<std::string> ());
+  } catch (tl::Exception &) {
+    error = true;
+  }
+  EXPECT_EQ (error, true);
+}
+
+//  writes a layout with a n x n array whose pitch is not a multiple of the pixel size
+static void write_array_layout (const std::string &fn, int n)
+{
+  db::Layout ly;
+  ly.dbu (0.001);
+  unsigned int l1 = ly.insert_layer (db::LayerProperties (1, 0));
+
+  db::Cell &child = ly.cell (ly.add_cell ("CHILD"));
+  child.shapes (l1).insert (db::Box (0, 0, 700, 300));
+  db::Point pts[] = { db::Point (0, 400), db::Point (900, 400), db::Point (0, 1000) };
+  db::Polygon poly;
+  poly.assign_hull (pts, pts + sizeof (pts) / sizeof (pts[0]));
+  child.shapes (l1).insert (poly);
+
+  db::Cell &top = ly.cell (ly.add_cell ("TOP"));
+  top.insert (db::CellInstArray (db::CellInst (child.cell_index ()), db::Trans (), db::Vector (1370, 0), db::Vector (0, 1110), n, n));
+
+  tl::OutputStream stream (fn);
+  db::SaveLayoutOptions options;
+  options.set_format ("GDS2");
+  db::Writer writer (options);
+  writer.write (ly, stream);
+}
+
+//  cached cell bitmaps deliver the same image than drawing the cells
+TEST(2)
+{
+  std::string fn = tmp_file ("t2.gds");
+  write_array_layout (fn, 4);
+
+  lay::BatchRenderer renderer;
+  renderer.set_size (217, 193);
+  renderer.set_oversampling (1);
+  renderer.set_threads (0);
+  renderer.load_layout (fn, db::LoadLayoutOptions (), std::string ());
+
+  renderer.view ()->bitmap_caching (false);
+  QImage img_wo_cache = renderer.render (db::DBox (0.0, 0.0, 6.0, 5.0));
+
+  renderer.view ()->bitmap_caching (true);
+  QImage img_with_cache = renderer.render (db::DBox (0.0, 0.0, 6.0, 5.0));
+
+  EXPECT_EQ (count_colors (img_with_cache) > 1, true);
+  EXPECT_EQ (img_with_cache == img_wo_cache, true);
+}
+
+//  many instances at different fractional offsets are drawn exactly too
+TEST(3)
+{
+  std::string fn = tmp_file ("t3.gds");
+  write_array_layout (fn, 20);
+
+  lay::BatchRenderer renderer;
+  renderer.set_size (217, 193);
+  renderer.set_oversampling (1);
+  renderer.set_threads (0);
+  renderer.load_layout (fn, db::LoadLayoutOptions (), std::string ());
+
+  renderer.view ()->bitmap_caching (false);
+  QImage img_wo_cache = renderer.render (db::DBox (0.0, 0.0, 25.0, 20.0));
+
+  renderer.view ()->bitmap_caching (true);
+  QImage img_with_cache = renderer.render (db::DBox (0.0, 0.0, 25.0, 20.0));
+
+  EXPECT_EQ (count_colors (img_with_cache) > 1, true);
+  EXPECT_EQ (img_with_cache == img_wo_cache, true);
+}
@@ -0,0 +1,205 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "layBitmapKernels.h"
+#include "layBitmap.h"
+#include "tlUnitTest.h"
+
+#include <vector>
+
+namespace
+{
+
+//  A simple deterministic random number generator
+struct Random
+{
+  Random () : m_state (12345) { }
+
+  uint32_t operator() ()
+  {
+    m_state = m_state * 1103515245 + 12345;
+    uint32_t r = m_state >> 16;
+    m_state = m_state * 1103515245 + 12345;
+    return (r << 16) ^ (m_state >> 16);
+  }
+
+  //  delivers words with some pixels set only
+  uint32_t sparse ()
+  {
+    return operator() () & operator() () & operator() ();
+  }
+
+private:
+  uint32_t m_state;
+};
+
+//  Restores the kernels on destruction
+struct KernelsRestorer
+{
+  KernelsRestorer () : m_kernels (lay::bitmap_kernels ()) { }
+  ~KernelsRestorer () { lay::set_bitmap_kernels (m_kernels); }
+
+private:
+  lay::BitmapKernels m_kernels;
+};
+
+}
+
+static std::vector<lay::BitmapKernels> available_kernels ()
+{
+  std::vector<lay::BitmapKernels> k;
+  if (lay::bitmap_kernels_available (lay::BitmapKernelsSSE2)) {
+    k.push_back (lay::BitmapKernelsSSE2);
+  }
+  if (lay::bitmap_kernels_available (lay::BitmapKernelsAVX2)) {
+    k.push_back (lay::BitmapKernelsAVX2);
+  }
+  return k;
+}
+
+//  fill_words and Bitmap::fill
+TEST(1)
+{
+  KernelsRestorer restorer;
+
+  EXPECT_EQ (lay::bitmap_kernels_available (lay::BitmapKernelsGeneric), true);
+
+  std::vector<lay::BitmapKernels> kernels = available_kernels ();
+
+  for (std::vector<lay::BitmapKernels>::const_iterator k = kernels.begin (); k != kernels.end (); ++k) {
+
+    for (unsigned int x1 = 0; x1 < 100; x1 += 7) {
+      for (unsigned int x2 = x1; x2 <= 1000; x2 += 13) {
+
+        lay::set_bitmap_kernels (lay::BitmapKernelsGeneric);
+        lay::Bitmap ref (1000, 2, 1.0);
+        ref.fill (1, x1, x2);
+
+        lay::set_bitmap_kernels (*k);
+        EXPECT_EQ (lay::bitmap_kernels (), *k);
+        lay::Bitmap b (1000, 2, 1.0);
+        b.fill (1, x1, x2);
+
+        for (unsigned int i = 0; i < (1000 + 31) / 32; ++i) {
+          EXPECT_EQ (b.scanline (1) [i], ref.scanline (1) [i]);
+        }
+
+      }
+    }
+
+  }
+}
+
+//  mask_scanline
+TEST(2)
+{
+  KernelsRestorer restorer;
+  Random rnd;
+
+  std::vector<lay::BitmapKernels> kernels = available_kernels ();
+
+  const unsigned int n = 77;
+  uint32_t sl [n];
+  uint32_t pattern [8];
+  for (unsigned int i = 0; i < n; ++i) {
+    sl [i] = rnd ();
+  }
+  for (unsigned int i = 0; i < 8; ++i) {
+    pattern [i] = rnd ();
+  }
+
+  unsigned int strides [] = { 1, 2, 3, 4, 5, 8 };
+
+  for (std::vector<lay::BitmapKernels>::const_iterator k = kernels.begin (); k != kernels.end (); ++k) {
+    for (unsigned int s = 0; s < sizeof (strides) / sizeof (strides [0]); ++s) {
+      for (unsigned int nn = 0; nn <= n; nn += 11) {
+
+        uint32_t ref [n], data [n];
+        for (unsigned int i = 0; i < n; ++i) {
+          ref [i] = data [i] = 0xdeadbeef;
+        }
+
+        lay::set_bitmap_kernels (lay::BitmapKernelsGeneric);
+        lay::mask_scanline (ref, sl, pattern, strides [s], nn);
+
+        lay::set_bitmap_kernels (*k);
+        lay::mask_scanline (data, sl, pattern, strides [s], nn);
+
+        for (unsigned int i = 0; i < n; ++i) {
+          EXPECT_EQ (data [i], ref [i]);
+        }
+
+      }
+    }
+  }
+}
+
+//  compose_scanline
+TEST(3)
+{
+  KernelsRestorer restorer;
+  Random rnd;
+
+  std::vector<lay::BitmapKernels> kernels = available_kernels ();
+
+  unsigned int widths [] = { 1, 5, 31, 32, 33, 100, 257 };
+  const unsigned int nplanes = 50;
+
+  for (std::vector<lay::BitmapKernels>::const_iterator k = kernels.begin (); k != kernels.end (); ++k) {
+    for (unsigned int w = 0; w < sizeof (widths) / sizeof (widths [0]); ++w) {
+      for (int transparent = 0; transparent < 2; ++transparent) {
+
+        unsigned int width = widths [w];
+        unsigned int nwords = (width + 31) / 32;
+
+        std::vector<uint32_t> data;
+        std::vector<std::pair<lay::color_t, lay::color_t> > masks;
+        for (unsigned int i = 0; i < nplanes * nwords; ++i) {
+          //  leave some words empty
+          data.push_back ((i % 5) == 3 ? 0 : rnd.sparse ());
+        }
+        for (unsigned int i = 0; i < nplanes; ++i) {
+          masks.push_back (std::make_pair (rnd () & 0x00ffffff, rnd () & 0x00ffffff));
+        }
+
+        std::vector<lay::color_t> ref, pixels;
+        for (unsigned int i = 0; i < width; ++i) {
+          ref.push_back (rnd ());
+        }
+        pixels = ref;
+
+        lay::set_bitmap_kernels (lay::BitmapKernelsGeneric);
+        lay::compose_scanline (&ref.front (), &data.front (), nplanes, nwords, &masks.front (), width, transparent != 0);
+
+        lay::set_bitmap_kernels (*k);
+        lay::compose_scanline (&pixels.front (), &data.front (), nplanes, nwords, &masks.front (), width, transparent != 0);
+
+        for (unsigned int i = 0; i < width; ++i) {
+          EXPECT_EQ (pixels [i], ref [i]);
+        }
+
+      }
+    }
+  }
+}
+
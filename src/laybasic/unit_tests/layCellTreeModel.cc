@@ -0,0 +1,154 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "layCellTreeModel.h"
+#include "dbLayout.h"
+#include "tlUnitTest.h"
+#include "tlString.h"
+
+namespace
+{
+
+//  Creates a layout with TOP -> A, TOP -> B, B -> C
+struct TestLayout
+{
+  TestLayout ()
+  {
+    unsigned int l = layout.insert_layer (db::LayerProperties (1, 0));
+
+    top = layout.add_cell ("TOP");
+    c = layout.add_cell ("C");
+    b = layout.add_cell ("B");
+    a = layout.add_cell ("A");
+
+    layout.cell (a).shapes (l).insert (db::Box (0, 0, 900, 900));
+    layout.cell (c).shapes (l).insert (db::Box (0, 0, 100, 100));
+    layout.cell (b).shapes (l).insert (db::Box (0, 0, 200, 10));
+
+    layout.cell (top).insert (db::CellInstArray (db::CellInst (a), db::Trans ()));
+    layout.cell (top).insert (db::CellInstArray (db::CellInst (b), db::Trans ()));
+    layout.cell (b).insert (db::CellInstArray (db::CellInst (c), db::Trans ()));
+
+    layout.update ();
+  }
+
+  db::Layout layout;
+  db::cell_index_type top, a, b, c;
+};
+
+}
+
+static std::string toplevel_names (lay::CellTreeModel &model)
+{
+  std::string s;
+  for (int i = 0; i < model.toplevel_items (); ++i) {
+    if (! s.empty ()) {
+      s += ",";
+    }
+    s += model.toplevel_item (i)->display_text ();
+  }
+  return s;
+}
+
+//  flat mode and sorting
+TEST(1)
+{
+  TestLayout tl;
+
+  lay::CellTreeModel model (0, &tl.layout, lay::CellTreeModel::Flat, 0, lay::CellTreeModel::ByName);
+  EXPECT_EQ (model.toplevel_items (), 4);
+  EXPECT_EQ (model.find_toplevel_item (tl.b), 1);
+  EXPECT_EQ (model.find_toplevel_item (tl.b, true), -1);
+  EXPECT_EQ (toplevel_names (model), "A,B,C,TOP");
+  EXPECT_EQ (model.toplevel_item (1)->index (), size_t (1));
+  EXPECT_EQ (model.toplevel_item (1)->cell_index (), tl.b);
+
+  lay::CellTreeModel model_by_area (0, &tl.layout, lay::CellTreeModel::Flat, 0, lay::CellTreeModel::ByArea);
+  EXPECT_EQ (toplevel_names (model_by_area), "C,B,A,TOP");
+
+  lay::CellTreeModel model_by_area_reverse (0, &tl.layout, lay::CellTreeModel::Flat, 0, lay::CellTreeModel::ByAreaReverse);
+  EXPECT_EQ (toplevel_names (model_by_area_reverse), "TOP,A,B,C");
+}
+
+//  hierarchical mode and locate
+TEST(2)
+{
+  TestLayout tl;
+
+  lay::CellTreeModel model (0, &tl.layout, 0, 0, lay::CellTreeModel::ByName);
+  EXPECT_EQ (toplevel_names (model), "TOP");
+
+  lay::CellTreeItem *top = model.toplevel_item (0);
+  EXPECT_EQ (top->children (), 2);
+  EXPECT_EQ (top->child (0)->display_text (), "A");
+  EXPECT_EQ (top->child (1)->display_text (), "B");
+  EXPECT_EQ (top->child (1)->child (0)->display_text (), "C");
+
+  //  top level only
+  EXPECT_EQ (model.locate ("C", false, true, true).isValid (), false);
+
+  QModelIndex index = model.locate ("C", false, true, false);
+  EXPECT_EQ (index.isValid (), true);
+  EXPECT_EQ (std::string (model.cell_name (index)), "C");
+  EXPECT_EQ (std::string (model.cell_name (model.parent (index))), "B");
+  EXPECT_EQ (model.locate_next () == index, true);
+
+  //  "?" matches all names as the header match mode is used
+  index = model.locate ("?", true, true, false);
+  EXPECT_EQ (std::string (model.cell_name (index)), "TOP");
+  EXPECT_EQ (std::string (model.cell_name (model.locate_next ())), "A");
+  EXPECT_EQ (std::string (model.cell_name (model.locate_next ())), "B");
+  EXPECT_EQ (std::string (model.cell_name (model.locate_next ())), "C");
+  EXPECT_EQ (std::string (model.cell_name (model.locate_next ())), "TOP");
+
+  EXPECT_EQ (model.locate ("X*", true, true, false).isValid (), false);
+}
+
+
+//  sorting many cells (sort keys computed in parallel)
+TEST(3)
+{
+  db::Layout layout;
+  unsigned int l = layout.insert_layer (db::LayerProperties (1, 0));
+
+  const int n = 12000;
+  for (int i = 0; i < n; ++i) {
+    db::cell_index_type ci = layout.add_cell (tl::sprintf ("C%05d", i).c_str ());
+    layout.cell (ci).shapes (l).insert (db::Box (0, 0, n - i, 1));
+  }
+
+  //  NOTE: the layout is not updated here - the bounding boxes are computed while sorting
+
+  lay::CellTreeModel model (0, &layout, lay::CellTreeModel::Flat, 0, lay::CellTreeModel::ByName);
+  EXPECT_EQ (model.toplevel_items (), n);
+  EXPECT_EQ (model.toplevel_item (0)->display_text (), "C00000");
+  EXPECT_EQ (model.toplevel_item (n - 1)->display_text (), "C11999");
+
+  lay::CellTreeModel model_by_area (0, &layout, lay::CellTreeModel::Flat, 0, lay::CellTreeModel::ByArea);
+  EXPECT_EQ (model_by_area.toplevel_items (), n);
+  bool sorted = true;
+  for (int i = 0; i < n && sorted; ++i) {
+    sorted = (model_by_area.toplevel_item (i)->display_text () == tl::sprintf ("C%05d", n - 1 - i));
+  }
+  EXPECT_EQ (sorted, true);
+}
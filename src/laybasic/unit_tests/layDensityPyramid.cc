@@ -0,0 +1,173 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "layDensityPyramid.h"
+#include "tlUnitTest.h"
+
+static std::string
+to_string (const lay::DensityMap &map, unsigned int level)
+{
+  std::string r;
+
+  for (unsigned int j = map.size (level); j > 0; --j) {
+    for (unsigned int k = 0; k < map.size (level); ++k) {
+      r += map.is_set (level, k, j - 1) ? "#" : "-";
+    }
+    r += "\n";
+  }
+
+  return r;
+}
+
+TEST(1)
+{
+  lay::DensityMap map (db::Box (0, 0, 640, 640), 64);
+
+  EXPECT_EQ (map.empty (), false);
+  EXPECT_EQ (map.size (), (unsigned int) 64);
+
+  map.set (db::Box (5, 5, 15, 15));
+  map.set (db::Box (20, 0, 30, 10));
+  map.set (db::Box (600, 600, 700, 700));
+  map.finish ();
+
+  EXPECT_EQ (map.levels (), (unsigned int) 7);
+  EXPECT_EQ (map.is_set (0, 0, 0), true);
+  EXPECT_EQ (map.is_set (0, 1, 1), true);
+  EXPECT_EQ (map.is_set (0, 2, 2), false);
+  EXPECT_EQ (map.is_set (0, 2, 0), true);
+  EXPECT_EQ (map.is_set (0, 3, 0), false);
+  EXPECT_EQ (map.is_set (0, 63, 63), true);
+  EXPECT_EQ (map.is_set (0, 59, 59), false);
+
+  EXPECT_EQ (map.bin_box (0, 1, 2).to_string (), "(10,20;20,30)");
+  EXPECT_EQ (map.bin_box (1, 0, 0).to_string (), "(0,0;20,20)");
+  EXPECT_EQ (map.bin_box (0, 2, 5, 0).to_string (), "(20,0;60,10)");
+
+  EXPECT_EQ (map.level_for (10.0), (unsigned int) 0);
+  EXPECT_EQ (map.level_for (25.0), (unsigned int) 1);
+  EXPECT_EQ (map.level_for (1000.0), (unsigned int) 6);
+
+  EXPECT_EQ (to_string (map, 4),
+    "---#\n"
+    "----\n"
+    "----\n"
+    "#---\n"
+  );
+
+  lay::DensityMap tri (db::Box (0, 0, 640, 640), 8);
+
+  db::Point pts[] = {
+    db::Point (0, 0),
+    db::Point (640, 0),
+    db::Point (0, 640)
+  };
+  db::Polygon poly;
+  poly.assign_hull (pts, pts + sizeof (pts) / sizeof (pts[0]));
+  tri.set (poly);
+  tri.finish ();
+
+  //  bins touching the polygon are set too
+  EXPECT_EQ (to_string (tri, 0),
+    "##------\n"
+    "###-----\n"
+    "####----\n"
+    "#####---\n"
+    "######--\n"
+    "#######-\n"
+    "########\n"
+    "########\n"
+  );
+}
+
+TEST(2)
+{
+  db::Layout ly;
+  unsigned int l1 = ly.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = ly.insert_layer (db::LayerProperties (2, 0));
+
+  db::Cell &child = ly.cell (ly.add_cell ("CHILD"));
+  child.shapes (l1).insert (db::Box (0, 0, 100, 100));
+  child.shapes (l2).insert (db::Box (0, 0, 10, 10));
+
+  db::Cell &top = ly.cell (ly.add_cell ("TOP"));
+  top.insert (db::CellInstArray (db::CellInst (child.cell_index ()), db::Trans (db::Vector (0, 0))));
+  top.insert (db::CellInstArray (db::CellInst (child.cell_index ()), db::Trans (db::Vector (1000, 1000))));
+  top.insert (db::CellInstArray (db::CellInst (child.cell_index ()), db::Trans (db::Vector (1000, 0))));
+
+  ly.update ();
+
+  lay::DensityPyramid dp (&ly);
+
+  const lay::DensityMap &map = dp.map (top.cell_index (), l1);
+  EXPECT_EQ (map.box ().to_string (), "(0,0;1100,1100)");
+  EXPECT_EQ (map.is_set (0, 0, 0), true);
+  EXPECT_EQ (map.is_set (0, 5, 5), true);
+  EXPECT_EQ (map.is_set (0, 6, 6), false);
+  EXPECT_EQ (map.is_set (0, 30, 30), false);
+  EXPECT_EQ (map.is_set (0, 63, 63), true);
+
+  EXPECT_EQ (to_string (map, 3),
+    "-------#\n"
+    "--------\n"
+    "--------\n"
+    "--------\n"
+    "--------\n"
+    "--------\n"
+    "--------\n"
+    "#------#\n"
+  );
+
+  //  the child's map has been computed too
+  EXPECT_EQ (dp.size (), size_t (2));
+
+  dp.map (top.cell_index (), l2);
+  EXPECT_EQ (dp.size (), size_t (3));
+
+  //  a change on layer 2 invalidates the maps of layer 2 only
+  child.shapes (l2).insert (db::Box (0, 0, 20, 20));
+  ly.update ();
+
+  EXPECT_EQ (dp.size (), size_t (3));
+  dp.update ();
+  EXPECT_EQ (dp.size (), size_t (2));
+
+  //  a change of the hierarchy invalidates everything
+  top.insert (db::CellInstArray (db::CellInst (child.cell_index ()), db::Trans (db::Vector (0, 1000))));
+  ly.update ();
+
+  dp.update ();
+  EXPECT_EQ (dp.size (), size_t (0));
+
+  EXPECT_EQ (to_string (dp.map (top.cell_index (), l1), 3),
+    "#------#\n"
+    "--------\n"
+    "--------\n"
+    "--------\n"
+    "--------\n"
+    "--------\n"
+    "--------\n"
+    "#------#\n"
+  );
+}
+
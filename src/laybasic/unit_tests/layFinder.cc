@@ -0,0 +1,139 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+
+#include "layFinder.h"
+#include "layLayoutView.h"
+#include "dbLayout.h"
+#include "tlUnitTest.h"
+
+#include <set>
+
+static std::vector<lay::ObjectInstPath> results (const lay::ShapeFinder &finder)
+{
+  return std::vector<lay::ObjectInstPath> (finder.begin (), finder.end ());
+}
+
+static std::vector<lay::ObjectInstPath> find_on_layer (lay::LayoutView *view, const lay::LayerProperties &lprops, const db::DBox &region)
+{
+  lay::ShapeFinder finder (false, false, db::ShapeIterator::All);
+  finder.find (view, lprops, region);
+  return results (finder);
+}
+
+//  box mode selection over multiple search contexts and layers
+TEST(1)
+{
+  //  first layout: two layers, which share one search context
+  db::Layout *ly1 = new db::Layout ();
+  ly1->dbu (0.001);
+  unsigned int la = ly1->insert_layer (db::LayerProperties (1, 0));
+  unsigned int lb = ly1->insert_layer (db::LayerProperties (2, 0));
+
+  db::Cell &child = ly1->cell (ly1->add_cell ("CHILD"));
+  child.shapes (la).insert (db::Box (0, 0, 700, 300));
+  child.shapes (lb).insert (db::Box (0, 400, 900, 1000));
+
+  db::Cell &top1 = ly1->cell (ly1->add_cell ("TOP"));
+  top1.shapes (la).insert (db::Box (-500, -500, -100, -100));
+  top1.shapes (lb).insert (db::Box (-500, 500, -100, 900));
+  top1.insert (db::CellInstArray (db::CellInst (child.cell_index ()), db::Trans (), db::Vector (1370, 0), db::Vector (0, 1110), 10, 10));
+
+  //  second layout: a separate search context
+  db::Layout *ly2 = new db::Layout ();
+  ly2->dbu (0.001);
+  unsigned int l2 = ly2->insert_layer (db::LayerProperties (1, 0));
+
+  db::Cell &top2 = ly2->cell (ly2->add_cell ("TOP"));
+  for (int i = 0; i < 20; ++i) {
+    top2.shapes (l2).insert (db::Box (i * 1000, 0, i * 1000 + 500, 500));
+  }
+
+  lay::LayoutView view (0, false, 0, 0, "view", lay::LayoutView::LV_Naked + lay::LayoutView::LV_NoZoom + lay::LayoutView::LV_NoServices + lay::LayoutView::LV_NoGrid);
+  view.add_layout (new lay::LayoutHandle (ly1, std::string ()), true);
+  view.add_layout (new lay::LayoutHandle (ly2, std::string ()), true);
+  view.max_hier ();
+
+  const lay::LayerPropertiesNode *lpa = 0, *lpb = 0, *lp2 = 0;
+  for (lay::LayerPropertiesConstIterator lp = view.begin_layers (); ! lp.at_end (); ++lp) {
+    if (lp->cellview_index () == 0 && lp->layer_index () == int (la)) {
+      lpa = lp.operator-> ();
+    } else if (lp->cellview_index () == 0 && lp->layer_index () == int (lb)) {
+      lpb = lp.operator-> ();
+    } else if (lp->cellview_index () == 1 && lp->layer_index () == int (l2)) {
+      lp2 = lp.operator-> ();
+    }
+  }
+  tl_assert (lpa != 0 && lpb != 0 && lp2 != 0);
+
+  db::DBox region (-1.0, -1.0, 10.0, 5.0);
+
+  //  the references: the shapes found on each layer alone
+  std::vector<lay::ObjectInstPath> ra = find_on_layer (&view, *lpa, region);
+  std::vector<lay::ObjectInstPath> rb = find_on_layer (&view, *lpb, region);
+  std::vector<lay::ObjectInstPath> r2 = find_on_layer (&view, *lp2, region);
+  EXPECT_EQ (ra.size (), size_t (1 + 7 * 5));
+  EXPECT_EQ (rb.size (), size_t (1 + 7 * 4));
+  EXPECT_EQ (r2.size (), size_t (10));
+
+  lay::ShapeFinder finder (false, false, db::ShapeIterator::All);
+  EXPECT_EQ (finder.find (&view, region), true);
+  EXPECT_EQ (finder.size (), ra.size () + rb.size () + r2.size ());
+
+  //  the results follow the order of the contexts and within one layer, the order of the traversal
+  std::vector<lay::ObjectInstPath> r = results (finder);
+  EXPECT_EQ (r.size (), finder.size ());
+
+  std::vector<lay::ObjectInstPath> fa, fb, f2;
+  for (std::vector<lay::ObjectInstPath>::const_iterator f = r.begin (); f != r.end (); ++f) {
+    if (f->cv_index () == 1) {
+      f2.push_back (*f);
+    } else {
+      //  all results of the first layout come before the ones of the second layout
+      EXPECT_EQ (f2.empty (), true);
+      (f->layer () == la ? fa : fb).push_back (*f);
+    }
+  }
+  EXPECT_EQ (fa == ra, true);
+  EXPECT_EQ (fb == rb, true);
+  EXPECT_EQ (f2 == r2, true);
+
+  //  excluding the results of one layer does not affect the other layer of the same context
+  std::set<lay::ObjectInstPath> excludes (rb.begin (), rb.end ());
+  excludes.insert (r2.front ());
+
+  lay::ShapeFinder finder2 (false, false, db::ShapeIterator::All, &excludes);
+  finder2.find (&view, region);
+  EXPECT_EQ (finder2.size (), ra.size () + r2.size () - 1);
+
+  std::vector<lay::ObjectInstPath> r_excl = results (finder2);
+  std::vector<lay::ObjectInstPath> expected (ra);
+  expected.insert (expected.end (), r2.begin () + 1, r2.end ());
+  EXPECT_EQ (r_excl == expected, true);
+
+  //  nothing there
+  lay::ShapeFinder finder3 (false, false, db::ShapeIterator::All);
+  EXPECT_EQ (finder3.find (&view, db::DBox (-100.0, -100.0, -90.0, -90.0)), false);
+  EXPECT_EQ (finder3.size (), size_t (0));
+  EXPECT_EQ (finder3.begin () == finder3.end (), true);
+}
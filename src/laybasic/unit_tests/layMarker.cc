@@ -0,0 +1,196 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+
+#include "layMarker.h"
+#include "layBatchRenderer.h"
+#include "layLayoutView.h"
+#include "tlUnitTest.h"
+
+#include <vector>
+
+namespace
+{
+
+//  A set of marker objects
+struct MarkerObjects
+{
+  std::vector<db::DBox> boxes;
+  std::vector<db::DPolygon> polygons;
+  std::vector<db::DEdge> edges;
+  std::vector<db::DEdgePair> edge_pairs;
+  std::vector<db::DPath> paths;
+  std::vector<db::DText> texts;
+
+  MarkerObjects (const db::DBox &fb)
+  {
+    double dx = fb.width () / 20.0, dy = fb.height () / 20.0;
+
+    for (int i = 0; i < 20; ++i) {
+      for (int j = 0; j < 20; ++j) {
+
+        db::DPoint p = fb.p1 () + db::DVector (i * dx, j * dy);
+
+        switch ((i + j) % 6) {
+        case 0:
+          boxes.push_back (db::DBox (p, p + db::DVector (dx * 0.5, dy * 0.7)));
+          break;
+        case 1:
+          {
+            db::DPoint pts[] = { p, p + db::DVector (dx * 0.8, 0.0), p + db::DVector (0.0, dy * 0.6) };
+            db::DPolygon poly;
+            poly.assign_hull (pts, pts + sizeof (pts) / sizeof (pts[0]));
+            polygons.push_back (poly);
+          }
+          break;
+        case 2:
+          edges.push_back (db::DEdge (p, p + db::DVector (dx * 0.7, dy * 0.3)));
+          break;
+        case 3:
+          edge_pairs.push_back (db::DEdgePair (db::DEdge (p, p + db::DVector (dx * 0.5, 0.0)), db::DEdge (p + db::DVector (dx * 0.5, dy * 0.4), p + db::DVector (0.0, dy * 0.4))));
+          break;
+        case 4:
+          {
+            db::DPoint pts[] = { p, p + db::DVector (dx * 0.5, 0.0), p + db::DVector (dx * 0.5, dy * 0.5) };
+            paths.push_back (db::DPath (pts, pts + sizeof (pts) / sizeof (pts[0]), dy * 0.1));
+          }
+          break;
+        default:
+          texts.push_back (db::DText ("T", db::DTrans (p - db::DPoint ())));
+          break;
+        }
+
+      }
+    }
+  }
+
+  void make_markers (lay::LayoutView *view, std::vector<lay::DMarker *> &markers) const
+  {
+    for (std::vector<db::DBox>::const_iterator i = boxes.begin (); i != boxes.end (); ++i) {
+      markers.push_back (new lay::DMarker (view));
+      markers.back ()->set (*i);
+    }
+    for (std::vector<db::DPolygon>::const_iterator i = polygons.begin (); i != polygons.end (); ++i) {
+      markers.push_back (new lay::DMarker (view));
+      markers.back ()->set (*i);
+    }
+    for (std::vector<db::DEdge>::const_iterator i = edges.begin (); i != edges.end (); ++i) {
+      markers.push_back (new lay::DMarker (view));
+      markers.back ()->set (*i);
+    }
+    for (std::vector<db::DEdgePair>::const_iterator i = edge_pairs.begin (); i != edge_pairs.end (); ++i) {
+      markers.push_back (new lay::DMarker (view));
+      markers.back ()->set (*i);
+    }
+    for (std::vector<db::DPath>::const_iterator i = paths.begin (); i != paths.end (); ++i) {
+      markers.push_back (new lay::DMarker (view));
+      markers.back ()->set (*i);
+    }
+    for (std::vector<db::DText>::const_iterator i = texts.begin (); i != texts.end (); ++i) {
+      markers.push_back (new lay::DMarker (view));
+      markers.back ()->set (*i);
+    }
+  }
+
+  void fill_bulk_marker (lay::BulkMarker &marker) const
+  {
+    for (std::vector<db::DBox>::const_iterator i = boxes.begin (); i != boxes.end (); ++i) {
+      marker.insert (*i);
+    }
+    for (std::vector<db::DPolygon>::const_iterator i = polygons.begin (); i != polygons.end (); ++i) {
+      marker.insert (*i);
+    }
+    for (std::vector<db::DEdge>::const_iterator i = edges.begin (); i != edges.end (); ++i) {
+      marker.insert (*i);
+    }
+    for (std::vector<db::DEdgePair>::const_iterator i = edge_pairs.begin (); i != edge_pairs.end (); ++i) {
+      marker.insert (*i);
+    }
+    for (std::vector<db::DPath>::const_iterator i = paths.begin (); i != paths.end (); ++i) {
+      marker.insert (*i);
+    }
+    for (std::vector<db::DText>::const_iterator i = texts.begin (); i != texts.end (); ++i) {
+      marker.insert (*i);
+    }
+  }
+};
+
+}
+
+//  BulkMarker renders the same image than individual markers
+TEST(1)
+{
+  std::string input = tl::testsrc ();
+  input += "/testdata/bd/strm2clip_in.gds";
+
+  lay::BatchRenderer renderer;
+  renderer.set_size (200, 150);
+  renderer.set_oversampling (1);
+  renderer.set_threads (0);
+  renderer.load_layout (input, db::LoadLayoutOptions (), std::string ());
+
+  db::DBox fb = renderer.view ()->full_box ();
+  //  a box showing a part of the markers only
+  db::DBox part (fb.center (), fb.p2 () + db::DVector (fb.width () * 0.2, 0.0));
+
+  MarkerObjects objects (fb);
+
+  QImage img_empty = renderer.render (fb);
+
+  std::vector<lay::DMarker *> markers;
+  objects.make_markers (renderer.view (), markers);
+
+  db::DBox ref_bbox;
+  for (std::vector<lay::DMarker *>::const_iterator m = markers.begin (); m != markers.end (); ++m) {
+    ref_bbox += (*m)->bbox ();
+  }
+
+  QImage img_markers = renderer.render (fb);
+  QImage img_markers_part = renderer.render (part);
+
+  for (std::vector<lay::DMarker *>::const_iterator m = markers.begin (); m != markers.end (); ++m) {
+    delete *m;
+  }
+  markers.clear ();
+
+  lay::BulkMarker bulk_marker (renderer.view ());
+  EXPECT_EQ (bulk_marker.empty (), true);
+  objects.fill_bulk_marker (bulk_marker);
+  EXPECT_EQ (bulk_marker.size (), size_t (400));
+  EXPECT_EQ (bulk_marker.bbox () == ref_bbox, true);
+
+  QImage img_bulk = renderer.render (fb);
+  QImage img_bulk_part = renderer.render (part);
+
+  EXPECT_EQ (img_markers == img_empty, false);
+  EXPECT_EQ (img_bulk == img_markers, true);
+  EXPECT_EQ (img_bulk_part == img_markers_part, true);
+
+  bulk_marker.set_trans (db::DCplxTrans (db::DVector (1.0, 2.0)));
+  EXPECT_EQ (bulk_marker.bbox () == ref_bbox.moved (db::DVector (1.0, 2.0)), true);
+
+  bulk_marker.clear ();
+  EXPECT_EQ (bulk_marker.empty (), true);
+  EXPECT_EQ (renderer.render (fb) == img_empty, true);
+}
+
@@ -8,9 +8,15 @@ include($$PWD/../../lib_ut.pri)
 
 SOURCES = \
   layAnnotationShapes.cc \
+  layBatchRenderer.cc \
   layBitmap.cc \
+  layBitmapKernels.cc \
   layBitmapsToImage.cc \
+  layCellTreeModel.cc \
+  layDensityPyramid.cc \
+  layFinder.cc \
   layLayerProperties.cc \
+  layMarker.cc \
   layParsedLayerSource.cc \
   layRenderer.cc \
   laySnap.cc \
@@ -66,6 +66,11 @@ public:
 
   void put (size_t ix, size_t iy, const db::Box &tile, size_t id, const tl::Variant &obj, double dbu, const db::ICplxTrans &trans, bool clip);
 
+  bool accepts_sub_tiles () const
+  {
+    return true;
+  }
+
 private:
   rdb::Database *mp_rdb;
   size_t m_cell_id, m_category_id;
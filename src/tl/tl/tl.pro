@@ -28,11 +28,13 @@ SOURCES = \
     tlLog.cc \
     tlObject.cc \
     tlProgress.cc \
+    tlProfiler.cc \
     tlScriptError.cc \
     tlStaticObjects.cc \
     tlStream.cc \
     tlString.cc \
     tlThreadedWorkers.cc \
+    tlThreadPool.cc \
     tlTimer.cc \
     tlVariant.cc \
     tlXMLParser.cc \
@@ -68,6 +70,7 @@ HEADERS = \
     tlObject.h \
     tlObjectCollection.h \
     tlProgress.h \
+    tlProfiler.h \
     tlReuseVector.h \
     tlScriptError.h \
     tlStableVector.h \
@@ -75,6 +78,7 @@ HEADERS = \
     tlStream.h \
     tlString.h \
     tlThreadedWorkers.h \
+    tlThreadPool.h \
     tlTimer.h \
     tlTypeTraits.h \
     tlUtils.h \
@@ -214,6 +214,11 @@ public:
     m_receivers.clear ();
   }
 
+  bool empty () const
+  {
+    return m_receivers.empty ();
+  }
+
   template <class T>
   T *find_receiver ()
   {
@@ -0,0 +1,584 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "tlProfiler.h"
+#include "tlString.h"
+#include "tlStream.h"
+#include "tlException.h"
+
+#include <QMutex>
+#include <QThreadStorage>
+
+#include <map>
+#include <set>
+#include <algorithm>
+#include <stdlib.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  include <windows.h>
+#else
+#  include <sys/time.h>
+#  include <sys/resource.h>
+#endif
+
+namespace tl
+{
+
+// -------------------------------------------------------------
+//  Some definitions
+
+//  The maximum number of invocations recorded per thread for the trace
+//  NOTE: the per-thread data is recycled when a thread terminates, so this limit
+//  applies to the threads running at the same time.
+const size_t max_events_per_thread = 1000000;
+
+// -------------------------------------------------------------
+//  System time and memory information
+
+static int64_t wall_us ()
+{
+#if defined(_WIN32)
+  LARGE_INTEGER freq, count;
+  QueryPerformanceFrequency (&freq);
+  QueryPerformanceCounter (&count);
+  return int64_t (double (count.QuadPart) * 1e6 / double (freq.QuadPart));
+#else
+  struct timeval tv;
+  gettimeofday (&tv, 0);
+  return int64_t (tv.tv_sec) * 1000000 + int64_t (tv.tv_usec);
+#endif
+}
+
+static int64_t cpu_us ()
+{
+#if defined(_WIN32)
+  FILETIME creation, exit, kernel, user;
+  if (! GetThreadTimes (GetCurrentThread (), &creation, &exit, &kernel, &user)) {
+    return 0;
+  }
+  uint64_t k = (uint64_t (kernel.dwHighDateTime) << 32) | uint64_t (kernel.dwLowDateTime);
+  uint64_t u = (uint64_t (user.dwHighDateTime) << 32) | uint64_t (user.dwLowDateTime);
+  //  FILETIME units are 100ns
+  return int64_t ((k + u) / 10);
+#else
+  struct rusage ru;
+#  if defined(RUSAGE_THREAD)
+  getrusage (RUSAGE_THREAD, &ru);
+#  else
+  //  NOTE: this gives the CPU time of the process
+  getrusage (RUSAGE_SELF, &ru);
+#  endif
+  return (int64_t (ru.ru_utime.tv_sec) + int64_t (ru.ru_stime.tv_sec)) * 1000000 + int64_t (ru.ru_utime.tv_usec) + int64_t (ru.ru_stime.tv_usec);
+#endif
+}
+
+static size_t peak_memory ()
+{
+#if defined(_WIN32)
+  //  not available without psapi
+  return 0;
+#else
+  struct rusage ru;
+  getrusage (RUSAGE_SELF, &ru);
+#  if defined(__APPLE__)
+  return size_t (ru.ru_maxrss);
+#  else
+  return size_t (ru.ru_maxrss) * 1024;
+#  endif
+#endif
+}
+
+// -------------------------------------------------------------
+//  Per-thread data
+
+namespace
+{
+
+struct ProfileNode
+{
+  ProfileNode (const char *n)
+    : name (n)
+  {
+    //  .. nothing yet ..
+  }
+
+  ~ProfileNode ()
+  {
+    for (std::map<const char *, ProfileNode *>::const_iterator c = children.begin (); c != children.end (); ++c) {
+      delete c->second;
+    }
+  }
+
+  void reset ()
+  {
+    stats = tl::ProfileStatistics ();
+    for (std::map<const char *, ProfileNode *>::const_iterator c = children.begin (); c != children.end (); ++c) {
+      c->second->reset ();
+    }
+  }
+
+  const char *name;
+  std::map<const char *, ProfileNode *> children;
+  tl::ProfileStatistics stats;
+
+private:
+  ProfileNode (const ProfileNode &);
+  ProfileNode &operator= (const ProfileNode &);
+};
+
+struct ProfileFrame
+{
+  ProfileNode *node;
+  int64_t wall_start, cpu_start;
+};
+
+struct ProfileEvent
+{
+  const char *name;
+  int64_t start, duration;
+};
+
+struct ProfileThreadData
+{
+  ProfileThreadData (int _id)
+    : id (_id), root (0)
+  {
+    //  .. nothing yet ..
+  }
+
+  int id;
+  QMutex lock;
+  ProfileNode root;
+  std::vector<ProfileFrame> stack;
+  std::vector<ProfileEvent> events;
+};
+
+static bool s_registry_destroyed = false;
+
+struct ProfilerRegistry
+{
+  ProfilerRegistry ()
+    : epoch (wall_us ())
+  {
+    //  .. nothing yet ..
+  }
+
+  ~ProfilerRegistry ()
+  {
+    s_registry_destroyed = true;
+    for (std::vector<ProfileThreadData *>::const_iterator t = threads.begin (); t != threads.end (); ++t) {
+      delete *t;
+    }
+  }
+
+  QMutex lock;
+  std::vector<ProfileThreadData *> threads;
+  std::vector<ProfileThreadData *> unused;
+  std::set<std::string> names;
+  int64_t epoch;
+};
+
+struct MergedNode
+{
+  MergedNode (const std::string &n)
+    : name (n)
+  {
+    //  .. nothing yet ..
+  }
+
+  ~MergedNode ()
+  {
+    for (std::map<std::string, MergedNode *>::const_iterator c = children.begin (); c != children.end (); ++c) {
+      delete c->second;
+    }
+  }
+
+  void merge (const ProfileNode &node)
+  {
+    for (std::map<const char *, ProfileNode *>::const_iterator c = node.children.begin (); c != node.children.end (); ++c) {
+
+      std::string n (c->first);
+      std::map<std::string, MergedNode *>::iterator m = children.find (n);
+      if (m == children.end ()) {
+        m = children.insert (std::make_pair (n, new MergedNode (n))).first;
+      }
+
+      const tl::ProfileStatistics &s = c->second->stats;
+      tl::ProfileStatistics &ms = m->second->stats;
+      ms.calls += s.calls;
+      ms.wall += s.wall;
+      ms.cpu += s.cpu;
+      ms.bytes += s.bytes;
+      ms.peak_memory = std::max (ms.peak_memory, s.peak_memory);
+
+      m->second->merge (*c->second);
+
+    }
+  }
+
+  std::string name;
+  std::map<std::string, MergedNode *> children;
+  tl::ProfileStatistics stats;
+};
+
+struct WallGreater
+{
+  bool operator() (const MergedNode *a, const MergedNode *b) const
+  {
+    return a->stats.wall > b->stats.wall;
+  }
+};
+
+}
+
+static ProfilerRegistry s_registry;
+
+namespace
+{
+
+/**
+ *  @brief The thread's reference to its data
+ *
+ *  The thread storage does not own the data - the registry does. When the thread
+ *  terminates, the handle is deleted and the data is handed back to the registry
+ *  which gives it to the next new thread. Hence the number of per-thread buffers
+ *  is limited by the number of threads running at the same time, not by the number
+ *  of threads created.
+ */
+struct ProfileThreadHandle
+{
+  ProfileThreadHandle (ProfileThreadData *d)
+    : data (d)
+  {
+    //  .. nothing yet ..
+  }
+
+  ~ProfileThreadHandle ()
+  {
+    if (s_registry_destroyed) {
+      return;
+    }
+
+    {
+      QMutexLocker locker (&data->lock);
+      data->stack.clear ();
+    }
+
+    QMutexLocker locker (&s_registry.lock);
+    s_registry.unused.push_back (data);
+  }
+
+  ProfileThreadData *data;
+};
+
+}
+
+static QThreadStorage<ProfileThreadHandle *> s_thread_data;
+
+static ProfileThreadData *thread_data ()
+{
+  if (! s_thread_data.hasLocalData ()) {
+
+    QMutexLocker locker (&s_registry.lock);
+
+    ProfileThreadData *td;
+    if (! s_registry.unused.empty ()) {
+      //  recycle the data of a terminated thread
+      td = s_registry.unused.back ();
+      s_registry.unused.pop_back ();
+    } else {
+      td = new ProfileThreadData (int (s_registry.threads.size ()));
+      s_registry.threads.push_back (td);
+    }
+
+    s_thread_data.setLocalData (new ProfileThreadHandle (td));
+
+  }
+  return s_thread_data.localData ()->data;
+}
+
+static void collect_entries (const MergedNode &node, const std::string &path, int depth, std::vector<ProfileReportEntry> &entries)
+{
+  std::vector<const MergedNode *> children;
+  for (std::map<std::string, MergedNode *>::const_iterator c = node.children.begin (); c != node.children.end (); ++c) {
+    children.push_back (c->second);
+  }
+  std::stable_sort (children.begin (), children.end (), WallGreater ());
+
+  for (std::vector<const MergedNode *>::const_iterator c = children.begin (); c != children.end (); ++c) {
+
+    std::string child_path = path.empty () ? (*c)->name : path + "/" + (*c)->name;
+
+    entries.push_back (ProfileReportEntry ());
+    ProfileReportEntry &e = entries.back ();
+    e.name = (*c)->name;
+    e.path = child_path;
+    e.depth = depth;
+    e.stats = (*c)->stats;
+
+    collect_entries (**c, child_path, depth + 1, entries);
+
+  }
+}
+
+static std::string json_string (const std::string &s)
+{
+  std::string r = "\"";
+  for (const char *cp = s.c_str (); *cp; ++cp) {
+    if (*cp == '"' || *cp == '\\') {
+      r += '\\';
+      r += *cp;
+    } else if ((unsigned char) *cp < 0x20) {
+      r += tl::sprintf ("\\u%04x", int (*cp));
+    } else {
+      r += *cp;
+    }
+  }
+  r += "\"";
+  return r;
+}
+
+// -------------------------------------------------------------
+//  Profiler implementation
+
+bool Profiler::ms_enabled = false;
+
+void
+Profiler::set_enabled (bool f)
+{
+  ms_enabled = f;
+}
+
+void
+Profiler::reset ()
+{
+  QMutexLocker locker (&s_registry.lock);
+
+  for (std::vector<ProfileThreadData *>::const_iterator t = s_registry.threads.begin (); t != s_registry.threads.end (); ++t) {
+    QMutexLocker thread_locker (&(*t)->lock);
+    (*t)->root.reset ();
+    (*t)->events.clear ();
+  }
+
+  s_registry.epoch = wall_us ();
+}
+
+void
+Profiler::enter (const char *name)
+{
+  ProfileThreadData *td = thread_data ();
+
+  QMutexLocker locker (&td->lock);
+
+  ProfileNode *parent = td->stack.empty () ? &td->root : td->stack.back ().node;
+
+  std::map<const char *, ProfileNode *>::iterator c = parent->children.find (name);
+  if (c == parent->children.end ()) {
+    c = parent->children.insert (std::make_pair (name, new ProfileNode (name))).first;
+  }
+
+  ProfileFrame frame;
+  frame.node = c->second;
+  frame.wall_start = wall_us ();
+  frame.cpu_start = cpu_us ();
+  td->stack.push_back (frame);
+}
+
+void
+Profiler::enter (const std::string &name)
+{
+  const char *n;
+  {
+    QMutexLocker locker (&s_registry.lock);
+    n = s_registry.names.insert (name).first->c_str ();
+  }
+
+  enter (n);
+}
+
+void
+Profiler::leave ()
+{
+  ProfileThreadData *td = thread_data ();
+
+  QMutexLocker locker (&td->lock);
+
+  if (td->stack.empty ()) {
+    return;
+  }
+
+  int64_t wall = wall_us ();
+  int64_t cpu = cpu_us ();
+
+  ProfileFrame frame = td->stack.back ();
+  td->stack.pop_back ();
+
+  tl::ProfileStatistics &stats = frame.node->stats;
+  stats.calls += 1;
+  stats.wall += double (wall - frame.wall_start) * 1e-6;
+  stats.cpu += double (cpu - frame.cpu_start) * 1e-6;
+  stats.peak_memory = std::max (stats.peak_memory, peak_memory ());
+
+  if (td->events.size () < max_events_per_thread) {
+    ProfileEvent ev;
+    ev.name = frame.node->name;
+    ev.start = frame.wall_start;
+    ev.duration = wall - frame.wall_start;
+    td->events.push_back (ev);
+  }
+}
+
+void
+Profiler::add_bytes (size_t n)
+{
+  ProfileThreadData *td = thread_data ();
+
+  QMutexLocker locker (&td->lock);
+
+  if (! td->stack.empty ()) {
+    td->stack.back ().node->stats.bytes += n;
+  }
+}
+
+std::vector<ProfileReportEntry>
+Profiler::entries ()
+{
+  MergedNode root ((std::string ()));
+
+  {
+    QMutexLocker locker (&s_registry.lock);
+    for (std::vector<ProfileThreadData *>::const_iterator t = s_registry.threads.begin (); t != s_registry.threads.end (); ++t) {
+      QMutexLocker thread_locker (&(*t)->lock);
+      root.merge ((*t)->root);
+    }
+  }
+
+  std::vector<ProfileReportEntry> entries;
+  collect_entries (root, std::string (), 0, entries);
+  return entries;
+}
+
+std::string
+Profiler::report ()
+{
+  std::vector<ProfileReportEntry> e = entries ();
+
+  std::string r = tl::sprintf ("%-48s %10s %12s %12s %14s %10s\n", "Zone", "Calls", "Wall [s]", "CPU [s]", "Bytes", "Peak [M]");
+
+  for (std::vector<ProfileReportEntry>::const_iterator i = e.begin (); i != e.end (); ++i) {
+    std::string name = std::string (size_t (i->depth * 2), ' ') + i->name;
+    r += tl::sprintf ("%-48s %10lu %12.3f %12.3f %14lu %10.1f\n",
+                      name, i->stats.calls, i->stats.wall, i->stats.cpu, i->stats.bytes,
+                      double (i->stats.peak_memory) / (1024.0 * 1024.0));
+  }
+
+  return r;
+}
+
+std::string
+Profiler::to_json ()
+{
+  std::string r = "{\n\"traceEvents\": [";
+
+  bool first = true;
+
+  {
+    QMutexLocker locker (&s_registry.lock);
+
+    for (std::vector<ProfileThreadData *>::const_iterator t = s_registry.threads.begin (); t != s_registry.threads.end (); ++t) {
+
+      QMutexLocker thread_locker (&(*t)->lock);
+
+      for (std::vector<ProfileEvent>::const_iterator ev = (*t)->events.begin (); ev != (*t)->events.end (); ++ev) {
+        if (! first) {
+          r += ",";
+        }
+        first = false;
+        r += "\n  {\"name\": " + json_string (ev->name) + ", \"ph\": \"X\", \"pid\": 1, \"tid\": " + tl::to_string ((*t)->id);
+        r += ", \"ts\": " + tl::to_string (ev->start - s_registry.epoch) + ", \"dur\": " + tl::to_string (ev->duration) + "}";
+      }
+
+    }
+  }
+
+  r += "\n],\n\"displayTimeUnit\": \"ms\",\n\"zones\": [";
+
+  std::vector<ProfileReportEntry> e = entries ();
+  for (std::vector<ProfileReportEntry>::const_iterator i = e.begin (); i != e.end (); ++i) {
+    if (i != e.begin ()) {
+      r += ",";
+    }
+    r += "\n  {\"path\": " + json_string (i->path) + ", \"calls\": " + tl::to_string (i->stats.calls);
+    r += ", \"wall\": " + tl::to_string (i->stats.wall) + ", \"cpu\": " + tl::to_string (i->stats.cpu);
+    r += ", \"bytes\": " + tl::to_string (i->stats.bytes) + ", \"peak_memory\": " + tl::to_string (i->stats.peak_memory) + "}";
+  }
+
+  r += "\n]\n}\n";
+  return r;
+}
+
+void
+Profiler::write_json (const std::string &path)
+{
+  tl::OutputStream os (path, tl::OutputStream::OM_Plain);
+  os << to_json ();
+}
+
+// -------------------------------------------------------------
+//  Startup and exit hook for KLAYOUT_PROFILE
+
+namespace
+{
+
+struct ProfilerEnvironment
+{
+  ProfilerEnvironment ()
+  {
+    const char *p = getenv ("KLAYOUT_PROFILE");
+    if (p && *p) {
+      m_path = p;
+      Profiler::set_enabled (true);
+    }
+  }
+
+  ~ProfilerEnvironment ()
+  {
+    if (! m_path.empty ()) {
+      try {
+        Profiler::write_json (m_path);
+      } catch (...) {
+        //  the log channels may not be available any longer at exit - ignore errors
+      }
+    }
+  }
+
+  std::string m_path;
+};
+
+}
+
+static ProfilerEnvironment s_environment;
+
+}
+
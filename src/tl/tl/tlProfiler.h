@@ -0,0 +1,241 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#ifndef HDR_tlProfiler
+#define HDR_tlProfiler
+
+#include "tlCommon.h"
+
+#include <string>
+#include <vector>
+
+namespace tl
+{
+
+/**
+ *  @brief The statistics collected for one profiler zone
+ */
+struct TL_PUBLIC ProfileStatistics
+{
+  ProfileStatistics ()
+    : calls (0), wall (0.0), cpu (0.0), bytes (0), peak_memory (0)
+  {
+    //  .. nothing yet ..
+  }
+
+  /**
+   *  @brief The number of times the zone was entered
+   */
+  size_t calls;
+
+  /**
+   *  @brief The accumulated wall clock time in seconds
+   */
+  double wall;
+
+  /**
+   *  @brief The accumulated CPU time of the executing threads in seconds
+   */
+  double cpu;
+
+  /**
+   *  @brief The number of bytes reported through Profiler::add_bytes
+   */
+  size_t bytes;
+
+  /**
+   *  @brief The peak memory size of the process in bytes when the zone was left
+   */
+  size_t peak_memory;
+};
+
+/**
+ *  @brief An entry in the profiler report
+ *
+ *  The path is the list of zone names from the top level zone to this zone,
+ *  separated by "/". The statistics are summed up over all threads.
+ */
+struct TL_PUBLIC ProfileReportEntry
+{
+  std::string name;
+  std::string path;
+  int depth;
+  ProfileStatistics stats;
+};
+
+/**
+ *  @brief The profiler
+ *
+ *  The profiler collects timing and other statistics for nested zones. Zones are
+ *  entered and left with ProfileZone objects:
+ *
+ *  @code
+ *  {
+ *    tl::ProfileZone zone ("EdgeProcessor::process");
+ *    ...
+ *  }
+ *  @endcode
+ *
+ *  Every thread collects its statistics separately in a tree of zones. The report
+ *  merges the trees. If the profiler is not enabled, a zone costs a single test.
+ *  When a thread terminates, its data is kept and continued by the next new thread.
+ *
+ *  In addition, the profiler records the individual zone invocations so they can
+ *  be written in the Chrome trace format (see "to_json"). The number of recorded
+ *  invocations is limited per thread.
+ *
+ *  If the environment variable KLAYOUT_PROFILE is set to a file path, the profiler
+ *  is enabled at startup and the JSON profile is written to this file at exit.
+ */
+class TL_PUBLIC Profiler
+{
+public:
+  /**
+   *  @brief Gets a value indicating whether the profiler is enabled
+   */
+  static bool is_enabled ()
+  {
+    return ms_enabled;
+  }
+
+  /**
+   *  @brief Enables or disables the profiler
+   *
+   *  Zones which are active while the profiler is enabled or disabled are not
+   *  recorded.
+   */
+  static void set_enabled (bool f);
+
+  /**
+   *  @brief Clears the statistics
+   *
+   *  This method must not be called while zones are active in other threads.
+   */
+  static void reset ();
+
+  /**
+   *  @brief Enters a zone
+   *
+   *  The name needs to stay valid for the lifetime of the application, i.e. a
+   *  string literal. Use the std::string version for dynamic names.
+   */
+  static void enter (const char *name);
+
+  /**
+   *  @brief Enters a zone with a dynamic name
+   */
+  static void enter (const std::string &name);
+
+  /**
+   *  @brief Leaves the current zone
+   */
+  static void leave ();
+
+  /**
+   *  @brief Adds the given number of bytes to the current zone
+   */
+  static void add_bytes (size_t n);
+
+  /**
+   *  @brief Gets the merged statistics
+   *
+   *  The entries are delivered depth first. Zones with the same parent are sorted
+   *  by descending wall time.
+   */
+  static std::vector<ProfileReportEntry> entries ();
+
+  /**
+   *  @brief Gets the statistics as a text table
+   */
+  static std::string report ();
+
+  /**
+   *  @brief Gets the profile in the Chrome trace event format
+   *
+   *  The "traceEvents" list contains the recorded invocations. The "zones" list
+   *  contains the merged statistics.
+   */
+  static std::string to_json ();
+
+  /**
+   *  @brief Writes the JSON profile to the given file
+   */
+  static void write_json (const std::string &path);
+
+private:
+  static bool ms_enabled;
+};
+
+/**
+ *  @brief A scoped profiler zone
+ *
+ *  The zone is entered on construction and left on destruction if the profiler
+ *  is enabled.
+ */
+class TL_PUBLIC ProfileZone
+{
+public:
+  /**
+   *  @brief Enters the zone with the given name
+   *
+   *  The name needs to be a string literal.
+   */
+  ProfileZone (const char *name)
+    : m_active (Profiler::is_enabled ())
+  {
+    if (m_active) {
+      Profiler::enter (name);
+    }
+  }
+
+  /**
+   *  @brief Leaves the zone
+   */
+  ~ProfileZone ()
+  {
+    if (m_active) {
+      Profiler::leave ();
+    }
+  }
+
+  /**
+   *  @brief Adds the given number of bytes to the zone
+   */
+  void add_bytes (size_t n)
+  {
+    if (m_active) {
+      Profiler::add_bytes (n);
+    }
+  }
+
+private:
+  bool m_active;
+
+  ProfileZone (const ProfileZone &);
+  ProfileZone &operator= (const ProfileZone &);
+};
+
+}
+
+#endif
+
@@ -31,9 +31,41 @@
 #include <QThreadStorage>
 #include <QThread>
 
+#if defined(_MSC_VER)
+#  include <windows.h>
+#endif
+
 namespace tl
 {
 
+// ---------------------------------------------------------------------------------------------
+//  ProgressCounter implementation
+
+void
+ProgressCounter::add (size_t n)
+{
+#if defined(_MSC_VER)
+#  if defined(_WIN64)
+  InterlockedExchangeAdd64 ((volatile LONG64 *) &m_value, LONG64 (n));
+#  else
+  InterlockedExchangeAdd ((volatile LONG *) &m_value, LONG (n));
+#  endif
+#else
+  __sync_fetch_and_add (&m_value, n);
+#endif
+}
+
+size_t
+ProgressCounter::get () const
+{
+#if defined(_MSC_VER)
+  //  volatile reads have acquire semantics on MSVC
+  return m_value;
+#else
+  return __sync_fetch_and_add (const_cast<volatile size_t *> (&m_value), size_t (0));
+#endif
+}
+
 // ---------------------------------------------------------------------------------------------
 //  ProgressAdaptor implementation
 
@@ -119,37 +151,33 @@ Progress::set_desc (const std::string &d)
 }
 
 void
-Progress::test (bool force_yield)
+Progress::do_test ()
 {
-  if (++m_interval_count >= m_yield_interval || force_yield) {
-
-    ProgressAdaptor *a = adaptor ();
+  ProgressAdaptor *a = adaptor ();
 
-    bool needs_trigger = false;
-    double v = value ();
-    if (fabs (v - m_last_value) > 1e-6) {
-      m_last_value = v;
-      needs_trigger = true;
-    }
+  bool needs_trigger = false;
+  double v = value ();
+  if (fabs (v - m_last_value) > 1e-6) {
+    m_last_value = v;
+    needs_trigger = true;
+  }
 
-    m_interval_count = 0;
+  m_interval_count = 0;
 
-    if (a) {
-      tl::Clock now = tl::Clock::current ();
-      if ((now - m_last_yield).seconds () > 0.1) {
-        m_last_yield = now;
-        if (needs_trigger) {
-          a->trigger (this);
-        }
-        a->yield (this);
+  if (a) {
+    tl::Clock now = tl::Clock::current ();
+    if ((now - m_last_yield).seconds () > 0.1) {
+      m_last_yield = now;
+      if (needs_trigger) {
+        a->trigger (this);
       }
+      a->yield (this);
     }
+  }
 
-    if (m_cancelled) {
-      m_cancelled = false;
-      throw tl::BreakException ();
-    }
-
+  if (m_cancelled) {
+    m_cancelled = false;
+    throw tl::BreakException ();
   }
 }
 
@@ -180,14 +208,6 @@ RelativeProgress::formatted_value () const
   return tl::sprintf (m_format, value ());
 }
 
-RelativeProgress &
-RelativeProgress::set (size_t count, bool force_yield)
-{
-  m_count = count;
-  test (force_yield);
-  return *this;
-}
-
 // ---------------------------------------------------------------------------------------------
 //  Progress implementation
 
@@ -224,14 +244,6 @@ AbsoluteProgress::formatted_value () const
   return tl::sprintf (m_format, v);
 }
 
-AbsoluteProgress &
-AbsoluteProgress::set (size_t count, bool /*force_yield*/)
-{
-  m_count = count;
-  test ();
-  return *this;
-}
-
 } // namespace tl
 
 
@@ -64,6 +64,54 @@ public:
 
 class Progress;
 
+/**
+ *  @brief A thread-safe progress counter
+ *
+ *  Worker threads cannot report progress through a Progress object as the
+ *  adaptor is specific for the thread. Instead they increment a counter of
+ *  this kind and the thread owning the progress object samples the counter
+ *  at a fixed rate, i.e. with "progress.set (counter.get (), true)".
+ *
+ *  Incrementing and reading the counter does not lock.
+ */
+class TL_PUBLIC ProgressCounter
+{
+public:
+  /**
+   *  @brief Creates a counter with value 0
+   */
+  ProgressCounter ()
+    : m_value (0)
+  {
+    //  .. nothing yet ..
+  }
+
+  /**
+   *  @brief Adds the given value to the counter
+   */
+  void add (size_t n);
+
+  /**
+   *  @brief Increments the counter
+   */
+  ProgressCounter &operator++ ()
+  {
+    add (1);
+    return *this;
+  }
+
+  /**
+   *  @brief Gets the current value
+   */
+  size_t get () const;
+
+private:
+  volatile size_t m_value;
+
+  ProgressCounter (const ProgressCounter &);
+  ProgressCounter &operator= (const ProgressCounter &);
+};
+
 /**
  *  @brief A "progress" reporter class 
  *
@@ -186,8 +234,14 @@ protected:
    *
    *  This method must be called by the derived class.
    *  If "force_yield" is true, the events are always processed.
+   *  Otherwise this method is cheap except for every "yield_interval"th call.
    */
-  void test (bool force_yield = false);
+  void test (bool force_yield = false)
+  {
+    if (++m_interval_count >= m_yield_interval || force_yield) {
+      do_test ();
+    }
+  }
 
 private:
   friend class ProgressAdaptor;
@@ -203,6 +257,8 @@ private:
 
   static tl::ProgressAdaptor *adaptor ();
   static void register_adaptor (tl::ProgressAdaptor *pa);
+
+  void do_test ();
 };
 
 /**
@@ -259,10 +315,27 @@ public:
     return set (m_count + 1);
   }
 
+  /**
+   *  @brief Increments the count by the given value
+   *
+   *  This method is intended for hot loops: it is inline and does not do more
+   *  than incrementing two counters except for every "yield_interval"th call.
+   */
+  void tick (size_t n = 1)
+  {
+    m_count += n;
+    test ();
+  }
+
   /**
    *  @brief Set the count absolutely
    */
-  RelativeProgress &set (size_t count, bool force_yield = false);
+  RelativeProgress &set (size_t count, bool force_yield = false)
+  {
+    m_count = count;
+    test (force_yield);
+    return *this;
+  }
 
 private:
   friend class ProgressAdaptor;
@@ -350,10 +423,26 @@ public:
     return set (m_count + 1);
   }
 
+  /**
+   *  @brief Increments the count by the given value
+   *
+   *  See RelativeProgress::tick for details.
+   */
+  void tick (size_t n = 1)
+  {
+    m_count += n;
+    test ();
+  }
+
   /**
    *  @brief Set the count absolutely
    */
-  AbsoluteProgress &set (size_t count, bool force_yield = false);
+  AbsoluteProgress &set (size_t count, bool /*force_yield*/ = false)
+  {
+    m_count = count;
+    test ();
+    return *this;
+  }
 
 private:
   friend class ProgressAdaptor;
@@ -36,12 +36,23 @@
 #include "tlHttpStream.h"
 #include "tlDeflate.h"
 #include "tlAssert.h"
+#include "tlThreadedWorkers.h"
+#include "tlLog.h"
 
 #include "tlException.h"
 #include "tlString.h"
 
 #include <QFileInfo>
 #include <QUrl>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QThread>
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <algorithm>
 
 namespace tl
 {
@@ -161,6 +172,21 @@ public:
 
   virtual void reset ();
 
+  /**
+   *  @brief Seek to the specified position
+   *
+   *  For compressed files, this will decompress the data up to the position.
+   */
+  virtual void seek (size_t s);
+
+  /**
+   *  @brief Returns a value indicating whether that stream supports seek
+   */
+  virtual bool supports_seek ()
+  {
+    return true;
+  }
+
   virtual std::string source () const
   {
     return m_source;
@@ -513,7 +539,8 @@ InputStream::reset ()
 
   //  optimize for a reset in the first m_bcap bytes
   //  -> this reduces the reset calls on mp_delegate which may not support this
-  if (m_pos < m_bcap) {
+  //  NOTE: this requires the buffer to hold the data from the beginning of the stream
+  if (m_pos < m_bcap && (! mp_bptr || size_t (mp_bptr - mp_buffer) == m_pos)) {
 
     m_blen += m_pos;
     mp_bptr = mp_buffer;
@@ -536,6 +563,43 @@ InputStream::reset ()
   }
 }
 
+void
+InputStream::seek (size_t pos)
+{
+  tl_assert (mp_inflate == 0);
+
+  if (pos >= m_pos && pos - m_pos <= m_blen) {
+
+    //  position is inside the buffer
+    mp_bptr += pos - m_pos;
+    m_blen -= pos - m_pos;
+    m_pos = pos;
+
+  } else if (mp_delegate->supports_seek ()) {
+
+    mp_delegate->seek (pos);
+
+    mp_bptr = mp_buffer;
+    m_blen = 0;
+    m_pos = pos;
+
+  } else {
+
+    if (pos < m_pos) {
+      reset ();
+    }
+
+    //  skip the data until we have reached the position
+    while (m_pos < pos) {
+      size_t n = std::min (pos - m_pos, std::max (size_t (1), m_blen));
+      if (! get (n)) {
+        break;
+      }
+    }
+
+  }
+}
+
 // ---------------------------------------------------------------
 //  TextInputStream implementation
 
@@ -756,6 +820,22 @@ InputZLibFile::reset ()
   }
 }
 
+void
+InputZLibFile::seek (size_t s)
+{
+  if (m_zs != NULL) {
+    if (gzseek (m_zs, z_off_t (s), SEEK_SET) < 0) {
+      int gz_err = 0;
+      const char *em = gzerror (m_zs, &gz_err);
+      if (gz_err == Z_ERRNO) {
+        throw FileReadErrorException (m_source, errno);
+      } else {
+        throw ZLibReadErrorException (m_source, em);
+      }
+    }
+  }
+}
+
 std::string
 InputZLibFile::absolute_path () const
 {
@@ -788,8 +868,9 @@ public:
    *  an error occurs.
    *
    *  @param path The (relative) path of the file to open
+   *  @param level The zlib compression level (-1 for the default level)
    */
-  OutputZLibFile (const std::string &path);
+  OutputZLibFile (const std::string &path, int level = Z_DEFAULT_COMPRESSION);
 
   /**
    *  @brief Close the file
@@ -909,6 +990,67 @@ private:
   std::string m_source;
 };
 
+class ParallelDeflateWorker;
+struct ParallelDeflateBlock;
+
+/**
+ *  @brief A multi-threaded zlib output file delegate
+ *
+ *  This delegate splits the data into blocks which are compressed in parallel
+ *  by a number of worker threads. Each block is compressed as a raw deflate stream
+ *  using the tail of the previous block as the preset dictionary. Except for the last one, 
+ *  the blocks are terminated by a sync flush, so the concatenated blocks form a single 
+ *  deflate stream. The output is a standard gzip file.
+ */
+class OutputParallelZLibFile
+  : public OutputStreamBase
+{
+public:
+  /**
+   *  @brief Open a file with the given path
+   *
+   *  @param path The (relative) path of the file to open
+   *  @param level The zlib compression level
+   *  @param nthreads The number of compression threads
+   */
+  OutputParallelZLibFile (const std::string &path, int level, int nthreads);
+
+  /**
+   *  @brief Close the file
+   *
+   *  The destructor will compress the remaining data and write the gzip trailer.
+   */
+  virtual ~OutputParallelZLibFile ();
+
+  /**
+   *  @brief Write to a file 
+   *
+   *  Implements the basic write method. 
+   *  Will throw a ZLibWriteErrorException if an error occurs.
+   */
+  virtual void write (const char *b, size_t n);
+
+private:
+  friend class ParallelDeflateWorker;
+
+  std::string m_source;
+  OutputFile m_file;
+  int m_level;
+  size_t m_max_pending;
+  std::string m_buffer, m_dict;
+  uLong m_crc;
+  unsigned long m_isize;
+  QMutex m_lock;
+  QWaitCondition m_block_done_condition;
+  std::deque<ParallelDeflateBlock *> m_blocks;
+  tl::Job<ParallelDeflateWorker> m_job;
+
+  void submit (bool last);
+  void write_blocks (size_t max_pending);
+  void finish ();
+  void block_done (ParallelDeflateBlock *block);
+};
+
 // ---------------------------------------------------------------
 //  OutputStream implementation
 
@@ -934,11 +1076,49 @@ OutputStream::output_mode_from_filename (const std::string &abstract_path, Outpu
   return om;
 }
 
+static int s_zlib_compression_level = Z_DEFAULT_COMPRESSION;
+static int s_zlib_threads = -1;
+
+void
+OutputStream::set_zlib_compression_level (int level)
+{
+  s_zlib_compression_level = level;
+}
+
+int
+OutputStream::zlib_compression_level ()
+{
+  return s_zlib_compression_level;
+}
+
+void
+OutputStream::set_zlib_threads (int n)
+{
+  s_zlib_threads = n;
+}
+
+int
+OutputStream::zlib_threads ()
+{
+  return s_zlib_threads;
+}
+
 static
 OutputStreamBase *create_file_stream (const std::string &path, OutputStream::OutputStreamMode om)
 {
   if (om == OutputStream::OM_Zlib) {
-    return new OutputZLibFile (path);
+
+    int nthreads = s_zlib_threads;
+    if (nthreads < 0) {
+      nthreads = QThread::idealThreadCount ();
+    }
+
+    if (nthreads > 1) {
+      return new OutputParallelZLibFile (path, s_zlib_compression_level, nthreads);
+    } else {
+      return new OutputZLibFile (path, s_zlib_compression_level);
+    }
+
   } else {
     return new OutputFile (path);
   }
@@ -1113,18 +1293,24 @@ OutputFile::write (const char *b, size_t n)
 // ---------------------------------------------------------------
 //  OutputZLibFile implementation
 
-OutputZLibFile::OutputZLibFile (const std::string &path)
+OutputZLibFile::OutputZLibFile (const std::string &path, int level)
   : m_zs (NULL)
 {
   m_source = path;
+
+  std::string mode = "wb";
+  if (level >= 0 && level <= 9) {
+    mode += char ('0' + level);
+  }
+
 #if defined(_WIN32)
   FILE *file = _wfopen ((const wchar_t *) tl::to_qstring (path).constData (), L"wb");
   if (file == NULL) {
     throw FileOpenErrorException (m_source, errno);
   }
-  m_zs = gzdopen (_fileno (file), "wb");
+  m_zs = gzdopen (_fileno (file), mode.c_str ());
 #else
-  m_zs = gzopen (tl::string_to_system (path).c_str (), "wb");
+  m_zs = gzopen (tl::string_to_system (path).c_str (), mode.c_str ());
 #endif
   if (m_zs == NULL) {
     throw FileOpenErrorException (m_source, errno);
@@ -1155,6 +1341,284 @@ OutputZLibFile::write (const char *b, size_t n)
   }
 }
 
+// ---------------------------------------------------------------
+//  OutputParallelZLibFile implementation
+
+//  The size of the blocks compressed independently
+const size_t parallel_deflate_block_size = 128 * 1024;
+
+//  The size of the preset dictionary (the deflate window size)
+const size_t parallel_deflate_dict_size = 32 * 1024;
+
+/**
+ *  @brief Represents one block of data compressed by a parallel deflate worker
+ */
+struct ParallelDeflateBlock
+{
+  ParallelDeflateBlock ()
+    : last (false), done (false), crc (0), input_size (0)
+  { }
+
+  void compress (int level);
+
+  std::string input, dict;
+  std::vector<char> output;
+  std::string error;
+  bool last, done;
+  uLong crc;
+  size_t input_size;
+};
+
+void
+ParallelDeflateBlock::compress (int level)
+{
+  input_size = input.size ();
+  crc = crc32 (crc32 (0L, Z_NULL, 0), (const Bytef *) input.c_str (), uInt (input.size ()));
+
+  z_stream zs;
+  memset (&zs, 0, sizeof (zs));
+
+  //  raw deflate (negative window bits) - the gzip frame is written by the file object
+  if (deflateInit2 (&zs, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    error = zs.msg ? zs.msg : "deflateInit2 failed";
+    return;
+  }
+
+  if (! dict.empty ()) {
+    deflateSetDictionary (&zs, (const Bytef *) dict.c_str (), uInt (dict.size ()));
+  }
+
+  //  extra space for the sync flush marker and the final block
+  output.resize (deflateBound (&zs, uLong (input.size ())) + 64);
+
+  zs.next_in = (Bytef *) input.c_str ();
+  zs.avail_in = uInt (input.size ());
+
+  size_t out_pos = 0;
+  int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+
+  while (true) {
+
+    if (out_pos == output.size ()) {
+      output.resize (output.size () * 2);
+    }
+
+    zs.next_out = (Bytef *) &output [out_pos];
+    zs.avail_out = uInt (output.size () - out_pos);
+
+    int ret = deflate (&zs, flush);
+    out_pos = output.size () - zs.avail_out;
+
+    if (ret == Z_STREAM_END || (! last && ret == Z_OK && zs.avail_out > 0)) {
+      break;
+    } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+      error = zs.msg ? zs.msg : "deflate failed";
+      break;
+    }
+
+  }
+
+  deflateEnd (&zs);
+
+  output.resize (out_pos);
+
+  //  release the input data early
+  std::string ().swap (input);
+  std::string ().swap (dict);
+}
+
+/**
+ *  @brief The task for the parallel deflate worker
+ */
+class ParallelDeflateTask
+  : public tl::Task
+{
+public:
+  ParallelDeflateTask (OutputParallelZLibFile *file, ParallelDeflateBlock *block, int level)
+    : mp_file (file), mp_block (block), m_level (level)
+  { }
+
+  OutputParallelZLibFile *file () const { return mp_file; }
+  ParallelDeflateBlock *block () const { return mp_block; }
+  int level () const { return m_level; }
+
+private:
+  OutputParallelZLibFile *mp_file;
+  ParallelDeflateBlock *mp_block;
+  int m_level;
+};
+
+/**
+ *  @brief The parallel deflate worker
+ */
+class ParallelDeflateWorker
+  : public tl::Worker
+{
+public:
+  ParallelDeflateWorker ()
+    : tl::Worker ()
+  { }
+
+  void perform_task (tl::Task *task)
+  {
+    ParallelDeflateTask *deflate_task = dynamic_cast<ParallelDeflateTask *> (task);
+    if (! deflate_task) {
+      return;
+    }
+
+    try {
+      deflate_task->block ()->compress (deflate_task->level ());
+    } catch (std::exception &ex) {
+      deflate_task->block ()->error = ex.what ();
+    } catch (...) {
+      deflate_task->block ()->error = "unspecific error";
+    }
+
+    deflate_task->file ()->block_done (deflate_task->block ());
+  }
+};
+
+OutputParallelZLibFile::OutputParallelZLibFile (const std::string &path, int level, int nthreads)
+  : m_source (path), m_file (path), m_level (level), m_max_pending (size_t (nthreads) * 2), m_isize (0), m_job (nthreads)
+{
+  m_crc = crc32 (0L, Z_NULL, 0);
+
+  //  gzip header: magic, deflate method, no flags, no time stamp, no extra flags, OS = unknown
+  static const unsigned char header[] = { 0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff };
+  m_file.write ((const char *) header, sizeof (header));
+}
+
+OutputParallelZLibFile::~OutputParallelZLibFile ()
+{
+  try {
+    finish ();
+  } catch (tl::Exception &ex) {
+    tl::error << ex.msg ();
+  }
+
+  m_job.terminate ();
+
+  //  clean up blocks which may be left over after an error
+  for (std::deque<ParallelDeflateBlock *>::const_iterator b = m_blocks.begin (); b != m_blocks.end (); ++b) {
+    delete *b;
+  }
+  m_blocks.clear ();
+}
+
+void
+OutputParallelZLibFile::write (const char *b, size_t n)
+{
+  while (n > 0) {
+
+    size_t nw = std::min (n, parallel_deflate_block_size - m_buffer.size ());
+    m_buffer.append (b, nw);
+    b += nw;
+    n -= nw;
+
+    if (m_buffer.size () == parallel_deflate_block_size) {
+      submit (false);
+    }
+
+  }
+}
+
+void
+OutputParallelZLibFile::submit (bool last)
+{
+  ParallelDeflateBlock *block = new ParallelDeflateBlock ();
+  block->last = last;
+  block->dict = m_dict;
+  block->input.swap (m_buffer);
+
+  //  the dictionary for the next block is the tail of the data seen so far
+  if (block->input.size () >= parallel_deflate_dict_size) {
+    m_dict.assign (block->input, block->input.size () - parallel_deflate_dict_size, parallel_deflate_dict_size);
+  } else {
+    m_dict += block->input;
+    if (m_dict.size () > parallel_deflate_dict_size) {
+      m_dict.erase (0, m_dict.size () - parallel_deflate_dict_size);
+    }
+  }
+
+  m_isize += (unsigned long) block->input.size ();
+
+  m_lock.lock ();
+  m_blocks.push_back (block);
+  m_lock.unlock ();
+
+  m_job.schedule (new ParallelDeflateTask (this, block, m_level));
+  if (! m_job.is_running ()) {
+    m_job.start ();
+  }
+
+  //  write the blocks finished already and limit the number of blocks in flight
+  write_blocks (last ? 0 : m_max_pending);
+}
+
+void
+OutputParallelZLibFile::block_done (ParallelDeflateBlock *block)
+{
+  QMutexLocker locker (&m_lock);
+  block->done = true;
+  m_block_done_condition.wakeAll ();
+}
+
+void
+OutputParallelZLibFile::write_blocks (size_t max_pending)
+{
+  while (true) {
+
+    ParallelDeflateBlock *block = 0;
+
+    {
+      QMutexLocker locker (&m_lock);
+
+      if (m_blocks.empty ()) {
+        break;
+      }
+
+      while (! m_blocks.front ()->done && m_blocks.size () > max_pending) {
+        m_block_done_condition.wait (&m_lock);
+      }
+
+      if (! m_blocks.front ()->done) {
+        break;
+      }
+
+      block = m_blocks.front ();
+      m_blocks.pop_front ();
+    }
+
+    std::auto_ptr<ParallelDeflateBlock> block_holder (block);
+
+    if (! block->error.empty ()) {
+      throw ZLibWriteErrorException (m_source, block->error.c_str ());
+    }
+
+    if (! block->output.empty ()) {
+      m_file.write (&block->output.front (), block->output.size ());
+    }
+
+    m_crc = crc32_combine (m_crc, block->crc, z_off_t (block->input_size));
+
+  }
+}
+
+void
+OutputParallelZLibFile::finish ()
+{
+  //  the final block terminates the deflate stream (may be empty)
+  submit (true);
+
+  //  gzip trailer: CRC32 and uncompressed size modulo 2^32 (little endian)
+  unsigned char trailer[8];
+  for (unsigned int i = 0; i < 4; ++i) {
+    trailer [i] = (unsigned char) ((m_crc >> (i * 8)) & 0xff);
+    trailer [i + 4] = (unsigned char) ((m_isize >> (i * 8)) & 0xff);
+  }
+  m_file.write ((const char *) trailer, sizeof (trailer));
+}
+
 #ifndef _WIN32 // not available on Windows
 
 // ---------------------------------------------------------------
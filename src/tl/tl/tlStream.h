@@ -33,6 +33,7 @@
 #include <sstream>
 #include <cstdio>
 #include <cstring>
+#include <algorithm>
 #include <zlib.h>
 
 
@@ -83,6 +84,25 @@ public:
    */
   virtual void reset () = 0;
 
+  /**
+   *  @brief Seek to the specified position 
+   *
+   *  Reading continues at that position after a seek.
+   *  This method is only called if supports_seek returns true.
+   */
+  virtual void seek (size_t /*s*/) 
+  {
+    //  .. the default implementation does nothing ..
+  }
+
+  /**
+   *  @brief Returns a value indicating whether that stream supports seek
+   */
+  virtual bool supports_seek () 
+  {
+    return false;
+  }
+
   /**
    *  @brief Get the source specification (i.e. the file name)
    */
@@ -136,6 +156,16 @@ public:
     m_pos = 0;
   }
 
+  virtual void seek (size_t s)
+  {
+    m_pos = std::min (s, m_length);
+  }
+
+  virtual bool supports_seek ()
+  {
+    return true;
+  }
+
   virtual std::string source () const
   {
     return "data";
@@ -306,6 +336,16 @@ public:
    */
   virtual void reset ();
 
+  /**
+   *  @brief Moves to the given position
+   *
+   *  If the delegate supports seeking, this is done by repositioning the delegate.
+   *  Otherwise the stream is reset if required and the data is skipped until the 
+   *  position is reached.
+   *  Seek is not supported while in inflate mode.
+   */
+  void seek (size_t pos);
+
   /**
    *  @brief Gets the absolute path for a given URL
    */
@@ -629,6 +669,34 @@ public:
    */
   static OutputStreamMode output_mode_from_filename (const std::string &abstract_path, OutputStreamMode om = OM_Auto);
 
+  /**
+   *  @brief Sets the compression level used for zlib-compressed files
+   *
+   *  The level is the zlib compression level (0 to 9). -1 selects the zlib default level.
+   *  This setting applies to all files opened with OM_Zlib mode afterwards.
+   */
+  static void set_zlib_compression_level (int level);
+
+  /**
+   *  @brief Gets the compression level used for zlib-compressed files
+   */
+  static int zlib_compression_level ();
+
+  /**
+   *  @brief Sets the number of threads used for compressing zlib files
+   *
+   *  With more than one thread, the data is split into blocks which are compressed
+   *  in parallel. The result is a standard gzip stream.
+   *  A value of 0 or 1 selects the single-threaded compressor. A negative value
+   *  will use the number of processor cores available (the default).
+   */
+  static void set_zlib_threads (int n);
+
+  /**
+   *  @brief Gets the number of threads used for compressing zlib files
+   */
+  static int zlib_threads ();
+
   /**
    *  @brief Default constructor
    *
@@ -0,0 +1,494 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "tlThreadPool.h"
+#include "tlProgress.h"
+#include "tlException.h"
+#include "tlStaticObjects.h"
+
+#include <QThread>
+
+#include <exception>
+
+namespace tl
+{
+
+// -----------------------------------------------------------------------------
+//  Some definitions
+
+//  The time in milliseconds a waiting thread sleeps before it looks for tasks again
+const unsigned long wait_interval = 10;
+
+// -----------------------------------------------------------------------------
+//  ThreadPoolWorker definition and implementation
+
+class ThreadPoolWorker
+  : public QThread
+{
+public:
+  ThreadPoolWorker (ThreadPool *pool, int index)
+    : mp_pool (pool), m_index (index)
+  {
+    //  .. nothing yet ..
+  }
+
+protected:
+  virtual void run ()
+  {
+    mp_pool->worker_main (m_index);
+  }
+
+private:
+  ThreadPool *mp_pool;
+  int m_index;
+};
+
+// -----------------------------------------------------------------------------
+//  ThreadPool implementation
+
+static ThreadPool *sp_instance = 0;
+static QMutex s_instance_lock;
+
+ThreadPool::ThreadPool (size_t nthreads)
+  : m_nthreads (nthreads), m_next_queue (0), m_pending (0), m_stopping (false), m_started (false)
+{
+  //  one queue per thread - with no threads, a single queue collects the tasks for
+  //  the waiting threads
+  for (size_t i = 0; i < std::max (size_t (1), nthreads); ++i) {
+    m_queues.push_back (new Queue ());
+  }
+  for (size_t i = 0; i < nthreads; ++i) {
+    m_workers.push_back (new ThreadPoolWorker (this, int (i)));
+  }
+}
+
+ThreadPool::~ThreadPool ()
+{
+  {
+    QMutexLocker locker (&m_lock);
+    m_stopping = true;
+    m_task_available.wakeAll ();
+  }
+
+  for (std::vector<ThreadPoolWorker *>::const_iterator w = m_workers.begin (); w != m_workers.end (); ++w) {
+    (*w)->wait ();
+    delete *w;
+  }
+  m_workers.clear ();
+
+  for (std::vector<Queue *>::const_iterator q = m_queues.begin (); q != m_queues.end (); ++q) {
+    for (std::deque<PoolTask *>::const_iterator t = (*q)->tasks.begin (); t != (*q)->tasks.end (); ++t) {
+      delete *t;
+    }
+    delete *q;
+  }
+  m_queues.clear ();
+}
+
+ThreadPool &
+ThreadPool::instance ()
+{
+  QMutexLocker locker (&s_instance_lock);
+
+  if (! sp_instance) {
+    sp_instance = new ThreadPool (size_t (std::max (1, QThread::idealThreadCount ())));
+    tl::StaticObjects::reg (&sp_instance);
+  }
+
+  return *sp_instance;
+}
+
+bool
+ThreadPool::is_worker_thread () const
+{
+  return current_worker () >= 0;
+}
+
+int
+ThreadPool::current_worker () const
+{
+  //  NOTE: the worker list does not change after construction, so no lock is required
+  QThread *current = QThread::currentThread ();
+  for (size_t i = 0; i < m_workers.size (); ++i) {
+    if (static_cast<QThread *> (m_workers [i]) == current) {
+      return int (i);
+    }
+  }
+  return -1;
+}
+
+void
+ThreadPool::start ()
+{
+  //  called with m_lock held
+  if (! m_started) {
+    m_started = true;
+    for (std::vector<ThreadPoolWorker *>::const_iterator w = m_workers.begin (); w != m_workers.end (); ++w) {
+      (*w)->start ();
+    }
+  }
+}
+
+void
+ThreadPool::submit (PoolTask *task)
+{
+  int worker = current_worker ();
+
+  QMutexLocker locker (&m_lock);
+
+  start ();
+
+  //  Tasks created inside a worker stay with this worker, others are distributed
+  size_t qi;
+  if (worker >= 0) {
+    qi = size_t (worker);
+  } else {
+    qi = m_next_queue;
+    m_next_queue = (m_next_queue + 1) % m_queues.size ();
+  }
+
+  {
+    QMutexLocker queue_locker (&m_queues [qi]->lock);
+    m_queues [qi]->tasks.push_back (task);
+  }
+
+  ++m_pending;
+  m_task_available.wakeOne ();
+}
+
+/**
+ *  @brief Takes a task from the queue
+ *
+ *  If a group is given, only tasks of this group are taken. "from_back" selects
+ *  LIFO (own queue) or FIFO (stealing) order.
+ */
+static PoolTask *
+take_task (std::deque<PoolTask *> &tasks, const TaskGroup *group, bool from_back)
+{
+  if (tasks.empty ()) {
+    return 0;
+  }
+
+  if (! group) {
+    PoolTask *task;
+    if (from_back) {
+      task = tasks.back ();
+      tasks.pop_back ();
+    } else {
+      task = tasks.front ();
+      tasks.pop_front ();
+    }
+    return task;
+  }
+
+  if (from_back) {
+    for (std::deque<PoolTask *>::iterator t = tasks.end (); t != tasks.begin (); ) {
+      --t;
+      if ((*t)->group () == group) {
+        PoolTask *task = *t;
+        tasks.erase (t);
+        return task;
+      }
+    }
+  } else {
+    for (std::deque<PoolTask *>::iterator t = tasks.begin (); t != tasks.end (); ++t) {
+      if ((*t)->group () == group) {
+        PoolTask *task = *t;
+        tasks.erase (t);
+        return task;
+      }
+    }
+  }
+
+  return 0;
+}
+
+PoolTask *
+ThreadPool::fetch (int worker, const TaskGroup *group)
+{
+  PoolTask *task = 0;
+
+  //  first look into our own queue (LIFO) ..
+  if (worker >= 0) {
+    Queue *q = m_queues [worker];
+    QMutexLocker queue_locker (&q->lock);
+    task = take_task (q->tasks, group, true);
+  }
+
+  //  .. then steal from the others (FIFO)
+  size_t nq = m_queues.size ();
+  size_t start = worker >= 0 ? size_t (worker) + 1 : 0;
+  for (size_t i = 0; i < nq && ! task; ++i) {
+    Queue *q = m_queues [(start + i) % nq];
+    QMutexLocker queue_locker (&q->lock);
+    task = take_task (q->tasks, group, false);
+  }
+
+  if (task) {
+    QMutexLocker locker (&m_lock);
+    --m_pending;
+  }
+
+  return task;
+}
+
+bool
+ThreadPool::run_one (int worker, const TaskGroup *group)
+{
+  PoolTask *task = fetch (worker, group);
+  if (! task) {
+    return false;
+  }
+
+  task->mp_group->execute (task);
+  return true;
+}
+
+void
+ThreadPool::worker_main (int worker)
+{
+  while (true) {
+
+    if (run_one (worker)) {
+      continue;
+    }
+
+    QMutexLocker locker (&m_lock);
+    if (m_stopping) {
+      break;
+    }
+    if (m_pending == 0) {
+      m_task_available.wait (&m_lock);
+    }
+
+  }
+}
+
+// -----------------------------------------------------------------------------
+//  TaskGroup implementation
+
+TaskGroup::TaskGroup (ThreadPool *pool)
+  : mp_pool (pool ? pool : &ThreadPool::instance ()),
+    m_pending (0), m_finished (0), m_cancelled (0), m_has_error (false), m_break (false)
+{
+  //  .. nothing yet ..
+}
+
+TaskGroup::~TaskGroup ()
+{
+  cancel ();
+  wait_internal (0);
+}
+
+void
+TaskGroup::run (PoolTask *task)
+{
+  task->mp_group = this;
+
+  {
+    QMutexLocker locker (&m_lock);
+    ++m_pending;
+  }
+
+  mp_pool->submit (task);
+}
+
+void
+TaskGroup::cancel ()
+{
+  m_cancelled.fetchAndStoreOrdered (1);
+}
+
+bool
+TaskGroup::is_cancelled () const
+{
+#if QT_VERSION >= 0x050000
+  return m_cancelled.loadAcquire () != 0;
+#else
+  return int (m_cancelled) != 0;
+#endif
+}
+
+size_t
+TaskGroup::finished () const
+{
+  QMutexLocker locker (&m_lock);
+  return m_finished;
+}
+
+bool
+TaskGroup::is_done () const
+{
+  QMutexLocker locker (&m_lock);
+  return m_pending == 0;
+}
+
+void
+TaskGroup::execute (PoolTask *task)
+{
+  bool has_error = false, is_break = false;
+  std::string error;
+
+  if (! is_cancelled ()) {
+    try {
+      task->run ();
+    } catch (tl::BreakException &) {
+      is_break = true;
+    } catch (tl::Exception &ex) {
+      has_error = true;
+      error = ex.msg ();
+    } catch (std::exception &ex) {
+      has_error = true;
+      error = ex.what ();
+    } catch (...) {
+      has_error = true;
+      error = tl::to_string (QObject::tr ("Unspecific error"));
+    }
+  }
+
+  delete task;
+
+  QMutexLocker locker (&m_lock);
+
+  if ((has_error || is_break) && ! m_has_error && ! m_break) {
+    //  the first error stops the remaining tasks
+    m_has_error = has_error;
+    m_break = is_break;
+    m_error = error;
+    m_cancelled.fetchAndStoreOrdered (1);
+  }
+
+  ++m_finished;
+  if (--m_pending == 0) {
+    m_done_condition.wakeAll ();
+  }
+}
+
+void
+TaskGroup::wait ()
+{
+  wait_internal (0);
+
+  QMutexLocker locker (&m_lock);
+  if (m_break) {
+    throw tl::BreakException ();
+  } else if (m_has_error) {
+    throw tl::Exception (m_error);
+  }
+}
+
+void
+TaskGroup::wait (tl::RelativeProgress &progress)
+{
+  try {
+    wait_internal (&progress);
+  } catch (tl::BreakException &) {
+    cancel ();
+    wait_internal (0);
+    throw;
+  }
+
+  wait ();
+}
+
+bool
+TaskGroup::wait_for (unsigned long timeout)
+{
+  //  NOTE: threads outside the pool only help with tasks of this group. Otherwise the
+  //  GUI thread for example would be blocked by unrelated tasks.
+  int worker = mp_pool->current_worker ();
+  if (mp_pool->threads () == 0) {
+    mp_pool->run_one (worker, this);
+  } else if (worker >= 0) {
+    mp_pool->run_one (worker);
+  } else {
+    QMutexLocker locker (&m_lock);
+    if (m_pending > 0) {
+      m_done_condition.wait (&m_lock, timeout);
+    }
+  }
+
+  if (! is_done ()) {
+    return false;
+  }
+
+  wait ();
+  return true;
+}
+
+void
+TaskGroup::wait_internal (tl::RelativeProgress *progress)
+{
+  int worker = mp_pool->current_worker ();
+
+  //  pool threads help with any task, other threads only with the tasks of this group
+  const TaskGroup *group = worker >= 0 ? 0 : this;
+
+  while (true) {
+
+    {
+      QMutexLocker locker (&m_lock);
+      if (m_pending == 0) {
+        break;
+      }
+    }
+
+    //  help executing tasks while we're waiting - this avoids dead locks
+    //  if tasks wait for nested groups
+    if (mp_pool->run_one (worker, group)) {
+      if (progress) {
+        progress->set (finished ());
+      }
+      continue;
+    }
+
+    {
+      QMutexLocker locker (&m_lock);
+      if (m_pending > 0) {
+        m_done_condition.wait (&m_lock, wait_interval);
+      }
+    }
+
+    if (progress) {
+      progress->set (finished (), true);
+    }
+
+  }
+}
+
+// -----------------------------------------------------------------------------
+//  Parallel algorithm support
+
+size_t
+parallel_chunk_size (size_t n, size_t grain, ThreadPool *pool)
+{
+  if (grain > 0) {
+    return grain;
+  }
+
+  size_t nthreads = (pool ? pool : &ThreadPool::instance ())->threads ();
+  size_t nchunks = std::max (size_t (1), nthreads * 4);
+  return std::max (size_t (1), (n + nchunks - 1) / nchunks);
+}
+
+}
@@ -0,0 +1,481 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#ifndef HDR_tlThreadPool
+#define HDR_tlThreadPool
+
+#include "tlCommon.h"
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <string>
+
+namespace tl
+{
+
+class ThreadPool;
+class ThreadPoolWorker;
+class TaskGroup;
+class RelativeProgress;
+
+/**
+ *  @brief A unit of work for the thread pool
+ *
+ *  Tasks are submitted to the pool through a TaskGroup. The group owns the task
+ *  and deletes it after it has been executed.
+ */
+class TL_PUBLIC PoolTask
+{
+public:
+  /**
+   *  @brief Constructor
+   */
+  PoolTask ()
+    : mp_group (0)
+  {
+    //  .. nothing yet ..
+  }
+
+  /**
+   *  @brief Destructor
+   */
+  virtual ~PoolTask ()
+  {
+    //  .. nothing yet ..
+  }
+
+  /**
+   *  @brief Executes the task
+   *
+   *  This method is called from one of the pool's threads or from a thread
+   *  waiting for a task group. Exceptions thrown by this method are reported
+   *  by TaskGroup::wait.
+   */
+  virtual void run () = 0;
+
+  /**
+   *  @brief Gets the group this task belongs to
+   */
+  TaskGroup *group () const
+  {
+    return mp_group;
+  }
+
+private:
+  friend class TaskGroup;
+  friend class ThreadPool;
+
+  TaskGroup *mp_group;
+
+  PoolTask (const PoolTask &);
+  PoolTask &operator= (const PoolTask &);
+};
+
+/**
+ *  @brief A process-wide thread pool with work stealing
+ *
+ *  The pool keeps a set of threads alive for the lifetime of the application.
+ *  Every thread has its own task queue. Tasks submitted from a pool thread go
+ *  to this thread's queue and are executed in LIFO order (depth first). Idle
+ *  threads steal tasks from the other queues in FIFO order. Tasks submitted
+ *  from outside the pool are distributed over the queues.
+ *
+ *  Threads waiting for a task group help executing tasks. Hence tasks can
+ *  submit and wait for nested task groups without blocking the pool. Pool
+ *  threads help with any task, other threads only with the tasks of the
+ *  group they are waiting for.
+ *
+ *  The pool is not used directly. Use TaskGroup, Future, parallel_for or
+ *  parallel_reduce instead.
+ */
+class TL_PUBLIC ThreadPool
+{
+public:
+  /**
+   *  @brief Creates a pool with the given number of threads
+   *
+   *  The threads are started when the first task is submitted. With 0 threads,
+   *  the tasks are executed by the thread waiting for the task group.
+   */
+  ThreadPool (size_t nthreads);
+
+  /**
+   *  @brief Destructor
+   *
+   *  The destructor stops the threads. All task groups must have finished.
+   */
+  ~ThreadPool ();
+
+  /**
+   *  @brief Gets the process-wide pool instance
+   *
+   *  The number of threads is the number of cores available.
+   */
+  static ThreadPool &instance ();
+
+  /**
+   *  @brief Gets the number of threads
+   */
+  size_t threads () const
+  {
+    return m_nthreads;
+  }
+
+  /**
+   *  @brief Gets a value indicating whether the current thread is one of the pool's threads
+   */
+  bool is_worker_thread () const;
+
+private:
+  friend class TaskGroup;
+  friend class ThreadPoolWorker;
+
+  struct Queue
+  {
+    QMutex lock;
+    std::deque<PoolTask *> tasks;
+  };
+
+  size_t m_nthreads;
+  std::vector<ThreadPoolWorker *> m_workers;
+  std::vector<Queue *> m_queues;
+  size_t m_next_queue;
+  size_t m_pending;
+  bool m_stopping;
+  bool m_started;
+  QMutex m_lock;
+  QWaitCondition m_task_available;
+
+  void start ();
+  void submit (PoolTask *task);
+  PoolTask *fetch (int worker, const TaskGroup *group);
+  bool run_one (int worker, const TaskGroup *group = 0);
+  void worker_main (int worker);
+  int current_worker () const;
+
+  ThreadPool (const ThreadPool &);
+  ThreadPool &operator= (const ThreadPool &);
+};
+
+/**
+ *  @brief A group of tasks executed in the thread pool
+ *
+ *  Tasks are added with "run" and are executed asynchronously. "wait" blocks
+ *  until all tasks have finished. While waiting, the thread executes pending
+ *  tasks itself. The first error raised by a task is thrown by "wait".
+ *
+ *  A group can be cancelled: tasks not started yet are dropped then. Long
+ *  running tasks can poll "is_cancelled" to stop early. Cancellation is connected
+ *  to tl::Progress through the "wait" version taking a progress object: if the
+ *  user cancels the operation, the group is cancelled and the BreakException
+ *  is forwarded.
+ *
+ *  The destructor cancels the group and waits for the running tasks.
+ */
+class TL_PUBLIC TaskGroup
+{
+public:
+  /**
+   *  @brief Creates a task group for the given pool
+   *
+   *  If no pool is given, the process-wide pool is used.
+   */
+  TaskGroup (ThreadPool *pool = 0);
+
+  /**
+   *  @brief Destructor
+   */
+  ~TaskGroup ();
+
+  /**
+   *  @brief Submits a task
+   *
+   *  The group takes ownership over the task.
+   */
+  void run (PoolTask *task);
+
+  /**
+   *  @brief Waits until all tasks have finished
+   *
+   *  If one of the tasks failed, the first error is thrown.
+   */
+  void wait ();
+
+  /**
+   *  @brief Waits until all tasks have finished and reports the progress
+   *
+   *  The progress is set to the number of finished tasks. If the progress reports
+   *  a break, the group is cancelled and the BreakException is thrown after the
+   *  running tasks have terminated.
+   */
+  void wait (tl::RelativeProgress &progress);
+
+  /**
+   *  @brief Waits until all tasks have finished or the timeout (in milliseconds) has expired
+   *  Returns true if all tasks have finished. In that case, errors are thrown like
+   *  "wait" does. Unlike "wait", this method does not help executing tasks unless
+   *  it is called from a pool thread or the pool does not have threads. In that
+   *  case, one task is executed per call.
+   *  This method is intended for threads which need to do other things while waiting,
+   *  i.e. the GUI thread updating a progress display.
+   */
+  bool wait_for (unsigned long timeout);
+
+  /**
+   *  @brief Cancels the group
+   */
+  void cancel ();
+
+  /**
+   *  @brief Gets a value indicating whether the group was cancelled
+   */
+  bool is_cancelled () const;
+
+  /**
+   *  @brief Gets the number of tasks finished so far
+   */
+  size_t finished () const;
+
+  /**
+   *  @brief Gets a value indicating whether all tasks have finished
+   */
+  bool is_done () const;
+
+private:
+  friend class ThreadPool;
+
+  ThreadPool *mp_pool;
+  mutable QMutex m_lock;
+  QWaitCondition m_done_condition;
+  size_t m_pending;
+  size_t m_finished;
+  QAtomicInt m_cancelled;
+  bool m_has_error;
+  bool m_break;
+  std::string m_error;
+
+  void execute (PoolTask *task);
+  void wait_internal (tl::RelativeProgress *progress);
+
+  TaskGroup (const TaskGroup &);
+  TaskGroup &operator= (const TaskGroup &);
+};
+
+/**
+ *  @brief A task computing a value for a Future
+ */
+template <class T, class F>
+class FutureTask
+  : public PoolTask
+{
+public:
+  FutureTask (const F &f, T *value)
+    : m_f (f), mp_value (value)
+  {
+    //  .. nothing yet ..
+  }
+
+  virtual void run ()
+  {
+    *mp_value = m_f ();
+  }
+
+private:
+  F m_f;
+  T *mp_value;
+};
+
+/**
+ *  @brief The result of an asynchronous computation
+ *
+ *  The future executes the given functor in the thread pool. "get" delivers
+ *  the return value of the functor and waits for the computation if required.
+ *  Errors raised by the functor are thrown by "get".
+ *
+ *  The functor needs to have an operator() returning a value which is
+ *  convertible to T.
+ */
+template <class T>
+class Future
+{
+public:
+  /**
+   *  @brief Starts the computation
+   */
+  template <class F>
+  explicit Future (const F &f, ThreadPool *pool = 0)
+    : m_group (pool), m_value ()
+  {
+    m_group.run (new FutureTask<T, F> (f, &m_value));
+  }
+
+  /**
+   *  @brief Gets the value, waiting for the computation if required
+   */
+  const T &get ()
+  {
+    m_group.wait ();
+    return m_value;
+  }
+
+  /**
+   *  @brief Gets a value indicating whether the result is available
+   */
+  bool is_ready () const
+  {
+    return m_group.is_done ();
+  }
+
+private:
+  TaskGroup m_group;
+  T m_value;
+
+  Future (const Future &);
+  Future &operator= (const Future &);
+};
+
+/**
+ *  @brief A task executing a chunk of parallel_for
+ */
+template <class F>
+class ParallelForTask
+  : public PoolTask
+{
+public:
+  ParallelForTask (const F &f, size_t from, size_t to)
+    : m_f (f), m_from (from), m_to (to)
+  {
+    //  .. nothing yet ..
+  }
+
+  virtual void run ()
+  {
+    for (size_t i = m_from; i < m_to && ! group ()->is_cancelled (); ++i) {
+      m_f (i);
+    }
+  }
+
+private:
+  F m_f;
+  size_t m_from, m_to;
+};
+
+/**
+ *  @brief Computes the chunk size for the parallel algorithms
+ *
+ *  If grain is 0, the range is split into about four chunks per thread.
+ */
+TL_PUBLIC size_t parallel_chunk_size (size_t n, size_t grain, ThreadPool *pool);
+
+/**
+ *  @brief Calls f(i) for all i in [from, to) in parallel
+ *
+ *  The range is split into chunks of "grain" indexes (0 for automatic). The
+ *  functor is copied for every chunk. The first error is thrown after all
+ *  chunks have finished.
+ */
+template <class F>
+void parallel_for (size_t from, size_t to, const F &f, size_t grain = 0, ThreadPool *pool = 0)
+{
+  if (to <= from) {
+    return;
+  }
+
+  size_t chunk = parallel_chunk_size (to - from, grain, pool);
+
+  TaskGroup group (pool);
+  for (size_t i = from; i < to; i += chunk) {
+    group.run (new ParallelForTask<F> (f, i, std::min (to, i + chunk)));
+  }
+  group.wait ();
+}
+
+/**
+ *  @brief A task executing a chunk of parallel_reduce
+ */
+template <class T, class F, class R>
+class ParallelReduceTask
+  : public PoolTask
+{
+public:
+  ParallelReduceTask (const F &f, const R &r, size_t from, size_t to, T *value)
+    : m_f (f), m_r (r), m_from (from), m_to (to), mp_value (value)
+  {
+    //  .. nothing yet ..
+  }
+
+  virtual void run ()
+  {
+    for (size_t i = m_from; i < m_to && ! group ()->is_cancelled (); ++i) {
+      *mp_value = m_r (*mp_value, m_f (i));
+    }
+  }
+
+private:
+  F m_f;
+  R m_r;
+  size_t m_from, m_to;
+  T *mp_value;
+};
+
+/**
+ *  @brief Computes reduce(... reduce(reduce(init, f(from)), f(from + 1)) ..., f(to - 1)) in parallel
+ *
+ *  "init" must be the neutral element of "reduce" as it is used as the start value for
+ *  every chunk. The chunk results are combined in the order of the chunks, so the
+ *  result does not depend on the scheduling.
+ */
+template <class T, class F, class R>
+T parallel_reduce (size_t from, size_t to, const T &init, const F &f, const R &reduce, size_t grain = 0, ThreadPool *pool = 0)
+{
+  if (to <= from) {
+    return init;
+  }
+
+  size_t chunk = parallel_chunk_size (to - from, grain, pool);
+
+  std::vector<T> values ((to - from + chunk - 1) / chunk, init);
+
+  TaskGroup group (pool);
+  size_t n = 0;
+  for (size_t i = from; i < to; i += chunk, ++n) {
+    group.run (new ParallelReduceTask<T, F, R> (f, reduce, i, std::min (to, i + chunk), &values [n]));
+  }
+  group.wait ();
+
+  T result = init;
+  for (typename std::vector<T>::const_iterator v = values.begin (); v != values.end (); ++v) {
+    result = reduce (result, *v);
+  }
+  return result;
+}
+
+}
+
+#endif
+
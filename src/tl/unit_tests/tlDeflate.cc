@@ -118,3 +118,43 @@ TEST(3)
   delete[] hello;
 }
 
+//  Parallel gzip file compression
+TEST(4)
+{
+  std::string data;
+  size_t r = 1;
+  for (size_t i = 0; i < 1000000; ++i) {
+    r *= 12361;
+    r ^= (r >> 8); 
+    data += "abc" [r % 3];
+    if (i % 1000 == 0) {
+      data += "a longer text to compress";
+    }
+  }
+
+  int level_saved = tl::OutputStream::zlib_compression_level ();
+  int threads_saved = tl::OutputStream::zlib_threads ();
+
+  for (int nthreads = 0; nthreads < 5; nthreads += 4) {
+
+    tl::OutputStream::set_zlib_compression_level (nthreads == 0 ? 9 : 1);
+    tl::OutputStream::set_zlib_threads (nthreads);
+
+    std::string fn = tmp_file ("test.gz");
+
+    {
+      tl::OutputStream os (fn);
+      os.put (data.c_str (), data.size ());
+    }
+
+    tl::InputStream is (fn);
+    std::string out = is.read_all ();
+
+    EXPECT_EQ (out.size (), data.size ());
+    EXPECT_EQ (out == data, true);
+
+  }
+
+  tl::OutputStream::set_zlib_compression_level (level_saved);
+  tl::OutputStream::set_zlib_threads (threads_saved);
+}
@@ -0,0 +1,166 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+
+#include "tlProfiler.h"
+#include "tlThreadPool.h"
+#include "tlUnitTest.h"
+
+#include <set>
+
+namespace
+{
+
+struct ProfiledLoop
+{
+  void operator() (size_t) const
+  {
+    tl::ProfileZone zone ("worker");
+    zone.add_bytes (2);
+  }
+};
+
+static std::vector<tl::ProfileReportEntry> called_entries ()
+{
+  //  entries from previous tests are still present, but without calls
+  std::vector<tl::ProfileReportEntry> entries = tl::Profiler::entries ();
+  std::vector<tl::ProfileReportEntry> called;
+  for (std::vector<tl::ProfileReportEntry>::const_iterator e = entries.begin (); e != entries.end (); ++e) {
+    if (e->stats.calls > 0) {
+      called.push_back (*e);
+    }
+  }
+  return called;
+}
+
+static std::string entries_to_string (const std::vector<tl::ProfileReportEntry> &entries)
+{
+  std::string r;
+  for (std::vector<tl::ProfileReportEntry>::const_iterator e = entries.begin (); e != entries.end (); ++e) {
+    if (! r.empty ()) {
+      r += ";";
+    }
+    r += e->path + ":" + tl::to_string (e->stats.calls) + ":" + tl::to_string (e->depth);
+  }
+  return r;
+}
+
+}
+
+//  nested zones
+TEST(1)
+{
+  tl::Profiler::set_enabled (true);
+  tl::Profiler::reset ();
+
+  for (int i = 0; i < 3; ++i) {
+    tl::ProfileZone outer ("outer");
+    {
+      tl::ProfileZone inner ("inner");
+      inner.add_bytes (10);
+    }
+    tl::Profiler::enter (std::string ("dynamic"));
+    tl::Profiler::leave ();
+  }
+
+  //  unbalanced leave calls are ignored
+  tl::Profiler::leave ();
+
+  tl::Profiler::set_enabled (false);
+
+  {
+    //  not recorded
+    tl::ProfileZone zone ("disabled");
+  }
+
+  std::vector<tl::ProfileReportEntry> entries = called_entries ();
+  EXPECT_EQ (entries.size (), size_t (3));
+  EXPECT_EQ (entries [0].path, "outer");
+  EXPECT_EQ (entries [0].stats.calls, size_t (3));
+  EXPECT_EQ (entries [0].stats.wall >= 0.0, true);
+
+  size_t bytes = 0;
+  for (std::vector<tl::ProfileReportEntry>::const_iterator e = entries.begin (); e != entries.end (); ++e) {
+    if (e->path == "outer/inner") {
+      bytes = e->stats.bytes;
+    }
+  }
+  EXPECT_EQ (bytes, size_t (30));
+
+  std::string json = tl::Profiler::to_json ();
+  EXPECT_EQ (json.find ("\"traceEvents\"") != std::string::npos, true);
+  EXPECT_EQ (json.find ("\"path\": \"outer/dynamic\"") != std::string::npos, true);
+
+  tl::Profiler::reset ();
+  EXPECT_EQ (called_entries ().size (), size_t (0));
+}
+
+//  aggregation over threads
+TEST(2)
+{
+  tl::Profiler::set_enabled (true);
+  tl::Profiler::reset ();
+
+  tl::ThreadPool pool (4);
+  tl::parallel_for (0, 1000, ProfiledLoop (), 10, &pool);
+
+  tl::Profiler::set_enabled (false);
+
+  std::vector<tl::ProfileReportEntry> called = called_entries ();
+  EXPECT_EQ (entries_to_string (called), "worker:1000:0");
+  EXPECT_EQ (called [0].stats.bytes, size_t (2000));
+
+  EXPECT_EQ (tl::Profiler::report ().find ("worker") != std::string::npos, true);
+
+  tl::Profiler::reset ();
+}
+
+//  the data of terminated threads is recycled
+TEST(3)
+{
+  tl::Profiler::set_enabled (true);
+  tl::Profiler::reset ();
+
+  //  each pool creates a new thread which terminates when the pool is destroyed
+  for (int i = 0; i < 20; ++i) {
+    tl::ThreadPool pool (1);
+    tl::parallel_for (0, 100, ProfiledLoop (), 10, &pool);
+  }
+
+  tl::Profiler::set_enabled (false);
+
+  EXPECT_EQ (entries_to_string (called_entries ()), "worker:2000:0");
+
+  //  count the thread ids of the trace
+  std::set<std::string> tids;
+  std::string json = tl::Profiler::to_json ();
+  for (size_t p = json.find ("\"tid\": "); p != std::string::npos; p = json.find ("\"tid\": ", p + 1)) {
+    size_t pe = json.find (",", p);
+    tids.insert (std::string (json, p, pe - p));
+  }
+
+  //  the main thread (which helps executing the tasks) and one thread for all pools
+  EXPECT_EQ (tids.size () <= size_t (2), true);
+
+  tl::Profiler::reset ();
+}
@@ -0,0 +1,57 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+
+#include "tlProgress.h"
+#include "tlThreadPool.h"
+#include "tlUnitTest.h"
+
+namespace
+{
+
+struct CountProgress
+{
+  CountProgress (tl::ProgressCounter *c) : mp_c (c) { }
+  void operator() (size_t i) const { mp_c->add (i % 3); }
+  tl::ProgressCounter *mp_c;
+};
+
+}
+
+//  Progress counters updated from multiple threads
+TEST(1)
+{
+  tl::ProgressCounter counter;
+  tl::parallel_for (0, 30000, CountProgress (&counter), 10);
+  EXPECT_EQ (counter.get (), size_t (30000));
+  ++counter;
+  EXPECT_EQ (counter.get (), size_t (30001));
+
+  tl::RelativeProgress progress ("test", 100000, 1000);
+  for (size_t i = 0; i < 50000; ++i) {
+    progress.tick ();
+  }
+  EXPECT_EQ (progress.value (), 50.0);
+  progress.set (counter.get (), true);
+  EXPECT_EQ (int (progress.value () + 0.5), 30);
+}
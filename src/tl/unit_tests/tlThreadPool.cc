@@ -0,0 +1,262 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2018 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+
+#include "tlThreadPool.h"
+#include "tlException.h"
+#include "tlUnitTest.h"
+
+#include <vector>
+
+namespace
+{
+
+struct Square
+{
+  Square (std::vector<long> *v) : mp_v (v) { }
+  void operator() (size_t i) const { (*mp_v) [i] = long (i) * long (i); }
+  std::vector<long> *mp_v;
+};
+
+struct Identity
+{
+  long operator() (size_t i) const { return long (i); }
+};
+
+struct Plus
+{
+  long operator() (long a, long b) const { return a + b; }
+};
+
+struct Concat
+{
+  std::string operator() (const std::string &a, const std::string &b) const { return a + b; }
+};
+
+struct Digit
+{
+  std::string operator() (size_t i) const { return std::string (1, char ('0' + i % 10)); }
+};
+
+struct SumUpTo
+{
+  SumUpTo (size_t n, tl::ThreadPool *pool = 0) : m_n (n), mp_pool (pool) { }
+  long operator() () const { return tl::parallel_reduce (size_t (0), m_n, 0l, Identity (), Plus (), 10, mp_pool); }
+  size_t m_n;
+  tl::ThreadPool *mp_pool;
+};
+
+struct Failing
+{
+  void operator() (size_t i) const
+  {
+    if (i == 17) {
+      throw tl::Exception ("error at 17");
+    }
+  }
+};
+
+class CountingTask
+  : public tl::PoolTask
+{
+public:
+  CountingTask (QMutex *lock, int *count) : mp_lock (lock), mp_count (count) { }
+
+  virtual void run ()
+  {
+    QMutexLocker locker (mp_lock);
+    ++*mp_count;
+  }
+
+private:
+  QMutex *mp_lock;
+  int *mp_count;
+};
+
+class FailingTask
+  : public tl::PoolTask
+{
+public:
+  virtual void run ()
+  {
+    throw tl::Exception ("task failed");
+  }
+};
+
+}
+
+//  parallel_for
+TEST(1)
+{
+  std::vector<long> v (10000, 0);
+  tl::parallel_for (0, v.size (), Square (&v));
+
+  bool ok = true;
+  for (size_t i = 0; i < v.size (); ++i) {
+    if (v [i] != long (i) * long (i)) {
+      ok = false;
+    }
+  }
+  EXPECT_EQ (ok, true);
+
+  //  with an explicit pool and grain
+  tl::ThreadPool pool (3);
+  std::vector<long> w (1000, 0);
+  tl::parallel_for (0, w.size (), Square (&w), 7, &pool);
+  EXPECT_EQ (w [999], 998001l);
+  EXPECT_EQ (w [500], 250000l);
+
+  //  no threads: the waiting thread executes the tasks
+  tl::ThreadPool pool0 (0);
+  std::vector<long> u (100, 0);
+  tl::parallel_for (0, u.size (), Square (&u), 0, &pool0);
+  EXPECT_EQ (u [99], 9801l);
+}
+
+//  parallel_reduce
+TEST(2)
+{
+  EXPECT_EQ (tl::parallel_reduce (size_t (0), size_t (100001), 0l, Identity (), Plus ()), 5000050000l);
+  EXPECT_EQ (tl::parallel_reduce (size_t (5), size_t (5), 42l, Identity (), Plus ()), 42l);
+
+  //  the order of the chunks is maintained
+  tl::ThreadPool pool (4);
+  EXPECT_EQ (tl::parallel_reduce (size_t (0), size_t (25), std::string (), Digit (), Concat (), 3, &pool), "0123456789012345678901234");
+}
+
+//  Future and nested groups
+TEST(3)
+{
+  tl::Future<long> f (SumUpTo (1001));
+  EXPECT_EQ (f.get (), 500500l);
+  EXPECT_EQ (f.is_ready (), true);
+
+  //  nested parallel_reduce inside pool tasks with a single thread must not dead lock
+  tl::ThreadPool pool (1);
+  tl::Future<long> f1 (SumUpTo (11, &pool), &pool);
+  tl::Future<long> f2 (SumUpTo (101, &pool), &pool);
+  EXPECT_EQ (f1.get () + f2.get (), 5105l);
+}
+
+//  Errors and cancellation
+TEST(4)
+{
+  std::string error;
+  try {
+    tl::parallel_for (0, 100, Failing (), 1);
+  } catch (tl::Exception &ex) {
+    error = ex.msg ();
+  }
+  EXPECT_EQ (error, "error at 17");
+
+  QMutex lock;
+  int count = 0;
+
+  tl::ThreadPool pool (0);
+  tl::TaskGroup group (&pool);
+  for (int i = 0; i < 10; ++i) {
+    group.run (new CountingTask (&lock, &count));
+  }
+  EXPECT_EQ (group.is_done (), false);
+  group.cancel ();
+  group.wait ();
+  EXPECT_EQ (group.is_done (), true);
+  EXPECT_EQ (group.finished (), size_t (10));
+  EXPECT_EQ (count, 0);
+
+  tl::TaskGroup group2 (&pool);
+  for (int i = 0; i < 10; ++i) {
+    group2.run (new CountingTask (&lock, &count));
+  }
+  group2.wait ();
+  EXPECT_EQ (count, 10);
+}
+
+//  Waiting with a timeout
+TEST(5)
+{
+  QMutex lock;
+  int count = 0;
+
+  //  no threads: every call executes one task
+  tl::ThreadPool pool0 (0);
+  tl::TaskGroup group0 (&pool0);
+  for (int i = 0; i < 3; ++i) {
+    group0.run (new CountingTask (&lock, &count));
+  }
+  EXPECT_EQ (group0.wait_for (10), false);
+  EXPECT_EQ (count, 1);
+  EXPECT_EQ (group0.wait_for (10), false);
+  EXPECT_EQ (group0.wait_for (10), true);
+  EXPECT_EQ (count, 3);
+
+  tl::ThreadPool pool (2);
+  tl::TaskGroup group (&pool);
+  for (int i = 0; i < 10; ++i) {
+    group.run (new CountingTask (&lock, &count));
+  }
+  while (! group.wait_for (10)) {
+    ;
+  }
+  EXPECT_EQ (count, 13);
+
+  //  errors are reported when the group has finished
+  std::string error;
+  tl::TaskGroup group2 (&pool);
+  group2.run (new FailingTask ());
+  try {
+    while (! group2.wait_for (10)) {
+      ;
+    }
+  } catch (tl::Exception &ex) {
+    error = ex.msg ();
+  }
+  EXPECT_EQ (error, "task failed");
+}
+
+//  Threads outside the pool only execute tasks of the group they are waiting for
+TEST(6)
+{
+  QMutex lock;
+  int count_a = 0, count_b = 0;
+
+  tl::ThreadPool pool (0);
+  tl::TaskGroup group_a (&pool);
+  tl::TaskGroup group_b (&pool);
+  for (int i = 0; i < 5; ++i) {
+    group_a.run (new CountingTask (&lock, &count_a));
+    group_b.run (new CountingTask (&lock, &count_b));
+  }
+
+  group_b.wait ();
+  EXPECT_EQ (count_b, 5);
+  EXPECT_EQ (count_a, 0);
+  EXPECT_EQ (group_a.is_done (), false);
+
+  while (! group_a.wait_for (10)) {
+    ;
+  }
+  EXPECT_EQ (count_a, 5);
+  EXPECT_EQ (count_b, 5);
+  EXPECT_EQ (group_b.is_cancelled (), false);
+}
@@ -24,10 +24,13 @@ SOURCES = \
   tlKDTree.cc \
   tlMath.cc \
   tlObject.cc \
+  tlProgress.cc \
   tlReuseVector.cc \
   tlStableVector.cc \
   tlString.cc \
   tlThreadedWorkers.cc \
+  tlThreadPool.cc \
+  tlProfiler.cc \
   tlUtils.cc \
   tlVariant.cc \
   tlWebDAV.cc \